@@ -14,6 +14,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * @{
  */
 
+#define ERRFILE_arm64_aes	( ERRFILE_ARCH | ERRFILE_CORE | 0x00000000 )
+#define ERRFILE_arm64_sha	( ERRFILE_ARCH | ERRFILE_CORE | 0x00010000 )
+
 /** @} */
 
 #endif /* _BITS_ERRFILE_H */
@@ -100,3 +100,41 @@ void bigint_multiply_raw ( const uint32_t *multiplicand0,
 		}
 	}
 }
+
+/**
+ * Multiply big integer by a single element and accumulate
+ *
+ * @v multiplicand0	Element 0 of big integer to be multiplied
+ * @v multiplier	Element to be multiplied
+ * @v value0		Element 0 of big integer to be added to
+ * @v size		Number of elements
+ * @ret carry		Carry out
+ */
+uint32_t bigint_multiply_accumulate_raw ( const uint32_t *multiplicand0,
+					  uint32_t multiplier,
+					  uint32_t *value0, unsigned int size ) {
+	const bigint_t ( size ) __attribute__ (( may_alias )) *multiplicand =
+		( ( const void * ) multiplicand0 );
+	bigint_t ( size ) __attribute__ (( may_alias )) *value =
+		( ( void * ) value0 );
+	uint32_t carry = 0;
+	uint64_t product;
+	unsigned int i;
+
+	/* Multiply and accumulate one element at a time.  The
+	 * compiler generates efficient code for the double-width
+	 * product without requiring any helper functions.  The carry
+	 * can never overflow, since:
+	 *
+	 *     a < 2^{n}, b < 2^{n}, c < 2^{n}, d < 2^{n}
+	 *         => ab + c + d < 2^{2n}
+	 */
+	for ( i = 0 ; i < size ; i++ ) {
+		product = ( ( ( uint64_t ) multiplicand->element[i] *
+			      multiplier ) + carry + value->element[i] );
+		value->element[i] = product;
+		carry = ( product >> 32 );
+	}
+
+	return carry;
+}
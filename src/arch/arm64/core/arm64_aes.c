@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * ARMv8 Cryptography Extensions accelerated AES
+ *
+ * The AESE and AESD instructions operate directly on the standard
+ * expanded key schedule, and the "equivalent inverse cipher"
+ * decryption key schedule constructed by the generic AES code.  We
+ * therefore reuse the generic AES context and key expansion, and
+ * accelerate only the block encryption and decryption.
+ *
+ * GCM hash key multiplication is accelerated using the PMULL
+ * polynomial multiplication instruction.  Reversing the bits within
+ * each byte converts the GCM bit ordering into a conventional
+ * little-endian polynomial representation, allowing the product to
+ * be reduced directly modulo x^128 + x^7 + x^2 + x + 1.
+ *
+ * Only registers v0-v7 are used, since the low halves of v8-v15 are
+ * callee-saved.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <ipxe/crypto.h>
+#include <ipxe/aes.h>
+#include <ipxe/cbc.h>
+#include <ipxe/gcm.h>
+
+/** ID_AA64ISAR0_EL1 AES field */
+#define ID_AA64ISAR0_AES( isar0 ) ( ( (isar0) >> 4 ) & 0xf )
+
+/** AES instructions are supported */
+#define ID_AA64ISAR0_AES_BASE 1
+
+/** AES and PMULL instructions are supported */
+#define ID_AA64ISAR0_AES_PMULL 2
+
+/** GCM field polynomial (excluding x^128 term), in each 64-bit lane */
+static const uint64_t aesce_poly[2] = { 0x87, 0x87 };
+
+/**
+ * Get supported AES instruction level
+ *
+ * @ret level		AES instruction level
+ */
+static unsigned int aesce_level ( void ) {
+	uint64_t isar0;
+
+	/* Read instruction set attribute register.  This is
+	 * accessible at EL1 and above, and is emulated by Linux for
+	 * userspace processes.
+	 */
+	__asm__ ( "mrs %0, ID_AA64ISAR0_EL1" : "=r" ( isar0 ) );
+	return ID_AA64ISAR0_AES ( isar0 );
+}
+
+/**
+ * Check for AES instruction support
+ *
+ * @ret rc		Return status code
+ */
+static int aesce_probe ( void ) {
+
+	/* Check for AES instructions */
+	if ( aesce_level() < ID_AA64ISAR0_AES_BASE ) {
+		DBGC ( &aesce_poly, "AESCE not supported\n" );
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+/**
+ * Check for AES and PMULL instruction support
+ *
+ * @ret rc		Return status code
+ */
+static int aesce_gcm_probe ( void ) {
+
+	/* Check for AES and polynomial multiplication instructions */
+	if ( aesce_level() < ID_AA64ISAR0_AES_PMULL ) {
+		DBGC ( &aesce_poly, "AESCE PMULL not supported\n" );
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+/**
+ * Set key
+ *
+ * @v ctx		Context
+ * @v key		Key
+ * @v keylen		Key length
+ * @ret rc		Return status code
+ */
+static int aesce_setkey ( void *ctx, const void *key, size_t keylen ) {
+
+	/* Use generic key expansion */
+	return cipher_setkey ( &aes_algorithm, ctx, key, keylen );
+}
+
+/**
+ * Encrypt data
+ *
+ * @v ctx		Context
+ * @v src		Data to encrypt
+ * @v dst		Buffer for encrypted data
+ * @v len		Length of data
+ */
+static void aesce_encrypt ( void *ctx, const void *src, void *dst,
+			    size_t len ) {
+	struct aes_context *aes = ctx;
+	const union aes_matrix *key;
+	unsigned long rounds;
+
+	/* Sanity check */
+	assert ( ( len % AES_BLOCKSIZE ) == 0 );
+
+	/* Encrypt each block */
+	for ( ; len ; src += AES_BLOCKSIZE, dst += AES_BLOCKSIZE,
+		      len -= AES_BLOCKSIZE ) {
+		key = aes->encrypt.key;
+		rounds = ( aes->rounds - 2 );
+		__asm__ __volatile__ ( ".arch_extension crypto\n\t"
+				       "ld1 {v0.16b}, [%2]\n\t"
+				       "\n1:\n\t"
+				       "ld1 {v1.16b}, [%0], #16\n\t"
+				       "aese v0.16b, v1.16b\n\t"
+				       "aesmc v0.16b, v0.16b\n\t"
+				       "subs %1, %1, #1\n\t"
+				       "bne 1b\n\t"
+				       "ld1 {v1.16b, v2.16b}, [%0]\n\t"
+				       "aese v0.16b, v1.16b\n\t"
+				       "eor v0.16b, v0.16b, v2.16b\n\t"
+				       "st1 {v0.16b}, [%3]\n\t"
+				       : "+r" ( key ), "+r" ( rounds )
+				       : "r" ( src ), "r" ( dst )
+				       : "v0", "v1", "v2", "cc", "memory" );
+	}
+}
+
+/**
+ * Decrypt data
+ *
+ * @v ctx		Context
+ * @v src		Data to decrypt
+ * @v dst		Buffer for decrypted data
+ * @v len		Length of data
+ */
+static void aesce_decrypt ( void *ctx, const void *src, void *dst,
+			    size_t len ) {
+	struct aes_context *aes = ctx;
+	const union aes_matrix *key;
+	unsigned long rounds;
+
+	/* Sanity check */
+	assert ( ( len % AES_BLOCKSIZE ) == 0 );
+
+	/* Decrypt each block */
+	for ( ; len ; src += AES_BLOCKSIZE, dst += AES_BLOCKSIZE,
+		      len -= AES_BLOCKSIZE ) {
+		key = aes->decrypt.key;
+		rounds = ( aes->rounds - 2 );
+		__asm__ __volatile__ ( ".arch_extension crypto\n\t"
+				       "ld1 {v0.16b}, [%2]\n\t"
+				       "\n1:\n\t"
+				       "ld1 {v1.16b}, [%0], #16\n\t"
+				       "aesd v0.16b, v1.16b\n\t"
+				       "aesimc v0.16b, v0.16b\n\t"
+				       "subs %1, %1, #1\n\t"
+				       "bne 1b\n\t"
+				       "ld1 {v1.16b, v2.16b}, [%0]\n\t"
+				       "aesd v0.16b, v1.16b\n\t"
+				       "eor v0.16b, v0.16b, v2.16b\n\t"
+				       "st1 {v0.16b}, [%3]\n\t"
+				       : "+r" ( key ), "+r" ( rounds )
+				       : "r" ( src ), "r" ( dst )
+				       : "v0", "v1", "v2", "cc", "memory" );
+	}
+}
+
+/**
+ * Multiply polynomial by hash key in situ
+ *
+ * @v key		Hash key
+ * @v poly		Multiplicand and result
+ */
+static void aesce_gcm_multiply ( const union gcm_block *key,
+				 union gcm_block *poly ) {
+
+	__asm__ __volatile__ ( ".arch_extension crypto\n\t"
+			       /* Load and bit-reverse operands */
+			       "ld1 {v0.16b}, [%1]\n\t"
+			       "ld1 {v1.16b}, [%0]\n\t"
+			       "rbit v0.16b, v0.16b\n\t"
+			       "rbit v1.16b, v1.16b\n\t"
+			       /* Calculate 256-bit product in v3:v2 */
+			       "pmull v2.1q, v0.1d, v1.1d\n\t"
+			       "pmull2 v3.1q, v0.2d, v1.2d\n\t"
+			       "ext v4.16b, v1.16b, v1.16b, #8\n\t"
+			       "pmull v5.1q, v0.1d, v4.1d\n\t"
+			       "pmull2 v4.1q, v0.2d, v4.2d\n\t"
+			       "eor v4.16b, v4.16b, v5.16b\n\t"
+			       "movi v5.16b, #0\n\t"
+			       "ext v6.16b, v5.16b, v4.16b, #8\n\t"
+			       "ext v7.16b, v4.16b, v5.16b, #8\n\t"
+			       "eor v2.16b, v2.16b, v6.16b\n\t"
+			       "eor v3.16b, v3.16b, v7.16b\n\t"
+			       /* Reduce upper half via x^128 = x^7+x^2+x+1 */
+			       "ld1 {v6.2d}, [%2]\n\t"
+			       "pmull2 v7.1q, v3.2d, v6.2d\n\t"
+			       "ext v4.16b, v7.16b, v5.16b, #8\n\t"
+			       "eor v3.16b, v3.16b, v4.16b\n\t"
+			       "ext v4.16b, v5.16b, v7.16b, #8\n\t"
+			       "eor v2.16b, v2.16b, v4.16b\n\t"
+			       "pmull v7.1q, v3.1d, v6.1d\n\t"
+			       "eor v2.16b, v2.16b, v7.16b\n\t"
+			       /* Bit-reverse and store result */
+			       "rbit v2.16b, v2.16b\n\t"
+			       "st1 {v2.16b}, [%1]\n\t"
+			       :
+			       : "r" ( key ), "r" ( poly ), "r" ( aesce_poly )
+			       : "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7",
+				 "memory" );
+}
+
+/** ARMv8 Cryptography Extensions accelerated basic AES algorithm */
+struct cipher_algorithm aesce_algorithm = {
+	.name = "aesce",
+	.ctxsize = sizeof ( struct aes_context ),
+	.blocksize = AES_BLOCKSIZE,
+	.alignsize = 0,
+	.authsize = 0,
+	.setkey = aesce_setkey,
+	.setiv = cipher_null_setiv,
+	.encrypt = aesce_encrypt,
+	.decrypt = aesce_decrypt,
+	.auth = cipher_null_auth,
+};
+
+/* ARMv8 accelerated AES in Cipher Block Chaining mode */
+CBC_CIPHER ( aesce_cbc, aesce_cbc_algorithm,
+	     aesce_algorithm, struct aes_context, AES_BLOCKSIZE );
+
+/* ARMv8 accelerated AES in Galois/Counter mode */
+GCM_CIPHER ( aesce_gcm, aesce_gcm_algorithm,
+	     aesce_algorithm, struct aes_context, AES_BLOCKSIZE,
+	     aesce_gcm_multiply );
+
+/** ARMv8 accelerated AES-CBC */
+struct cipher_accelerator aesce_cbc_accelerator __cipher_accelerator = {
+	.generic = &aes_cbc_algorithm,
+	.cipher = &aesce_cbc_algorithm,
+	.probe = aesce_probe,
+};
+
+/** ARMv8 accelerated AES-GCM */
+struct cipher_accelerator aesce_gcm_accelerator __cipher_accelerator = {
+	.generic = &aes_gcm_algorithm,
+	.cipher = &aesce_gcm_algorithm,
+	.probe = aesce_gcm_probe,
+};
@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * ARMv8 Cryptography Extensions accelerated SHA-1 and SHA-256
+ *
+ * Only registers v0-v7 and v16-v23 are used, since the low halves of
+ * v8-v15 are callee-saved.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <byteswap.h>
+#include <errno.h>
+#include <ipxe/crypto.h>
+#include <ipxe/sha1.h>
+#include <ipxe/sha256.h>
+
+/** ID_AA64ISAR0_EL1 SHA1 field */
+#define ID_AA64ISAR0_SHA1( isar0 ) ( ( (isar0) >> 8 ) & 0xf )
+
+/** ID_AA64ISAR0_EL1 SHA2 field */
+#define ID_AA64ISAR0_SHA2( isar0 ) ( ( (isar0) >> 12 ) & 0xf )
+
+/** SHA-1 round constants (replicated across all lanes) */
+static const uint32_t cesha_sha1_k[16] = {
+	0x5a827999, 0x5a827999, 0x5a827999, 0x5a827999,
+	0x6ed9eba1, 0x6ed9eba1, 0x6ed9eba1, 0x6ed9eba1,
+	0x8f1bbcdc, 0x8f1bbcdc, 0x8f1bbcdc, 0x8f1bbcdc,
+	0xca62c1d6, 0xca62c1d6, 0xca62c1d6, 0xca62c1d6,
+};
+
+/** Message schedule registers */
+#define M0 "v16"
+#define M1 "v17"
+#define M2 "v18"
+#define M3 "v19"
+
+/** SHA-1 round constant registers */
+#define K0 "v20"
+#define K1 "v21"
+#define K2 "v22"
+#define K3 "v23"
+
+/** SHA-1 "E" registers */
+#define E0 "1"
+#define E1 "2"
+
+/**
+ * Perform four SHA-1 rounds
+ *
+ * @v j			Round number divided by four
+ * @v fn		Round function ("c", "p", or "m")
+ * @v k			Round constant register
+ * @v m			Message schedule register for these rounds
+ * @v m1		Message schedule register for next rounds
+ * @v m2		Message schedule register for later rounds
+ * @v m3		Message schedule register for previous rounds
+ * @v e			"E" register number for these rounds
+ * @v enext		"E" register number for next rounds
+ *
+ * The hash state is held in v0 (ABCD), and v3 is used as a temporary.
+ */
+#define CE_SHA1_QUAD( j, fn, k, m, m1, m2, m3, e, enext )		\
+	"add v3.4s, " m ".4s, " k ".4s\n\t"				\
+	"sha1h s" enext ", s0\n\t"					\
+	"sha1" #fn " q0, s" e ", v3.4s\n\t"				\
+	".if " #j " < 16\n\t"						\
+	"sha1su0 " m ".4s, " m1 ".4s, " m2 ".4s\n\t"			\
+	"sha1su1 " m ".4s, " m3 ".4s\n\t"				\
+	".endif\n\t"
+
+/**
+ * Perform four SHA-256 rounds
+ *
+ * @v q			Round number divided by four
+ * @v m			Message schedule register for these rounds
+ * @v m1		Message schedule register for next rounds
+ * @v m2		Message schedule register for later rounds
+ * @v m3		Message schedule register for previous rounds
+ *
+ * The hash state is held in v0 (ABCD) and v1 (EFGH).  Registers
+ * v2-v4 are used as temporaries.
+ */
+#define CE_SHA256_QUAD( q, m, m1, m2, m3 )				\
+	"ld1 {v4.4s}, [%[kp]], #16\n\t"				\
+	"add v3.4s, " m ".4s, v4.4s\n\t"				\
+	"mov v2.16b, v0.16b\n\t"					\
+	"sha256h q0, q1, v3.4s\n\t"					\
+	"sha256h2 q1, q2, v3.4s\n\t"					\
+	".if " #q " < 12\n\t"						\
+	"sha256su0 " m ".4s, " m1 ".4s\n\t"				\
+	"sha256su1 " m ".4s, " m2 ".4s, " m3 ".4s\n\t"		\
+	".endif\n\t"
+
+/**
+ * Read instruction set attribute register
+ *
+ * @ret isar0		ID_AA64ISAR0_EL1
+ */
+static uint64_t cesha_isar0 ( void ) {
+	uint64_t isar0;
+
+	/* This register is accessible at EL1 and above, and is
+	 * emulated by Linux for userspace processes.
+	 */
+	__asm__ ( "mrs %0, ID_AA64ISAR0_EL1" : "=r" ( isar0 ) );
+	return isar0;
+}
+
+/**
+ * Check for SHA-1 instruction support
+ *
+ * @ret rc		Return status code
+ */
+static int cesha_sha1_probe ( void ) {
+
+	if ( ! ID_AA64ISAR0_SHA1 ( cesha_isar0() ) ) {
+		DBGC ( &cesha_sha1_k, "CESHA SHA-1 not supported\n" );
+		return -ENOTSUP;
+	}
+	return 0;
+}
+
+/**
+ * Check for SHA-256 instruction support
+ *
+ * @ret rc		Return status code
+ */
+static int cesha_sha256_probe ( void ) {
+
+	if ( ! ID_AA64ISAR0_SHA2 ( cesha_isar0() ) ) {
+		DBGC ( &cesha_sha1_k, "CESHA SHA-256 not supported\n" );
+		return -ENOTSUP;
+	}
+	return 0;
+}
+
+/**
+ * Digest SHA-1 data blocks
+ *
+ * @v digest		Intermediate digest value
+ * @v data		Data blocks
+ * @v count		Number of data blocks
+ */
+static void cesha_sha1_blocks ( void *digest, const void *data,
+				size_t count ) {
+	struct sha1_digest *hash = digest;
+	uint32_t state[5];
+	unsigned int i;
+
+	/* Do nothing if there are no blocks to digest */
+	if ( ! count )
+		return;
+
+	/* Convert digest to host-endian order */
+	for ( i = 0 ; i < 5 ; i++ )
+		state[i] = be32_to_cpu ( hash->h[i] );
+
+	/* Digest blocks */
+	__asm__ __volatile__ ( ".arch_extension sha2\n\t"
+			       "ld1 {v20.4s-v23.4s}, [%[k]]\n\t"
+			       "ld1 {v5.4s}, [%[state]]\n\t"
+			       "ldr s6, [%[state], #16]\n\t"
+			       "\n1:\n\t"
+			       "ld1 {v16.16b-v19.16b}, [%[data]], #64\n\t"
+			       "rev32 v16.16b, v16.16b\n\t"
+			       "rev32 v17.16b, v17.16b\n\t"
+			       "rev32 v18.16b, v18.16b\n\t"
+			       "rev32 v19.16b, v19.16b\n\t"
+			       "mov v0.16b, v5.16b\n\t"
+			       "mov v1.16b, v6.16b\n\t"
+			       CE_SHA1_QUAD ( 0, c, K0, M0, M1, M2, M3,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 1, c, K0, M1, M2, M3, M0,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 2, c, K0, M2, M3, M0, M1,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 3, c, K0, M3, M0, M1, M2,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 4, c, K0, M0, M1, M2, M3,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 5, p, K1, M1, M2, M3, M0,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 6, p, K1, M2, M3, M0, M1,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 7, p, K1, M3, M0, M1, M2,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 8, p, K1, M0, M1, M2, M3,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 9, p, K1, M1, M2, M3, M0,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 10, m, K2, M2, M3, M0, M1,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 11, m, K2, M3, M0, M1, M2,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 12, m, K2, M0, M1, M2, M3,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 13, m, K2, M1, M2, M3, M0,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 14, m, K2, M2, M3, M0, M1,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 15, p, K3, M3, M0, M1, M2,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 16, p, K3, M0, M1, M2, M3,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 17, p, K3, M1, M2, M3, M0,
+					      E1, E0 )
+			       CE_SHA1_QUAD ( 18, p, K3, M2, M3, M0, M1,
+					      E0, E1 )
+			       CE_SHA1_QUAD ( 19, p, K3, M3, M0, M1, M2,
+					      E1, E0 )
+			       "add v5.4s, v5.4s, v0.4s\n\t"
+			       "add v6.2s, v6.2s, v1.2s\n\t"
+			       "subs %[count], %[count], #1\n\t"
+			       "bne 1b\n\t"
+			       "st1 {v5.4s}, [%[state]]\n\t"
+			       "str s6, [%[state], #16]\n\t"
+			       : [data] "+r" ( data ), [count] "+r" ( count )
+			       : [state] "r" ( state ), [k] "r" ( cesha_sha1_k )
+			       : "v0", "v1", "v2", "v3", "v5", "v6", "v16", "v17",
+				 "v18", "v19", "v20", "v21", "v22", "v23", "cc",
+				 "memory" );
+
+	/* Convert digest back to big-endian order */
+	for ( i = 0 ; i < 5 ; i++ )
+		hash->h[i] = cpu_to_be32 ( state[i] );
+}
+
+/**
+ * Digest SHA-256 data blocks
+ *
+ * @v digest		Intermediate digest value
+ * @v data		Data blocks
+ * @v count		Number of data blocks
+ */
+static void cesha_sha256_blocks ( void *digest, const void *data,
+				  size_t count ) {
+	struct sha256_digest *hash = digest;
+	uint32_t state[8];
+	const uint32_t *kp;
+	unsigned int i;
+
+	/* Do nothing if there are no blocks to digest */
+	if ( ! count )
+		return;
+
+	/* Convert digest to host-endian order */
+	for ( i = 0 ; i < 8 ; i++ )
+		state[i] = be32_to_cpu ( hash->h[i] );
+
+	/* Digest blocks */
+	__asm__ __volatile__ ( ".arch_extension sha2\n\t"
+			       "ld1 {v5.4s, v6.4s}, [%[state]]\n\t"
+			       "\n1:\n\t"
+			       "ld1 {v16.16b-v19.16b}, [%[data]], #64\n\t"
+			       "rev32 v16.16b, v16.16b\n\t"
+			       "rev32 v17.16b, v17.16b\n\t"
+			       "rev32 v18.16b, v18.16b\n\t"
+			       "rev32 v19.16b, v19.16b\n\t"
+			       "mov %[kp], %[k]\n\t"
+			       "mov v0.16b, v5.16b\n\t"
+			       "mov v1.16b, v6.16b\n\t"
+			       CE_SHA256_QUAD ( 0, M0, M1, M2, M3 )
+			       CE_SHA256_QUAD ( 1, M1, M2, M3, M0 )
+			       CE_SHA256_QUAD ( 2, M2, M3, M0, M1 )
+			       CE_SHA256_QUAD ( 3, M3, M0, M1, M2 )
+			       CE_SHA256_QUAD ( 4, M0, M1, M2, M3 )
+			       CE_SHA256_QUAD ( 5, M1, M2, M3, M0 )
+			       CE_SHA256_QUAD ( 6, M2, M3, M0, M1 )
+			       CE_SHA256_QUAD ( 7, M3, M0, M1, M2 )
+			       CE_SHA256_QUAD ( 8, M0, M1, M2, M3 )
+			       CE_SHA256_QUAD ( 9, M1, M2, M3, M0 )
+			       CE_SHA256_QUAD ( 10, M2, M3, M0, M1 )
+			       CE_SHA256_QUAD ( 11, M3, M0, M1, M2 )
+			       CE_SHA256_QUAD ( 12, M0, M1, M2, M3 )
+			       CE_SHA256_QUAD ( 13, M1, M2, M3, M0 )
+			       CE_SHA256_QUAD ( 14, M2, M3, M0, M1 )
+			       CE_SHA256_QUAD ( 15, M3, M0, M1, M2 )
+			       "add v5.4s, v5.4s, v0.4s\n\t"
+			       "add v6.4s, v6.4s, v1.4s\n\t"
+			       "subs %[count], %[count], #1\n\t"
+			       "bne 1b\n\t"
+			       "st1 {v5.4s, v6.4s}, [%[state]]\n\t"
+			       : [data] "+r" ( data ), [count] "+r" ( count ),
+				 [kp] "=&r" ( kp )
+			       : [state] "r" ( state ), [k] "r" ( sha256_k )
+			       : "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v16",
+				 "v17", "v18", "v19", "cc", "memory" );
+
+	/* Convert digest back to big-endian order */
+	for ( i = 0 ; i < 8 ; i++ )
+		hash->h[i] = cpu_to_be32 ( state[i] );
+}
+
+/** ARMv8 accelerated SHA-1 */
+struct digest_accelerator cesha_sha1_accelerator __digest_accelerator = {
+	.name = "cesha",
+	.generic = &sha1_algorithm,
+	.blocks = cesha_sha1_blocks,
+	.probe = cesha_sha1_probe,
+};
+
+/** ARMv8 accelerated SHA-256 */
+struct digest_accelerator cesha_sha256_accelerator __digest_accelerator = {
+	.name = "cesha",
+	.generic = &sha256_algorithm,
+	.blocks = cesha_sha256_blocks,
+	.probe = cesha_sha256_probe,
+};
@@ -36,6 +36,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Colour for debug messages */
 #define colour 0x861d
 
+/** CR4 flag indicating that SSE instructions have been enabled */
+#define CR4_OSFXSR 0x00000200UL
+
 /**
  * Check whether or not CPUID instruction is supported
  *
@@ -171,3 +174,34 @@ void x86_features ( struct x86_features *features ) {
 	/* Get AMD-defined features */
 	x86_amd_features ( features );
 }
+
+/**
+ * Check whether or not SSE instructions are usable
+ *
+ * @ret rc		Return status code
+ */
+int x86_sse_enabled ( void ) {
+	unsigned long cs;
+	unsigned long cr4;
+
+	/* If we are not running in ring 0, then we must be running
+	 * under an operating system (e.g. Linux userspace) which
+	 * will have enabled SSE instructions.
+	 */
+	__asm__ ( "mov %%cs, %0" : "=r" ( cs ) );
+	if ( cs & 3 )
+		return 0;
+
+	/* Otherwise, check that SSE instructions have been enabled
+	 * by the firmware (as is always the case under UEFI, but not
+	 * necessarily under BIOS).
+	 */
+	__asm__ ( "mov %%cr4, %0" : "=r" ( cr4 ) );
+	if ( ! ( cr4 & CR4_OSFXSR ) ) {
+		DBGC ( colour, "CPUID SSE is not enabled (CR4 %#08lx)\n",
+		       cr4 );
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
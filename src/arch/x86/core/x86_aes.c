@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * AES-NI accelerated AES
+ *
+ * The AES-NI instructions operate directly on the standard expanded
+ * key schedule, and the "equivalent inverse cipher" decryption key
+ * schedule constructed by the generic AES code.  We therefore reuse
+ * the generic AES context and key expansion, and accelerate only the
+ * block encryption and decryption.
+ *
+ * GCM hash key multiplication is accelerated using the PCLMULQDQ
+ * carry-less multiplication instruction, as described in Intel's
+ * white paper "Intel Carry-Less Multiplication Instruction and its
+ * Usage for Computing the GCM Mode".
+ *
+ * iPXE is built without SSE support, and so the compiler will never
+ * hold values in SSE registers.  The inline assembly therefore does
+ * not (and cannot) declare these registers as clobbered.  Only
+ * registers %xmm0-%xmm5 are used, since these are the only SSE
+ * registers treated as volatile by all of the calling conventions
+ * under which we may be running.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <ipxe/crypto.h>
+#include <ipxe/cpuid.h>
+#include <ipxe/aes.h>
+#include <ipxe/cbc.h>
+#include <ipxe/gcm.h>
+
+/** Byte reversal mask for PSHUFB */
+static const uint8_t aesni_reverse[16] = {
+	15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+};
+
+/**
+ * Check for AES-NI support
+ *
+ * @ret rc		Return status code
+ */
+static int aesni_probe ( void ) {
+	struct x86_features features;
+
+	/* Check for AES instructions */
+	x86_features ( &features );
+	if ( ! ( features.intel.ecx & CPUID_FEATURES_INTEL_ECX_AES ) ) {
+		DBGC ( &aesni_reverse, "AESNI not supported\n" );
+		return -ENOTSUP;
+	}
+
+	/* Check that SSE instructions are usable */
+	return x86_sse_enabled();
+}
+
+/**
+ * Check for AES-NI and PCLMULQDQ support
+ *
+ * @ret rc		Return status code
+ */
+static int aesni_gcm_probe ( void ) {
+	struct x86_features features;
+	int rc;
+
+	/* Check for AES instructions */
+	if ( ( rc = aesni_probe() ) != 0 )
+		return rc;
+
+	/* Check for carry-less multiplication and byte shuffling */
+	x86_features ( &features );
+	if ( ! ( features.intel.ecx & CPUID_FEATURES_INTEL_ECX_PCLMULQDQ ) ) {
+		DBGC ( &aesni_reverse, "AESNI PCLMULQDQ not supported\n" );
+		return -ENOTSUP;
+	}
+	if ( ! ( features.intel.ecx & CPUID_FEATURES_INTEL_ECX_SSSE3 ) ) {
+		DBGC ( &aesni_reverse, "AESNI SSSE3 not supported\n" );
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+/**
+ * Set key
+ *
+ * @v ctx		Context
+ * @v key		Key
+ * @v keylen		Key length
+ * @ret rc		Return status code
+ */
+static int aesni_setkey ( void *ctx, const void *key, size_t keylen ) {
+
+	/* Use generic key expansion */
+	return cipher_setkey ( &aes_algorithm, ctx, key, keylen );
+}
+
+/**
+ * Encrypt data
+ *
+ * @v ctx		Context
+ * @v src		Data to encrypt
+ * @v dst		Buffer for encrypted data
+ * @v len		Length of data
+ */
+static void aesni_encrypt ( void *ctx, const void *src, void *dst,
+			    size_t len ) {
+	struct aes_context *aes = ctx;
+	const union aes_matrix *key;
+	unsigned long rounds;
+
+	/* Sanity check */
+	assert ( ( len % AES_BLOCKSIZE ) == 0 );
+
+	/* Encrypt each block */
+	for ( ; len ; src += AES_BLOCKSIZE, dst += AES_BLOCKSIZE,
+		      len -= AES_BLOCKSIZE ) {
+		key = aes->encrypt.key;
+		rounds = ( aes->rounds - 2 );
+		__asm__ __volatile__ ( "movdqu (%2), %%xmm0\n\t"
+				       "movdqu (%0), %%xmm1\n\t"
+				       "pxor %%xmm1, %%xmm0\n\t"
+				       "\n1:\n\t"
+				       "add $16, %0\n\t"
+				       "movdqu (%0), %%xmm1\n\t"
+				       "aesenc %%xmm1, %%xmm0\n\t"
+				       "dec %1\n\t"
+				       "jnz 1b\n\t"
+				       "movdqu 16(%0), %%xmm1\n\t"
+				       "aesenclast %%xmm1, %%xmm0\n\t"
+				       "movdqu %%xmm0, (%3)\n\t"
+				       : "+r" ( key ), "+r" ( rounds )
+				       : "r" ( src ), "r" ( dst )
+				       : "memory" );
+	}
+}
+
+/**
+ * Decrypt data
+ *
+ * @v ctx		Context
+ * @v src		Data to decrypt
+ * @v dst		Buffer for decrypted data
+ * @v len		Length of data
+ */
+static void aesni_decrypt ( void *ctx, const void *src, void *dst,
+			    size_t len ) {
+	struct aes_context *aes = ctx;
+	const union aes_matrix *key;
+	unsigned long rounds;
+
+	/* Sanity check */
+	assert ( ( len % AES_BLOCKSIZE ) == 0 );
+
+	/* Decrypt each block */
+	for ( ; len ; src += AES_BLOCKSIZE, dst += AES_BLOCKSIZE,
+		      len -= AES_BLOCKSIZE ) {
+		key = aes->decrypt.key;
+		rounds = ( aes->rounds - 2 );
+		__asm__ __volatile__ ( "movdqu (%2), %%xmm0\n\t"
+				       "movdqu (%0), %%xmm1\n\t"
+				       "pxor %%xmm1, %%xmm0\n\t"
+				       "\n1:\n\t"
+				       "add $16, %0\n\t"
+				       "movdqu (%0), %%xmm1\n\t"
+				       "aesdec %%xmm1, %%xmm0\n\t"
+				       "dec %1\n\t"
+				       "jnz 1b\n\t"
+				       "movdqu 16(%0), %%xmm1\n\t"
+				       "aesdeclast %%xmm1, %%xmm0\n\t"
+				       "movdqu %%xmm0, (%3)\n\t"
+				       : "+r" ( key ), "+r" ( rounds )
+				       : "r" ( src ), "r" ( dst )
+				       : "memory" );
+	}
+}
+
+/**
+ * Multiply polynomial by hash key in situ
+ *
+ * @v key		Hash key
+ * @v poly		Multiplicand and result
+ *
+ * Both operands are byte-reversed so that each may be treated as a
+ * bit-reflected 128-bit little-endian value.  The 256-bit carry-less
+ * product is shifted left by one bit to compensate for the
+ * reflection, and then reduced modulo the (reflected) field
+ * polynomial using shifts and XORs.
+ */
+static void aesni_gcm_multiply ( const union gcm_block *key,
+				 union gcm_block *poly ) {
+
+	__asm__ __volatile__ ( /* Load and byte-reverse operands */
+			       "movdqu (%2), %%xmm5\n\t"
+			       "movdqu (%1), %%xmm0\n\t"
+			       "movdqu (%0), %%xmm1\n\t"
+			       "pshufb %%xmm5, %%xmm0\n\t"
+			       "pshufb %%xmm5, %%xmm1\n\t"
+			       /* Calculate 256-bit product in %xmm3:%xmm2 */
+			       "movdqa %%xmm0, %%xmm2\n\t"
+			       "pclmulqdq $0x00, %%xmm1, %%xmm2\n\t"
+			       "movdqa %%xmm0, %%xmm3\n\t"
+			       "pclmulqdq $0x11, %%xmm1, %%xmm3\n\t"
+			       "movdqa %%xmm0, %%xmm4\n\t"
+			       "pclmulqdq $0x10, %%xmm1, %%xmm4\n\t"
+			       "pclmulqdq $0x01, %%xmm1, %%xmm0\n\t"
+			       "pxor %%xmm4, %%xmm0\n\t"
+			       "movdqa %%xmm0, %%xmm4\n\t"
+			       "pslldq $8, %%xmm4\n\t"
+			       "psrldq $8, %%xmm0\n\t"
+			       "pxor %%xmm4, %%xmm2\n\t"
+			       "pxor %%xmm0, %%xmm3\n\t"
+			       /* Shift product left by one bit */
+			       "movdqa %%xmm2, %%xmm0\n\t"
+			       "movdqa %%xmm3, %%xmm1\n\t"
+			       "pslld $1, %%xmm2\n\t"
+			       "pslld $1, %%xmm3\n\t"
+			       "psrld $31, %%xmm0\n\t"
+			       "psrld $31, %%xmm1\n\t"
+			       "movdqa %%xmm0, %%xmm4\n\t"
+			       "pslldq $4, %%xmm1\n\t"
+			       "pslldq $4, %%xmm0\n\t"
+			       "psrldq $12, %%xmm4\n\t"
+			       "por %%xmm0, %%xmm2\n\t"
+			       "por %%xmm1, %%xmm3\n\t"
+			       "por %%xmm4, %%xmm3\n\t"
+			       /* Reduce (first phase) */
+			       "movdqa %%xmm2, %%xmm0\n\t"
+			       "movdqa %%xmm2, %%xmm1\n\t"
+			       "movdqa %%xmm2, %%xmm4\n\t"
+			       "pslld $31, %%xmm0\n\t"
+			       "pslld $30, %%xmm1\n\t"
+			       "pslld $25, %%xmm4\n\t"
+			       "pxor %%xmm1, %%xmm0\n\t"
+			       "pxor %%xmm4, %%xmm0\n\t"
+			       "movdqa %%xmm0, %%xmm5\n\t"
+			       "pslldq $12, %%xmm0\n\t"
+			       "psrldq $4, %%xmm5\n\t"
+			       "pxor %%xmm0, %%xmm2\n\t"
+			       /* Reduce (second phase) */
+			       "movdqa %%xmm2, %%xmm0\n\t"
+			       "movdqa %%xmm2, %%xmm1\n\t"
+			       "movdqa %%xmm2, %%xmm4\n\t"
+			       "psrld $1, %%xmm0\n\t"
+			       "psrld $2, %%xmm1\n\t"
+			       "psrld $7, %%xmm4\n\t"
+			       "pxor %%xmm1, %%xmm0\n\t"
+			       "pxor %%xmm4, %%xmm0\n\t"
+			       "pxor %%xmm5, %%xmm0\n\t"
+			       "pxor %%xmm0, %%xmm2\n\t"
+			       "pxor %%xmm2, %%xmm3\n\t"
+			       /* Byte-reverse and store result */
+			       "movdqu (%2), %%xmm5\n\t"
+			       "pshufb %%xmm5, %%xmm3\n\t"
+			       "movdqu %%xmm3, (%1)\n\t"
+			       :
+			       : "r" ( key ), "r" ( poly ), "r" ( aesni_reverse )
+			       : "memory" );
+}
+
+/** AES-NI accelerated basic AES algorithm */
+struct cipher_algorithm aesni_algorithm = {
+	.name = "aesni",
+	.ctxsize = sizeof ( struct aes_context ),
+	.blocksize = AES_BLOCKSIZE,
+	.alignsize = 0,
+	.authsize = 0,
+	.setkey = aesni_setkey,
+	.setiv = cipher_null_setiv,
+	.encrypt = aesni_encrypt,
+	.decrypt = aesni_decrypt,
+	.auth = cipher_null_auth,
+};
+
+/* AES-NI accelerated AES in Cipher Block Chaining mode */
+CBC_CIPHER ( aesni_cbc, aesni_cbc_algorithm,
+	     aesni_algorithm, struct aes_context, AES_BLOCKSIZE );
+
+/* AES-NI accelerated AES in Galois/Counter mode */
+GCM_CIPHER ( aesni_gcm, aesni_gcm_algorithm,
+	     aesni_algorithm, struct aes_context, AES_BLOCKSIZE,
+	     aesni_gcm_multiply );
+
+/** AES-NI accelerated AES-CBC */
+struct cipher_accelerator aesni_cbc_accelerator __cipher_accelerator = {
+	.generic = &aes_cbc_algorithm,
+	.cipher = &aesni_cbc_algorithm,
+	.probe = aesni_probe,
+};
+
+/** AES-NI accelerated AES-GCM */
+struct cipher_accelerator aesni_gcm_accelerator __cipher_accelerator = {
+	.generic = &aes_gcm_algorithm,
+	.cipher = &aesni_gcm_algorithm,
+	.probe = aesni_gcm_probe,
+};
@@ -94,3 +94,44 @@ void bigint_multiply_raw ( const uint32_t *multiplicand0,
 		}
 	}
 }
+
+/**
+ * Multiply big integer by a single element and accumulate
+ *
+ * @v multiplicand0	Element 0 of big integer to be multiplied
+ * @v multiplier	Element to be multiplied
+ * @v value0		Element 0 of big integer to be added to
+ * @v size		Number of elements
+ * @ret carry		Carry out
+ */
+uint32_t bigint_multiply_accumulate_raw ( const uint32_t *multiplicand0,
+					  uint32_t multiplier,
+					  uint32_t *value0, unsigned int size ) {
+	const bigint_t ( size ) __attribute__ (( may_alias )) *multiplicand =
+		( ( const void * ) multiplicand0 );
+	bigint_t ( size ) __attribute__ (( may_alias )) *value =
+		( ( void * ) value0 );
+	uint32_t carry = 0;
+	uint32_t discard_a;
+	unsigned int i;
+
+	/* Multiply and accumulate one element at a time.  The carry
+	 * can never overflow, since:
+	 *
+	 *     a < 2^{n}, b < 2^{n}, c < 2^{n}, d < 2^{n}
+	 *         => ab + c + d < 2^{2n}
+	 */
+	for ( i = 0 ; i < size ; i++ ) {
+		__asm__ ( "mull %4\n\t"
+			  "addl %3, %%eax\n\t"
+			  "adcl $0, %%edx\n\t"
+			  "addl %%eax, %1\n\t"
+			  "adcl $0, %%edx\n\t"
+			  : "=&a" ( discard_a ), "+m" ( value->element[i] ),
+			    "=&d" ( carry )
+			  : "r" ( carry ), "rm" ( multiplier ),
+			    "0" ( multiplicand->element[i] ) );
+	}
+
+	return carry;
+}
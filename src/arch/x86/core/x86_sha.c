@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * SHA extensions accelerated SHA-1 and SHA-256
+ *
+ * The instruction sequences are based upon those described in
+ * Intel's white paper "Intel SHA Extensions".
+ *
+ * iPXE is built without SSE support, and so the compiler will never
+ * hold values in SSE registers.  The inline assembly therefore does
+ * not (and cannot) declare these registers as clobbered.  Registers
+ * %xmm6 and %xmm7 are preserved explicitly, since these are treated
+ * as callee-saved by the UEFI calling convention.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <byteswap.h>
+#include <errno.h>
+#include <ipxe/crypto.h>
+#include <ipxe/cpuid.h>
+#include <ipxe/sha1.h>
+#include <ipxe/sha256.h>
+
+/** Byte reversal mask for PSHUFB */
+static const uint8_t shani_reverse[16] = {
+	15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+};
+
+/** Dword byte swap mask for PSHUFB */
+static const uint8_t shani_bswap[16] = {
+	3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+};
+
+/** SHA-256 digest words in {ABEF,CDGH} register order */
+static const uint8_t shani_sha256_order[8] = { 5, 4, 1, 0, 7, 6, 3, 2 };
+
+/** Message schedule registers */
+#define M0 "%%xmm3"
+#define M1 "%%xmm4"
+#define M2 "%%xmm5"
+#define M3 "%%xmm6"
+
+/** SHA-1 "E" registers */
+#define E0 "%%xmm1"
+#define E1 "%%xmm2"
+
+/**
+ * Perform four SHA-1 rounds
+ *
+ * @v j			Round number divided by four
+ * @v k			Round function selector
+ * @v m			Message schedule register for these rounds
+ * @v next		Message schedule register for next rounds
+ * @v prev		Message schedule register for previous rounds
+ * @v prev2		Message schedule register for earlier rounds
+ * @v e			"E" register for these rounds
+ * @v enext		"E" register for next rounds
+ *
+ * The hash state is held in %xmm0 and the byte reversal mask in %xmm7.
+ */
+#define SHANI_SHA1_QUAD( j, k, m, next, prev, prev2, e, enext )	\
+	".if " #j " < 4\n\t"						\
+	"movdqu (" #j "*16)(%[data]), " m "\n\t"			\
+	"pshufb %%xmm7, " m "\n\t"					\
+	".endif\n\t"							\
+	".if " #j " == 0\n\t"						\
+	"paddd " m ", " e "\n\t"					\
+	".else\n\t"							\
+	"sha1nexte " m ", " e "\n\t"					\
+	".endif\n\t"							\
+	"movdqa %%xmm0, " enext "\n\t"				\
+	".if ( " #j " >= 3 ) && ( " #j " <= 18 )\n\t"			\
+	"sha1msg2 " m ", " next "\n\t"				\
+	".endif\n\t"							\
+	"sha1rnds4 $" #k ", " e ", %%xmm0\n\t"			\
+	".if ( " #j " >= 1 ) && ( " #j " <= 16 )\n\t"			\
+	"sha1msg1 " m ", " prev "\n\t"				\
+	".endif\n\t"							\
+	".if ( " #j " >= 2 ) && ( " #j " <= 17 )\n\t"			\
+	"pxor " m ", " prev2 "\n\t"					\
+	".endif\n\t"
+
+/**
+ * Perform four SHA-256 rounds
+ *
+ * @v i			Round number
+ * @v m			Message schedule register for these rounds
+ * @v m1		Message schedule register for next rounds
+ * @v m2		Message schedule register for later rounds
+ * @v m3		Message schedule register for previous rounds
+ *
+ * The hash state is held in %xmm1 (ABEF) and %xmm2 (CDGH).
+ * Registers %xmm0 and %xmm7 are used as temporaries.
+ */
+#define SHANI_SHA256_QUAD( i, m, m1, m2, m3 )				\
+	".if " #i " < 16\n\t"						\
+	"movdqu (" #i "*4)(%[data]), " m "\n\t"			\
+	"movdqu (%[bswap]), %%xmm0\n\t"				\
+	"pshufb %%xmm0, " m "\n\t"					\
+	".endif\n\t"							\
+	"movdqu (" #i "*4)(%[k]), %%xmm0\n\t"				\
+	"paddd " m ", %%xmm0\n\t"					\
+	"sha256rnds2 %%xmm1, %%xmm2\n\t"				\
+	".if ( " #i " >= 12 ) && ( " #i " < 60 )\n\t"			\
+	"movdqa " m ", %%xmm7\n\t"					\
+	"palignr $4, " m3 ", %%xmm7\n\t"				\
+	"paddd %%xmm7, " m1 "\n\t"					\
+	"sha256msg2 " m ", " m1 "\n\t"				\
+	".endif\n\t"							\
+	"pshufd $0x0e, %%xmm0, %%xmm0\n\t"				\
+	"sha256rnds2 %%xmm2, %%xmm1\n\t"				\
+	".if ( " #i " >= 4 ) && ( " #i " < 52 )\n\t"			\
+	"sha256msg1 " m ", " m3 "\n\t"				\
+	".endif\n\t"
+
+/**
+ * Check for SHA extensions support
+ *
+ * @ret rc		Return status code
+ */
+static int shani_probe ( void ) {
+	struct x86_features features;
+	uint32_t discard_a;
+	uint32_t discard_c;
+	uint32_t discard_d;
+	uint32_t ebx;
+	int rc;
+
+	/* Check for SHA instructions */
+	if ( ( rc = cpuid_supported ( CPUID_STRUCTURED ) ) != 0 )
+		return rc;
+	cpuid ( CPUID_STRUCTURED, 0, &discard_a, &ebx, &discard_c,
+		&discard_d );
+	if ( ! ( ebx & CPUID_STRUCTURED_EBX_SHA ) ) {
+		DBGC ( &shani_reverse, "SHANI not supported\n" );
+		return -ENOTSUP;
+	}
+
+	/* Check for byte shuffling */
+	x86_features ( &features );
+	if ( ! ( features.intel.ecx & CPUID_FEATURES_INTEL_ECX_SSSE3 ) ) {
+		DBGC ( &shani_reverse, "SHANI SSSE3 not supported\n" );
+		return -ENOTSUP;
+	}
+
+	/* Check that SSE instructions are usable */
+	return x86_sse_enabled();
+}
+
+/**
+ * Digest SHA-1 data blocks
+ *
+ * @v digest		Intermediate digest value
+ * @v data		Data blocks
+ * @v count		Number of data blocks
+ */
+static void shani_sha1_blocks ( void *digest, const void *data,
+				size_t count ) {
+	struct sha1_digest *hash = digest;
+	uint32_t state[8];
+	uint8_t save[64];
+	unsigned int i;
+
+	/* Do nothing if there are no blocks to digest */
+	if ( ! count )
+		return;
+
+	/* Construct {ABCD,E} register values */
+	for ( i = 0 ; i < 4 ; i++ )
+		state[i] = be32_to_cpu ( hash->h[ 3 - i ] );
+	memset ( &state[4], 0, ( 3 * sizeof ( state[0] ) ) );
+	state[7] = be32_to_cpu ( hash->h[4] );
+
+	/* Digest blocks */
+	__asm__ __volatile__ ( "movdqu %%xmm6, 0(%[save])\n\t"
+			       "movdqu %%xmm7, 16(%[save])\n\t"
+			       "movdqu 0(%[state]), %%xmm0\n\t"
+			       "movdqu 16(%[state]), %%xmm1\n\t"
+			       "movdqu (%[reverse]), %%xmm7\n\t"
+			       "\n1:\n\t"
+			       "movdqu %%xmm0, 32(%[save])\n\t"
+			       "movdqu %%xmm1, 48(%[save])\n\t"
+			       SHANI_SHA1_QUAD ( 0, 0, M0, M1, M3, M2,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 1, 0, M1, M2, M0, M3,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 2, 0, M2, M3, M1, M0,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 3, 0, M3, M0, M2, M1,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 4, 0, M0, M1, M3, M2,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 5, 1, M1, M2, M0, M3,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 6, 1, M2, M3, M1, M0,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 7, 1, M3, M0, M2, M1,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 8, 1, M0, M1, M3, M2,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 9, 1, M1, M2, M0, M3,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 10, 2, M2, M3, M1, M0,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 11, 2, M3, M0, M2, M1,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 12, 2, M0, M1, M3, M2,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 13, 2, M1, M2, M0, M3,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 14, 2, M2, M3, M1, M0,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 15, 3, M3, M0, M2, M1,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 16, 3, M0, M1, M3, M2,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 17, 3, M1, M2, M0, M3,
+						 E1, E0 )
+			       SHANI_SHA1_QUAD ( 18, 3, M2, M3, M1, M0,
+						 E0, E1 )
+			       SHANI_SHA1_QUAD ( 19, 3, M3, M0, M2, M1,
+						 E1, E0 )
+			       "movdqu 48(%[save]), %%xmm3\n\t"
+			       "sha1nexte %%xmm3, %%xmm1\n\t"
+			       "movdqu 32(%[save]), %%xmm3\n\t"
+			       "paddd %%xmm3, %%xmm0\n\t"
+			       "add $64, %[data]\n\t"
+			       "dec %[count]\n\t"
+			       "jnz 1b\n\t"
+			       "movdqu %%xmm0, 0(%[state])\n\t"
+			       "movdqu %%xmm1, 16(%[state])\n\t"
+			       "movdqu 0(%[save]), %%xmm6\n\t"
+			       "movdqu 16(%[save]), %%xmm7\n\t"
+			       : [data] "+r" ( data ), [count] "+r" ( count )
+			       : [state] "r" ( state ), [save] "r" ( save ),
+				 [reverse] "r" ( shani_reverse )
+			       : "cc", "memory" );
+
+	/* Extract digest */
+	for ( i = 0 ; i < 4 ; i++ )
+		hash->h[ 3 - i ] = cpu_to_be32 ( state[i] );
+	hash->h[4] = cpu_to_be32 ( state[7] );
+}
+
+/**
+ * Digest SHA-256 data blocks
+ *
+ * @v digest		Intermediate digest value
+ * @v data		Data blocks
+ * @v count		Number of data blocks
+ */
+static void shani_sha256_blocks ( void *digest, const void *data,
+				  size_t count ) {
+	struct sha256_digest *hash = digest;
+	uint32_t state[8];
+	uint8_t save[64];
+	unsigned int i;
+
+	/* Do nothing if there are no blocks to digest */
+	if ( ! count )
+		return;
+
+	/* Construct {ABEF,CDGH} register values */
+	for ( i = 0 ; i < 8 ; i++ )
+		state[i] = be32_to_cpu ( hash->h[ shani_sha256_order[i] ] );
+
+	/* Digest blocks */
+	__asm__ __volatile__ ( "movdqu %%xmm6, 0(%[save])\n\t"
+			       "movdqu %%xmm7, 16(%[save])\n\t"
+			       "movdqu 0(%[state]), %%xmm1\n\t"
+			       "movdqu 16(%[state]), %%xmm2\n\t"
+			       "\n1:\n\t"
+			       "movdqu %%xmm1, 32(%[save])\n\t"
+			       "movdqu %%xmm2, 48(%[save])\n\t"
+			       SHANI_SHA256_QUAD ( 0, M0, M1, M2, M3 )
+			       SHANI_SHA256_QUAD ( 4, M1, M2, M3, M0 )
+			       SHANI_SHA256_QUAD ( 8, M2, M3, M0, M1 )
+			       SHANI_SHA256_QUAD ( 12, M3, M0, M1, M2 )
+			       SHANI_SHA256_QUAD ( 16, M0, M1, M2, M3 )
+			       SHANI_SHA256_QUAD ( 20, M1, M2, M3, M0 )
+			       SHANI_SHA256_QUAD ( 24, M2, M3, M0, M1 )
+			       SHANI_SHA256_QUAD ( 28, M3, M0, M1, M2 )
+			       SHANI_SHA256_QUAD ( 32, M0, M1, M2, M3 )
+			       SHANI_SHA256_QUAD ( 36, M1, M2, M3, M0 )
+			       SHANI_SHA256_QUAD ( 40, M2, M3, M0, M1 )
+			       SHANI_SHA256_QUAD ( 44, M3, M0, M1, M2 )
+			       SHANI_SHA256_QUAD ( 48, M0, M1, M2, M3 )
+			       SHANI_SHA256_QUAD ( 52, M1, M2, M3, M0 )
+			       SHANI_SHA256_QUAD ( 56, M2, M3, M0, M1 )
+			       SHANI_SHA256_QUAD ( 60, M3, M0, M1, M2 )
+			       "movdqu 32(%[save]), %%xmm0\n\t"
+			       "paddd %%xmm0, %%xmm1\n\t"
+			       "movdqu 48(%[save]), %%xmm0\n\t"
+			       "paddd %%xmm0, %%xmm2\n\t"
+			       "add $64, %[data]\n\t"
+			       "dec %[count]\n\t"
+			       "jnz 1b\n\t"
+			       "movdqu %%xmm1, 0(%[state])\n\t"
+			       "movdqu %%xmm2, 16(%[state])\n\t"
+			       "movdqu 0(%[save]), %%xmm6\n\t"
+			       "movdqu 16(%[save]), %%xmm7\n\t"
+			       : [data] "+r" ( data ), [count] "+r" ( count )
+			       : [state] "r" ( state ), [save] "r" ( save ),
+				 [k] "r" ( sha256_k ),
+				 [bswap] "r" ( shani_bswap )
+			       : "cc", "memory" );
+
+	/* Extract digest */
+	for ( i = 0 ; i < 8 ; i++ )
+		hash->h[ shani_sha256_order[i] ] = cpu_to_be32 ( state[i] );
+}
+
+/** SHA extensions accelerated SHA-1 */
+struct digest_accelerator shani_sha1_accelerator __digest_accelerator = {
+	.name = "shani",
+	.generic = &sha1_algorithm,
+	.blocks = shani_sha1_blocks,
+	.probe = shani_probe,
+};
+
+/** SHA extensions accelerated SHA-256 */
+struct digest_accelerator shani_sha256_accelerator __digest_accelerator = {
+	.name = "shani",
+	.generic = &sha256_algorithm,
+	.blocks = shani_sha256_blocks,
+	.probe = shani_probe,
+};
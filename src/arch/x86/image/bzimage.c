@@ -47,6 +47,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 FEATURE ( FEATURE_IMAGE, "bzImage", DHCP_EB_FEATURE_BZIMAGE, 1 );
 
+struct image_type bzimage_image_type __image_type ( PROBE_NORMAL );
+
 /**
  * bzImage context
  */
@@ -366,9 +368,14 @@ static size_t bzimage_load_initrd ( struct image *image,
 	/* Create cpio header for non-prebuilt images */
 	offset = cpio_header ( initrd, &cpio );
 
-	/* Copy in initrd image body (and cpio header if applicable) */
+	/* Copy in initrd image body (unless already in place) and
+	 * cpio header (if applicable)
+	 */
 	if ( address ) {
-		memmove_user ( address, offset, initrd->data, 0, initrd->len );
+		if ( userptr_add ( address, offset ) != initrd->data ) {
+			memmove_user ( address, offset, initrd->data, 0,
+				       initrd->len );
+		}
 		if ( offset ) {
 			memset_user ( address, 0, 0, offset );
 			copy_to_user ( address, 0, &cpio, sizeof ( cpio ) );
@@ -393,6 +400,70 @@ static size_t bzimage_load_initrd ( struct image *image,
 	return offset;
 }
 
+/**
+ * Check whether initrds are already in their final positions
+ *
+ * @v image		bzImage image
+ * @v bzimg		bzImage context
+ * @ret placed		Initrds are already in their final positions
+ *
+ * Initrds downloaded after selecting the kernel will have been
+ * placed in ascending address order, with space reserved below each
+ * initrd for its cpio header (if any).
+ */
+static int bzimage_initrds_placed ( struct image *image,
+				    struct bzimage_context *bzimg ) {
+	struct cpio_header cpio;
+	struct image *initrd;
+	physaddr_t bottom;
+	physaddr_t padded;
+	physaddr_t data;
+	physaddr_t dest;
+	physaddr_t start;
+	size_t offset;
+	size_t len;
+	int first = 1;
+
+	/* Calculate lowest usable address */
+	bottom = padded = user_to_phys ( bzimg->pm_kernel, bzimg->pm_sz );
+
+	/* Check each initrd in turn */
+	for_each_image ( initrd ) {
+
+		/* Skip kernel */
+		if ( initrd == image )
+			continue;
+
+		/* Check that initrd has been placed */
+		if ( ! ( initrd->flags & IMAGE_PLACED ) )
+			return 0;
+
+		/* Check that the cpio header (if any) does not overlap
+		 * the preceding initrd, that the image body does not
+		 * overlap the preceding initrd's zero-padding, and
+		 * that the first initrd starts on an aligned boundary
+		 * above the kernel.
+		 */
+		offset = cpio_header ( initrd, &cpio );
+		data = user_to_phys ( initrd->data, 0 );
+		dest = ( data - offset );
+		start = ( first ? ( dest & ~( INITRD_ALIGN - 1 ) ) : dest );
+		if ( ( offset > data ) || ( start < bottom ) ||
+		     ( data < padded ) )
+			return 0;
+		first = 0;
+
+		/* Check that initrd lies within kernel's memory limit */
+		len = bzimage_load_initrd ( image, initrd, UNULL );
+		bottom = ( dest + len );
+		padded = ( dest + bzimage_align ( len ) );
+		if ( ( bottom - 1 ) > bzimg->mem_limit )
+			return 0;
+	}
+
+	return 1;
+}
+
 /**
  * Check that initrds can be loaded
  *
@@ -427,6 +498,13 @@ static int bzimage_check_initrds ( struct image *image,
 			     user_to_virt ( initrd->data, 0 ), initrd->len );
 	}
 
+	/* No further checks are required if initrds are in place */
+	if ( bzimage_initrds_placed ( image, bzimg ) ) {
+		DBGC ( image, "bzImage %p initrds already in place\n",
+		       image );
+		return 0;
+	}
+
 	/* Calculate lowest usable address */
 	bottom = userptr_add ( bzimg->pm_kernel, bzimg->pm_sz );
 
@@ -451,6 +529,52 @@ static int bzimage_check_initrds ( struct image *image,
 	return 0;
 }
 
+/**
+ * Load initrds already in their final positions
+ *
+ * @v image		bzImage image
+ * @v bzimg		bzImage context
+ */
+static void bzimage_load_placed_initrds ( struct image *image,
+					 struct bzimage_context *bzimg ) {
+	struct cpio_header cpio;
+	struct image *initrd;
+	userptr_t dest;
+	userptr_t end = UNULL;
+	size_t len;
+
+	/* Load initrds in order */
+	for_each_image ( initrd ) {
+
+		/* Skip kernel */
+		if ( initrd == image )
+			continue;
+
+		/* Calculate address of cpio header (if any) */
+		dest = userptr_add ( initrd->data,
+				     -cpio_header ( initrd, &cpio ) );
+
+		/* Start first initrd on an aligned boundary */
+		if ( ! bzimg->ramdisk_image ) {
+			bzimg->ramdisk_image = ( user_to_phys ( dest, 0 ) &
+						 ~( INITRD_ALIGN - 1 ) );
+			end = phys_to_user ( bzimg->ramdisk_image );
+		}
+
+		/* Zero-fill any gap preceding this initrd */
+		memset_user ( end, 0, 0, userptr_sub ( dest, end ) );
+
+		/* Load initrd (without moving image body) */
+		len = bzimage_load_initrd ( image, initrd, dest );
+		end = userptr_add ( dest, len );
+		bzimg->ramdisk_size = ( user_to_phys ( end, 0 ) -
+					bzimg->ramdisk_image );
+	}
+	DBGC ( image, "bzImage %p initrds in place at [%#08lx,%#08lx)\n",
+	       image, bzimg->ramdisk_image,
+	       ( bzimg->ramdisk_image + bzimg->ramdisk_size ) );
+}
+
 /**
  * Load initrds, if any
  *
@@ -467,6 +591,12 @@ static void bzimage_load_initrds ( struct image *image,
 	size_t offset;
 	size_t len;
 
+	/* Use initrds in place, if possible */
+	if ( bzimage_initrds_placed ( image, bzimg ) ) {
+		bzimage_load_placed_initrds ( image, bzimg );
+		return;
+	}
+
 	/* Reshuffle initrds into desired order */
 	initrd_reshuffle ( userptr_add ( bzimg->pm_kernel, bzimg->pm_sz ) );
 
@@ -625,6 +755,46 @@ int bzimage_probe ( struct image *image ) {
 	return 0;
 }
 
+/**
+ * Place image data at its final load address
+ *
+ * @v image		Image
+ * @v xferbuf		Data transfer buffer to initialise
+ * @ret rc		Return status code
+ *
+ * All images registered when a bzImage kernel is executed are treated
+ * as initrds.  Once a bzImage kernel has been selected, any image
+ * downloaded subsequently may therefore be placed directly within the
+ * range of addresses usable for the kernel's initrds, avoiding the
+ * need to rearrange initrds in memory before starting the kernel.
+ * Any image that does not fit will be moved to an ordinary buffer,
+ * and rearranged as normal.
+ */
+int image_place ( struct image *image, struct xfer_buffer *xferbuf ) {
+	struct bzimage_context bzimg;
+	struct image *kernel;
+	char *cmdline;
+	int rc;
+
+	/* Do nothing unless a bzImage kernel has been selected */
+	kernel = image_find_selected();
+	if ( ! ( kernel && ( kernel->type == &bzimage_image_type ) ) )
+		return -ENOTSUP;
+	cmdline = ( kernel->cmdline ? kernel->cmdline : "" );
+
+	/* Determine range of addresses usable for initrds */
+	if ( ( rc = bzimage_parse_header ( kernel, &bzimg,
+					   kernel->data ) ) != 0 )
+		return rc;
+	if ( ( rc = bzimage_parse_cmdline ( kernel, &bzimg, cmdline ) ) != 0 )
+		return rc;
+
+	/* Place image */
+	return initrd_place ( image, xferbuf,
+			      user_to_phys ( bzimg.pm_kernel, bzimg.pm_sz ),
+			      bzimg.mem_limit );
+}
+
 /** Linux bzImage image type */
 struct image_type bzimage_image_type __image_type ( PROBE_NORMAL ) = {
 	.name = "bzImage",
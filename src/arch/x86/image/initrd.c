@@ -27,8 +27,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <initrd.h>
 #include <ipxe/image.h>
 #include <ipxe/uaccess.h>
+#include <ipxe/umalloc.h>
 #include <ipxe/init.h>
 #include <ipxe/memblock.h>
+#include <ipxe/xferbuf.h>
 #include <ipxe/cpio.h>
 
 /** @file
@@ -43,6 +45,18 @@ userptr_t initrd_top;
 /** Minimum address available for initrd */
 userptr_t initrd_bottom;
 
+/** Initrd placement area */
+static userptr_t initrd_area;
+
+/** Usable length of initrd placement area */
+static size_t initrd_area_len;
+
+/** Used length of initrd placement area */
+static size_t initrd_area_used;
+
+/** Number of images placed within initrd placement area */
+static unsigned int initrd_area_count;
+
 /**
  * Squash initrds as high as possible in memory
  *
@@ -281,6 +295,272 @@ int initrd_reshuffle_check ( size_t len, userptr_t bottom ) {
 	return ( ( len < available ) ? 0 : -ENOBUFS );
 }
 
+/**
+ * Release space within initrd placement area
+ *
+ * @v data		Placed data, or UNULL
+ * @v len		Length of placed data
+ */
+static void initrd_area_release ( userptr_t data, size_t len ) {
+	size_t offset;
+
+	/* Reclaim space if this is the highest placed image */
+	if ( data ) {
+		offset = userptr_sub ( data, initrd_area );
+		if ( ( offset + len ) == initrd_area_used )
+			initrd_area_used = ( offset - INITRD_ALIGN );
+	}
+
+	/* Release placement area when no placed images remain */
+	assert ( initrd_area_count > 0 );
+	if ( --initrd_area_count )
+		return;
+	DBGC ( &images, "INITRD releasing placement area\n" );
+	ufree ( initrd_area );
+	initrd_area = UNULL;
+	initrd_area_len = 0;
+	initrd_area_used = 0;
+}
+
+/**
+ * Move placed initrd data to a umalloc()-based data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v len		New length
+ * @ret rc		Return status code
+ *
+ * An image that cannot grow within the placement area (e.g. because
+ * it would overflow the area, or because another image has since been
+ * placed above it) is copied once to an ordinary umalloc()-based
+ * buffer, and will be reshuffled into position as normal when the
+ * kernel is executed.
+ */
+static int initrd_place_fallback ( struct xfer_buffer *xferbuf, size_t len ) {
+	userptr_t *udata = xferbuf->data;
+	struct image *image = container_of ( udata, struct image, data );
+	userptr_t data;
+
+	/* Allocate umalloc()-based buffer */
+	data = umalloc ( len );
+	if ( ! data )
+		return -ENOSPC;
+	DBGC ( &images, "INITRD %s could not be placed; using [%#08lx,%#08lx)"
+	       "\n", image->name, user_to_phys ( data, 0 ),
+	       user_to_phys ( data, len ) );
+
+	/* Copy any existing data and release placement */
+	if ( *udata ) {
+		memcpy_user ( data, 0, *udata, 0, xferbuf->allocated );
+		initrd_area_release ( *udata, xferbuf->allocated );
+	} else {
+		initrd_area_release ( UNULL, 0 );
+	}
+	image->flags &= ~IMAGE_PLACED;
+
+	/* Switch to umalloc()-based buffer */
+	*udata = data;
+	xferbuf->op = &xferbuf_umalloc_operations;
+
+	return 0;
+}
+
+/**
+ * Reallocate placed initrd data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v len		New length (or zero to free buffer)
+ * @ret rc		Return status code
+ */
+static int initrd_place_realloc ( struct xfer_buffer *xferbuf, size_t len ) {
+	userptr_t *udata = xferbuf->data;
+	physaddr_t start;
+	size_t offset;
+
+	/* Calculate offset within placement area */
+	if ( *udata ) {
+
+		/* Any placed image may shrink, but only the highest
+		 * placed image may grow.
+		 */
+		offset = userptr_sub ( *udata, initrd_area );
+		if ( ( offset + xferbuf->allocated ) != initrd_area_used ) {
+			if ( len <= xferbuf->allocated )
+				return 0;
+			return initrd_place_fallback ( xferbuf, len );
+		}
+
+	} else {
+
+		/* Place new image above all existing placed images,
+		 * leaving space below it for a cpio header.
+		 */
+		start = user_to_phys ( initrd_area, initrd_area_used );
+		start = ( ( start + ( 2 * INITRD_ALIGN ) - 1 ) &
+			  ~( INITRD_ALIGN - 1 ) );
+		offset = ( start - user_to_phys ( initrd_area, 0 ) );
+	}
+
+	/* Fall back to a umalloc()-based buffer if space is not
+	 * available
+	 */
+	if ( ( offset > initrd_area_len ) ||
+	     ( len > ( initrd_area_len - offset ) ) ) {
+		DBGC ( &images, "INITRD could not place %#zx bytes at "
+		       "%#08lx\n", len, user_to_phys ( initrd_area, offset ) );
+		return initrd_place_fallback ( xferbuf, len );
+	}
+
+	/* Record placement */
+	*udata = userptr_add ( initrd_area, offset );
+	initrd_area_used = ( offset + len );
+
+	return 0;
+}
+
+/**
+ * Write data to placed initrd data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @v data		Data to copy
+ * @v len		Length of data
+ */
+static void initrd_place_write ( struct xfer_buffer *xferbuf, size_t offset,
+				 const void *data, size_t len ) {
+	userptr_t *udata = xferbuf->data;
+
+	copy_to_user ( *udata, offset, data, len );
+}
+
+/**
+ * Read data from placed initrd data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @v data		Data to read
+ * @v len		Length of data
+ */
+static void initrd_place_read ( struct xfer_buffer *xferbuf, size_t offset,
+				void *data, size_t len ) {
+	userptr_t *udata = xferbuf->data;
+
+	copy_from_user ( data, *udata, offset, len );
+}
+
+/** Placed initrd data buffer operations */
+static struct xfer_buffer_operations initrd_place_operations = {
+	.realloc = initrd_place_realloc,
+	.write = initrd_place_write,
+	.read = initrd_place_read,
+};
+
+/**
+ * Reserve initrd placement area
+ *
+ * @v bottom		Lowest address usable for initrds
+ * @v limit		Highest address usable for initrds
+ * @ret rc		Return status code
+ */
+static int initrd_area_reserve ( physaddr_t bottom, physaddr_t limit ) {
+	userptr_t start;
+	physaddr_t base;
+	size_t skip;
+	size_t spare;
+	size_t len;
+
+	/* Find largest free memory block */
+	len = largest_memblock ( &start );
+	base = user_to_phys ( start, 0 );
+
+	/* Use this block above the lowest usable address, leaving a
+	 * proportion of free space for other allocations.
+	 */
+	skip = ( ( bottom > base ) ? ( bottom - base ) : 0 );
+	spare = ( len / INITRD_PLACE_FREE_FRACTION );
+	if ( spare < INITRD_PLACE_MIN_FREE_LEN )
+		spare = INITRD_PLACE_MIN_FREE_LEN;
+	skip += spare;
+	if ( len <= skip ) {
+		DBGC ( &images, "INITRD insufficient space for placement "
+		       "area\n" );
+		return -ENOSPC;
+	}
+	len -= skip;
+
+	/* Allocate placement area */
+	initrd_area = umalloc ( len );
+	if ( ! initrd_area ) {
+		DBGC ( &images, "INITRD could not allocate %#zx-byte placement "
+		       "area\n", len );
+		return -ENOMEM;
+	}
+	base = user_to_phys ( initrd_area, 0 );
+
+	/* Check that placement area lies within the usable range */
+	if ( ( base < bottom ) || ( base > limit ) ) {
+		DBGC ( &images, "INITRD placement area [%#08lx,%#08lx) outside "
+		       "[%#08lx,%#08lx]\n", base, user_to_phys ( initrd_area,
+		       len ), bottom, limit );
+		ufree ( initrd_area );
+		initrd_area = UNULL;
+		return -ERANGE;
+	}
+
+	/* Truncate placement area to the usable range */
+	if ( ( len - 1 ) > ( limit - base ) )
+		len = ( limit - base + 1 );
+	initrd_area_len = len;
+	initrd_area_used = 0;
+	DBGC ( &images, "INITRD placement area [%#08lx,%#08lx)\n",
+	       base, user_to_phys ( initrd_area, len ) );
+
+	return 0;
+}
+
+/**
+ * Place image within initrd placement area
+ *
+ * @v image		Image
+ * @v xferbuf		Data transfer buffer to initialise
+ * @v bottom		Lowest address usable for initrds
+ * @v limit		Highest address usable for initrds
+ * @ret rc		Return status code
+ *
+ * Placed images are allocated in ascending address order, with space
+ * reserved below each image for a cpio header.  Images downloaded in
+ * order will therefore already be in their final positions when
+ * passed to the loaded OS kernel.
+ */
+int initrd_place ( struct image *image, struct xfer_buffer *xferbuf,
+		   physaddr_t bottom, physaddr_t limit ) {
+	int rc;
+
+	/* Reserve placement area, if not already reserved */
+	if ( ( ! initrd_area_count ) &&
+	     ( ( rc = initrd_area_reserve ( bottom, limit ) ) != 0 ) )
+		return rc;
+
+	/* Mark image as placed */
+	image->flags |= IMAGE_PLACED;
+	initrd_area_count++;
+
+	/* Initialise data transfer buffer */
+	xferbuf->data = &image->data;
+	xferbuf->op = &initrd_place_operations;
+
+	return 0;
+}
+
+/**
+ * Release placed image data
+ *
+ * @v image		Image
+ */
+void image_unplace ( struct image *image ) {
+
+	initrd_area_release ( image->data, image->len );
+}
+
 /**
  * initrd startup function
  *
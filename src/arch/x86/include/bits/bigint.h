@@ -325,5 +325,9 @@ bigint_done_raw ( const uint32_t *value0, unsigned int size __unused,
 extern void bigint_multiply_raw ( const uint32_t *multiplicand0,
 				  const uint32_t *multiplier0,
 				  uint32_t *value0, unsigned int size );
+extern uint32_t bigint_multiply_accumulate_raw ( const uint32_t *multiplicand0,
+						 uint32_t multiplier,
+						 uint32_t *value0,
+						 unsigned int size );
 
 #endif /* _BITS_BIGINT_H */
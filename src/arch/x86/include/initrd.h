@@ -11,13 +11,34 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <ipxe/uaccess.h>
 
+struct image;
+struct xfer_buffer;
+
 /** Minimum free space required to reshuffle initrds
  *
  * Chosen to avoid absurdly long reshuffling times
  */
 #define INITRD_MIN_FREE_LEN ( 512 * 1024 )
 
+/** Fraction of free memory to leave when reserving the initrd
+ * placement area
+ *
+ * Any other external memory allocations made while initrds remain
+ * placed (including any downloads that turn out not to fit within
+ * the placement area) must be satisfied from outside the area.
+ */
+#define INITRD_PLACE_FREE_FRACTION 4
+
+/** Minimum free space to leave when reserving the initrd placement area
+ *
+ * Chosen to allow for typical non-initrd downloads (e.g. scripts and
+ * signatures) on systems with little memory
+ */
+#define INITRD_PLACE_MIN_FREE_LEN ( 16 * 1024 * 1024 )
+
 extern void initrd_reshuffle ( userptr_t bottom );
 extern int initrd_reshuffle_check ( size_t len, userptr_t bottom );
+extern int initrd_place ( struct image *image, struct xfer_buffer *xferbuf,
+			  physaddr_t bottom, physaddr_t limit );
 
 #endif /* _INITRD_H */
@@ -39,6 +39,15 @@ struct x86_features {
 /** Get standard features */
 #define CPUID_FEATURES 0x00000001UL
 
+/** Carry-less multiplication instruction is supported */
+#define CPUID_FEATURES_INTEL_ECX_PCLMULQDQ 0x00000002UL
+
+/** Supplemental SSE3 instructions are supported */
+#define CPUID_FEATURES_INTEL_ECX_SSSE3 0x00000200UL
+
+/** AES instructions are supported */
+#define CPUID_FEATURES_INTEL_ECX_AES 0x02000000UL
+
 /** Hypervisor is present */
 #define CPUID_FEATURES_INTEL_ECX_HYPERVISOR 0x80000000UL
 
@@ -48,6 +57,12 @@ struct x86_features {
 /** FXSAVE and FXRSTOR are supported */
 #define CPUID_FEATURES_INTEL_EDX_FXSR 0x01000000UL
 
+/** Get structured extended features */
+#define CPUID_STRUCTURED 0x00000007UL
+
+/** SHA instructions are supported */
+#define CPUID_STRUCTURED_EBX_SHA 0x20000000UL
+
 /** Get largest extended function */
 #define CPUID_AMD_MAX_FN 0x80000000UL
 
@@ -90,5 +105,6 @@ cpuid ( uint32_t function, uint32_t subfunction, uint32_t *eax, uint32_t *ebx,
 
 extern int cpuid_supported ( uint32_t function );
 extern void x86_features ( struct x86_features *features );
+extern int x86_sse_enabled ( void );
 
 #endif /* _IPXE_CPUID_H */
@@ -290,6 +290,9 @@ REQUIRE_OBJECT ( cert_cmd );
 #ifdef IMAGE_MEM_CMD
 REQUIRE_OBJECT ( image_mem_cmd );
 #endif
+#ifdef DNSCACHE_CMD
+REQUIRE_OBJECT ( dnscache_cmd );
+#endif
 
 /*
  * Drag in miscellaneous objects
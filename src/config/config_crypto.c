@@ -21,6 +21,7 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+#include <ipxe/tls.h>
 #include <config/crypto.h>
 
 /** @file
@@ -38,6 +39,26 @@ PROVIDE_REQUIRING_SYMBOL();
 REQUIRE_OBJECT ( oid_rsa );
 #endif
 
+/* ECDSA */
+#if defined ( CRYPTO_PUBKEY_ECDSA )
+REQUIRE_OBJECT ( oid_ecdsa );
+#endif
+
+/* ECDSA and P-256 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_CURVE_P256 )
+REQUIRE_OBJECT ( oid_p256 );
+#endif
+
+/* ECDHE using X25519 */
+#if defined ( CRYPTO_CURVE_X25519 )
+REQUIRE_OBJECT ( ecdhe_x25519 );
+#endif
+
+/* ECDHE using P-256 */
+#if defined ( CRYPTO_CURVE_P256 )
+REQUIRE_OBJECT ( ecdhe_p256 );
+#endif
+
 /* MD4 */
 #if defined ( CRYPTO_DIGEST_MD4 )
 REQUIRE_OBJECT ( oid_md4 );
@@ -83,6 +104,24 @@ REQUIRE_OBJECT ( oid_sha512_224 );
 REQUIRE_OBJECT ( oid_sha512_256 );
 #endif
 
+/* Hardware-accelerated AES */
+#if defined ( CRYPTO_ACCEL_AES ) && \
+    ( defined ( __i386__ ) || defined ( __x86_64__ ) )
+REQUIRE_OBJECT ( x86_aes );
+#endif
+#if defined ( CRYPTO_ACCEL_AES_ARM64 ) && defined ( __aarch64__ )
+REQUIRE_OBJECT ( arm64_aes );
+#endif
+
+/* Hardware-accelerated SHA-1 and SHA-256 */
+#if defined ( CRYPTO_ACCEL_SHA ) && \
+    ( defined ( __i386__ ) || defined ( __x86_64__ ) )
+REQUIRE_OBJECT ( x86_sha );
+#endif
+#if defined ( CRYPTO_ACCEL_SHA_ARM64 ) && defined ( __aarch64__ )
+REQUIRE_OBJECT ( arm64_sha );
+#endif
+
 /* RSA and MD5 */
 #if defined ( CRYPTO_PUBKEY_RSA ) && defined ( CRYPTO_DIGEST_MD5 )
 REQUIRE_OBJECT ( rsa_md5 );
@@ -113,6 +152,16 @@ REQUIRE_OBJECT ( rsa_sha384 );
 REQUIRE_OBJECT ( rsa_sha512 );
 #endif
 
+/* ECDSA and SHA-256 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_DIGEST_SHA256 )
+REQUIRE_OBJECT ( ecdsa_sha256 );
+#endif
+
+/* ECDSA and SHA-384 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_DIGEST_SHA384 )
+REQUIRE_OBJECT ( ecdsa_sha384 );
+#endif
+
 /* RSA, AES-CBC, and SHA-1 */
 #if defined ( CRYPTO_PUBKEY_RSA ) && defined ( CRYPTO_CIPHER_AES_CBC ) && \
     defined ( CRYPTO_DIGEST_SHA1 )
@@ -136,3 +185,39 @@ REQUIRE_OBJECT ( rsa_aes_gcm_sha256 );
     defined ( CRYPTO_DIGEST_SHA384 )
 REQUIRE_OBJECT ( rsa_aes_gcm_sha384 );
 #endif
+
+/* ECDSA, AES-CBC, and SHA-1 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_CIPHER_AES_CBC ) && \
+    defined ( CRYPTO_DIGEST_SHA1 )
+REQUIRE_OBJECT ( ecdsa_aes_cbc_sha1 );
+#endif
+
+/* ECDSA, AES-CBC, and SHA-256 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_CIPHER_AES_CBC ) && \
+    defined ( CRYPTO_DIGEST_SHA256 )
+REQUIRE_OBJECT ( ecdsa_aes_cbc_sha256 );
+#endif
+
+/* ECDSA, AES-GCM, and SHA-256 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_CIPHER_AES_GCM ) && \
+    defined ( CRYPTO_DIGEST_SHA256 )
+REQUIRE_OBJECT ( ecdsa_aes_gcm_sha256 );
+#endif
+
+/* ECDSA, AES-GCM, and SHA-384 */
+#if defined ( CRYPTO_PUBKEY_ECDSA ) && defined ( CRYPTO_CIPHER_AES_GCM ) && \
+    defined ( CRYPTO_DIGEST_SHA384 )
+REQUIRE_OBJECT ( ecdsa_aes_gcm_sha384 );
+#endif
+
+/* TLSv1.3, AES-GCM, and SHA-256 */
+#if ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_3 ) && \
+    defined ( CRYPTO_CIPHER_AES_GCM ) && defined ( CRYPTO_DIGEST_SHA256 )
+REQUIRE_OBJECT ( tls13_aes_gcm_sha256 );
+#endif
+
+/* TLSv1.3, AES-GCM, and SHA-384 */
+#if ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_3 ) && \
+    defined ( CRYPTO_CIPHER_AES_GCM ) && defined ( CRYPTO_DIGEST_SHA384 )
+REQUIRE_OBJECT ( tls13_aes_gcm_sha384 );
+#endif
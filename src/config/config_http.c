@@ -46,6 +46,9 @@ REQUIRE_OBJECT ( httpntlm );
 #ifdef HTTP_ENC_PEERDIST
 REQUIRE_OBJECT ( peerdist );
 #endif
+#ifdef HTTP_MULTI
+REQUIRE_OBJECT ( httpmulti );
+#endif
 #ifdef HTTP_HACK_GCE
 REQUIRE_OBJECT ( httpgce );
 #endif
@@ -12,15 +12,45 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Minimum TLS version */
 #define TLS_VERSION_MIN TLS_VERSION_TLS_1_1
 
+/** Maximum TLS version */
+#define TLS_VERSION_MAX TLS_VERSION_TLS_1_3
+
 /** RSA public-key algorithm */
 #define CRYPTO_PUBKEY_RSA
 
+/** ECDSA public-key algorithm (signature verification only) */
+#define CRYPTO_PUBKEY_ECDSA
+
+/** X25519 elliptic curve key exchange */
+#define CRYPTO_CURVE_X25519
+
+/** P-256 elliptic curve (secp256r1) */
+#define CRYPTO_CURVE_P256
+
 /** AES-CBC block cipher */
 #define CRYPTO_CIPHER_AES_CBC
 
 /** AES-GCM block cipher */
 #define CRYPTO_CIPHER_AES_GCM
 
+/** Hardware-accelerated AES (AES-NI) */
+#define CRYPTO_ACCEL_AES
+
+/** Hardware-accelerated AES (ARMv8 Cryptography Extensions)
+ *
+ * This implementation has not yet been tested on ARM hardware.
+ */
+//#define CRYPTO_ACCEL_AES_ARM64
+
+/** Hardware-accelerated SHA-1 and SHA-256 (SHA extensions) */
+#define CRYPTO_ACCEL_SHA
+
+/** Hardware-accelerated SHA-1 and SHA-256 (ARMv8 Cryptography Extensions)
+ *
+ * This implementation has not yet been tested on ARM hardware.
+ */
+//#define CRYPTO_ACCEL_SHA_ARM64
+
 /** MD4 digest algorithm */
 //#define CRYPTO_DIGEST_MD4
 
@@ -80,6 +80,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define HTTP_AUTH_DIGEST	/* Digest authentication */
 //#define HTTP_AUTH_NTLM	/* NTLM authentication */
 //#define HTTP_ENC_PEERDIST	/* PeerDist content encoding */
+//#define HTTP_MULTI		/* Parallel multi-connection downloads */
 //#define HTTP_HACK_GCE		/* Google Compute Engine hacks */
 
 /*
@@ -158,6 +159,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#define NTP_CMD		/* NTP commands */
 //#define CERT_CMD		/* Certificate management commands */
 //#define IMAGE_MEM_CMD		/* Read memory command */
+//#define DNSCACHE_CMD		/* DNS cache management commands */
 #define IMAGE_ARCHIVE_CMD	/* Archive image management commands */
 
 /*
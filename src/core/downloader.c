@@ -88,7 +88,8 @@ static void downloader_finished ( struct downloader *downloader, int rc ) {
 			 downloader->image->name, strerror ( rc ) );
 	}
 
-	/* Update image length */
+	/* Release unused space and update image length */
+	xferbuf_trim ( &downloader->buffer );
 	downloader->image->len = downloader->buffer.len;
 
 	/* Shut down interfaces */
@@ -245,6 +246,19 @@ static struct interface_descriptor downloader_job_desc =
  *
  */
 
+/**
+ * Place image data at its final load address (when image placement is
+ * not present)
+ *
+ * @v image		Image
+ * @v xferbuf		Data transfer buffer
+ * @ret rc		Return status code
+ */
+__weak int image_place ( struct image *image __unused,
+			 struct xfer_buffer *xferbuf __unused ) {
+	return -ENOTSUP;
+}
+
 /**
  * Instantiate a downloader
  *
@@ -269,7 +283,12 @@ int create_downloader ( struct interface *job, struct image *image ) {
 	intf_init ( &downloader->xfer, &downloader_xfer_desc,
 		    &downloader->refcnt );
 	downloader->image = image_get ( image );
-	xferbuf_umalloc_init ( &downloader->buffer, &image->data );
+
+	/* Place image data directly at its final load address, if
+	 * applicable, otherwise use a umalloc()-based buffer.
+	 */
+	if ( image_place ( image, &downloader->buffer ) != 0 )
+		xferbuf_umalloc_init ( &downloader->buffer, &image->data );
 
 	/* Instantiate child objects and attach to our interfaces */
 	if ( ( rc = xfer_open_uri ( &downloader->xfer, image->uri ) ) != 0 )
@@ -64,6 +64,15 @@ static int require_trusted_images = 0;
 /** Prevent changes to image trust requirement */
 static int require_trusted_images_permanent = 0;
 
+/**
+ * Release placed image data (when image placement is not present)
+ *
+ * @v image		Image
+ */
+__weak void image_unplace ( struct image *image __unused ) {
+	/* Nothing to do */
+}
+
 /**
  * Free executable image
  *
@@ -76,7 +85,11 @@ static void free_image ( struct refcnt *refcnt ) {
 	free ( image->name );
 	free ( image->cmdline );
 	uri_put ( image->uri );
-	ufree ( image->data );
+	if ( image->flags & IMAGE_PLACED ) {
+		image_unplace ( image );
+	} else {
+		ufree ( image->data );
+	}
 	image_put ( image->replacement );
 	free ( image );
 }
@@ -27,14 +27,101 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <strings.h>
 #include <errno.h>
 #include <ipxe/malloc.h>
+#include <ipxe/profile.h>
 #include <ipxe/iobuf.h>
 
 /** @file
  *
  * I/O buffers
  *
+ * Free I/O buffers of the power-of-two sizes produced by alloc_iob()
+ * are retained in per-size-class caches, so that (for example)
+ * received packet buffers may be recycled straight back to the
+ * network device without walking the heap's free list.
  */
 
+/** A cache of free I/O buffers of a single size class */
+struct io_buffer_cache {
+	/** List of free I/O buffers */
+	struct list_head free;
+	/** Number of free I/O buffers */
+	unsigned int count;
+	/** Length of each aligned block (including any inline descriptor) */
+	size_t len;
+};
+
+/** Number of I/O buffer cache size classes */
+#define IOB_CACHE_CLASSES ( IOB_CACHE_MAX_LOG2 - IOB_CACHE_MIN_LOG2 + 1 )
+
+/** I/O buffer caches
+ *
+ * Buffers with inline and detached descriptors are cached
+ * separately, since they are not interchangeable.
+ */
+static struct io_buffer_cache iob_caches[2][IOB_CACHE_CLASSES];
+
+/** Total length of all cached free I/O buffers */
+static size_t iob_cache_len;
+
+/** I/O buffer cache profiler
+ *
+ * Each cacheable allocation records a sample of 100 for a cache hit
+ * or 0 for a cache miss, so that the mean is the hit rate as a
+ * percentage.
+ */
+static struct profiler iob_cache_profiler __profiler =
+	{ .name = "iob.cache_hit%" };
+
+/**
+ * Identify I/O buffer cache
+ *
+ * @v len		Length of buffer (excluding any inline descriptor)
+ * @v detached		Descriptor is detached
+ * @ret cache		I/O buffer cache, or NULL if not cacheable
+ */
+static struct io_buffer_cache * iob_cache ( size_t len, int detached ) {
+	struct io_buffer_cache *cache;
+	struct io_buffer *iobuf;
+	unsigned int total_log2;
+	size_t total;
+
+	/* Calculate total (power-of-two) length of aligned block */
+	total = ( detached ? len : ( len + sizeof ( *iobuf ) ) );
+	if ( total & ( total - 1 ) )
+		return NULL;
+	total_log2 = ( fls ( total ) - 1 );
+	if ( ( total_log2 < IOB_CACHE_MIN_LOG2 ) ||
+	     ( total_log2 > IOB_CACHE_MAX_LOG2 ) )
+		return NULL;
+
+	/* Initialise cache on first use */
+	cache = &iob_caches[detached][ total_log2 - IOB_CACHE_MIN_LOG2 ];
+	if ( ! cache->free.next ) {
+		INIT_LIST_HEAD ( &cache->free );
+		cache->len = total;
+	}
+
+	return cache;
+}
+
+/**
+ * Remove first I/O buffer from cache
+ *
+ * @v cache		I/O buffer cache
+ * @ret iobuf		I/O buffer, or NULL if cache is empty
+ */
+static struct io_buffer * iob_cache_get ( struct io_buffer_cache *cache ) {
+	struct io_buffer *iobuf;
+
+	iobuf = list_first_entry ( &cache->free, struct io_buffer, list );
+	if ( iobuf ) {
+		list_del ( &iobuf->list );
+		cache->count--;
+		iob_cache_len -= cache->len;
+	}
+	return iobuf;
+}
+
 /**
  * Allocate I/O buffer with specified alignment and offset
  *
@@ -127,24 +214,89 @@ struct io_buffer * alloc_iob_raw ( size_t len, size_t align, size_t offset ) {
  * up to the nearest power of two).
  */
 struct io_buffer * alloc_iob ( size_t len ) {
+	struct io_buffer_cache *cache;
+	struct io_buffer *iobuf;
+	size_t padding;
+	size_t align;
+	int detached;
 
 	/* Pad to minimum length */
 	if ( len < IOB_ZLEN )
 		len = IOB_ZLEN;
 
+	/* Use a cached buffer of the appropriate size class, if
+	 * possible.  The length of a cacheable buffer is always
+	 * rounded up to fill the whole of its aligned block, so that
+	 * any buffer in the same size class can satisfy the request.
+	 */
+	padding = ( sizeof ( *iobuf ) + __alignof__ ( *iobuf ) - 1 );
+	if ( len <= ( 1UL << IOB_CACHE_MAX_LOG2 ) ) {
+
+		/* Identify size class (as per alloc_iob_raw()) */
+		align = ( 1UL << fls ( ( ( len > padding ) ?
+					 len : padding ) - 1 ) );
+		detached = ( len > ( align - padding ) );
+		cache = iob_cache ( ( detached ? align :
+				      ( align - sizeof ( *iobuf ) ) ),
+				    detached );
+		if ( cache ) {
+
+			/* Reuse cached buffer, if available */
+			iobuf = iob_cache_get ( cache );
+			if ( iobuf ) {
+				iobuf->data = iobuf->tail = iobuf->head;
+				if ( PROFILING ) {
+					profile_update ( &iob_cache_profiler,
+							 100 );
+				}
+				return iobuf;
+			}
+			if ( PROFILING )
+				profile_update ( &iob_cache_profiler, 0 );
+
+			/* Otherwise, allocate a full-sized buffer */
+			len = ( detached ? align : ( align - padding ) );
+		}
+	}
+
 	/* Align buffer on its own size to avoid potential problems
 	 * with boundary-crossing DMA.
 	 */
 	return alloc_iob_raw ( len, len, 0 );
 }
 
+/**
+ * Free I/O buffer memory
+ *
+ * @v iobuf	I/O buffer
+ */
+static void iob_free_raw ( struct io_buffer *iobuf ) {
+	size_t len;
+
+	/* Free buffer */
+	len = ( iobuf->end - iobuf->head );
+	if ( iobuf->end == iobuf ) {
+
+		/* Descriptor is inline */
+		free_phys ( iobuf->head, ( len + sizeof ( *iobuf ) ) );
+
+	} else {
+
+		/* Descriptor is detached */
+		free_phys ( iobuf->head, len );
+		free ( iobuf );
+	}
+}
+
 /**
  * Free I/O buffer
  *
  * @v iobuf	I/O buffer
  */
 void free_iob ( struct io_buffer *iobuf ) {
+	struct io_buffer_cache *cache;
 	size_t len;
+	int detached;
 
 	/* Allow free_iob(NULL) to be valid */
 	if ( ! iobuf )
@@ -156,19 +308,25 @@ void free_iob ( struct io_buffer *iobuf ) {
 	assert ( iobuf->tail <= iobuf->end );
 	assert ( ! dma_mapped ( &iobuf->map ) );
 
-	/* Free buffer */
+	/* Return buffer to cache, if it exactly fills a naturally
+	 * aligned block of a cacheable size class and the cache
+	 * limits have not been reached.
+	 */
 	len = ( iobuf->end - iobuf->head );
-	if ( iobuf->end == iobuf ) {
-
-		/* Descriptor is inline */
-		free_phys ( iobuf->head, ( len + sizeof ( *iobuf ) ) );
-
-	} else {
-
-		/* Descriptor is detached */
-		free_phys ( iobuf->head, len );
-		free ( iobuf );
+	detached = ( iobuf->end != iobuf );
+	cache = iob_cache ( len, detached );
+	if ( cache && ( cache->count < IOB_CACHE_MAX ) &&
+	     ( ( iob_cache_len + cache->len ) <=
+	       ( ( freemem + usedmem ) / IOB_CACHE_HEAP_FRACTION ) ) &&
+	     ( ( virt_to_phys ( iobuf->head ) & ( cache->len - 1 ) ) == 0 ) ) {
+		list_add ( &iobuf->list, &cache->free );
+		cache->count++;
+		iob_cache_len += cache->len;
+		return;
 	}
+
+	/* Otherwise, free buffer */
+	iob_free_raw ( iobuf );
 }
 
 /**
@@ -304,3 +462,35 @@ struct io_buffer * iob_split ( struct io_buffer *iobuf, size_t len ) {
 	iob_pull ( iobuf, len );
 	return split;
 }
+
+/**
+ * Discard some cached I/O buffers
+ *
+ * @ret discarded	Number of cached items discarded
+ */
+static unsigned int iob_cache_discard ( void ) {
+	struct io_buffer_cache *cache;
+	struct io_buffer *iobuf;
+	unsigned int discarded = 0;
+	unsigned int i;
+	unsigned int j;
+
+	/* Free one buffer from each nonempty cache */
+	for ( i = 0 ; i < 2 ; i++ ) {
+		for ( j = 0 ; j < IOB_CACHE_CLASSES ; j++ ) {
+			cache = &iob_caches[i][j];
+			if ( ! cache->count )
+				continue;
+			iobuf = iob_cache_get ( cache );
+			iob_free_raw ( iobuf );
+			discarded++;
+		}
+	}
+
+	return discarded;
+}
+
+/** I/O buffer cache discarder */
+struct cache_discarder iob_cache_discarder __cache_discarder ( CACHE_CHEAP ) = {
+	.discard = iob_cache_discard,
+};
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Red-black trees
+ *
+ * The tree maintains the standard red-black invariants:
+ *
+ *   a) the root node is black,
+ *   b) a red node never has a red child, and
+ *   c) every path from a node down to a NULL leaf passes through the
+ *      same number of black nodes,
+ *
+ * which together guarantee that the tree depth is at most twice the
+ * logarithm of the number of nodes.
+ */
+
+#include <assert.h>
+#include <ipxe/rbtree.h>
+
+/**
+ * Replace child link
+ *
+ * @v root		Red-black tree
+ * @v parent		Parent node, or NULL
+ * @v old		Old child node
+ * @v new		New child node, or NULL
+ */
+static void rb_replace_child ( struct rb_root *root, struct rb_node *parent,
+			       struct rb_node *old, struct rb_node *new ) {
+
+	if ( ! parent ) {
+		root->node = new;
+	} else if ( parent->left == old ) {
+		parent->left = new;
+	} else {
+		assert ( parent->right == old );
+		parent->right = new;
+	}
+}
+
+/**
+ * Rotate subtree left
+ *
+ * @v root		Red-black tree
+ * @v node		Root of subtree (which must have a right child)
+ */
+static void rb_rotate_left ( struct rb_root *root, struct rb_node *node ) {
+	struct rb_node *pivot = node->right;
+
+	node->right = pivot->left;
+	if ( pivot->left )
+		pivot->left->parent = node;
+	pivot->parent = node->parent;
+	rb_replace_child ( root, node->parent, node, pivot );
+	pivot->left = node;
+	node->parent = pivot;
+}
+
+/**
+ * Rotate subtree right
+ *
+ * @v root		Red-black tree
+ * @v node		Root of subtree (which must have a left child)
+ */
+static void rb_rotate_right ( struct rb_root *root, struct rb_node *node ) {
+	struct rb_node *pivot = node->left;
+
+	node->left = pivot->right;
+	if ( pivot->right )
+		pivot->right->parent = node;
+	pivot->parent = node->parent;
+	rb_replace_child ( root, node->parent, node, pivot );
+	pivot->right = node;
+	node->parent = pivot;
+}
+
+/**
+ * Check if node is red
+ *
+ * @v node		Node, or NULL
+ * @ret red		Node is red
+ */
+static inline int rb_is_red ( struct rb_node *node ) {
+
+	/* NULL leaves are black */
+	return ( node && node->red );
+}
+
+/**
+ * Insert node into red-black tree
+ *
+ * @v root		Red-black tree
+ * @v node		New node
+ * @v parent		Parent node, or NULL if tree is empty
+ * @v link		Empty child link within parent (or tree root)
+ *
+ * The caller must already have located the position for the new node
+ * by descending the tree to an empty child link.
+ */
+void rb_insert ( struct rb_root *root, struct rb_node *node,
+		 struct rb_node *parent, struct rb_node **link ) {
+	struct rb_node *grandparent;
+	struct rb_node *uncle;
+
+	/* Link in new node as a red leaf */
+	assert ( *link == NULL );
+	node->parent = parent;
+	node->left = NULL;
+	node->right = NULL;
+	node->red = 1;
+	*link = node;
+
+	/* Restore invariants while we have a red node with a red parent */
+	while ( rb_is_red ( parent = node->parent ) ) {
+
+		/* A red parent cannot be the root node */
+		grandparent = parent->parent;
+		assert ( grandparent != NULL );
+
+		if ( parent == grandparent->left ) {
+			uncle = grandparent->right;
+			if ( rb_is_red ( uncle ) ) {
+				/* Recolour and continue from grandparent */
+				parent->red = 0;
+				uncle->red = 0;
+				grandparent->red = 1;
+				node = grandparent;
+				continue;
+			}
+			if ( node == parent->right ) {
+				rb_rotate_left ( root, parent );
+				node = parent;
+				parent = node->parent;
+			}
+			parent->red = 0;
+			grandparent->red = 1;
+			rb_rotate_right ( root, grandparent );
+		} else {
+			uncle = grandparent->left;
+			if ( rb_is_red ( uncle ) ) {
+				/* Recolour and continue from grandparent */
+				parent->red = 0;
+				uncle->red = 0;
+				grandparent->red = 1;
+				node = grandparent;
+				continue;
+			}
+			if ( node == parent->left ) {
+				rb_rotate_right ( root, parent );
+				node = parent;
+				parent = node->parent;
+			}
+			parent->red = 0;
+			grandparent->red = 1;
+			rb_rotate_left ( root, grandparent );
+		}
+	}
+
+	/* Root node is always black */
+	root->node->red = 0;
+}
+
+/**
+ * Restore invariants after removing a black node
+ *
+ * @v root		Red-black tree
+ * @v node		Node that replaced the removed node, or NULL
+ * @v parent		Parent of replacement node, or NULL
+ *
+ * The subtree rooted at @c node has one fewer black node on each path
+ * than its sibling subtree.
+ */
+static void rb_erase_fixup ( struct rb_root *root, struct rb_node *node,
+			     struct rb_node *parent ) {
+	struct rb_node *sibling;
+
+	while ( ( ! rb_is_red ( node ) ) && ( node != root->node ) ) {
+
+		if ( node == parent->left ) {
+			sibling = parent->right;
+			if ( rb_is_red ( sibling ) ) {
+				sibling->red = 0;
+				parent->red = 1;
+				rb_rotate_left ( root, parent );
+				sibling = parent->right;
+			}
+			if ( ( ! rb_is_red ( sibling->left ) ) &&
+			     ( ! rb_is_red ( sibling->right ) ) ) {
+				/* Recolour and continue from parent */
+				sibling->red = 1;
+				node = parent;
+				parent = node->parent;
+				continue;
+			}
+			if ( ! rb_is_red ( sibling->right ) ) {
+				sibling->left->red = 0;
+				sibling->red = 1;
+				rb_rotate_right ( root, sibling );
+				sibling = parent->right;
+			}
+			sibling->red = parent->red;
+			parent->red = 0;
+			sibling->right->red = 0;
+			rb_rotate_left ( root, parent );
+		} else {
+			sibling = parent->left;
+			if ( rb_is_red ( sibling ) ) {
+				sibling->red = 0;
+				parent->red = 1;
+				rb_rotate_right ( root, parent );
+				sibling = parent->left;
+			}
+			if ( ( ! rb_is_red ( sibling->left ) ) &&
+			     ( ! rb_is_red ( sibling->right ) ) ) {
+				/* Recolour and continue from parent */
+				sibling->red = 1;
+				node = parent;
+				parent = node->parent;
+				continue;
+			}
+			if ( ! rb_is_red ( sibling->left ) ) {
+				sibling->right->red = 0;
+				sibling->red = 1;
+				rb_rotate_left ( root, sibling );
+				sibling = parent->left;
+			}
+			sibling->red = parent->red;
+			parent->red = 0;
+			sibling->left->red = 0;
+			rb_rotate_right ( root, parent );
+		}
+		node = root->node;
+		break;
+	}
+
+	/* Colour final node black */
+	if ( node )
+		node->red = 0;
+}
+
+/**
+ * Remove node from red-black tree
+ *
+ * @v root		Red-black tree
+ * @v node		Node to remove
+ */
+void rb_erase ( struct rb_root *root, struct rb_node *node ) {
+	struct rb_node *successor;
+	struct rb_node *child;
+	struct rb_node *parent;
+	int red;
+
+	if ( node->left && node->right ) {
+
+		/* Node has two children: replace it with its in-order
+		 * successor (which has no left child).
+		 */
+		successor = node->right;
+		while ( successor->left )
+			successor = successor->left;
+		child = successor->right;
+		red = successor->red;
+		if ( successor->parent == node ) {
+			parent = successor;
+		} else {
+			parent = successor->parent;
+			parent->left = child;
+			if ( child )
+				child->parent = parent;
+			successor->right = node->right;
+			node->right->parent = successor;
+		}
+		rb_replace_child ( root, node->parent, node, successor );
+		successor->parent = node->parent;
+		successor->left = node->left;
+		node->left->parent = successor;
+		successor->red = node->red;
+
+	} else {
+
+		/* Node has at most one child: replace it with that child */
+		child = ( node->left ? node->left : node->right );
+		parent = node->parent;
+		red = node->red;
+		rb_replace_child ( root, parent, node, child );
+		if ( child )
+			child->parent = parent;
+	}
+
+	/* Restore invariants if a black node has been removed */
+	if ( ! red )
+		rb_erase_fixup ( root, child, parent );
+}
+
+/**
+ * Find first (lowest) node in red-black tree
+ *
+ * @v root		Red-black tree
+ * @ret node		First node, or NULL if tree is empty
+ */
+struct rb_node * rb_first ( struct rb_root *root ) {
+	struct rb_node *node = root->node;
+
+	if ( node ) {
+		while ( node->left )
+			node = node->left;
+	}
+	return node;
+}
+
+/**
+ * Find last (highest) node in red-black tree
+ *
+ * @v root		Red-black tree
+ * @ret node		Last node, or NULL if tree is empty
+ */
+struct rb_node * rb_last ( struct rb_root *root ) {
+	struct rb_node *node = root->node;
+
+	if ( node ) {
+		while ( node->right )
+			node = node->right;
+	}
+	return node;
+}
+
+/**
+ * Find next node in red-black tree
+ *
+ * @v node		Node
+ * @ret next		Next (higher) node, or NULL if this is the last node
+ */
+struct rb_node * rb_next ( struct rb_node *node ) {
+	struct rb_node *parent;
+
+	/* Next node is the lowest node in the right subtree, if any */
+	if ( node->right ) {
+		node = node->right;
+		while ( node->left )
+			node = node->left;
+		return node;
+	}
+
+	/* Otherwise, ascend until we ascend from a left child */
+	while ( ( parent = node->parent ) && ( node == parent->right ) )
+		node = parent;
+	return parent;
+}
+
+/**
+ * Find previous node in red-black tree
+ *
+ * @v node		Node
+ * @ret prev		Previous (lower) node, or NULL if this is the first node
+ */
+struct rb_node * rb_prev ( struct rb_node *node ) {
+	struct rb_node *parent;
+
+	/* Previous node is the highest node in the left subtree, if any */
+	if ( node->left ) {
+		node = node->left;
+		while ( node->right )
+			node = node->right;
+		return node;
+	}
+
+	/* Otherwise, ascend until we ascend from a right child */
+	while ( ( parent = node->parent ) && ( node == parent->left ) )
+		node = parent;
+	return parent;
+}
@@ -42,6 +42,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dhcp.h>
 #include <ipxe/settings.h>
 #include <ipxe/quiesce.h>
+#include <ipxe/umalloc.h>
+#include <ipxe/malloc.h>
+#include <ipxe/init.h>
 #include <ipxe/sanboot.h>
 
 /**
@@ -75,6 +78,51 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define SAN_DEFAULT_RETRIES 10
 
+/**
+ * Default number of concurrently outstanding commands
+ *
+ * Large reads and writes are split across several concurrently
+ * outstanding commands, allowing the underlying device to overlap
+ * the latency of each command with the data transfer for the
+ * others.  The underlying device's flow control window may further
+ * limit the number of outstanding commands.
+ */
+#define SAN_DEFAULT_DEPTH 4
+
+/**
+ * Minimum length of each command within a split read/write
+ *
+ * Avoid splitting small requests into commands that would be
+ * dominated by per-command overheads.
+ */
+#define SAN_MIN_SPLIT_LEN 16384
+
+/**
+ * Length of each block cache line
+ *
+ * Boot loaders tend to issue large numbers of small sequential
+ * reads, each of which would otherwise incur a full network round
+ * trip.  Reads are cached (and read ahead) in units of this length,
+ * subject to the underlying device's maximum transfer size.
+ */
+#define SAN_CACHE_LINE_LEN 65536
+
+/**
+ * Scale factor for recorded path latencies
+ *
+ * Latencies are recorded in units of ( 1 / 2^SAN_LATENCY_SCALE )
+ * ticks, to retain some precision for fast paths.
+ */
+#define SAN_LATENCY_SCALE 4
+
+/**
+ * Weight of each new sample within the average path latency
+ *
+ * The average latency is updated as a moving average, with each
+ * completed command contributing ( 1 / SAN_LATENCY_WEIGHT ).
+ */
+#define SAN_LATENCY_WEIGHT 8
+
 /**
  * Delay between reopening attempts
  *
@@ -91,6 +139,15 @@ LIST_HEAD ( san_devices );
 /** Number of times to retry commands */
 static unsigned long san_retries = SAN_DEFAULT_RETRIES;
 
+/** Number of concurrently outstanding commands */
+static unsigned long san_depth = SAN_DEFAULT_DEPTH;
+
+/** Stripe reads across all usable paths */
+static unsigned long san_stripe;
+
+/** Block caching has been disabled for the remaining lifetime of iPXE */
+static int san_cache_disabled;
+
 /**
  * Find SAN device by drive number
  *
@@ -124,35 +181,83 @@ static void sandev_free ( struct refcnt *refcnt ) {
 		uri_put ( sandev->path[i].uri );
 		assert ( sandev->path[i].desc == NULL );
 	}
+	assert ( ! timer_running ( &sandev->cache.timer ) );
+	ufree ( sandev->cache.data );
 	free ( sandev );
 }
 
+/**
+ * Record completion of a command issued via SAN path
+ *
+ * @v sanpath		SAN path
+ * @v started		Command start time (in ticks)
+ * @v rc		Command status
+ */
+static void sanpath_command_done ( struct san_path *sanpath,
+				   unsigned long started, int rc ) {
+	unsigned long latency;
+
+	/* Update outstanding command count */
+	assert ( sanpath->outstanding > 0 );
+	sanpath->outstanding--;
+
+	/* Update average latency for successful commands */
+	if ( rc == 0 ) {
+		latency = ( ( currticks() - started ) << SAN_LATENCY_SCALE );
+		sanpath->latency = ( ( ( sanpath->latency *
+					 ( SAN_LATENCY_WEIGHT - 1 ) ) +
+				       latency ) / SAN_LATENCY_WEIGHT );
+	}
+}
+
 /**
  * Close SAN device command
  *
- * @v sandev		SAN device
+ * @v sancmd		SAN device command
  * @v rc		Reason for close
  */
-static void sandev_command_close ( struct san_device *sandev, int rc ) {
-
-	/* Stop timer */
-	stop_timer ( &sandev->timer );
+static void sandev_command_close ( struct san_command *sancmd, int rc ) {
+	struct san_device *sandev = sancmd->sandev;
 
 	/* Restart interface */
-	intf_restart ( &sandev->command, rc );
+	intf_restart ( &sancmd->command, rc );
+
+	/* Do nothing more unless command is outstanding */
+	if ( sancmd->rc != -EINPROGRESS )
+		return;
 
 	/* Record command status */
-	sandev->command_rc = rc;
+	sancmd->rc = rc;
+	sanpath_command_done ( sancmd->sanpath, sancmd->started, rc );
+
+	/* Stop timer once all commands have completed */
+	assert ( sandev->outstanding > 0 );
+	if ( --sandev->outstanding == 0 )
+		stop_timer ( &sandev->timer );
 }
 
 /**
- * Record SAN device capacity
+ * Close all SAN device commands
  *
  * @v sandev		SAN device
+ * @v rc		Reason for close
+ */
+static void sandev_command_close_all ( struct san_device *sandev, int rc ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < SAN_MAX_DEPTH ; i++ )
+		sandev_command_close ( &sandev->command[i], rc );
+}
+
+/**
+ * Record SAN device capacity
+ *
+ * @v sancmd		SAN device command
  * @v capacity		SAN device capacity
  */
-static void sandev_command_capacity ( struct san_device *sandev,
+static void sandev_command_capacity ( struct san_command *sancmd,
 				      struct block_device_capacity *capacity ) {
+	struct san_device *sandev = sancmd->sandev;
 
 	/* Record raw capacity information */
 	memcpy ( &sandev->capacity, capacity, sizeof ( sandev->capacity ) );
@@ -160,14 +265,14 @@ static void sandev_command_capacity ( struct san_device *sandev,
 
 /** SAN device command interface operations */
 static struct interface_operation sandev_command_op[] = {
-	INTF_OP ( intf_close, struct san_device *, sandev_command_close ),
-	INTF_OP ( block_capacity, struct san_device *,
+	INTF_OP ( intf_close, struct san_command *, sandev_command_close ),
+	INTF_OP ( block_capacity, struct san_command *,
 		  sandev_command_capacity ),
 };
 
 /** SAN device command interface descriptor */
 static struct interface_descriptor sandev_command_desc =
-	INTF_DESC ( struct san_device, command, sandev_command_op );
+	INTF_DESC ( struct san_command, command, sandev_command_op );
 
 /**
  * Handle SAN device command timeout
@@ -179,7 +284,109 @@ static void sandev_command_expired ( struct retry_timer *timer,
 	struct san_device *sandev =
 		container_of ( timer, struct san_device, timer );
 
-	sandev_command_close ( sandev, -ETIMEDOUT );
+	sandev_command_close_all ( sandev, -ETIMEDOUT );
+}
+
+/**
+ * Close SAN device block cache line fill
+ *
+ * @v line		Block cache line
+ * @v rc		Reason for close
+ */
+static void sandev_cache_fill_close ( struct san_cache_line *line, int rc ) {
+	struct san_device *sandev = line->sandev;
+	struct san_cache *cache = &sandev->cache;
+
+	/* Restart interface */
+	intf_restart ( &line->fill, rc );
+
+	/* Do nothing more unless line is being filled */
+	if ( ! ( line->flags & SAN_LINE_FILLING ) )
+		return;
+
+	/* Mark line as valid, unless fill failed or line was
+	 * overwritten while being filled.
+	 */
+	if ( rc != 0 ) {
+		DBGC ( sandev, "SAN %#02x could not fill cache line %#llx: "
+		       "%s\n", sandev->drive, ( unsigned long long ) line->lba,
+		       strerror ( rc ) );
+	}
+	line->flags = ( ( ( rc == 0 ) && ! ( line->flags & SAN_LINE_STALE ) ) ?
+			SAN_LINE_VALID : 0 );
+	sanpath_command_done ( line->sanpath, line->started, rc );
+	assert ( cache->filling > 0 );
+	cache->filling--;
+}
+
+/**
+ * Close all SAN device block cache line fills
+ *
+ * @v sandev		SAN device
+ * @v rc		Reason for close
+ */
+static void sandev_cache_close_all ( struct san_device *sandev, int rc ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ )
+		sandev_cache_fill_close ( &sandev->cache.line[i], rc );
+}
+
+/** SAN device block cache line fill interface operations */
+static struct interface_operation sandev_cache_fill_op[] = {
+	INTF_OP ( intf_close, struct san_cache_line *,
+		  sandev_cache_fill_close ),
+};
+
+/** SAN device block cache line fill interface descriptor */
+static struct interface_descriptor sandev_cache_fill_desc =
+	INTF_DESC ( struct san_cache_line, fill, sandev_cache_fill_op );
+
+/**
+ * Handle SAN device block cache fill timeout
+ *
+ * @v retry		Retry timer
+ *
+ * The underlying commands are left to complete in their own time,
+ * since aborting a command may tear down the whole SAN connection.
+ * Any lines still being filled are marked as stale, so that their
+ * contents will be discarded upon completion.
+ */
+static void sandev_cache_expired ( struct retry_timer *timer,
+				   int over __unused ) {
+	struct san_device *sandev =
+		container_of ( timer, struct san_device, cache.timer );
+	struct san_cache_line *line;
+	unsigned int i;
+
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ ) {
+		line = &sandev->cache.line[i];
+		if ( line->flags & SAN_LINE_FILLING ) {
+			DBGC ( sandev, "SAN %#02x timed out filling cache line "
+			       "%#llx\n", sandev->drive,
+			       ( unsigned long long ) line->lba );
+			line->flags |= SAN_LINE_STALE;
+		}
+	}
+}
+
+/**
+ * Free SAN device block cache
+ *
+ * @v sandev		SAN device
+ */
+static void sandev_cache_free ( struct san_device *sandev ) {
+	struct san_cache *cache = &sandev->cache;
+	unsigned int i;
+
+	/* Abandon any fills in progress */
+	sandev_cache_close_all ( sandev, -ECANCELED );
+
+	/* Free cached data */
+	ufree ( cache->data );
+	cache->data = UNULL;
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ )
+		cache->line[i].flags = 0;
 }
 
 /**
@@ -232,6 +439,10 @@ static int sanpath_open ( struct san_path *sanpath ) {
  */
 static void sanpath_close ( struct san_path *sanpath, int rc ) {
 	struct san_device *sandev = sanpath->sandev;
+	struct san_command *sancmd;
+	struct san_cache_line *line;
+	struct san_path *tmp;
+	unsigned int i;
 
 	/* Record status */
 	sanpath->path_rc = rc;
@@ -244,12 +455,42 @@ static void sanpath_close ( struct san_path *sanpath, int rc ) {
 	process_del ( &sanpath->process );
 
 	/* Restart interfaces, avoiding potential loops */
+	for ( i = 0 ; i < SAN_MAX_DEPTH ; i++ ) {
+		sancmd = &sandev->command[i];
+		if ( sancmd->sanpath == sanpath )
+			intf_nullify ( &sancmd->command );
+	}
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ ) {
+		line = &sandev->cache.line[i];
+		if ( line->sanpath == sanpath )
+			intf_nullify ( &line->fill );
+	}
+	intf_restart ( &sanpath->block, rc );
+	for ( i = 0 ; i < SAN_MAX_DEPTH ; i++ ) {
+		sancmd = &sandev->command[i];
+		if ( sancmd->sanpath == sanpath )
+			sandev_command_close ( sancmd, rc );
+	}
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ ) {
+		line = &sandev->cache.line[i];
+		if ( line->sanpath == sanpath )
+			sandev_cache_fill_close ( line, rc );
+	}
+	assert ( sanpath->outstanding == 0 );
+
+	/* If this was the active path, then fail over to any other
+	 * available path (which will exist only when striping).
+	 */
 	if ( sanpath == sandev->active ) {
-		intfs_restart ( rc, &sandev->command, &sanpath->block, NULL );
 		sandev->active = NULL;
-		sandev_command_close ( sandev, rc );
-	} else {
-		intf_restart ( &sanpath->block, rc );
+		list_for_each_entry ( tmp, &sandev->opened, list ) {
+			if ( tmp->path_rc == 0 ) {
+				DBGC ( sandev, "SAN %#02x.%d is active\n",
+				       sandev->drive, tmp->index );
+				sandev->active = tmp;
+				break;
+			}
+		}
 	}
 }
 
@@ -294,8 +535,10 @@ static size_t sanpath_block_window ( struct san_path *sanpath __unused ) {
 static void sanpath_step ( struct san_path *sanpath ) {
 	struct san_device *sandev = sanpath->sandev;
 
-	/* Ignore if we are already the active device */
-	if ( sanpath == sandev->active )
+	/* Ignore if we are already the active device or already
+	 * available for striping.
+	 */
+	if ( ( sanpath == sandev->active ) || ( sanpath->path_rc == 0 ) )
 		return;
 
 	/* Wait until path has become available */
@@ -310,6 +553,9 @@ static void sanpath_step ( struct san_path *sanpath ) {
 		DBGC ( sandev, "SAN %#02x.%d is active\n",
 		       sandev->drive, sanpath->index );
 		sandev->active = sanpath;
+	} else if ( san_stripe ) {
+		DBGC ( sandev, "SAN %#02x.%d is available for striping\n",
+		       sandev->drive, sanpath->index );
 	} else {
 		DBGC ( sandev, "SAN %#02x.%d is available\n",
 		       sandev->drive, sanpath->index );
@@ -350,8 +596,9 @@ static void sandev_restart ( struct san_device *sandev, int rc ) {
 	/* Clear active path */
 	sandev->active = NULL;
 
-	/* Close any outstanding command */
-	sandev_command_close ( sandev, rc );
+	/* Close any outstanding commands and cache fills */
+	sandev_command_close_all ( sandev, rc );
+	sandev_cache_close_all ( sandev, rc );
 }
 
 /**
@@ -437,12 +684,14 @@ union san_command_params {
  * Initiate SAN device read/write command
  *
  * @v sandev		SAN device
+ * @v sancmd		SAN device command
  * @v params		Command parameters
  * @ret rc		Return status code
  */
 static int sandev_command_rw ( struct san_device *sandev,
+			       struct san_command *sancmd,
 			       const union san_command_params *params ) {
-	struct san_path *sanpath = sandev->active;
+	struct san_path *sanpath = sancmd->sanpath;
 	size_t len = ( params->rw.count * sandev->capacity.blksize );
 	int rc;
 
@@ -450,7 +699,7 @@ static int sandev_command_rw ( struct san_device *sandev,
 	assert ( sanpath != NULL );
 
 	/* Initiate read/write command */
-	if ( ( rc = params->rw.block_rw ( &sanpath->block, &sandev->command,
+	if ( ( rc = params->rw.block_rw ( &sanpath->block, &sancmd->command,
 					  params->rw.lba, params->rw.count,
 					  params->rw.buffer, len ) ) != 0 ) {
 		DBGC ( sandev, "SAN %#02x.%d could not initiate read/write: "
@@ -465,13 +714,15 @@ static int sandev_command_rw ( struct san_device *sandev,
  * Initiate SAN device read capacity command
  *
  * @v sandev		SAN device
+ * @v sancmd		SAN device command
  * @v params		Command parameters
  * @ret rc		Return status code
  */
 static int
 sandev_command_read_capacity ( struct san_device *sandev,
+			       struct san_command *sancmd,
 			       const union san_command_params *params __unused){
-	struct san_path *sanpath = sandev->active;
+	struct san_path *sanpath = sancmd->sanpath;
 	int rc;
 
 	/* Sanity check */
@@ -479,7 +730,7 @@ sandev_command_read_capacity ( struct san_device *sandev,
 
 	/* Initiate read capacity command */
 	if ( ( rc = block_read_capacity ( &sanpath->block,
-					  &sandev->command ) ) != 0 ) {
+					  &sancmd->command ) ) != 0 ) {
 		DBGC ( sandev, "SAN %#02x.%d could not initiate read capacity: "
 		       "%s\n", sandev->drive, sanpath->index, strerror ( rc ) );
 		return rc;
@@ -489,23 +740,112 @@ sandev_command_read_capacity ( struct san_device *sandev,
 }
 
 /**
- * Execute a single SAN device command and wait for completion
+ * Choose SAN path for a further command
+ *
+ * @v sandev		SAN device
+ * @v stripe		Command may be issued via any usable path
+ * @ret sanpath		SAN path, or NULL if no path can accept a command
+ *
+ * When striping, the path with the lowest expected completion time
+ * (based on the number of outstanding commands and the average
+ * command latency) will be chosen.
+ */
+static struct san_path * sandev_path ( struct san_device *sandev,
+				       int stripe ) {
+	struct san_path *sanpath;
+	struct san_path *best = NULL;
+	unsigned long best_cost = 0;
+	unsigned long cost;
+
+	/* Use active path unless striping */
+	if ( ! ( stripe && san_stripe ) ) {
+		sanpath = sandev->active;
+		if ( sanpath && xfer_window ( &sanpath->block ) )
+			return sanpath;
+		return NULL;
+	}
+
+	/* Choose cheapest available path */
+	list_for_each_entry ( sanpath, &sandev->opened, list ) {
+		if ( sanpath->path_rc != 0 )
+			continue;
+		if ( ! xfer_window ( &sanpath->block ) )
+			continue;
+		cost = ( ( sanpath->outstanding + 1 ) *
+			 ( sanpath->latency + 1 ) );
+		if ( ( ! best ) || ( cost < best_cost ) ) {
+			best = sanpath;
+			best_cost = cost;
+		}
+	}
+	return best;
+}
+
+/**
+ * Wait for SAN device block cache fills
+ *
+ * @v sandev		SAN device
+ * @v line		Block cache line to wait for, or NULL
+ * @v stripe		Command may be issued via any usable path
+ *
+ * If a line is specified, wait for it to be filled.  Otherwise, wait
+ * until a path can accept a further command.
+ *
+ * No network polling takes place between calls into iPXE, and so
+ * fills are timed only while a caller is waiting for them.  If the
+ * caller cannot otherwise make progress since all usable paths are
+ * occupied by fills, then the fills will be abandoned upon timeout.
+ */
+static void sandev_cache_wait ( struct san_device *sandev,
+				struct san_cache_line *line, int stripe ) {
+	struct san_cache *cache = &sandev->cache;
+
+	/* Wait for fill progress */
+	start_timer_fixed ( &cache->timer, SAN_COMMAND_TIMEOUT );
+	while ( ( line ? ( ( line->flags & SAN_LINE_FILLING ) &&
+			   ! ( line->flags & SAN_LINE_STALE ) ) :
+		  ( cache->filling && ! sandev_path ( sandev, stripe ) ) ) &&
+		timer_running ( &cache->timer ) ) {
+		step();
+	}
+	stop_timer ( &cache->timer );
+
+	/* Abandon any fills that are blocking all usable paths */
+	if ( ( ! line ) && cache->filling && ! sandev_path ( sandev, stripe ) )
+		sandev_cache_close_all ( sandev, -ETIMEDOUT );
+}
+
+/**
+ * Execute SAN device commands and wait for completion
  *
  * @v sandev		SAN device
  * @v command		Command
- * @v params		Command parameters (if required)
+ * @v params		List of command parameters (if required)
+ * @v count		Number of commands
+ * @v stripe		Commands may be issued via any usable path
  * @ret rc		Return status code
+ *
+ * Commands are issued concurrently, subject to the underlying
+ * device's flow control window.  If any command fails then all of
+ * the commands will be retried.
  */
 static int
 sandev_command ( struct san_device *sandev,
 		 int ( * command ) ( struct san_device *sandev,
+				     struct san_command *sancmd,
 				     const union san_command_params *params ),
-		 const union san_command_params *params ) {
+		 const union san_command_params *params, unsigned int count,
+		 int stripe ) {
+	struct san_command *sancmd;
+	struct san_path *sanpath;
 	unsigned int retries = 0;
+	unsigned int i;
 	int rc;
 
 	/* Sanity check */
+	assert ( count <= SAN_MAX_DEPTH );
 	assert ( ! timer_running ( &sandev->timer ) );
+	assert ( sandev->outstanding == 0 );
 
 	/* Unquiesce system */
 	unquiesce();
@@ -527,21 +867,62 @@ sandev_command ( struct san_device *sandev,
 			continue;
 		}
 
-		/* Initiate command */
-		if ( ( rc = command ( sandev, params ) ) != 0 ) {
-			retries++;
-			continue;
-		}
+		/* Initiate commands */
+		rc = 0;
+		for ( i = 0 ; i < count ; i++ ) {
+
+			/* Wait for device to accept a further command */
+			while ( sandev->outstanding &&
+				! sandev_path ( sandev, stripe ) ) {
+				step();
+			}
+			sandev_cache_wait ( sandev, NULL, stripe );
+			if ( ! sandev->active ) {
+				rc = -ENOTCONN;
+				break;
+			}
+			sanpath = sandev_path ( sandev, stripe );
+			if ( ! sanpath )
+				sanpath = sandev->active;
 
-		/* Start expiry timer */
-		start_timer_fixed ( &sandev->timer, SAN_COMMAND_TIMEOUT );
+			/* Mark command as outstanding, starting expiry
+			 * timer if this is the only outstanding command.
+			 * (The command may complete immediately.)
+			 */
+			sancmd = &sandev->command[i];
+			sancmd->rc = -EINPROGRESS;
+			sancmd->sanpath = sanpath;
+			sancmd->started = currticks();
+			sanpath->outstanding++;
+			if ( sandev->outstanding++ == 0 ) {
+				start_timer_fixed ( &sandev->timer,
+						    SAN_COMMAND_TIMEOUT );
+			}
 
-		/* Wait for command to complete */
+			/* Initiate command */
+			if ( ( rc = command ( sandev, sancmd,
+					      ( params ? &params[i] : NULL ) ) )
+			     != 0 ) {
+				sandev_command_close ( sancmd, rc );
+				break;
+			}
+		}
+
+		/* Wait for all commands to complete */
 		while ( timer_running ( &sandev->timer ) )
 			step();
+		assert ( sandev->outstanding == 0 );
+		if ( rc != 0 ) {
+			retries++;
+			continue;
+		}
 
 		/* Check command status */
-		if ( ( rc = sandev->command_rc ) != 0 ) {
+		for ( i = 0 ; i < count ; i++ ) {
+			if ( ( rc = sandev->command[i].rc ) != 0 )
+				break;
+		}
+		if ( rc != 0 ) {
 			retries++;
 			continue;
 		}
@@ -590,40 +971,339 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
 					    struct interface *data,
 					    uint64_t lba, unsigned int count,
 					    userptr_t buffer, size_t len ) ) {
-	union san_command_params params;
+	union san_command_params params[SAN_MAX_DEPTH];
 	unsigned int remaining;
+	unsigned int frag_count;
+	unsigned int min_count;
+	unsigned int depth;
+	unsigned int i;
 	size_t frag_len;
 	int rc;
 
-	/* Initialise command parameters */
-	params.rw.block_rw = block_rw;
-	params.rw.buffer = buffer;
-	params.rw.lba = ( lba << sandev->blksize_shift );
-	params.rw.count = sandev->capacity.max_count;
+	/* Determine fragment length.  Split the request across up
+	 * to san_depth concurrently outstanding commands, without
+	 * creating excessively small commands.
+	 */
+	lba <<= sandev->blksize_shift;
 	remaining = ( count << sandev->blksize_shift );
+	depth = san_depth;
+	frag_count = ( ( remaining + depth - 1 ) / depth );
+	min_count = ( SAN_MIN_SPLIT_LEN / sandev->capacity.blksize );
+	if ( frag_count < min_count )
+		frag_count = min_count;
+	if ( frag_count > sandev->capacity.max_count )
+		frag_count = sandev->capacity.max_count;
 
 	/* Read/write fragments */
 	while ( remaining ) {
 
-		/* Determine fragment length */
-		if ( params.rw.count > remaining )
-			params.rw.count = remaining;
+		/* Construct command parameters for each fragment */
+		for ( i = 0 ; ( i < depth ) && remaining ; i++ ) {
+			params[i].rw.block_rw = block_rw;
+			params[i].rw.buffer = buffer;
+			params[i].rw.lba = lba;
+			params[i].rw.count = frag_count;
+			if ( params[i].rw.count > remaining )
+				params[i].rw.count = remaining;
+			frag_len = ( sandev->capacity.blksize *
+				     params[i].rw.count );
+			buffer = userptr_add ( buffer, frag_len );
+			lba += params[i].rw.count;
+			remaining -= params[i].rw.count;
+		}
 
-		/* Execute command */
+		/* Execute commands */
 		if ( ( rc = sandev_command ( sandev, sandev_command_rw,
-					     &params ) ) != 0 )
+					     params, i,
+					     ( block_rw == block_read ) ) ) != 0 )
 			return rc;
+	}
+
+	return 0;
+}
 
-		/* Move to next fragment */
-		frag_len = ( sandev->capacity.blksize * params.rw.count );
-		params.rw.buffer = userptr_add ( params.rw.buffer, frag_len );
-		params.rw.lba += params.rw.count;
-		remaining -= params.rw.count;
+/**
+ * Allocate SAN device block cache, if applicable
+ *
+ * @v sandev		SAN device
+ * @ret rc		Return status code
+ */
+static int sandev_cache_alloc ( struct san_device *sandev ) {
+	struct san_cache *cache = &sandev->cache;
+	size_t blksize = sandev->capacity.blksize;
+	unsigned int count;
+
+	/* Do nothing if already allocated */
+	if ( cache->data )
+		return 0;
+
+	/* Do nothing if caching has been disabled */
+	if ( san_cache_disabled )
+		return -ENOTSUP;
+
+	/* Calculate line size.  Each line must be a power-of-two
+	 * multiple of the exposed block size, and must be readable
+	 * using a single underlying command.
+	 */
+	if ( ( blksize == 0 ) || ( blksize > SAN_CACHE_LINE_LEN ) )
+		return -ENOTSUP;
+	count = ( SAN_CACHE_LINE_LEN / blksize );
+	while ( count > sandev->capacity.max_count )
+		count >>= 1;
+	if ( count < ( 1U << sandev->blksize_shift ) )
+		return -ENOTSUP;
+
+	/* Allocate cached data */
+	cache->data = umalloc ( SAN_CACHE_LINES * count * blksize );
+	if ( ! cache->data ) {
+		DBGC ( sandev, "SAN %#02x could not allocate block cache\n",
+		       sandev->drive );
+		return -ENOMEM;
 	}
+	cache->count = count;
+	DBGC ( sandev, "SAN %#02x using %d %zd-byte cache lines\n",
+	       sandev->drive, SAN_CACHE_LINES, ( count * blksize ) );
 
 	return 0;
 }
 
+/**
+ * Find SAN device block cache line
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting (underlying) logical block address of line
+ * @ret line		Block cache line (valid or being filled), or NULL
+ */
+static struct san_cache_line * sandev_cache_find ( struct san_device *sandev,
+						   uint64_t lba ) {
+	struct san_cache_line *line;
+	unsigned int i;
+
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ ) {
+		line = &sandev->cache.line[i];
+		if ( ( line->lba == lba ) &&
+		     ( line->flags & ( SAN_LINE_VALID | SAN_LINE_FILLING ) ) &&
+		     ! ( line->flags & SAN_LINE_STALE ) ) {
+			return line;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Start filling SAN device block cache line
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting (underlying) logical block address of line
+ * @ret line		Block cache line being filled, or NULL
+ *
+ * The least recently used line that is not already being filled will
+ * be reused.  No line will be filled if the device cannot currently
+ * accept a further command.
+ */
+static struct san_cache_line * sandev_cache_fill ( struct san_device *sandev,
+						   uint64_t lba ) {
+	struct san_cache *cache = &sandev->cache;
+	struct san_path *sanpath;
+	struct san_cache_line *line = NULL;
+	struct san_cache_line *tmp;
+	size_t len = ( cache->count * sandev->capacity.blksize );
+	unsigned int i;
+	int rc;
+
+	/* Do not cache lines extending beyond the end of the device */
+	if ( ( lba + cache->count ) > sandev->capacity.blocks )
+		return NULL;
+
+	/* Choose path, if any can accept a further command */
+	sanpath = sandev_path ( sandev, 1 );
+	if ( ! sanpath )
+		return NULL;
+
+	/* Choose least recently used line */
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ ) {
+		tmp = &cache->line[i];
+		if ( tmp->flags & SAN_LINE_FILLING )
+			continue;
+		if ( ( ! line ) || ( tmp->used < line->used ) )
+			line = tmp;
+	}
+	if ( ! line )
+		return NULL;
+
+	/* Mark line as being filled.  (The fill may complete
+	 * immediately.)
+	 */
+	line->lba = lba;
+	line->flags = SAN_LINE_FILLING;
+	line->used = ++cache->age;
+	line->sanpath = sanpath;
+	line->started = currticks();
+	sanpath->outstanding++;
+	cache->filling++;
+
+	/* Initiate read */
+	if ( ( rc = block_read ( &sanpath->block, &line->fill, lba,
+				 cache->count,
+				 userptr_add ( cache->data,
+					       ( ( line - cache->line ) * len ) ),
+				 len ) ) != 0 ) {
+		DBGC ( sandev, "SAN %#02x.%d could not initiate cache fill: "
+		       "%s\n", sandev->drive, sanpath->index, strerror ( rc ) );
+		sandev_cache_fill_close ( line, rc );
+		return NULL;
+	}
+
+	return line;
+}
+
+/**
+ * Read from SAN device block cache
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @ret cached		Number of leading logical blocks read from cache
+ *
+ * Reads that are smaller than a cache line will cause the containing
+ * line to be filled, so that subsequent nearby reads may be satisfied
+ * from the cache.  Any lines already being filled (e.g. by read-ahead)
+ * will be waited for.
+ */
+static unsigned int sandev_cache_read ( struct san_device *sandev,
+					uint64_t lba, unsigned int count,
+					userptr_t buffer ) {
+	struct san_cache *cache = &sandev->cache;
+	struct san_cache_line *line;
+	size_t blksize = sandev->capacity.blksize;
+	uint64_t line_lba;
+	unsigned int offset;
+	unsigned int frag_count;
+	unsigned int cached;
+	int missed = 0;
+
+	/* Convert to underlying blocks */
+	lba <<= sandev->blksize_shift;
+	count <<= sandev->blksize_shift;
+
+	/* Detect sequential reads */
+	if ( lba == cache->next_lba ) {
+		cache->sequential++;
+	} else {
+		cache->sequential = 0;
+	}
+	cache->next_lba = ( lba + count );
+
+	/* Do nothing more unless cache can be used */
+	if ( sandev_cache_alloc ( sandev ) != 0 )
+		return 0;
+
+	/* Read leading blocks from cache */
+	for ( cached = 0 ; cached < count ; cached += frag_count ) {
+
+		/* Find (or fill) line containing this block */
+		offset = ( lba & ( cache->count - 1 ) );
+		line_lba = ( lba - offset );
+		line = sandev_cache_find ( sandev, line_lba );
+		if ( ( ! line ) && ( count < cache->count ) ) {
+			sandev_cache_wait ( sandev, NULL, 1 );
+			line = sandev_cache_fill ( sandev, line_lba );
+			missed = 1;
+		}
+		if ( ! line )
+			break;
+
+		/* Wait for line to be filled */
+		sandev_cache_wait ( sandev, line, 0 );
+		if ( ! ( line->flags & SAN_LINE_VALID ) )
+			break;
+		line->used = ++cache->age;
+
+		/* Copy data from line */
+		frag_count = ( cache->count - offset );
+		if ( frag_count > ( count - cached ) )
+			frag_count = ( count - cached );
+		memcpy_user ( buffer, 0, cache->data,
+			      ( ( ( ( line - cache->line ) * cache->count ) +
+				  offset ) * blksize ),
+			      ( frag_count * blksize ) );
+		buffer = userptr_add ( buffer, ( frag_count * blksize ) );
+		lba += frag_count;
+	}
+
+	/* Update statistics */
+	if ( ( cached == count ) && ! missed ) {
+		cache->hits++;
+	} else {
+		cache->misses++;
+	}
+
+	return ( cached >> sandev->blksize_shift );
+}
+
+/**
+ * Read ahead into SAN device block cache
+ *
+ * @v sandev		SAN device
+ *
+ * If recent reads have been sequential, start filling the cache lines
+ * following the most recent read.  The read-ahead window grows with
+ * each further sequential read, up to the command queue depth.
+ */
+static void sandev_cache_readahead ( struct san_device *sandev ) {
+	struct san_cache *cache = &sandev->cache;
+	unsigned int window;
+	uint64_t lba;
+
+	/* Do nothing unless reads are sequential and cache is usable */
+	if ( ( ! cache->sequential ) || ( ! cache->data ) )
+		return;
+
+	/* Fill any missing lines within read-ahead window */
+	window = cache->sequential;
+	if ( window > san_depth )
+		window = san_depth;
+	lba = ( cache->next_lba & ~( ( uint64_t ) cache->count - 1 ) );
+	for ( ; window-- ; lba += cache->count ) {
+		if ( sandev_cache_find ( sandev, lba ) )
+			continue;
+		if ( ! sandev_cache_fill ( sandev, lba ) )
+			break;
+	}
+}
+
+/**
+ * Invalidate SAN device block cache
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ */
+static void sandev_cache_invalidate ( struct san_device *sandev,
+				      uint64_t lba, unsigned int count ) {
+	struct san_cache *cache = &sandev->cache;
+	struct san_cache_line *line;
+	unsigned int i;
+
+	/* Convert to underlying blocks */
+	lba <<= sandev->blksize_shift;
+	count <<= sandev->blksize_shift;
+
+	/* Invalidate any overlapping lines */
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ ) {
+		line = &cache->line[i];
+		if ( ( line->lba >= ( lba + count ) ) ||
+		     ( ( line->lba + cache->count ) <= lba ) )
+			continue;
+		if ( line->flags & SAN_LINE_FILLING ) {
+			line->flags |= SAN_LINE_STALE;
+		} else {
+			line->flags = 0;
+		}
+	}
+}
+
 /**
  * Read from SAN device
  *
@@ -635,11 +1315,27 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
  */
 int sandev_read ( struct san_device *sandev, uint64_t lba,
 		  unsigned int count, userptr_t buffer ) {
+	unsigned int cached;
 	int rc;
 
-	/* Read from device */
-	if ( ( rc = sandev_rw ( sandev, lba, count, buffer, block_read ) ) != 0 )
+	/* Unquiesce system */
+	unquiesce();
+
+	/* Read as much as possible from cache */
+	cached = sandev_cache_read ( sandev, lba, count, buffer );
+	lba += cached;
+	count -= cached;
+	buffer = userptr_add ( buffer, ( cached * sandev_blksize ( sandev ) ) );
+
+	/* Read remainder from device */
+	if ( count &&
+	     ( ( rc = sandev_rw ( sandev, lba, count, buffer,
+				  block_read ) ) != 0 ) ) {
 		return rc;
+	}
+
+	/* Read ahead, if applicable */
+	sandev_cache_readahead ( sandev );
 
 	return 0;
 }
@@ -657,6 +1353,9 @@ int sandev_write ( struct san_device *sandev, uint64_t lba,
 		   unsigned int count, userptr_t buffer ) {
 	int rc;
 
+	/* Invalidate any cached data */
+	sandev_cache_invalidate ( sandev, lba, count );
+
 	/* Write to device */
 	if ( ( rc = sandev_rw ( sandev, lba, count, buffer, block_write ) ) != 0 )
 		return rc;
@@ -805,6 +1504,9 @@ static int sandev_parse_iso9660 ( struct san_device *sandev ) {
 		       "treating as CD-ROM\n", sandev->drive );
 		sandev->blksize_shift = blksize_shift;
 		sandev->is_cdrom = 1;
+
+		/* Discard any data cached using the original geometry */
+		sandev_cache_free ( sandev );
 	}
 
  err_rw:
@@ -835,8 +1537,19 @@ struct san_device * alloc_sandev ( struct uri **uris, unsigned int count,
 	if ( ! sandev )
 		return NULL;
 	ref_init ( &sandev->refcnt, sandev_free );
-	intf_init ( &sandev->command, &sandev_command_desc, &sandev->refcnt );
+	for ( i = 0 ; i < SAN_MAX_DEPTH ; i++ ) {
+		sandev->command[i].sandev = sandev;
+		intf_init ( &sandev->command[i].command, &sandev_command_desc,
+			    &sandev->refcnt );
+	}
 	timer_init ( &sandev->timer, sandev_command_expired, &sandev->refcnt );
+	for ( i = 0 ; i < SAN_CACHE_LINES ; i++ ) {
+		sandev->cache.line[i].sandev = sandev;
+		intf_init ( &sandev->cache.line[i].fill,
+			    &sandev_cache_fill_desc, &sandev->refcnt );
+	}
+	timer_init ( &sandev->cache.timer, sandev_cache_expired,
+		     &sandev->refcnt );
 	sandev->priv = ( ( ( void * ) sandev ) + size );
 	sandev->paths = count;
 	INIT_LIST_HEAD ( &sandev->opened );
@@ -893,7 +1606,7 @@ int register_sandev ( struct san_device *sandev, unsigned int drive,
 
 	/* Read device capacity */
 	if ( ( rc = sandev_command ( sandev, sandev_command_read_capacity,
-				     NULL ) ) != 0 )
+				     NULL, 1, 0 ) ) != 0 )
 		goto err_capacity;
 
 	/* Configure as a CD-ROM, if applicable */
@@ -936,7 +1649,8 @@ void unregister_sandev ( struct san_device *sandev ) {
 	/* Remove ACPI descriptors */
 	sandev_undescribe ( sandev );
 
-	DBGC ( sandev, "SAN %#02x unregistered\n", sandev->drive );
+	DBGC ( sandev, "SAN %#02x unregistered (cache %ld hits, %ld misses)\n",
+	       sandev->drive, sandev->cache.hits, sandev->cache.misses );
 }
 
 /** The "san-drive" setting */
@@ -973,6 +1687,22 @@ const struct setting san_retries_setting __setting ( SETTING_SANBOOT_EXTRA,
 	.type = &setting_type_int8,
 };
 
+/** The "san-depth" setting */
+const struct setting san_depth_setting __setting ( SETTING_SANBOOT_EXTRA,
+						   san-depth ) = {
+	.name = "san-depth",
+	.description = "SAN command queue depth",
+	.type = &setting_type_uint8,
+};
+
+/** The "san-stripe" setting */
+const struct setting san_stripe_setting __setting ( SETTING_SANBOOT_EXTRA,
+						    san-stripe ) = {
+	.name = "san-stripe",
+	.description = "Stripe SAN reads across multiple paths",
+	.type = &setting_type_uint8,
+};
+
 /**
  * Apply SAN boot settings
  *
@@ -986,6 +1716,22 @@ static int sandev_apply ( void ) {
 		san_retries = SAN_DEFAULT_RETRIES;
 	}
 
+	/* Apply "san-depth" setting */
+	if ( fetch_uint_setting ( NULL, &san_depth_setting,
+				  &san_depth ) < 0 ) {
+		san_depth = SAN_DEFAULT_DEPTH;
+	}
+	if ( ! san_depth )
+		san_depth = 1;
+	if ( san_depth > SAN_MAX_DEPTH )
+		san_depth = SAN_MAX_DEPTH;
+
+	/* Apply "san-stripe" setting */
+	if ( fetch_uint_setting ( NULL, &san_stripe_setting,
+				  &san_stripe ) < 0 ) {
+		san_stripe = 0;
+	}
+
 	return 0;
 }
 
@@ -993,3 +1739,69 @@ static int sandev_apply ( void ) {
 struct settings_applicator sandev_applicator __settings_applicator = {
 	.apply = sandev_apply,
 };
+
+/**
+ * Discard some cached SAN device data
+ *
+ * @ret discarded	Number of cached items discarded
+ */
+static unsigned int sandev_cache_discard ( void ) {
+	struct san_device *sandev;
+
+	/* Free block cache of first SAN device not currently filling
+	 * its cache, if any.
+	 */
+	for_each_sandev ( sandev ) {
+		if ( sandev->cache.data && ( ! sandev->cache.filling ) ) {
+			sandev_cache_free ( sandev );
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * SAN device block cache discarder
+ *
+ * Cached blocks can be recreated by rereading from the SAN device.
+ */
+struct cache_discarder sandev_discarder __cache_discarder ( CACHE_NORMAL ) = {
+	.discard = sandev_cache_discard,
+};
+
+/**
+ * Shut down SAN device block caches
+ *
+ * @v booting		System is shutting down in order to boot
+ */
+static void sandev_cache_shutdown ( int booting ) {
+	struct san_device *sandev;
+	unsigned int i;
+
+	for_each_sandev ( sandev ) {
+
+		/* Abandon any fills in progress */
+		sandev_cache_close_all ( sandev, -ECANCELED );
+
+		/* Leak cached data if booting, since it may not be
+		 * possible to free external memory while control is
+		 * being handed over to the operating system (e.g. from
+		 * within ExitBootServices()).
+		 */
+		if ( booting ) {
+			sandev->cache.data = UNULL;
+			for ( i = 0 ; i < SAN_CACHE_LINES ; i++ )
+				sandev->cache.line[i].flags = 0;
+		}
+	}
+
+	/* Disable any further caching if booting */
+	if ( booting )
+		san_cache_disabled = 1;
+}
+
+/** SAN device block cache shutdown function */
+struct startup_fn sandev_cache_startup_fn __startup_fn ( STARTUP_NORMAL ) = {
+	.name = "sancache",
+	.shutdown = sandev_cache_shutdown,
+};
@@ -59,9 +59,33 @@ void xferbuf_free ( struct xfer_buffer *xferbuf ) {
 
 	xferbuf->op->realloc ( xferbuf, 0 );
 	xferbuf->len = 0;
+	xferbuf->allocated = 0;
 	xferbuf->pos = 0;
 }
 
+/**
+ * Release unused space in data transfer buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ *
+ * This should be called once the final size of the data is known.
+ */
+void xferbuf_trim ( struct xfer_buffer *xferbuf ) {
+	int rc;
+
+	/* Do nothing unless excess space has been allocated */
+	if ( xferbuf->allocated <= xferbuf->len )
+		return;
+
+	/* Shrink buffer (ignoring errors, since the data is intact) */
+	if ( ( rc = xferbuf->op->realloc ( xferbuf, xferbuf->len ) ) != 0 ) {
+		DBGC ( xferbuf, "XFERBUF %p could not trim buffer to %zd "
+		       "bytes: %s\n", xferbuf, xferbuf->len, strerror ( rc ) );
+		return;
+	}
+	xferbuf->allocated = xferbuf->len;
+}
+
 /**
  * Ensure that data transfer buffer is large enough for the specified size
  *
@@ -70,17 +94,46 @@ void xferbuf_free ( struct xfer_buffer *xferbuf ) {
  * @ret rc		Return status code
  */
 static int xferbuf_ensure_size ( struct xfer_buffer *xferbuf, size_t len ) {
+	size_t size;
 	int rc;
 
 	/* If buffer is already large enough, do nothing */
 	if ( len <= xferbuf->len )
 		return 0;
 
-	/* Extend buffer */
-	if ( ( rc = xferbuf->op->realloc ( xferbuf, len ) ) != 0 ) {
-		DBGC ( xferbuf, "XFERBUF %p could not extend buffer to "
-		       "%zd bytes: %s\n", xferbuf, len, strerror ( rc ) );
-		return rc;
+	/* Extend buffer, if necessary */
+	if ( len > xferbuf->allocated ) {
+
+		/* If the buffer is empty then the length is probably
+		 * known in advance (e.g. from an HTTP Content-Length),
+		 * and we allocate exactly the required size.
+		 * Otherwise, grow the buffer geometrically so that
+		 * data of unknown length (e.g. from a chunked HTTP
+		 * response) does not incur a quadratic cost in
+		 * reallocation.
+		 */
+		size = len;
+		if ( xferbuf->len ) {
+			size += ( len / 2 );
+			if ( size < len )
+				size = len;
+		}
+
+		/* Extend buffer, retrying with the exact required
+		 * size if geometric growth fails.
+		 */
+		if ( ( size == len ) ||
+		     ( xferbuf->op->realloc ( xferbuf, size ) != 0 ) ) {
+			size = len;
+			if ( ( rc = xferbuf->op->realloc ( xferbuf,
+							   size ) ) != 0 ) {
+				DBGC ( xferbuf, "XFERBUF %p could not extend "
+				       "buffer to %zd bytes: %s\n", xferbuf,
+				       len, strerror ( rc ) );
+				return rc;
+			}
+		}
+		xferbuf->allocated = size;
 	}
 	xferbuf->len = len;
 
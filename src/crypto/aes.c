@@ -803,4 +803,5 @@ CBC_CIPHER ( aes_cbc, aes_cbc_algorithm,
 
 /* AES in Galois/Counter mode */
 GCM_CIPHER ( aes_gcm, aes_gcm_algorithm,
-	     aes_algorithm, struct aes_context, AES_BLOCKSIZE );
+	     aes_algorithm, struct aes_context, AES_BLOCKSIZE,
+	     gcm_multiply_key );
@@ -50,6 +50,14 @@ static struct profiler bigint_mod_multiply_rescale_profiler __profiler =
 static struct profiler bigint_mod_multiply_subtract_profiler __profiler =
 	{ .name = "bigint_mod_multiply.subtract" };
 
+/** Modular exponentiation overall profiler */
+static struct profiler bigint_mod_exp_profiler __profiler =
+	{ .name = "bigint_mod_exp" };
+
+/** Modular exponentiation Montgomery setup profiler */
+static struct profiler bigint_mod_exp_setup_profiler __profiler =
+	{ .name = "bigint_mod_exp.setup" };
+
 /**
  * Perform modular multiplication of big integers
  *
@@ -119,6 +127,87 @@ void bigint_mod_multiply_raw ( const bigint_element_t *multiplicand0,
 	profile_stop ( &bigint_mod_multiply_profiler );
 }
 
+/**
+ * Calculate Montgomery reduction constant
+ *
+ * @v modulus		Element 0 of (odd) modulus
+ * @ret inverse		Negated inverse of modulus element 0
+ *
+ * Calculates -N^{-1} mod 2^{w}, where w is the number of bits in a
+ * big integer element, using Newton-Raphson iteration.  Each
+ * iteration doubles the number of correct low-order bits.
+ */
+bigint_element_t bigint_montgomery_inverse_raw ( bigint_element_t modulus ) {
+	bigint_element_t inverse;
+	unsigned int bits;
+
+	/* Any odd N is its own inverse modulo 2^{3} */
+	inverse = modulus;
+	for ( bits = 3 ; bits < ( 8 * sizeof ( inverse ) ) ; bits *= 2 )
+		inverse *= ( 2 - ( modulus * inverse ) );
+
+	return ( -inverse );
+}
+
+/**
+ * Perform Montgomery multiplication of big integers
+ *
+ * @v multiplicand0	Element 0 of big integer to be multiplied
+ * @v multiplier0	Element 0 of big integer to be multiplied
+ * @v modulus0		Element 0 of big integer (odd) modulus
+ * @v inverse		Montgomery reduction constant
+ * @v result0		Element 0 of big integer to hold result
+ * @v size		Number of elements in all big integers
+ * @v tmp		Temporary working space (at least 2 * size + 1 elements)
+ *
+ * Calculates ( multiplicand * multiplier / R ) mod modulus, where
+ * R = 2^{size * w}, by interleaving each row of the multiplication
+ * with the addition of the multiple of the modulus that clears the
+ * lowest element.  The multiplier must be less than the modulus.
+ * The result may overlap either input.
+ */
+void bigint_montgomery_raw ( const bigint_element_t *multiplicand0,
+			     const bigint_element_t *multiplier0,
+			     const bigint_element_t *modulus0,
+			     bigint_element_t inverse,
+			     bigint_element_t *result0,
+			     unsigned int size, bigint_element_t *tmp ) {
+	bigint_element_t *window;
+	bigint_element_t multiple;
+	bigint_element_t carry;
+	unsigned int i;
+
+	/* Zero accumulator */
+	memset ( tmp, 0, ( ( ( 2 * size ) + 1 ) * sizeof ( tmp[0] ) ) );
+
+	/* Accumulate one row at a time, sliding the accumulator
+	 * window up by one element for each row.
+	 */
+	for ( i = 0 ; i < size ; i++ ) {
+		window = &tmp[i];
+
+		/* Add multiplicand * multiplier[i] */
+		carry = bigint_multiply_accumulate_raw ( multiplicand0,
+							 multiplier0[i],
+							 window, size );
+		window[size] += carry;
+		window[ size + 1 ] += ( window[size] < carry );
+
+		/* Add multiple of modulus that clears lowest element */
+		multiple = ( window[0] * inverse );
+		carry = bigint_multiply_accumulate_raw ( modulus0, multiple,
+							 window, size );
+		window[size] += carry;
+		window[ size + 1 ] += ( window[size] < carry );
+	}
+
+	/* Result is now less than twice the modulus */
+	window = &tmp[size];
+	if ( window[size] || bigint_is_geq_raw ( window, modulus0, size ) )
+		bigint_subtract_raw ( modulus0, window, size );
+	memcpy ( result0, window, ( size * sizeof ( result0[0] ) ) );
+}
+
 /**
  * Perform modular exponentiation of big integers
  *
@@ -129,6 +218,11 @@ void bigint_mod_multiply_raw ( const bigint_element_t *multiplicand0,
  * @v size		Number of elements in base, modulus, and result
  * @v exponent_size	Number of elements in exponent
  * @v tmp		Temporary working space
+ *
+ * Odd moduli (as used by RSA and Diffie-Hellman) are handled using
+ * Montgomery multiplication with sliding window exponentiation.
+ * Even moduli fall back to square-and-multiply using the generic
+ * modular multiplication.
  */
 void bigint_mod_exp_raw ( const bigint_element_t *base0,
 			  const bigint_element_t *modulus0,
@@ -148,21 +242,173 @@ void bigint_mod_exp_raw ( const bigint_element_t *base0,
 	struct {
 		bigint_t ( size ) base;
 		bigint_t ( exponent_size ) exponent;
-		uint8_t mod_multiply[mod_multiply_len];
+		bigint_t ( size ) powers[BIGINT_MOD_EXP_MAX_POWERS];
+		union {
+			uint8_t mod_multiply[mod_multiply_len];
+			bigint_element_t montgomery[ ( 2 * size ) + 1 ];
+		} u;
 	} *temp = tmp;
 	static const uint8_t start[1] = { 0x01 };
+	bigint_element_t inverse;
+	unsigned int width = ( 8 * sizeof ( modulus->element[0] ) );
+	unsigned int shift;
+	unsigned int bits;
+	unsigned int window;
+	unsigned int powers;
+	unsigned int value;
+	unsigned int i;
+	int bit;
+	int low;
+	int first;
 
-	memcpy ( &temp->base, base, sizeof ( temp->base ) );
-	memcpy ( &temp->exponent, exponent, sizeof ( temp->exponent ) );
-	bigint_init ( result, start, sizeof ( start ) );
+	/* Sanity check */
+	assert ( sizeof ( *temp ) == bigint_mod_exp_tmp_len ( modulus,
+							      exponent ) );
 
-	while ( ! bigint_is_zero ( &temp->exponent ) ) {
-		if ( bigint_bit_is_set ( &temp->exponent, 0 ) ) {
-			bigint_mod_multiply ( result, &temp->base, modulus,
-					      result, temp->mod_multiply );
+	/* Use square-and-multiply for even moduli */
+	if ( ! ( modulus->element[0] & 1 ) ) {
+		memcpy ( &temp->base, base, sizeof ( temp->base ) );
+		memcpy ( &temp->exponent, exponent, sizeof ( temp->exponent ) );
+		bigint_init ( result, start, sizeof ( start ) );
+		while ( ! bigint_is_zero ( &temp->exponent ) ) {
+			if ( bigint_bit_is_set ( &temp->exponent, 0 ) ) {
+				bigint_mod_multiply ( result, &temp->base,
+						      modulus, result,
+						      temp->u.mod_multiply );
+			}
+			bigint_ror ( &temp->exponent );
+			bigint_mod_multiply ( &temp->base, &temp->base,
+					      modulus, &temp->base,
+					      temp->u.mod_multiply );
 		}
-		bigint_ror ( &temp->exponent );
-		bigint_mod_multiply ( &temp->base, &temp->base, modulus,
-				      &temp->base, temp->mod_multiply );
+		return;
+	}
+
+	/* Handle zero exponent */
+	bits = bigint_max_set_bit ( exponent );
+	if ( ! bits ) {
+		bigint_init ( result, start, sizeof ( start ) );
+		return;
+	}
+
+	/* Start profiling */
+	profile_start ( &bigint_mod_exp_profiler );
+
+	/* Calculate R^2 mod N, where R = 2^{size * w}.  Write
+	 * ( size * w ) as ( shift * 2^{k} ).  Calculate R * 2^{shift}
+	 * mod N using generic modular multiplication (which is cheap
+	 * since the product is only slightly larger than the modulus),
+	 * then square k times in Montgomery form to obtain
+	 * R * 2^{shift * 2^{k}} = R^2 mod N.
+	 */
+	profile_start ( &bigint_mod_exp_setup_profiler );
+	inverse = bigint_montgomery_inverse ( modulus );
+	for ( shift = ( size * width ) ; ! ( shift & 1 ) ; shift >>= 1 ) {}
+	memset ( result, 0, sizeof ( *result ) );
+	result->element[ size - 1 ] =
+		( ( ( bigint_element_t ) 1 ) << ( width - 1 ) );
+	memset ( &temp->base, 0, sizeof ( temp->base ) );
+	temp->base.element[ ( shift + 1 ) / width ] =
+		( ( ( bigint_element_t ) 1 ) << ( ( shift + 1 ) % width ) );
+	bigint_mod_multiply ( result, &temp->base, modulus, &temp->base,
+			      temp->u.mod_multiply );
+	for ( i = shift ; i < ( size * width ) ; i <<= 1 ) {
+		bigint_montgomery_raw ( temp->base.element, temp->base.element,
+					modulus->element, inverse,
+					temp->base.element, size,
+					temp->u.montgomery );
+	}
+
+	/* Choose window size based on exponent length */
+	if ( bits > 239 ) {
+		window = 5;
+	} else if ( bits > 79 ) {
+		window = 4;
+	} else if ( bits > 23 ) {
+		window = 3;
+	} else {
+		window = 1;
+	}
+	powers = ( 1 << ( window - 1 ) );
+	assert ( powers <= BIGINT_MOD_EXP_MAX_POWERS );
+
+	/* Precompute odd powers of base in Montgomery form */
+	bigint_montgomery_raw ( base->element, temp->base.element,
+				modulus->element, inverse,
+				temp->powers[0].element, size,
+				temp->u.montgomery );
+	if ( powers > 1 ) {
+		bigint_montgomery_raw ( temp->powers[0].element,
+					temp->powers[0].element,
+					modulus->element, inverse,
+					temp->base.element, size,
+					temp->u.montgomery );
+	}
+	for ( i = 1 ; i < powers ; i++ ) {
+		bigint_montgomery_raw ( temp->powers[ i - 1 ].element,
+					temp->base.element,
+					modulus->element, inverse,
+					temp->powers[i].element, size,
+					temp->u.montgomery );
 	}
+	profile_stop ( &bigint_mod_exp_setup_profiler );
+
+	/* Process exponent from the most significant bit downwards */
+	first = 1;
+	for ( bit = ( bits - 1 ) ; bit >= 0 ; bit = ( low - 1 ) ) {
+
+		/* Square for each zero bit */
+		if ( ! bigint_bit_is_set ( exponent, bit ) ) {
+			bigint_montgomery_raw ( result->element,
+						result->element,
+						modulus->element, inverse,
+						result->element, size,
+						temp->u.montgomery );
+			low = bit;
+			continue;
+		}
+
+		/* Find longest window ending in a set bit */
+		low = ( bit - ( int ) window + 1 );
+		if ( low < 0 )
+			low = 0;
+		while ( ! bigint_bit_is_set ( exponent, low ) )
+			low++;
+		value = 0;
+		for ( i = low ; i <= ( unsigned int ) bit ; i++ ) {
+			if ( bigint_bit_is_set ( exponent, i ) )
+				value |= ( 1 << ( i - low ) );
+		}
+
+		/* Square once per bit in the window, then multiply by
+		 * the corresponding odd power.
+		 */
+		if ( first ) {
+			memcpy ( result, &temp->powers[ value >> 1 ],
+				 sizeof ( *result ) );
+			first = 0;
+			continue;
+		}
+		for ( i = low ; i <= ( unsigned int ) bit ; i++ ) {
+			bigint_montgomery_raw ( result->element,
+						result->element,
+						modulus->element, inverse,
+						result->element, size,
+						temp->u.montgomery );
+		}
+		bigint_montgomery_raw ( result->element,
+					temp->powers[ value >> 1 ].element,
+					modulus->element, inverse,
+					result->element, size,
+					temp->u.montgomery );
+	}
+
+	/* Convert out of Montgomery form */
+	bigint_init ( &temp->base, start, sizeof ( start ) );
+	bigint_montgomery_raw ( result->element, temp->base.element,
+				modulus->element, inverse, result->element,
+				size, temp->u.montgomery );
+
+	/* Stop profiling */
+	profile_stop ( &bigint_mod_exp_profiler );
 }
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Hardware-accelerated cipher algorithms
+ *
+ */
+
+#include <string.h>
+#include <ipxe/crypto.h>
+
+/**
+ * Find hardware-accelerated version of a cipher algorithm
+ *
+ * @v cipher		Generic cipher algorithm
+ * @ret cipher		Accelerated cipher algorithm, or generic algorithm
+ *
+ * The returned algorithm may have a different context size from the
+ * generic algorithm, and so must be selected before any context is
+ * allocated.
+ */
+struct cipher_algorithm *
+cipher_accelerated ( struct cipher_algorithm *cipher ) {
+	struct cipher_accelerator *accel;
+	int rc;
+
+	/* Use first usable accelerated algorithm, if any */
+	for_each_table_entry ( accel, CIPHER_ACCELERATORS ) {
+		if ( accel->generic != cipher )
+			continue;
+		if ( ( rc = accel->probe() ) != 0 ) {
+			DBGC ( cipher, "CRYPTO %s cannot use %s: %s\n",
+			       cipher->name, accel->cipher->name,
+			       strerror ( rc ) );
+			continue;
+		}
+		DBGC ( cipher, "CRYPTO %s using %s\n",
+		       cipher->name, accel->cipher->name );
+		return accel->cipher;
+	}
+
+	return cipher;
+}
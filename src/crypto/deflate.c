@@ -28,6 +28,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <errno.h>
 #include <assert.h>
 #include <ctype.h>
+#include <byteswap.h>
 #include <ipxe/uaccess.h>
 #include <ipxe/deflate.h>
 
@@ -296,6 +297,161 @@ static int deflate_alphabet ( struct deflate *deflate,
 	return 0;
 }
 
+/**
+ * Reverse Huffman-coded symbol
+ *
+ * @v huf		Huffman-coded symbol
+ * @v bits		Length of Huffman-coded symbol (in bits)
+ * @ret index		Bit-reversed symbol
+ */
+static unsigned int deflate_fast_reverse ( unsigned int huf,
+					   unsigned int bits ) {
+
+	return ( ( ( deflate_reverse[ huf & 0xff ] << 8 ) |
+		   deflate_reverse[ huf >> 8 ] ) >> ( 16 - bits ) );
+}
+
+/**
+ * Translate raw symbol to fast lookup table entry
+ *
+ * @v deflate		Decompressor
+ * @v alphabet		Huffman alphabet
+ * @v raw		Raw symbol
+ * @v bits		Number of bits consumed
+ * @v fast		Fast lookup table entry to fill in
+ *
+ * Literal/length and distance symbols are translated into literal
+ * bytes and base lengths or distances, so that the fast path never
+ * needs to consult the raw symbol tables.
+ */
+static void deflate_fast_symbol ( struct deflate *deflate,
+				  struct deflate_alphabet *alphabet,
+				  unsigned int raw, unsigned int bits,
+				  struct deflate_fast *fast ) {
+	unsigned int extra;
+
+	/* Translate raw symbol */
+	fast->bits = bits;
+	if ( alphabet == &deflate->distance_codelen ) {
+		extra = ( raw / 2 );
+		if ( extra )
+			extra--;
+		fast->value = deflate_distance_base[raw];
+		fast->op = ( DEFLATE_FAST_BASE | extra );
+	} else if ( raw < DEFLATE_LITLEN_END ) {
+		fast->value = raw;
+		fast->op = DEFLATE_FAST_LITERAL;
+	} else if ( raw == DEFLATE_LITLEN_END ) {
+		fast->value = 0;
+		fast->op = DEFLATE_FAST_END;
+	} else if ( ( raw - DEFLATE_LITLEN_END - 1 ) < 28 ) {
+		raw -= ( DEFLATE_LITLEN_END + 1 );
+		extra = ( raw / 4 );
+		if ( extra )
+			extra--;
+		fast->value = deflate_litlen_base[raw];
+		fast->op = ( DEFLATE_FAST_BASE | extra );
+	} else {
+		fast->value = 258;
+		fast->op = DEFLATE_FAST_BASE;
+	}
+}
+
+/**
+ * Construct fast lookup table
+ *
+ * @v deflate		Decompressor
+ * @v alphabet		Huffman alphabet
+ * @v table		Fast lookup table
+ * @v max		Maximum number of entries in fast lookup table
+ * @v root		Primary table index length (in bits)
+ * @ret rc		Return status code
+ *
+ * The primary table is indexed directly by the next @c root bits of
+ * input data.  Symbols longer than this are found via a link to a
+ * subtable, which is sized to fit the longest symbol sharing that
+ * prefix.  The alphabet must already have been verified as complete.
+ */
+static int deflate_fast_table ( struct deflate *deflate,
+				struct deflate_alphabet *alphabet,
+				struct deflate_fast *table, unsigned int max,
+				unsigned int root ) {
+	struct deflate_huf_symbols *huf_sym;
+	struct deflate_fast *link;
+	struct deflate_fast fast;
+	unsigned int used = ( 1 << root );
+	unsigned int bits;
+	unsigned int huf;
+	unsigned int index;
+	unsigned int tail;
+	unsigned int sub;
+	unsigned int i;
+
+	/* Populate primary table and record subtable sizes.  Symbols
+	 * are processed in order of increasing length, so the final
+	 * recorded size for each subtable will be the largest
+	 * required.
+	 */
+	for ( bits = 1 ; bits <= DEFLATE_HUFFMAN_BITS ; bits++ ) {
+		huf_sym = &alphabet->huf[ bits - 1 ];
+		huf = ( huf_sym->start >> huf_sym->shift );
+		for ( i = 0 ; i < huf_sym->freq ; i++, huf++ ) {
+			if ( bits <= root ) {
+				deflate_fast_symbol ( deflate, alphabet,
+						      huf_sym->raw[huf], bits,
+						      &fast );
+				for ( index = deflate_fast_reverse ( huf, bits);
+				      index < ( 1U << root ) ;
+				      index += ( 1 << bits ) ) {
+					table[index] = fast;
+				}
+			} else {
+				tail = ( bits - root );
+				index = deflate_fast_reverse ( ( huf >> tail ),
+							       root );
+				link = &table[index];
+				link->bits = root;
+				link->op = ( DEFLATE_FAST_LINK | tail );
+			}
+		}
+	}
+
+	/* Allocate subtables */
+	for ( index = 0 ; index < ( 1U << root ) ; index++ ) {
+		link = &table[index];
+		if ( ! ( link->op & DEFLATE_FAST_LINK ) )
+			continue;
+		link->value = used;
+		used += ( 1 << ( link->op & DEFLATE_FAST_BITS_MASK ) );
+		if ( used > max ) {
+			DBGC ( alphabet, "DEFLATE %p \"%s\" is too large for "
+			       "fast lookup\n", deflate,
+			       deflate_alphabet_name ( deflate, alphabet ) );
+			return -ENOSPC;
+		}
+	}
+
+	/* Populate subtables */
+	for ( bits = ( root + 1 ) ; bits <= DEFLATE_HUFFMAN_BITS ; bits++ ) {
+		huf_sym = &alphabet->huf[ bits - 1 ];
+		huf = ( huf_sym->start >> huf_sym->shift );
+		tail = ( bits - root );
+		for ( i = 0 ; i < huf_sym->freq ; i++, huf++ ) {
+			deflate_fast_symbol ( deflate, alphabet,
+					      huf_sym->raw[huf], tail, &fast );
+			index = deflate_fast_reverse ( ( huf >> tail ), root );
+			link = &table[index];
+			sub = ( link->op & DEFLATE_FAST_BITS_MASK );
+			for ( index = deflate_fast_reverse ( huf, tail ) ;
+			      index < ( 1U << sub ) ; index += ( 1 << tail ) ) {
+				table[ link->value + index ] = fast;
+			}
+		}
+	}
+
+	return 0;
+}
+
 /**
  * Attempt to accumulate bits from input stream
  *
@@ -471,6 +627,220 @@ static void deflate_copy ( struct deflate_chunk *out,
 	out->offset += len;
 }
 
+/**
+ * Decode a Huffman-coded symbol using a fast lookup table
+ *
+ * @v table		Fast lookup table
+ * @v root		Primary table index length (in bits)
+ * @v accumulator	Accumulator
+ * @v bits		Number of bits within the accumulator
+ * @ret fast		Fast lookup table entry
+ *
+ * The caller must ensure that the accumulator holds at least @c
+ * DEFLATE_HUFFMAN_BITS bits.
+ */
+static inline __attribute__ (( always_inline )) const struct deflate_fast *
+deflate_fast_decode ( const struct deflate_fast *table, unsigned int root,
+		      uint64_t *accumulator, unsigned int *bits ) {
+	const struct deflate_fast *fast;
+	unsigned int sub;
+
+	/* Look up primary table entry */
+	fast = &table[ *accumulator & ( ( 1 << root ) - 1 ) ];
+
+	/* Follow link to subtable, if applicable */
+	if ( fast->op & DEFLATE_FAST_LINK ) {
+		*accumulator >>= fast->bits;
+		*bits -= fast->bits;
+		sub = ( fast->op & DEFLATE_FAST_BITS_MASK );
+		fast = &table[ fast->value +
+			       ( *accumulator & ( ( 1 << sub ) - 1 ) ) ];
+	}
+
+	/* Consume bits */
+	*accumulator >>= fast->bits;
+	*bits -= fast->bits;
+
+	return fast;
+}
+
+/**
+ * Copy duplicate string within output buffer
+ *
+ * @v dst		Destination
+ * @v distance		Distance to duplicated string
+ * @v len		Length of duplicated string
+ *
+ * The destination buffer must have space for up to seven bytes
+ * beyond the end of the duplicated string.
+ */
+static inline __attribute__ (( always_inline )) void
+deflate_fast_copy ( uint8_t *dst, size_t distance, size_t len ) {
+	const uint8_t *src = ( dst - distance );
+	uint8_t *end = ( dst + len );
+	uint64_t word;
+
+	/* Copy a word at a time, unless the overlap is too close */
+	if ( distance >= sizeof ( word ) ) {
+		do {
+			memcpy ( &word, src, sizeof ( word ) );
+			memcpy ( dst, &word, sizeof ( word ) );
+			src += sizeof ( word );
+			dst += sizeof ( word );
+		} while ( dst < end );
+	} else {
+		while ( dst < end )
+			*(dst++) = *(src++);
+	}
+}
+
+/**
+ * Inflate Huffman-coded data using fast lookup tables
+ *
+ * @v deflate		Decompressor
+ * @v in		Compressed input data
+ * @v out		Output data buffer
+ * @ret rc		Return status code, or positive at end of block
+ *
+ * Symbols are decoded for as long as the remaining input data and
+ * output buffer space are large enough to hold any complete
+ * literal/length and distance pair.  Any remaining symbols are left
+ * for the (slower, but resumable) state machine to decode.
+ */
+static int deflate_inflate_fast ( struct deflate *deflate,
+				  struct deflate_chunk *in,
+				  struct deflate_chunk *out ) {
+	const struct deflate_fast *fast;
+	const uint8_t *in_data;
+	const uint8_t *first;
+	const uint8_t *data;
+	const uint8_t *end;
+	uint8_t *out_data;
+	size_t out_offset = out->offset;
+	size_t dup_len;
+	size_t dup_distance;
+	size_t unused;
+	uint64_t accumulator;
+	uint64_t word;
+	unsigned int bits;
+	unsigned int extra;
+	unsigned int i;
+	int writable;
+	int rc = 0;
+
+	/* Do nothing unless fast lookup tables and sufficient input
+	 * data are available.
+	 */
+	if ( ( ! deflate->fast ) ||
+	     ( ( in->len - in->offset ) < sizeof ( word ) ) ) {
+		return 0;
+	}
+
+	/* Initialise state */
+	in_data = user_to_virt ( in->data, 0 );
+	first = data = ( in_data + in->offset );
+	end = ( in_data + in->len );
+	out_data = user_to_virt ( out->data, 0 );
+	accumulator = deflate->accumulator;
+	bits = deflate->bits;
+
+	/* Decode symbols */
+	while ( ( end - data ) >= ( ( int ) sizeof ( word ) ) ) {
+
+		/* Stop unless there is space for the longest possible
+		 * duplicate string (or no space at all, in which case
+		 * we are merely calculating the output length).
+		 */
+		writable = ( ( out_offset + DEFLATE_FAST_OUT_SLACK ) <=
+			     out->len );
+		if ( ( ! writable ) && ( out_offset < out->len ) )
+			break;
+
+		/* Refill accumulator with as many whole bytes as will
+		 * fit, leaving between 56 and 63 accumulated bits.
+		 */
+		if ( bits < 56 ) {
+			memcpy ( &word, data, sizeof ( word ) );
+			accumulator |= ( le64_to_cpu ( word ) << bits );
+			data += ( ( 63 - bits ) / 8 );
+			bits |= 56;
+		}
+
+		/* Decode literal/length symbol */
+		fast = deflate_fast_decode ( deflate->litlen_fast,
+					     DEFLATE_FAST_LITLEN_BITS,
+					     &accumulator, &bits );
+
+		/* Handle literals and end of block */
+		if ( fast->op == DEFLATE_FAST_LITERAL ) {
+			if ( writable )
+				out_data[out_offset] = fast->value;
+			out_offset++;
+			continue;
+		} else if ( fast->op == DEFLATE_FAST_END ) {
+			rc = 1;
+			break;
+		}
+
+		/* Extract length extra bits */
+		extra = ( fast->op & DEFLATE_FAST_BITS_MASK );
+		dup_len = ( fast->value +
+			    ( accumulator & ( ( 1 << extra ) - 1 ) ) );
+		accumulator >>= extra;
+		bits -= extra;
+
+		/* Decode distance symbol and extract extra bits */
+		fast = deflate_fast_decode ( deflate->distance_fast,
+					     DEFLATE_FAST_DISTANCE_BITS,
+					     &accumulator, &bits );
+		extra = ( fast->op & DEFLATE_FAST_BITS_MASK );
+		dup_distance = ( fast->value +
+				 ( accumulator & ( ( 1 << extra ) - 1 ) ) );
+		accumulator >>= extra;
+		bits -= extra;
+
+		/* Sanity check */
+		if ( dup_distance > out_offset ) {
+			DBGC ( deflate, "DEFLATE %p bad distance %zd (max "
+			       "%zd)\n", deflate, dup_distance, out_offset );
+			return -EINVAL;
+		}
+
+		/* Copy data, allowing for overlap */
+		if ( writable ) {
+			deflate_fast_copy ( ( out_data + out_offset ),
+					    dup_distance, dup_len );
+		}
+		out_offset += dup_len;
+	}
+
+	/* Return any unused whole bytes to the input data.  The
+	 * accumulator may have held bits from a previous input chunk
+	 * on entry, so we cannot return more bytes than we read.
+	 */
+	unused = ( bits / 8 );
+	if ( unused > ( ( size_t ) ( data - first ) ) )
+		unused = ( data - first );
+	data -= unused;
+	bits -= ( 8 * unused );
+	assert ( bits <= ( 8 * sizeof ( deflate->accumulator ) ) );
+	accumulator &= ( ( 1ULL << bits ) - 1 );
+
+	/* Update state */
+	in->offset = ( data - in_data );
+	out->offset = out_offset;
+	deflate->accumulator = accumulator;
+	deflate->rotalumucca = 0;
+	for ( i = 0 ; i < bits ; i += 8 ) {
+		deflate->rotalumucca |=
+			( deflate_reverse[ ( accumulator >> i ) & 0xff ] <<
+			  ( 24 - i ) );
+	}
+	deflate->bits = bits;
+
+	return rc;
+}
+
 /**
  * Inflate compressed data
  *
@@ -818,6 +1188,20 @@ int deflate_inflate ( struct deflate *deflate,
 					       distance_count,
 					       distance_offset ) ) != 0 )
 			return rc;
+
+		/* Construct fast lookup tables, if possible */
+		rc = deflate_fast_table ( deflate, &deflate->litlen,
+					  deflate->litlen_fast,
+					  DEFLATE_FAST_LITLEN_MAX,
+					  DEFLATE_FAST_LITLEN_BITS );
+		if ( rc == 0 ) {
+			rc = deflate_fast_table ( deflate,
+						  &deflate->distance_codelen,
+						  deflate->distance_fast,
+						  DEFLATE_FAST_DISTANCE_MAX,
+						  DEFLATE_FAST_DISTANCE_BITS );
+		}
+		deflate->fast = ( rc == 0 );
 	}
 
  lzhuf_litlen: {
@@ -825,6 +1209,14 @@ int deflate_inflate ( struct deflate *deflate,
 		uint8_t byte;
 		unsigned int extra;
 		unsigned int bits;
+		int rc;
+
+		/* Decode as much as possible via the fast path */
+		rc = deflate_inflate_fast ( deflate, in, out );
+		if ( rc < 0 )
+			return rc;
+		if ( rc > 0 )
+			goto block_done;
 
 		/* Decode Huffman codes */
 		while ( 1 ) {
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Hardware-accelerated digest algorithms
+ *
+ */
+
+#include <string.h>
+#include <ipxe/crypto.h>
+
+/**
+ * Find best digest block function implementation
+ *
+ * @v digest		Generic digest algorithm
+ * @ret accel		Digest block function implementation, or NULL
+ */
+struct digest_accelerator *
+digest_accelerated ( struct digest_algorithm *digest ) {
+	struct digest_accelerator *accel;
+	int rc;
+
+	/* Use first usable implementation */
+	for_each_table_entry ( accel, DIGEST_ACCELERATORS ) {
+		if ( accel->generic != digest )
+			continue;
+		if ( accel->probe && ( ( rc = accel->probe() ) != 0 ) ) {
+			DBGC ( digest, "CRYPTO %s cannot use %s: %s\n",
+			       digest->name, accel->name, strerror ( rc ) );
+			continue;
+		}
+		DBGC ( digest, "CRYPTO %s using %s\n",
+		       digest->name, accel->name );
+		return accel;
+	}
+
+	return NULL;
+}
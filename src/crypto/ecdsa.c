@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Elliptic Curve Digital Signature Algorithm (ECDSA)
+ *
+ * ECDSA is documented in FIPS 186-4 section 6 and (for use within
+ * X.509 certificates) in RFC 5480.  Only signature verification is
+ * supported.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/asn1.h>
+#include <ipxe/crypto.h>
+#include <ipxe/bigint.h>
+#include <ipxe/weierstrass.h>
+#include <ipxe/ecdsa.h>
+
+/* Disambiguate the various error causes */
+#define EACCES_VERIFY \
+	__einfo_error ( EINFO_EACCES_VERIFY )
+#define EINFO_EACCES_VERIFY \
+	__einfo_uniqify ( EINFO_EACCES, 0x01, "ECDSA signature incorrect" )
+
+/**
+ * Parse ECDSA public key
+ *
+ * @v context		ECDSA context
+ * @v raw		ASN.1 cursor
+ * @ret point		Raw public key curve point
+ * @ret rc		Return status code
+ */
+static int ecdsa_parse_key ( struct ecdsa_context *context,
+			     const struct asn1_cursor *raw,
+			     const uint8_t **point ) {
+	struct asn1_algorithm *algorithm;
+	struct asn1_bit_string bits;
+	struct asn1_cursor cursor;
+	struct asn1_cursor params;
+	int rc;
+
+	/* Enter subjectPublicKeyInfo */
+	memcpy ( &cursor, raw, sizeof ( cursor ) );
+	asn1_enter ( &cursor, ASN1_SEQUENCE );
+
+	/* Identify named curve from algorithm parameters */
+	memcpy ( &params, &cursor, sizeof ( params ) );
+	asn1_enter ( &params, ASN1_SEQUENCE );
+	asn1_skip ( &params, ASN1_OID );
+	if ( ( rc = asn1_curve_algorithm ( &params, &algorithm ) ) != 0 )
+		return rc;
+	context->curve = algorithm->curve;
+
+	/* Skip algorithm */
+	asn1_skip ( &cursor, ASN1_SEQUENCE );
+
+	/* Enter subjectPublicKey */
+	if ( ( rc = asn1_integral_bit_string ( &cursor, &bits ) ) != 0 )
+		return rc;
+
+	/* Check for an uncompressed point of the correct length */
+	*point = bits.data;
+	if ( ( bits.len != ( 1 + context->curve->pointsize ) ) ||
+	     ( **point != WEIERSTRASS_UNCOMPRESSED ) ) {
+		DBGC ( context, "ECDSA %p unsupported %s public key:\n",
+		       context, context->curve->name );
+		DBGC_HDA ( context, 0, bits.data, bits.len );
+		return -ENOTSUP;
+	}
+	(*point)++;
+
+	return 0;
+}
+
+/**
+ * Initialise ECDSA public key
+ *
+ * @v ctx		ECDSA context
+ * @v key		Key
+ * @v key_len		Length of key
+ * @ret rc		Return status code
+ */
+static int ecdsa_init ( void *ctx, const void *key, size_t key_len ) {
+	struct ecdsa_context *context = ctx;
+	struct asn1_cursor cursor;
+	const uint8_t *point;
+	int rc;
+
+	/* Initialise context */
+	memset ( context, 0, sizeof ( *context ) );
+
+	/* Initialise cursor */
+	cursor.data = key;
+	cursor.len = key_len;
+
+	/* Parse public key */
+	if ( ( rc = ecdsa_parse_key ( context, &cursor, &point ) ) != 0 ) {
+		DBGC ( context, "ECDSA %p invalid public key:\n", context );
+		DBGC_HDA ( context, 0, cursor.data, cursor.len );
+		goto err_parse;
+	}
+	DBGC ( context, "ECDSA %p %s public key:\n",
+	       context, context->curve->name );
+	DBGC_HDA ( context, 0, point, context->curve->pointsize );
+
+	/* Record public key */
+	context->public = malloc ( context->curve->pointsize );
+	if ( ! context->public ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	memcpy ( context->public, point, context->curve->pointsize );
+
+	return 0;
+
+ err_alloc:
+ err_parse:
+	return rc;
+}
+
+/**
+ * Calculate ECDSA maximum output length
+ *
+ * @v ctx		ECDSA context
+ * @ret max_len		Maximum output length
+ */
+static size_t ecdsa_max_len ( void *ctx __unused ) {
+
+	/* Encryption and signing are not supported */
+	return 0;
+}
+
+/**
+ * Encrypt using ECDSA
+ *
+ * @v ctx		ECDSA context
+ * @v plaintext		Plaintext
+ * @v plaintext_len	Length of plaintext
+ * @v ciphertext	Ciphertext
+ * @ret ciphertext_len	Length of ciphertext, or negative error
+ */
+static int ecdsa_encrypt ( void *ctx __unused, const void *plaintext __unused,
+			   size_t plaintext_len __unused,
+			   void *ciphertext __unused ) {
+
+	/* ECDSA is a signature-only algorithm */
+	return -ENOTSUP;
+}
+
+/**
+ * Decrypt using ECDSA
+ *
+ * @v ctx		ECDSA context
+ * @v ciphertext	Ciphertext
+ * @v ciphertext_len	Ciphertext length
+ * @v plaintext		Plaintext
+ * @ret plaintext_len	Plaintext length, or negative error
+ */
+static int ecdsa_decrypt ( void *ctx __unused, const void *ciphertext __unused,
+			   size_t ciphertext_len __unused,
+			   void *plaintext __unused ) {
+
+	/* ECDSA is a signature-only algorithm */
+	return -ENOTSUP;
+}
+
+/**
+ * Sign digest value using ECDSA
+ *
+ * @v ctx		ECDSA context
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @v signature		Signature
+ * @ret signature_len	Signature length, or negative error
+ */
+static int ecdsa_sign ( void *ctx __unused,
+			struct digest_algorithm *digest __unused,
+			const void *value __unused, void *signature __unused ) {
+
+	/* Private keys are not supported */
+	return -ENOTSUP;
+}
+
+/**
+ * Parse ECDSA signature integer
+ *
+ * @v context		ECDSA context
+ * @v cursor		ASN.1 cursor
+ * @v integer0		Element 0 of big integer to fill in
+ * @ret rc		Return status code
+ */
+static int ecdsa_parse_integer ( struct ecdsa_context *context,
+				 const struct asn1_cursor *cursor,
+				 bigint_element_t *integer0 ) {
+	size_t len = context->curve->keysize;
+	unsigned int size = bigint_required_size ( len );
+	bigint_t ( size ) __attribute__ (( may_alias )) *integer =
+		( ( void * ) integer0 );
+	bigint_t ( size ) order;
+	struct asn1_cursor contents;
+
+	/* Enter integer */
+	memcpy ( &contents, cursor, sizeof ( contents ) );
+	asn1_enter ( &contents, ASN1_INTEGER );
+
+	/* Skip initial sign byte if applicable */
+	if ( ( contents.len > 1 ) &&
+	     ( *( ( uint8_t * ) contents.data ) == 0x00 ) ) {
+		contents.data++;
+		contents.len--;
+	}
+
+	/* Fail if cursor or integer are invalid */
+	if ( ( contents.len == 0 ) || ( contents.len > len ) )
+		return -EINVAL;
+
+	/* Construct integer and check that 1 <= integer < n */
+	bigint_init ( integer, contents.data, contents.len );
+	bigint_init ( &order, context->curve->order, len );
+	if ( bigint_is_zero ( integer ) || bigint_is_geq ( integer, &order ) )
+		return -EINVAL;
+
+	return 0;
+}
+
+/**
+ * Verify signed digest value using ECDSA
+ *
+ * @v ctx		ECDSA context
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @v signature		Signature
+ * @v signature_len	Signature length
+ * @ret rc		Return status code
+ */
+static int ecdsa_verify ( void *ctx, struct digest_algorithm *digest,
+			  const void *value, const void *signature,
+			  size_t signature_len ) {
+	struct ecdsa_context *context = ctx;
+	struct elliptic_curve *curve = context->curve;
+	size_t len = curve->keysize;
+	size_t pointsize = curve->pointsize;
+	unsigned int size = bigint_required_size ( len );
+	struct {
+		bigint_t ( size ) order;
+		bigint_t ( size ) exponent;
+		bigint_t ( size ) two;
+		bigint_t ( size ) r;
+		bigint_t ( size ) s;
+		bigint_t ( size ) e;
+		bigint_t ( size ) w;
+		bigint_t ( size ) u1;
+		bigint_t ( size ) u2;
+		bigint_t ( size ) x;
+	} values;
+	size_t tmp_len = bigint_mod_exp_tmp_len ( &values.order,
+						  &values.exponent );
+	uint8_t tmp[tmp_len];
+	uint8_t u1[len];
+	uint8_t u2[len];
+	uint8_t point1[pointsize];
+	uint8_t point2[pointsize];
+	static const uint8_t two_raw[] = { 2 };
+	struct asn1_cursor cursor;
+	size_t value_len;
+	int rc;
+
+	DBGC ( context, "ECDSA %p verifying %s digest:\n",
+	       context, digest->name );
+	DBGC_HDA ( context, 0, value, digest->digestsize );
+	DBGC_HDA ( context, 0, signature, signature_len );
+
+	/* Parse signature */
+	cursor.data = signature;
+	cursor.len = signature_len;
+	asn1_enter ( &cursor, ASN1_SEQUENCE );
+	if ( ( rc = ecdsa_parse_integer ( context, &cursor,
+					  values.r.element ) ) != 0 )
+		goto err_signature;
+	asn1_skip_any ( &cursor );
+	if ( ( rc = ecdsa_parse_integer ( context, &cursor,
+					  values.s.element ) ) != 0 )
+		goto err_signature;
+
+	/* Construct e from the leftmost bits of the digest value (with
+	 * all supported curves having a whole number of bytes in the
+	 * group order).
+	 */
+	bigint_init ( &values.order, curve->order, len );
+	value_len = digest->digestsize;
+	if ( value_len > len )
+		value_len = len;
+	bigint_init ( &values.e, value, value_len );
+	if ( bigint_is_geq ( &values.e, &values.order ) )
+		bigint_subtract ( &values.order, &values.e );
+
+	/* Calculate w = s^-1 = s^(n-2) mod n */
+	bigint_init ( &values.two, two_raw, sizeof ( two_raw ) );
+	memcpy ( &values.exponent, &values.order, sizeof ( values.exponent ) );
+	bigint_subtract ( &values.two, &values.exponent );
+	bigint_mod_exp ( &values.s, &values.order, &values.exponent,
+			 &values.w, tmp );
+
+	/* Calculate u1 = e * w mod n and u2 = r * w mod n */
+	bigint_mod_multiply ( &values.e, &values.w, &values.order,
+			      &values.u1, tmp );
+	bigint_mod_multiply ( &values.r, &values.w, &values.order,
+			      &values.u2, tmp );
+	bigint_done ( &values.u1, u1, sizeof ( u1 ) );
+	bigint_done ( &values.u2, u2, sizeof ( u2 ) );
+
+	/* Calculate (x,y) = u1 * G + u2 * Q */
+	if ( ( rc = elliptic_multiply ( curve, curve->base, u1,
+					point1 ) ) != 0 )
+		goto err_multiply;
+	if ( ( rc = elliptic_multiply ( curve, context->public, u2,
+					point2 ) ) != 0 )
+		goto err_multiply;
+	if ( ( rc = elliptic_add ( curve, point1, point2, point1 ) ) != 0 )
+		goto err_add;
+
+	/* Check that x mod n = r */
+	bigint_init ( &values.x, point1, len );
+	if ( bigint_is_geq ( &values.x, &values.order ) )
+		bigint_subtract ( &values.order, &values.x );
+	if ( memcmp ( &values.x, &values.r, sizeof ( values.x ) ) != 0 ) {
+		DBGC ( context, "ECDSA %p signature verification failed\n",
+		       context );
+		return -EACCES_VERIFY;
+	}
+
+	DBGC ( context, "ECDSA %p signature verified successfully\n",
+	       context );
+	return 0;
+
+ err_add:
+ err_multiply:
+	DBGC ( context, "ECDSA %p could not calculate curve point: %s\n",
+	       context, strerror ( rc ) );
+	return -EACCES_VERIFY;
+ err_signature:
+	DBGC ( context, "ECDSA %p invalid signature\n", context );
+	return rc;
+}
+
+/**
+ * Finalise ECDSA public key
+ *
+ * @v ctx		ECDSA context
+ */
+static void ecdsa_final ( void *ctx ) {
+	struct ecdsa_context *context = ctx;
+
+	free ( context->public );
+	context->public = NULL;
+}
+
+/**
+ * Check for matching ECDSA public/private key pair
+ *
+ * @v private_key	Private key
+ * @v private_key_len	Private key length
+ * @v public_key	Public key
+ * @v public_key_len	Public key length
+ * @ret rc		Return status code
+ */
+static int ecdsa_match ( const void *private_key __unused,
+			 size_t private_key_len __unused,
+			 const void *public_key __unused,
+			 size_t public_key_len __unused ) {
+
+	/* Private keys are not supported */
+	return -ENOTSUP;
+}
+
+/** ECDSA public-key algorithm */
+struct pubkey_algorithm ecdsa_algorithm = {
+	.name		= "ecdsa",
+	.ctxsize	= ECDSA_CTX_SIZE,
+	.init		= ecdsa_init,
+	.max_len	= ecdsa_max_len,
+	.encrypt	= ecdsa_encrypt,
+	.decrypt	= ecdsa_decrypt,
+	.sign		= ecdsa_sign,
+	.verify		= ecdsa_verify,
+	.final		= ecdsa_final,
+	.match		= ecdsa_match,
+};
+
+/* Drag in objects via ecdsa_algorithm */
+REQUIRING_SYMBOL ( ecdsa_algorithm );
+
+/* Drag in crypto configuration */
+REQUIRE_OBJECT ( config_crypto );
@@ -152,11 +152,27 @@ gcm_count ( union gcm_block *ctr, uint32_t delta ) {
  */
 static inline void gcm_xor ( const void *src1, const void *src2, void *dst,
 			     size_t len ) {
+	const union gcm_block *src1_block = src1;
+	const union gcm_block *src2_block = src2;
+	union gcm_block *dst_block = dst;
 	uint8_t *dst_bytes = dst;
 	const uint8_t *src1_bytes = src1;
 	const uint8_t *src2_bytes = src2;
 
-	/* XOR one byte at a time */
+	/* XOR whole dwords for a complete block */
+	if ( len == sizeof ( *dst_block ) ) {
+		dst_block->dword[0] = ( src1_block->dword[0] ^
+					src2_block->dword[0] );
+		dst_block->dword[1] = ( src1_block->dword[1] ^
+					src2_block->dword[1] );
+		dst_block->dword[2] = ( src1_block->dword[2] ^
+					src2_block->dword[2] );
+		dst_block->dword[3] = ( src1_block->dword[3] ^
+					src2_block->dword[3] );
+		return;
+	}
+
+	/* Otherwise, XOR one byte at a time */
 	while ( len-- )
 		*(dst_bytes++) = ( *(src1_bytes++) ^ *(src2_bytes++) );
 }
@@ -283,8 +299,7 @@ static void gcm_multiply_x_8 ( union gcm_block *poly ) {
  * @v key		Hash key
  * @v poly		Multiplicand and result
  */
-static void gcm_multiply_key ( const union gcm_block *key,
-			       union gcm_block *poly ) {
+void gcm_multiply_key ( const union gcm_block *key, union gcm_block *poly ) {
 	union gcm_block res;
 	uint8_t *byte;
 
@@ -368,7 +383,7 @@ static void gcm_process ( struct gcm_context *context, const void *src,
 		}
 
 		/* Update hash */
-		gcm_multiply_key ( &context->key, &context->hash );
+		context->multiply ( &context->key, &context->hash );
 		DBGC2 ( context, "GCM %p X[%d]:\n", context, block );
 		DBGC2_HDA ( context, 0, &context->hash,
 			    sizeof ( context->hash ) );
@@ -391,7 +406,7 @@ static void gcm_hash ( struct gcm_context *context, union gcm_block *hash ) {
 
 	/* Update hash */
 	gcm_xor_block ( &context->hash, hash );
-	gcm_multiply_key ( &context->key, hash );
+	context->multiply ( &context->key, hash );
 	DBGC2 ( context, "GCM %p GHASH(H,A,C):\n", context );
 	DBGC2_HDA ( context, 0, hash, sizeof ( *hash ) );
 }
@@ -431,14 +446,18 @@ void gcm_tag ( struct gcm_context *context, union gcm_block *tag ) {
  * @v key		Key
  * @v keylen		Key length
  * @v raw_cipher	Underlying cipher
+ * @v multiply		Hash key multiplication method
  * @ret rc		Return status code
  */
 int gcm_setkey ( struct gcm_context *context, const void *key, size_t keylen,
-		 struct cipher_algorithm *raw_cipher ) {
+		 struct cipher_algorithm *raw_cipher,
+		 void ( * multiply ) ( const union gcm_block *key,
+				       union gcm_block *poly ) ) {
 	int rc;
 
 	/* Initialise GCM context */
 	memset ( context, 0, sizeof ( *context ) );
+	context->multiply = multiply;
 	context->raw_cipher = raw_cipher;
 
 	/* Set underlying block cipher key */
@@ -455,8 +474,9 @@ int gcm_setkey ( struct gcm_context *context, const void *key, size_t keylen,
 	/* Reset counter */
 	context->ctr.ctr.value = cpu_to_be32 ( 1 );
 
-	/* Construct cached tables */
-	gcm_cache ( &context->key );
+	/* Construct cached tables, if applicable */
+	if ( multiply == gcm_multiply_key )
+		gcm_cache ( &context->key );
 
 	return 0;
 }
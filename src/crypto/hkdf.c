@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/**
+ * @file
+ *
+ * HMAC-based Extract-and-Expand Key Derivation Function (HKDF)
+ *
+ * This is the key derivation function defined in RFC 5869, as used
+ * by the TLS 1.3 key schedule.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <ipxe/crypto.h>
+#include <ipxe/hmac.h>
+#include <ipxe/hkdf.h>
+
+/**
+ * Extract pseudorandom key
+ *
+ * @v digest		Digest algorithm
+ * @v salt		Salt (or NULL for a zero-filled salt)
+ * @v salt_len		Length of salt
+ * @v ikm		Input keying material
+ * @v ikm_len		Length of input keying material
+ * @v prk		Pseudorandom key to fill in
+ *
+ * The pseudorandom key will have the length of the digest output.
+ */
+void hkdf_extract ( struct digest_algorithm *digest, const void *salt,
+		    size_t salt_len, const void *ikm, size_t ikm_len,
+		    void *prk ) {
+	uint8_t ctx[ hmac_ctxsize ( digest ) ];
+
+	/* An absent salt is equivalent to a zero-filled salt of the
+	 * digest output length, which HMAC would in any case pad with
+	 * zeros to the digest block size.
+	 */
+	if ( ! salt )
+		salt_len = 0;
+
+	/* PRK = HMAC-Hash ( salt, IKM ) */
+	hmac_init ( digest, ctx, salt, salt_len );
+	hmac_update ( digest, ctx, ikm, ikm_len );
+	hmac_final ( digest, ctx, prk );
+}
+
+/**
+ * Expand pseudorandom key
+ *
+ * @v digest		Digest algorithm
+ * @v prk		Pseudorandom key
+ * @v prk_len		Length of pseudorandom key
+ * @v info		Context and application specific information
+ * @v info_len		Length of information
+ * @v out		Output keying material to fill in
+ * @v len		Length of output keying material
+ */
+void hkdf_expand ( struct digest_algorithm *digest, const void *prk,
+		   size_t prk_len, const void *info, size_t info_len,
+		   void *out, size_t len ) {
+	uint8_t ctx[ hmac_ctxsize ( digest ) ];
+	uint8_t t[digest->digestsize];
+	uint8_t counter = 0;
+	size_t frag_len;
+
+	/* Sanity check */
+	assert ( len <= ( 255 * sizeof ( t ) ) );
+
+	/* T(n) = HMAC-Hash ( PRK, T(n-1) | info | n ) */
+	while ( len ) {
+		hmac_init ( digest, ctx, prk, prk_len );
+		if ( counter )
+			hmac_update ( digest, ctx, t, sizeof ( t ) );
+		hmac_update ( digest, ctx, info, info_len );
+		counter++;
+		hmac_update ( digest, ctx, &counter, sizeof ( counter ) );
+		hmac_final ( digest, ctx, t );
+		frag_len = len;
+		if ( frag_len > sizeof ( t ) )
+			frag_len = sizeof ( t );
+		memcpy ( out, t, frag_len );
+		out += frag_len;
+		len -= frag_len;
+	}
+
+	/* Erase intermediate output */
+	memset ( t, 0, sizeof ( t ) );
+}
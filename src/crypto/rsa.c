@@ -28,6 +28,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdarg.h>
 #include <string.h>
 #include <errno.h>
+#include <byteswap.h>
 #include <ipxe/asn1.h>
 #include <ipxe/crypto.h>
 #include <ipxe/bigint.h>
@@ -560,6 +561,231 @@ static int rsa_verify ( void *ctx, struct digest_algorithm *digest,
 	return 0;
 }
 
+/**
+ * Calculate RSA-PSS encoded message length in bits
+ *
+ * @v context		RSA context
+ * @ret bits		Encoded message length in bits
+ */
+static unsigned int rsa_pss_bits ( struct rsa_context *context ) {
+	bigint_t ( context->size ) *modulus = ( ( void * ) context->modulus0 );
+
+	return ( bigint_max_set_bit ( modulus ) - 1 );
+}
+
+/**
+ * Apply RSA-PSS mask generation function (MGF1)
+ *
+ * @v digest		Digest algorithm
+ * @v seed		Seed (of digest output length)
+ * @v data		Data to be masked
+ * @v len		Length of data
+ */
+static void rsa_pss_mask ( struct digest_algorithm *digest, const void *seed,
+			   void *data, size_t len ) {
+	uint8_t ctx[digest->ctxsize];
+	uint8_t mask[digest->digestsize];
+	uint8_t *bytes = data;
+	uint32_t counter = 0;
+	uint32_t counter_be;
+	size_t frag_len;
+	unsigned int i;
+
+	while ( len ) {
+		counter_be = htonl ( counter++ );
+		digest_init ( digest, ctx );
+		digest_update ( digest, ctx, seed, digest->digestsize );
+		digest_update ( digest, ctx, &counter_be,
+				sizeof ( counter_be ) );
+		digest_final ( digest, ctx, mask );
+		frag_len = len;
+		if ( frag_len > sizeof ( mask ) )
+			frag_len = sizeof ( mask );
+		for ( i = 0 ; i < frag_len ; i++ )
+			bytes[i] ^= mask[i];
+		bytes += frag_len;
+		len -= frag_len;
+	}
+}
+
+/**
+ * Calculate RSA-PSS message hash
+ *
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @v salt		Salt (of digest output length)
+ * @v hash		Message hash to fill in
+ */
+static void rsa_pss_hash ( struct digest_algorithm *digest, const void *value,
+			   const void *salt, void *hash ) {
+	static const uint8_t zero[8];
+	uint8_t ctx[digest->ctxsize];
+
+	digest_init ( digest, ctx );
+	digest_update ( digest, ctx, zero, sizeof ( zero ) );
+	digest_update ( digest, ctx, value, digest->digestsize );
+	digest_update ( digest, ctx, salt, digest->digestsize );
+	digest_final ( digest, ctx, hash );
+}
+
+/**
+ * Sign digest value using RSA-PSS
+ *
+ * @v ctx		RSA context
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @v signature		Signature
+ * @ret signature_len	Signature length, or negative error
+ *
+ * The salt length and the mask generation function digest are both
+ * taken from the message digest algorithm, as required by TLS.
+ */
+static int rsa_pss_sign ( void *ctx, struct digest_algorithm *digest,
+			  const void *value, void *signature ) {
+	struct rsa_context *context = ctx;
+	size_t digest_len = digest->digestsize;
+	unsigned int bits = rsa_pss_bits ( context );
+	size_t em_len = ( ( bits + 7 ) / 8 );
+	size_t db_len = ( em_len - digest_len - 1 );
+	uint8_t *encoded;
+	uint8_t *em;
+	uint8_t *salt;
+	uint8_t *hash;
+	int rc;
+
+	/* Sanity check */
+	if ( em_len < ( ( 2 * digest_len ) + 2 ) ) {
+		DBGC ( context, "RSA %p modulus too short for PSS %s\n",
+		       context, digest->name );
+		return -ERANGE;
+	}
+	DBGC ( context, "RSA %p PSS signing %s digest:\n",
+	       context, digest->name );
+	DBGC_HDA ( context, 0, value, digest_len );
+
+	/* Construct encoded message (using the big integer output
+	 * buffer as temporary storage)
+	 */
+	encoded = ( ( void * ) context->output0 );
+	em = ( encoded + context->max_len - em_len );
+	salt = ( em + db_len - digest_len );
+	hash = ( em + db_len );
+	memset ( encoded, 0, ( salt - encoded - 1 ) );
+	salt[-1] = 0x01;
+	if ( ( rc = get_random_nz ( salt, digest_len ) ) != 0 ) {
+		DBGC ( context, "RSA %p could not generate salt: %s\n",
+		       context, strerror ( rc ) );
+		return rc;
+	}
+	rsa_pss_hash ( digest, value, salt, hash );
+	rsa_pss_mask ( digest, hash, em, db_len );
+	em[0] &= ( 0xff >> ( ( 8 * em_len ) - bits ) );
+	em[ em_len - 1 ] = 0xbc;
+	DBGC ( context, "RSA %p PSS encoded %s digest:\n",
+	       context, digest->name );
+	DBGC_HDA ( context, 0, encoded, context->max_len );
+
+	/* Encipher the encoded message */
+	rsa_cipher ( context, encoded, signature );
+	DBGC ( context, "RSA %p PSS signed %s digest:\n",
+	       context, digest->name );
+	DBGC_HDA ( context, 0, signature, context->max_len );
+
+	return context->max_len;
+}
+
+/**
+ * Verify signed digest value using RSA-PSS
+ *
+ * @v ctx		RSA context
+ * @v digest		Digest algorithm
+ * @v value		Digest value
+ * @v signature		Signature
+ * @v signature_len	Signature length
+ * @ret rc		Return status code
+ */
+static int rsa_pss_verify ( void *ctx, struct digest_algorithm *digest,
+			    const void *value, const void *signature,
+			    size_t signature_len ) {
+	struct rsa_context *context = ctx;
+	size_t digest_len = digest->digestsize;
+	unsigned int bits = rsa_pss_bits ( context );
+	size_t em_len = ( ( bits + 7 ) / 8 );
+	size_t db_len = ( em_len - digest_len - 1 );
+	uint8_t top = ( 0xff >> ( ( 8 * em_len ) - bits ) );
+	uint8_t *encoded;
+	uint8_t *em;
+	uint8_t *salt;
+	uint8_t *hash;
+	uint8_t *expected;
+	uint8_t *tmp;
+
+	/* Sanity checks */
+	if ( signature_len != context->max_len ) {
+		DBGC ( context, "RSA %p signature incorrect length (%zd "
+		       "bytes, should be %zd)\n",
+		       context, signature_len, context->max_len );
+		return -ERANGE;
+	}
+	if ( em_len < ( ( 2 * digest_len ) + 2 ) ) {
+		DBGC ( context, "RSA %p modulus too short for PSS %s\n",
+		       context, digest->name );
+		return -ERANGE;
+	}
+	DBGC ( context, "RSA %p PSS verifying %s digest:\n",
+	       context, digest->name );
+	DBGC_HDA ( context, 0, value, digest_len );
+	DBGC_HDA ( context, 0, signature, signature_len );
+
+	/* Decipher the signature (using the big integer input buffer
+	 * as temporary storage)
+	 */
+	encoded = ( ( void * ) context->input0 );
+	rsa_cipher ( context, signature, encoded );
+	DBGC ( context, "RSA %p deciphered signature:\n", context );
+	DBGC_HDA ( context, 0, encoded, context->max_len );
+
+	/* Check fixed portions of the encoded message */
+	em = ( encoded + context->max_len - em_len );
+	salt = ( em + db_len - digest_len );
+	hash = ( em + db_len );
+	for ( tmp = encoded ; tmp < em ; tmp++ ) {
+		if ( *tmp )
+			goto invalid;
+	}
+	if ( ( em[ em_len - 1 ] != 0xbc ) || ( em[0] & ~top ) )
+		goto invalid;
+
+	/* Unmask data block and check padding */
+	rsa_pss_mask ( digest, hash, em, db_len );
+	em[0] &= top;
+	for ( tmp = em ; tmp < ( salt - 1 ) ; tmp++ ) {
+		if ( *tmp )
+			goto invalid;
+	}
+	if ( salt[-1] != 0x01 )
+		goto invalid;
+
+	/* Recalculate message hash (using the big integer output
+	 * buffer as temporary storage)
+	 */
+	expected = ( ( void * ) context->output0 );
+	rsa_pss_hash ( digest, value, salt, expected );
+
+	/* Verify the signature */
+	if ( memcmp ( expected, hash, digest_len ) != 0 )
+		goto invalid;
+
+	DBGC ( context, "RSA %p PSS signature verified successfully\n",
+	       context );
+	return 0;
+
+ invalid:
+	DBGC ( context, "RSA %p PSS signature verification failed\n",
+	       context );
+	return -EACCES_VERIFY;
+}
+
 /**
  * Finalise RSA cipher
  *
@@ -625,6 +851,20 @@ struct pubkey_algorithm rsa_algorithm = {
 	.match		= rsa_match,
 };
 
+/** RSA public-key algorithm using RSA-PSS signatures */
+struct pubkey_algorithm rsa_pss_algorithm = {
+	.name		= "rsa-pss",
+	.ctxsize	= RSA_CTX_SIZE,
+	.init		= rsa_init,
+	.max_len	= rsa_max_len,
+	.encrypt	= rsa_encrypt,
+	.decrypt	= rsa_decrypt,
+	.sign		= rsa_pss_sign,
+	.verify		= rsa_pss_verify,
+	.final		= rsa_final,
+	.match		= rsa_match,
+};
+
 /* Drag in objects via rsa_algorithm */
 REQUIRING_SYMBOL ( rsa_algorithm );
 
@@ -105,6 +105,9 @@ static struct sha1_step sha1_steps[4] = {
 	{ .f = sha1_f_20_39_60_79,	.k = 0xca62c1d6 },
 };
 
+/** SHA-1 block function implementation in use */
+static struct digest_accelerator *sha1_accel;
+
 /**
  * Initialise SHA-1 algorithm
  *
@@ -113,6 +116,10 @@ static struct sha1_step sha1_steps[4] = {
 static void sha1_init ( void *ctx ) {
 	struct sha1_context *context = ctx;
 
+	/* Select block function implementation, if not already done */
+	if ( ! sha1_accel )
+		sha1_accel = digest_accelerated ( &sha1_algorithm );
+
 	context->ddd.dd.digest.h[0] = cpu_to_be32 ( 0x67452301 );
 	context->ddd.dd.digest.h[1] = cpu_to_be32 ( 0xefcdab89 );
 	context->ddd.dd.digest.h[2] = cpu_to_be32 ( 0x98badcfe );
@@ -122,11 +129,14 @@ static void sha1_init ( void *ctx ) {
 }
 
 /**
- * Calculate SHA-1 digest of accumulated data
+ * Digest SHA-1 data blocks
  *
- * @v context		SHA-1 context
+ * @v digest		Intermediate digest value
+ * @v data		Data blocks
+ * @v count		Number of data blocks
  */
-static void sha1_digest ( struct sha1_context *context ) {
+static void sha1_blocks ( void *digest, const void *data, size_t count ) {
+	struct sha1_digest *hash = digest;
         union {
 		union sha1_digest_data_dwords ddd;
 		struct sha1_variables v;
@@ -144,7 +154,6 @@ static void sha1_digest ( struct sha1_context *context ) {
 	unsigned int i;
 
 	/* Sanity checks */
-	assert ( ( context->len % sizeof ( context->ddd.dd.data ) ) == 0 );
 	linker_assert ( &u.ddd.dd.digest.h[0] == a, sha1_bad_layout );
 	linker_assert ( &u.ddd.dd.digest.h[1] == b, sha1_bad_layout );
 	linker_assert ( &u.ddd.dd.digest.h[2] == c, sha1_bad_layout );
@@ -152,50 +161,52 @@ static void sha1_digest ( struct sha1_context *context ) {
 	linker_assert ( &u.ddd.dd.digest.h[4] == e, sha1_bad_layout );
 	linker_assert ( &u.ddd.dd.data.dword[0] == w, sha1_bad_layout );
 
-	DBGC ( context, "SHA1 digesting:\n" );
-	DBGC_HDA ( context, 0, &context->ddd.dd.digest,
-		   sizeof ( context->ddd.dd.digest ) );
-	DBGC_HDA ( context, context->len, &context->ddd.dd.data,
-		   sizeof ( context->ddd.dd.data ) );
+	for ( ; count-- ; data += sizeof ( u.ddd.dd.data ) ) {
 
-	/* Convert h[0..4] to host-endian, and initialise a, b, c, d,
-	 * e, and w[0..15]
-	 */
-	for ( i = 0 ; i < ( sizeof ( u.ddd.dword ) /
-			    sizeof ( u.ddd.dword[0] ) ) ; i++ ) {
-		be32_to_cpus ( &context->ddd.dword[i] );
-		u.ddd.dword[i] = context->ddd.dword[i];
-	}
+		DBGC ( hash, "SHA1 digesting:\n" );
+		DBGC_HDA ( hash, 0, hash, sizeof ( *hash ) );
+		DBGC_HDA ( hash, 0, data, sizeof ( u.ddd.dd.data ) );
 
-	/* Initialise w[16..79] */
-	for ( i = 16 ; i < 80 ; i++ )
-		w[i] = rol32 ( ( w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16] ), 1 );
-
-	/* Main loop */
-	for ( i = 0 ; i < 80 ; i++ ) {
-		step = &sha1_steps[ i / 20 ];
-		f = step->f ( &u.v );
-		k = step->k;
-		temp = ( rol32 ( *a, 5 ) + f + *e + k + w[i] );
-		*e = *d;
-		*d = *c;
-		*c = rol32 ( *b, 30 );
-		*b = *a;
-		*a = temp;
-		DBGC2 ( context, "%2d : %08x %08x %08x %08x %08x\n",
-			i, *a, *b, *c, *d, *e );
-	}
+		/* Initialise a, b, c, d, e, and w[0..15] in
+		 * host-endian order
+		 */
+		memcpy ( &u.ddd.dd.digest, hash, sizeof ( u.ddd.dd.digest ) );
+		memcpy ( &u.ddd.dd.data, data, sizeof ( u.ddd.dd.data ) );
+		for ( i = 0 ; i < ( sizeof ( u.ddd.dword ) /
+				    sizeof ( u.ddd.dword[0] ) ) ; i++ ) {
+			be32_to_cpus ( &u.ddd.dword[i] );
+		}
 
-	/* Add chunk to hash and convert back to big-endian */
-	for ( i = 0 ; i < 5 ; i++ ) {
-		context->ddd.dd.digest.h[i] =
-			cpu_to_be32 ( context->ddd.dd.digest.h[i] +
-				      u.ddd.dd.digest.h[i] );
-	}
+		/* Initialise w[16..79] */
+		for ( i = 16 ; i < 80 ; i++ ) {
+			w[i] = rol32 ( ( w[i-3] ^ w[i-8] ^ w[i-14] ^
+					 w[i-16] ), 1 );
+		}
 
-	DBGC ( context, "SHA1 digested:\n" );
-	DBGC_HDA ( context, 0, &context->ddd.dd.digest,
-		   sizeof ( context->ddd.dd.digest ) );
+		/* Main loop */
+		for ( i = 0 ; i < 80 ; i++ ) {
+			step = &sha1_steps[ i / 20 ];
+			f = step->f ( &u.v );
+			k = step->k;
+			temp = ( rol32 ( *a, 5 ) + f + *e + k + w[i] );
+			*e = *d;
+			*d = *c;
+			*c = rol32 ( *b, 30 );
+			*b = *a;
+			*a = temp;
+			DBGC2 ( hash, "%2d : %08x %08x %08x %08x %08x\n",
+				i, *a, *b, *c, *d, *e );
+		}
+
+		/* Add chunk to hash (in big-endian order) */
+		for ( i = 0 ; i < 5 ; i++ ) {
+			hash->h[i] = cpu_to_be32 ( be32_to_cpu ( hash->h[i] ) +
+						   u.ddd.dd.digest.h[i] );
+		}
+
+		DBGC ( hash, "SHA1 digested:\n" );
+		DBGC_HDA ( hash, 0, hash, sizeof ( *hash ) );
+	}
 }
 
 /**
@@ -207,18 +218,37 @@ static void sha1_digest ( struct sha1_context *context ) {
  */
 static void sha1_update ( void *ctx, const void *data, size_t len ) {
 	struct sha1_context *context = ctx;
+	struct digest_accelerator *accel = sha1_accel;
 	const uint8_t *byte = data;
+	size_t blocksize = sizeof ( context->ddd.dd.data );
 	size_t offset;
+	size_t frag_len;
 
-	/* Accumulate data a byte at a time, performing the digest
-	 * whenever we fill the data buffer
-	 */
-	while ( len-- ) {
-		offset = ( context->len % sizeof ( context->ddd.dd.data ) );
-		context->ddd.dd.data.byte[offset] = *(byte++);
-		context->len++;
-		if ( ( context->len % sizeof ( context->ddd.dd.data ) ) == 0 )
-			sha1_digest ( context );
+	while ( len ) {
+
+		/* Digest any complete blocks directly from the source
+		 * data, otherwise accumulate data in the data buffer
+		 * and digest it once full.
+		 */
+		offset = ( context->len % blocksize );
+		if ( ( offset == 0 ) && ( len >= blocksize ) ) {
+			frag_len = ( len - ( len % blocksize ) );
+			accel->blocks ( &context->ddd.dd.digest, byte,
+					( frag_len / blocksize ) );
+		} else {
+			frag_len = ( blocksize - offset );
+			if ( frag_len > len )
+				frag_len = len;
+			memcpy ( &context->ddd.dd.data.byte[offset], byte,
+				 frag_len );
+			if ( ( offset + frag_len ) == blocksize ) {
+				accel->blocks ( &context->ddd.dd.digest,
+						&context->ddd.dd.data, 1 );
+			}
+		}
+		context->len += frag_len;
+		byte += frag_len;
+		len -= frag_len;
 	}
 }
 
@@ -263,3 +293,10 @@ struct digest_algorithm sha1_algorithm = {
 	.update		= sha1_update,
 	.final		= sha1_final,
 };
+
+/** Generic SHA-1 block function */
+struct digest_accelerator sha1_generic __digest_generic = {
+	.name = "sha1",
+	.generic = &sha1_algorithm,
+	.blocks = sha1_blocks,
+};
@@ -54,7 +54,7 @@ struct sha256_variables {
 } __attribute__ (( packed ));
 
 /** SHA-256 constants */
-static const uint32_t k[SHA256_ROUNDS] = {
+const uint32_t sha256_k[SHA256_ROUNDS] = {
 	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
 	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
 	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
@@ -82,6 +82,9 @@ static const struct sha256_digest sha256_init_digest = {
 	},
 };
 
+/** SHA-256 block function implementation in use */
+static struct digest_accelerator *sha256_accel;
+
 /**
  * Initialise SHA-256 family algorithm
  *
@@ -93,6 +96,10 @@ void sha256_family_init ( struct sha256_context *context,
 			  const struct sha256_digest *init,
 			  size_t digestsize ) {
 
+	/* Select block function implementation, if not already done */
+	if ( ! sha256_accel )
+		sha256_accel = digest_accelerated ( &sha256_algorithm );
+
 	context->len = 0;
 	context->digestsize = digestsize;
 	memcpy ( &context->ddd.dd.digest, init,
@@ -112,11 +119,14 @@ static void sha256_init ( void *ctx ) {
 }
 
 /**
- * Calculate SHA-256 digest of accumulated data
+ * Digest SHA-256 data blocks
  *
- * @v context		SHA-256 context
+ * @v digest		Intermediate digest value
+ * @v data		Data blocks
+ * @v count		Number of data blocks
  */
-static void sha256_digest ( struct sha256_context *context ) {
+static void sha256_blocks ( void *digest, const void *data, size_t count ) {
+	struct sha256_digest *hash = digest;
         union {
 		union sha256_digest_data_dwords ddd;
 		struct sha256_variables v;
@@ -139,7 +149,6 @@ static void sha256_digest ( struct sha256_context *context ) {
 	unsigned int i;
 
 	/* Sanity checks */
-	assert ( ( context->len % sizeof ( context->ddd.dd.data ) ) == 0 );
 	linker_assert ( &u.ddd.dd.digest.h[0] == a, sha256_bad_layout );
 	linker_assert ( &u.ddd.dd.digest.h[1] == b, sha256_bad_layout );
 	linker_assert ( &u.ddd.dd.digest.h[2] == c, sha256_bad_layout );
@@ -150,60 +159,63 @@ static void sha256_digest ( struct sha256_context *context ) {
 	linker_assert ( &u.ddd.dd.digest.h[7] == h, sha256_bad_layout );
 	linker_assert ( &u.ddd.dd.data.dword[0] == w, sha256_bad_layout );
 
-	DBGC ( context, "SHA256 digesting:\n" );
-	DBGC_HDA ( context, 0, &context->ddd.dd.digest,
-		   sizeof ( context->ddd.dd.digest ) );
-	DBGC_HDA ( context, context->len, &context->ddd.dd.data,
-		   sizeof ( context->ddd.dd.data ) );
+	for ( ; count-- ; data += sizeof ( u.ddd.dd.data ) ) {
 
-	/* Convert h[0..7] to host-endian, and initialise a, b, c, d,
-	 * e, f, g, h, and w[0..15]
-	 */
-	for ( i = 0 ; i < ( sizeof ( u.ddd.dword ) /
-			    sizeof ( u.ddd.dword[0] ) ) ; i++ ) {
-		be32_to_cpus ( &context->ddd.dword[i] );
-		u.ddd.dword[i] = context->ddd.dword[i];
-	}
+		DBGC ( hash, "SHA256 digesting:\n" );
+		DBGC_HDA ( hash, 0, hash, sizeof ( *hash ) );
+		DBGC_HDA ( hash, 0, data, sizeof ( u.ddd.dd.data ) );
 
-	/* Initialise w[16..63] */
-	for ( i = 16 ; i < SHA256_ROUNDS ; i++ ) {
-		s0 = ( ror32 ( w[i-15], 7 ) ^ ror32 ( w[i-15], 18 ) ^
-		       ( w[i-15] >> 3 ) );
-		s1 = ( ror32 ( w[i-2], 17 ) ^ ror32 ( w[i-2], 19 ) ^
-		       ( w[i-2] >> 10 ) );
-		w[i] = ( w[i-16] + s0 + w[i-7] + s1 );
-	}
+		/* Initialise a, b, c, d, e, f, g, h, and w[0..15] in
+		 * host-endian order
+		 */
+		memcpy ( &u.ddd.dd.digest, hash, sizeof ( u.ddd.dd.digest ) );
+		memcpy ( &u.ddd.dd.data, data, sizeof ( u.ddd.dd.data ) );
+		for ( i = 0 ; i < ( sizeof ( u.ddd.dword ) /
+				    sizeof ( u.ddd.dword[0] ) ) ; i++ ) {
+			be32_to_cpus ( &u.ddd.dword[i] );
+		}
 
-	/* Main loop */
-	for ( i = 0 ; i < SHA256_ROUNDS ; i++ ) {
-		s0 = ( ror32 ( *a, 2 ) ^ ror32 ( *a, 13 ) ^ ror32 ( *a, 22 ) );
-		maj = ( ( *a & *b ) ^ ( *a & *c ) ^ ( *b & *c ) );
-		t2 = ( s0 + maj );
-		s1 = ( ror32 ( *e, 6 ) ^ ror32 ( *e, 11 ) ^ ror32 ( *e, 25 ) );
-		ch = ( ( *e & *f ) ^ ( (~*e) & *g ) );
-		t1 = ( *h + s1 + ch + k[i] + w[i] );
-		*h = *g;
-		*g = *f;
-		*f = *e;
-		*e = ( *d + t1 );
-		*d = *c;
-		*c = *b;
-		*b = *a;
-		*a = ( t1 + t2 );
-		DBGC2 ( context, "%2d : %08x %08x %08x %08x %08x %08x %08x "
-			"%08x\n", i, *a, *b, *c, *d, *e, *f, *g, *h );
-	}
+		/* Initialise w[16..63] */
+		for ( i = 16 ; i < SHA256_ROUNDS ; i++ ) {
+			s0 = ( ror32 ( w[i-15], 7 ) ^ ror32 ( w[i-15], 18 ) ^
+			       ( w[i-15] >> 3 ) );
+			s1 = ( ror32 ( w[i-2], 17 ) ^ ror32 ( w[i-2], 19 ) ^
+			       ( w[i-2] >> 10 ) );
+			w[i] = ( w[i-16] + s0 + w[i-7] + s1 );
+		}
 
-	/* Add chunk to hash and convert back to big-endian */
-	for ( i = 0 ; i < 8 ; i++ ) {
-		context->ddd.dd.digest.h[i] =
-			cpu_to_be32 ( context->ddd.dd.digest.h[i] +
-				      u.ddd.dd.digest.h[i] );
-	}
+		/* Main loop */
+		for ( i = 0 ; i < SHA256_ROUNDS ; i++ ) {
+			s0 = ( ror32 ( *a, 2 ) ^ ror32 ( *a, 13 ) ^
+			       ror32 ( *a, 22 ) );
+			maj = ( ( *a & *b ) ^ ( *a & *c ) ^ ( *b & *c ) );
+			t2 = ( s0 + maj );
+			s1 = ( ror32 ( *e, 6 ) ^ ror32 ( *e, 11 ) ^
+			       ror32 ( *e, 25 ) );
+			ch = ( ( *e & *f ) ^ ( (~*e) & *g ) );
+			t1 = ( *h + s1 + ch + sha256_k[i] + w[i] );
+			*h = *g;
+			*g = *f;
+			*f = *e;
+			*e = ( *d + t1 );
+			*d = *c;
+			*c = *b;
+			*b = *a;
+			*a = ( t1 + t2 );
+			DBGC2 ( hash, "%2d : %08x %08x %08x %08x %08x %08x "
+				"%08x %08x\n", i, *a, *b, *c, *d, *e, *f, *g,
+				*h );
+		}
+
+		/* Add chunk to hash (in big-endian order) */
+		for ( i = 0 ; i < 8 ; i++ ) {
+			hash->h[i] = cpu_to_be32 ( be32_to_cpu ( hash->h[i] ) +
+						   u.ddd.dd.digest.h[i] );
+		}
 
-	DBGC ( context, "SHA256 digested:\n" );
-	DBGC_HDA ( context, 0, &context->ddd.dd.digest,
-		   sizeof ( context->ddd.dd.digest ) );
+		DBGC ( hash, "SHA256 digested:\n" );
+		DBGC_HDA ( hash, 0, hash, sizeof ( *hash ) );
+	}
 }
 
 /**
@@ -215,18 +227,37 @@ static void sha256_digest ( struct sha256_context *context ) {
  */
 void sha256_update ( void *ctx, const void *data, size_t len ) {
 	struct sha256_context *context = ctx;
+	struct digest_accelerator *accel = sha256_accel;
 	const uint8_t *byte = data;
+	size_t blocksize = sizeof ( context->ddd.dd.data );
 	size_t offset;
+	size_t frag_len;
 
-	/* Accumulate data a byte at a time, performing the digest
-	 * whenever we fill the data buffer
-	 */
-	while ( len-- ) {
-		offset = ( context->len % sizeof ( context->ddd.dd.data ) );
-		context->ddd.dd.data.byte[offset] = *(byte++);
-		context->len++;
-		if ( ( context->len % sizeof ( context->ddd.dd.data ) ) == 0 )
-			sha256_digest ( context );
+	while ( len ) {
+
+		/* Digest any complete blocks directly from the source
+		 * data, otherwise accumulate data in the data buffer
+		 * and digest it once full.
+		 */
+		offset = ( context->len % blocksize );
+		if ( ( offset == 0 ) && ( len >= blocksize ) ) {
+			frag_len = ( len - ( len % blocksize ) );
+			accel->blocks ( &context->ddd.dd.digest, byte,
+					( frag_len / blocksize ) );
+		} else {
+			frag_len = ( blocksize - offset );
+			if ( frag_len > len )
+				frag_len = len;
+			memcpy ( &context->ddd.dd.data.byte[offset], byte,
+				 frag_len );
+			if ( ( offset + frag_len ) == blocksize ) {
+				accel->blocks ( &context->ddd.dd.digest,
+						&context->ddd.dd.data, 1 );
+			}
+		}
+		context->len += frag_len;
+		byte += frag_len;
+		len -= frag_len;
 	}
 }
 
@@ -270,3 +301,10 @@ struct digest_algorithm sha256_algorithm = {
 	.update		= sha256_update,
 	.final		= sha256_final,
 };
+
+/** Generic SHA-256 block function */
+struct digest_accelerator sha256_generic __digest_generic = {
+	.name = "sha256",
+	.generic = &sha256_algorithm,
+	.blocks = sha256_blocks,
+};
@@ -0,0 +1,575 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Weierstrass elliptic curves
+ *
+ * Points are held internally in projective coordinates (X:Y:Z) with
+ * each coordinate in Montgomery form, and are added using the
+ * complete addition formula for a = -3 given as algorithm 4 in
+ * "Complete addition formulas for prime order elliptic curves"
+ * (Renes, Costello and Batina, https://eprint.iacr.org/2015/1060).
+ * Since this formula requires no special cases for doubling or for
+ * the point at infinity, scalar multiplication can be performed
+ * using a Montgomery ladder with no secret-dependent branches.
+ *
+ * Points are represented externally as raw big-endian affine
+ * coordinates X||Y.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/bigint.h>
+#include <ipxe/crypto.h>
+#include <ipxe/weierstrass.h>
+
+/** Number of coordinates in a projective point */
+#define WEIERSTRASS_AXES 3
+
+/** Point addition registers */
+enum weierstrass_register {
+	WEIERSTRASS_X1 = 0,
+	WEIERSTRASS_Y1,
+	WEIERSTRASS_Z1,
+	WEIERSTRASS_X2,
+	WEIERSTRASS_Y2,
+	WEIERSTRASS_Z2,
+	WEIERSTRASS_X3,
+	WEIERSTRASS_Y3,
+	WEIERSTRASS_Z3,
+	WEIERSTRASS_T0,
+	WEIERSTRASS_T1,
+	WEIERSTRASS_T2,
+	WEIERSTRASS_T3,
+	WEIERSTRASS_T4,
+	WEIERSTRASS_B,
+	WEIERSTRASS_NUM_REGISTERS
+};
+
+/** Point addition field operations */
+enum weierstrass_opcode {
+	WEIERSTRASS_OP_ADD = 0,
+	WEIERSTRASS_OP_SUBTRACT,
+	WEIERSTRASS_OP_MULTIPLY,
+};
+
+/** A point addition step */
+struct weierstrass_step {
+	/** Field operation */
+	uint8_t opcode;
+	/** Destination register */
+	uint8_t dest;
+	/** Left operand register */
+	uint8_t left;
+	/** Right operand register */
+	uint8_t right;
+};
+
+/** Define a point addition step */
+#define WEIERSTRASS_STEP( _opcode, _dest, _left, _right ) {		\
+		.opcode = WEIERSTRASS_OP_ ## _opcode,			\
+		.dest = WEIERSTRASS_ ## _dest,				\
+		.left = WEIERSTRASS_ ## _left,				\
+		.right = WEIERSTRASS_ ## _right,			\
+	}
+
+/** Complete point addition formula for a = -3 (one step per line) */
+static const struct weierstrass_step weierstrass_add_steps[] = {
+	WEIERSTRASS_STEP ( MULTIPLY, T0, X1, X2 ),
+	WEIERSTRASS_STEP ( MULTIPLY, T1, Y1, Y2 ),
+	WEIERSTRASS_STEP ( MULTIPLY, T2, Z1, Z2 ),
+	WEIERSTRASS_STEP ( ADD, T3, X1, Y1 ),
+	WEIERSTRASS_STEP ( ADD, T4, X2, Y2 ),
+	WEIERSTRASS_STEP ( MULTIPLY, T3, T3, T4 ),
+	WEIERSTRASS_STEP ( ADD, T4, T0, T1 ),
+	WEIERSTRASS_STEP ( SUBTRACT, T3, T3, T4 ),
+	WEIERSTRASS_STEP ( ADD, T4, Y1, Z1 ),
+	WEIERSTRASS_STEP ( ADD, X3, Y2, Z2 ),
+	WEIERSTRASS_STEP ( MULTIPLY, T4, T4, X3 ),
+	WEIERSTRASS_STEP ( ADD, X3, T1, T2 ),
+	WEIERSTRASS_STEP ( SUBTRACT, T4, T4, X3 ),
+	WEIERSTRASS_STEP ( ADD, X3, X1, Z1 ),
+	WEIERSTRASS_STEP ( ADD, Y3, X2, Z2 ),
+	WEIERSTRASS_STEP ( MULTIPLY, X3, X3, Y3 ),
+	WEIERSTRASS_STEP ( ADD, Y3, T0, T2 ),
+	WEIERSTRASS_STEP ( SUBTRACT, Y3, X3, Y3 ),
+	WEIERSTRASS_STEP ( MULTIPLY, Z3, B, T2 ),
+	WEIERSTRASS_STEP ( SUBTRACT, X3, Y3, Z3 ),
+	WEIERSTRASS_STEP ( ADD, Z3, X3, X3 ),
+	WEIERSTRASS_STEP ( ADD, X3, X3, Z3 ),
+	WEIERSTRASS_STEP ( SUBTRACT, Z3, T1, X3 ),
+	WEIERSTRASS_STEP ( ADD, X3, T1, X3 ),
+	WEIERSTRASS_STEP ( MULTIPLY, Y3, B, Y3 ),
+	WEIERSTRASS_STEP ( ADD, T1, T2, T2 ),
+	WEIERSTRASS_STEP ( ADD, T2, T1, T2 ),
+	WEIERSTRASS_STEP ( SUBTRACT, Y3, Y3, T2 ),
+	WEIERSTRASS_STEP ( SUBTRACT, Y3, Y3, T0 ),
+	WEIERSTRASS_STEP ( ADD, T1, Y3, Y3 ),
+	WEIERSTRASS_STEP ( ADD, Y3, T1, Y3 ),
+	WEIERSTRASS_STEP ( ADD, T1, T0, T0 ),
+	WEIERSTRASS_STEP ( ADD, T0, T1, T0 ),
+	WEIERSTRASS_STEP ( SUBTRACT, T0, T0, T2 ),
+	WEIERSTRASS_STEP ( MULTIPLY, T1, T4, Y3 ),
+	WEIERSTRASS_STEP ( MULTIPLY, T2, T0, Y3 ),
+	WEIERSTRASS_STEP ( MULTIPLY, Y3, X3, Z3 ),
+	WEIERSTRASS_STEP ( ADD, Y3, Y3, T2 ),
+	WEIERSTRASS_STEP ( MULTIPLY, X3, T3, X3 ),
+	WEIERSTRASS_STEP ( SUBTRACT, X3, X3, T1 ),
+	WEIERSTRASS_STEP ( MULTIPLY, Z3, T4, Z3 ),
+	WEIERSTRASS_STEP ( MULTIPLY, T1, T3, T0 ),
+	WEIERSTRASS_STEP ( ADD, Z3, Z3, T1 ),
+};
+
+/**
+ * Add field elements
+ *
+ * @v curve		Weierstrass curve
+ * @v augend0		Element 0 of field element to add
+ * @v addend0		Element 0 of field element to add
+ * @v result0		Element 0 of field element to hold result
+ *
+ * The result may overlap either input.
+ */
+static void weierstrass_add_field ( struct weierstrass_curve *curve,
+				    const bigint_element_t *augend0,
+				    const bigint_element_t *addend0,
+				    bigint_element_t *result0 ) {
+	unsigned int size = curve->size;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *augend =
+		( ( const void * ) augend0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *addend =
+		( ( const void * ) addend0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *prime =
+		( ( const void * ) curve->prime );
+	bigint_t ( size ) __attribute__ (( may_alias )) *result =
+		( ( void * ) result0 );
+	bigint_t ( size ) sum;
+
+	/* Calculate sum (which cannot overflow) */
+	memcpy ( &sum, augend, sizeof ( sum ) );
+	bigint_add ( addend, &sum );
+
+	/* Reduce modulo the field prime */
+	if ( bigint_is_geq ( &sum, prime ) )
+		bigint_subtract ( prime, &sum );
+	memcpy ( result, &sum, sizeof ( *result ) );
+}
+
+/**
+ * Subtract field elements
+ *
+ * @v curve		Weierstrass curve
+ * @v minuend0		Element 0 of field element to subtract from
+ * @v subtrahend0	Element 0 of field element to subtract
+ * @v result0		Element 0 of field element to hold result
+ *
+ * The result may overlap either input.
+ */
+static void weierstrass_subtract_field ( struct weierstrass_curve *curve,
+					 const bigint_element_t *minuend0,
+					 const bigint_element_t *subtrahend0,
+					 bigint_element_t *result0 ) {
+	unsigned int size = curve->size;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *minuend =
+		( ( const void * ) minuend0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *subtrahend =
+		( ( const void * ) subtrahend0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *prime =
+		( ( const void * ) curve->prime );
+	bigint_t ( size ) __attribute__ (( may_alias )) *result =
+		( ( void * ) result0 );
+	bigint_t ( size ) difference;
+
+	/* Calculate difference plus prime (which cannot underflow) */
+	memcpy ( &difference, minuend, sizeof ( difference ) );
+	bigint_add ( prime, &difference );
+	bigint_subtract ( subtrahend, &difference );
+
+	/* Reduce modulo the field prime */
+	if ( bigint_is_geq ( &difference, prime ) )
+		bigint_subtract ( prime, &difference );
+	memcpy ( result, &difference, sizeof ( *result ) );
+}
+
+/**
+ * Multiply field elements
+ *
+ * @v curve		Weierstrass curve
+ * @v multiplicand0	Element 0 of field element to multiply
+ * @v multiplier0	Element 0 of field element to multiply
+ * @v result0		Element 0 of field element to hold result
+ *
+ * The inputs must be in Montgomery form, and the result will be in
+ * Montgomery form.  The result may overlap either input.
+ */
+static void weierstrass_multiply_field ( struct weierstrass_curve *curve,
+					 const bigint_element_t *multiplicand0,
+					 const bigint_element_t *multiplier0,
+					 bigint_element_t *result0 ) {
+	unsigned int size = curve->size;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *multiplicand =
+		( ( const void * ) multiplicand0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *multiplier =
+		( ( const void * ) multiplier0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *prime =
+		( ( const void * ) curve->prime );
+	bigint_t ( size ) __attribute__ (( may_alias )) *result =
+		( ( void * ) result0 );
+	bigint_t ( ( 2 * size ) + 1 ) tmp;
+
+	bigint_montgomery ( multiplicand, multiplier, prime, curve->inverse,
+			    result, tmp.element );
+}
+
+/**
+ * Initialise curve constants
+ *
+ * @v curve		Weierstrass curve
+ */
+static void weierstrass_init ( struct weierstrass_curve *curve ) {
+	unsigned int size = curve->size;
+	bigint_t ( size ) __attribute__ (( may_alias )) *prime =
+		( ( void * ) curve->prime );
+	bigint_t ( size ) __attribute__ (( may_alias )) *fermat =
+		( ( void * ) curve->fermat );
+	bigint_t ( size ) __attribute__ (( may_alias )) *square =
+		( ( void * ) curve->square );
+	bigint_t ( size ) __attribute__ (( may_alias )) *one =
+		( ( void * ) curve->one );
+	bigint_t ( size ) __attribute__ (( may_alias )) *b =
+		( ( void * ) curve->b );
+	static const uint8_t one_raw[] = { 1 };
+	static const uint8_t two_raw[] = { 2 };
+	bigint_t ( size ) two;
+	unsigned int bits;
+	unsigned int i;
+
+	/* Do nothing if constants have already been calculated */
+	if ( curve->inverse )
+		return;
+
+	/* Construct field prime and Fermat inversion exponent */
+	bigint_init ( prime, curve->prime_raw, curve->len );
+	bigint_init ( &two, two_raw, sizeof ( two_raw ) );
+	memcpy ( fermat, prime, sizeof ( *fermat ) );
+	bigint_subtract ( &two, fermat );
+
+	/* Calculate R mod p and R^2 mod p by repeated doubling */
+	bits = ( 8 * sizeof ( prime->element ) );
+	bigint_init ( one, one_raw, sizeof ( one_raw ) );
+	for ( i = 0 ; i < bits ; i++ )
+		weierstrass_add_field ( curve, one->element, one->element,
+					one->element );
+	memcpy ( square, one, sizeof ( *square ) );
+	for ( i = 0 ; i < bits ; i++ )
+		weierstrass_add_field ( curve, square->element,
+					square->element, square->element );
+
+	/* Calculate Montgomery reduction constant */
+	curve->inverse = bigint_montgomery_inverse ( prime );
+
+	/* Convert constant "b" to Montgomery form */
+	bigint_init ( b, curve->b_raw, curve->len );
+	weierstrass_multiply_field ( curve, b->element, square->element,
+				     b->element );
+
+	DBGC ( curve, "WEIERSTRASS %p initialised %zd-bit curve\n",
+	       curve, ( 8 * curve->len ) );
+}
+
+/**
+ * Parse raw curve point
+ *
+ * @v curve		Weierstrass curve
+ * @v raw		Raw affine point X||Y
+ * @v point0		Element 0 of projective point to fill in
+ * @ret rc		Return status code
+ */
+static int weierstrass_import ( struct weierstrass_curve *curve,
+				const void *raw, bigint_element_t *point0 ) {
+	unsigned int size = curve->size;
+	size_t len = curve->len;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *prime =
+		( ( const void * ) curve->prime );
+	bigint_t ( size ) __attribute__ (( may_alias )) *point =
+		( ( void * ) point0 );
+	bigint_t ( size ) lhs;
+	bigint_t ( size ) rhs;
+	const uint8_t *data = raw;
+	unsigned int i;
+
+	/* Parse affine coordinates and convert to Montgomery form */
+	for ( i = 0 ; i < 2 ; i++ ) {
+		bigint_init ( &point[i], ( data + ( i * len ) ), len );
+		if ( bigint_is_geq ( &point[i], prime ) ) {
+			DBGC ( curve, "WEIERSTRASS %p invalid coordinate:\n",
+			       curve );
+			DBGC_HDA ( curve, 0, raw, ( 2 * len ) );
+			return -EINVAL;
+		}
+		weierstrass_multiply_field ( curve, point[i].element,
+					     curve->square, point[i].element );
+	}
+	memcpy ( &point[2], curve->one, sizeof ( point[2] ) );
+
+	/* Check that point lies on the curve y^2 = x^3 - 3x + b */
+	weierstrass_multiply_field ( curve, point[1].element, point[1].element,
+				     lhs.element );
+	weierstrass_multiply_field ( curve, point[0].element, point[0].element,
+				     rhs.element );
+	for ( i = 0 ; i < 3 ; i++ ) {
+		weierstrass_subtract_field ( curve, rhs.element, curve->one,
+					     rhs.element );
+	}
+	weierstrass_multiply_field ( curve, rhs.element, point[0].element,
+				     rhs.element );
+	weierstrass_add_field ( curve, rhs.element, curve->b, rhs.element );
+	if ( memcmp ( &lhs, &rhs, sizeof ( lhs ) ) != 0 ) {
+		DBGC ( curve, "WEIERSTRASS %p point is not on curve:\n",
+		       curve );
+		DBGC_HDA ( curve, 0, raw, ( 2 * len ) );
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/**
+ * Construct raw curve point
+ *
+ * @v curve		Weierstrass curve
+ * @v point0		Element 0 of projective point
+ * @v raw		Raw affine point X||Y to fill in
+ * @ret rc		Return status code
+ */
+static int weierstrass_export ( struct weierstrass_curve *curve,
+				const bigint_element_t *point0, void *raw ) {
+	unsigned int size = curve->size;
+	size_t len = curve->len;
+	const bigint_t ( size ) __attribute__ (( may_alias )) *point =
+		( ( const void * ) point0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *fermat =
+		( ( const void * ) curve->fermat );
+	static const uint8_t one_raw[] = { 1 };
+	bigint_t ( size ) reciprocal;
+	bigint_t ( size ) coordinate;
+	bigint_t ( size ) one;
+	uint8_t *data = raw;
+	unsigned int i;
+	int bit;
+
+	/* Fail if point is the point at infinity */
+	if ( bigint_is_zero ( &point[2] ) ) {
+		DBGC ( curve, "WEIERSTRASS %p result is point at infinity\n",
+		       curve );
+		return -EINVAL;
+	}
+
+	/* Calculate Z^-1 = Z^(p-2) */
+	memcpy ( &reciprocal, curve->one, sizeof ( reciprocal ) );
+	for ( bit = ( bigint_max_set_bit ( fermat ) - 1 ) ; bit >= 0 ; bit-- ){
+		weierstrass_multiply_field ( curve, reciprocal.element,
+					     reciprocal.element,
+					     reciprocal.element );
+		if ( bigint_bit_is_set ( fermat, bit ) ) {
+			weierstrass_multiply_field ( curve, reciprocal.element,
+						     point[2].element,
+						     reciprocal.element );
+		}
+	}
+
+	/* Construct affine coordinates and convert from Montgomery form */
+	bigint_init ( &one, one_raw, sizeof ( one_raw ) );
+	for ( i = 0 ; i < 2 ; i++ ) {
+		weierstrass_multiply_field ( curve, point[i].element,
+					     reciprocal.element,
+					     coordinate.element );
+		weierstrass_multiply_field ( curve, coordinate.element,
+					     one.element, coordinate.element );
+		bigint_done ( &coordinate, ( data + ( i * len ) ), len );
+	}
+
+	return 0;
+}
+
+/**
+ * Add projective points
+ *
+ * @v curve		Weierstrass curve
+ * @v augend0		Element 0 of projective point to add
+ * @v addend0		Element 0 of projective point to add
+ * @v result0		Element 0 of projective point to hold result
+ *
+ * The result may overlap either input.
+ */
+static void weierstrass_add ( struct weierstrass_curve *curve,
+			      const bigint_element_t *augend0,
+			      const bigint_element_t *addend0,
+			      bigint_element_t *result0 ) {
+	unsigned int size = curve->size;
+	bigint_t ( size ) regs[WEIERSTRASS_NUM_REGISTERS];
+	size_t point_len = ( WEIERSTRASS_AXES * sizeof ( regs[0] ) );
+	const struct weierstrass_step *step;
+	bigint_element_t *dest;
+	bigint_element_t *left;
+	bigint_element_t *right;
+	unsigned int i;
+
+	/* Load registers */
+	memcpy ( &regs[WEIERSTRASS_X1], augend0, point_len );
+	memcpy ( &regs[WEIERSTRASS_X2], addend0, point_len );
+	memcpy ( &regs[WEIERSTRASS_B], curve->b, sizeof ( regs[0] ) );
+
+	/* Perform addition */
+	for ( i = 0 ; i < ( sizeof ( weierstrass_add_steps ) /
+			    sizeof ( weierstrass_add_steps[0] ) ) ; i++ ) {
+		step = &weierstrass_add_steps[i];
+		dest = regs[step->dest].element;
+		left = regs[step->left].element;
+		right = regs[step->right].element;
+		switch ( step->opcode ) {
+		case WEIERSTRASS_OP_ADD:
+			weierstrass_add_field ( curve, left, right, dest );
+			break;
+		case WEIERSTRASS_OP_SUBTRACT:
+			weierstrass_subtract_field ( curve, left, right, dest );
+			break;
+		default:
+			weierstrass_multiply_field ( curve, left, right, dest );
+			break;
+		}
+	}
+
+	/* Store result */
+	memcpy ( result0, &regs[WEIERSTRASS_X3], point_len );
+}
+
+/**
+ * Conditionally swap projective points
+ *
+ * @v curve		Weierstrass curve
+ * @v first0		Element 0 of first projective point
+ * @v second0		Element 0 of second projective point
+ * @v swap		Swap points
+ *
+ * The swap is performed in constant time.
+ */
+static void weierstrass_swap ( struct weierstrass_curve *curve,
+			       bigint_element_t *first0,
+			       bigint_element_t *second0,
+			       unsigned int swap ) {
+	bigint_element_t mask = -( ( bigint_element_t ) swap );
+	bigint_element_t diff;
+	unsigned int i;
+
+	for ( i = 0 ; i < ( WEIERSTRASS_AXES * curve->size ) ; i++ ) {
+		diff = ( ( first0[i] ^ second0[i] ) & mask );
+		first0[i] ^= diff;
+		second0[i] ^= diff;
+	}
+}
+
+/**
+ * Multiply curve point by scalar
+ *
+ * @v curve		Weierstrass curve
+ * @v base		Base point (raw affine X||Y)
+ * @v scalar		Scalar multiple (raw big-endian value)
+ * @v result		Result point (raw affine X||Y) to fill in
+ * @ret rc		Return status code
+ */
+int weierstrass_multiply ( struct weierstrass_curve *curve, const void *base,
+			   const void *scalar, void *result ) {
+	unsigned int size = curve->size;
+	size_t len = curve->len;
+	const uint8_t *bytes = scalar;
+	bigint_t ( size ) ladder[2][WEIERSTRASS_AXES];
+	unsigned int swap;
+	int bit;
+	int rc;
+
+	/* Calculate curve constants, if not already done */
+	weierstrass_init ( curve );
+
+	/* Initialise ladder with R0 = infinity (0:1:0) and R1 = base */
+	memset ( ladder[0], 0, sizeof ( ladder[0] ) );
+	memcpy ( &ladder[0][1], curve->one, sizeof ( ladder[0][1] ) );
+	if ( ( rc = weierstrass_import ( curve, base,
+					 ladder[1][0].element ) ) != 0 )
+		return rc;
+
+	/* Perform Montgomery ladder, most significant bit first */
+	for ( bit = ( ( 8 * len ) - 1 ) ; bit >= 0 ; bit-- ) {
+		swap = ( ( bytes[ len - 1 - ( bit / 8 ) ] >> ( bit % 8 ) ) & 1 );
+		weierstrass_swap ( curve, ladder[0][0].element,
+				   ladder[1][0].element, swap );
+		weierstrass_add ( curve, ladder[0][0].element,
+				  ladder[1][0].element, ladder[1][0].element );
+		weierstrass_add ( curve, ladder[0][0].element,
+				  ladder[0][0].element, ladder[0][0].element );
+		weierstrass_swap ( curve, ladder[0][0].element,
+				   ladder[1][0].element, swap );
+	}
+
+	/* Construct result */
+	return weierstrass_export ( curve, ladder[0][0].element, result );
+}
+
+/**
+ * Add curve points (as a one-off operation)
+ *
+ * @v curve		Weierstrass curve
+ * @v addend		Curve point to add (raw affine X||Y)
+ * @v augend		Curve point to add (raw affine X||Y)
+ * @v result		Curve point (raw affine X||Y) to fill in
+ * @ret rc		Return status code
+ */
+int weierstrass_add_once ( struct weierstrass_curve *curve,
+			   const void *addend, const void *augend,
+			   void *result ) {
+	unsigned int size = curve->size;
+	bigint_t ( size ) points[2][WEIERSTRASS_AXES];
+	int rc;
+
+	/* Calculate curve constants, if not already done */
+	weierstrass_init ( curve );
+
+	/* Parse points */
+	if ( ( rc = weierstrass_import ( curve, addend,
+					 points[0][0].element ) ) != 0 )
+		return rc;
+	if ( ( rc = weierstrass_import ( curve, augend,
+					 points[1][0].element ) ) != 0 )
+		return rc;
+
+	/* Add points */
+	weierstrass_add ( curve, points[0][0].element, points[1][0].element,
+			  points[0][0].element );
+
+	/* Construct result */
+	return weierstrass_export ( curve, points[0][0].element, result );
+}
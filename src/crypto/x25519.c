@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * X25519 key exchange
+ *
+ * X25519 is documented in RFC 7748.  Field elements are held in
+ * Montgomery form and multiplied using the generic big integer
+ * Montgomery multiplication.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/bigint.h>
+#include <ipxe/crypto.h>
+#include <ipxe/x25519.h>
+
+/** Number of big integer elements in an X25519 field element */
+#define X25519_SIZE bigint_required_size ( X25519_LEN )
+
+/** An X25519 field element */
+typedef bigint_t ( X25519_SIZE ) x25519_t;
+
+/** X25519 field prime p = 2^255 - 19 (raw big-endian value) */
+static const uint8_t x25519_prime_raw[X25519_LEN] = {
+	0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xed
+};
+
+/** X25519 constant (A - 2) / 4 = 121665 (raw big-endian value) */
+static const uint8_t x25519_a24_raw[] = { 0x01, 0xdb, 0x41 };
+
+/** X25519 base point */
+static const uint8_t x25519_base[X25519_LEN] = { 9 };
+
+/** Field prime */
+static x25519_t x25519_prime;
+
+/** Fermat inversion exponent (p - 2) */
+static x25519_t x25519_fermat;
+
+/** Montgomery conversion constant (R^2 mod p) */
+static x25519_t x25519_square;
+
+/** One (in Montgomery form) */
+static x25519_t x25519_one;
+
+/** Constant (A - 2) / 4 (in Montgomery form) */
+static x25519_t x25519_a24;
+
+/** Montgomery reduction constant (or zero if not yet calculated) */
+static bigint_element_t x25519_inverse;
+
+/**
+ * Add field elements
+ *
+ * @v augend		Field element to add
+ * @v addend		Field element to add
+ * @v result		Field element to hold result
+ *
+ * The result may overlap either input.
+ */
+static void x25519_add ( const x25519_t *augend, const x25519_t *addend,
+			 x25519_t *result ) {
+	x25519_t sum;
+
+	/* Calculate sum (which cannot overflow since p < 2^255) */
+	memcpy ( &sum, augend, sizeof ( sum ) );
+	bigint_add ( addend, &sum );
+
+	/* Reduce modulo the field prime */
+	if ( bigint_is_geq ( &sum, &x25519_prime ) )
+		bigint_subtract ( &x25519_prime, &sum );
+	memcpy ( result, &sum, sizeof ( *result ) );
+}
+
+/**
+ * Subtract field elements
+ *
+ * @v minuend		Field element to subtract from
+ * @v subtrahend	Field element to subtract
+ * @v result		Field element to hold result
+ *
+ * The result may overlap either input.
+ */
+static void x25519_subtract ( const x25519_t *minuend,
+			      const x25519_t *subtrahend, x25519_t *result ) {
+	x25519_t difference;
+
+	/* Calculate difference plus prime (which cannot underflow) */
+	memcpy ( &difference, minuend, sizeof ( difference ) );
+	bigint_add ( &x25519_prime, &difference );
+	bigint_subtract ( subtrahend, &difference );
+
+	/* Reduce modulo the field prime */
+	if ( bigint_is_geq ( &difference, &x25519_prime ) )
+		bigint_subtract ( &x25519_prime, &difference );
+	memcpy ( result, &difference, sizeof ( *result ) );
+}
+
+/**
+ * Multiply field elements
+ *
+ * @v multiplicand	Field element to multiply
+ * @v multiplier	Field element to multiply
+ * @v result		Field element to hold result
+ *
+ * The result may overlap either input.
+ */
+static void x25519_multiply ( const x25519_t *multiplicand,
+			      const x25519_t *multiplier, x25519_t *result ) {
+	bigint_t ( ( 2 * X25519_SIZE ) + 1 ) tmp;
+
+	bigint_montgomery ( multiplicand, multiplier, &x25519_prime,
+			    x25519_inverse, result, tmp.element );
+}
+
+/**
+ * Conditionally swap field elements
+ *
+ * @v first		Field element
+ * @v second		Field element
+ * @v swap		Swap elements
+ *
+ * The swap is performed in constant time.
+ */
+static void x25519_swap ( x25519_t *first, x25519_t *second,
+			  unsigned int swap ) {
+	bigint_element_t mask = -( ( bigint_element_t ) swap );
+	bigint_element_t diff;
+	unsigned int i;
+
+	for ( i = 0 ; i < X25519_SIZE ; i++ ) {
+		diff = ( ( first->element[i] ^ second->element[i] ) & mask );
+		first->element[i] ^= diff;
+		second->element[i] ^= diff;
+	}
+}
+
+/**
+ * Initialise field constants
+ *
+ */
+static void x25519_init ( void ) {
+	static const uint8_t one_raw[] = { 1 };
+	static const uint8_t two_raw[] = { 2 };
+	unsigned int bits = ( 8 * sizeof ( x25519_prime ) );
+	x25519_t two;
+	unsigned int i;
+
+	/* Do nothing if constants have already been calculated */
+	if ( x25519_inverse )
+		return;
+
+	/* Construct field prime and Fermat inversion exponent */
+	bigint_init ( &x25519_prime, x25519_prime_raw,
+		      sizeof ( x25519_prime_raw ) );
+	bigint_init ( &two, two_raw, sizeof ( two_raw ) );
+	memcpy ( &x25519_fermat, &x25519_prime, sizeof ( x25519_fermat ) );
+	bigint_subtract ( &two, &x25519_fermat );
+
+	/* Calculate R mod p and R^2 mod p by repeated doubling */
+	bigint_init ( &x25519_one, one_raw, sizeof ( one_raw ) );
+	for ( i = 0 ; i < bits ; i++ )
+		x25519_add ( &x25519_one, &x25519_one, &x25519_one );
+	memcpy ( &x25519_square, &x25519_one, sizeof ( x25519_square ) );
+	for ( i = 0 ; i < bits ; i++ )
+		x25519_add ( &x25519_square, &x25519_square, &x25519_square );
+
+	/* Calculate Montgomery reduction constant */
+	x25519_inverse = bigint_montgomery_inverse ( &x25519_prime );
+
+	/* Convert constant (A - 2) / 4 to Montgomery form */
+	bigint_init ( &x25519_a24, x25519_a24_raw, sizeof ( x25519_a24_raw ) );
+	x25519_multiply ( &x25519_a24, &x25519_square, &x25519_a24 );
+}
+
+/**
+ * Calculate X25519 function
+ *
+ * @v base		Base point u-coordinate (little-endian)
+ * @v scalar		Scalar multiple (little-endian)
+ * @v result		Result point u-coordinate (little-endian) to fill in
+ * @ret rc		Return status code
+ */
+static int x25519_curve_multiply ( const void *base, const void *scalar,
+				   void *result ) {
+	static const uint8_t one_raw[] = { 1 };
+	const uint8_t *in = base;
+	uint8_t *out = result;
+	uint8_t raw[X25519_LEN];
+	uint8_t k[X25519_LEN];
+	x25519_t x1, x2, z2, x3, z3;
+	x25519_t a, aa, b, bb, c, d, e, da, cb;
+	x25519_t reciprocal;
+	x25519_t one;
+	unsigned int swap;
+	unsigned int bit;
+	unsigned int i;
+	int t;
+
+	/* Calculate field constants, if not already done */
+	x25519_init();
+
+	/* Decode scalar (RFC 7748 section 5 "decodeScalar25519") */
+	memcpy ( k, scalar, sizeof ( k ) );
+	k[0] &= 0xf8;
+	k[ X25519_LEN - 1 ] &= 0x7f;
+	k[ X25519_LEN - 1 ] |= 0x40;
+
+	/* Decode u-coordinate, masking the most significant bit and
+	 * accepting non-canonical values (RFC 7748 section 5
+	 * "decodeUCoordinate").
+	 */
+	for ( i = 0 ; i < X25519_LEN ; i++ )
+		raw[i] = in[ X25519_LEN - 1 - i ];
+	raw[0] &= 0x7f;
+	bigint_init ( &x1, raw, sizeof ( raw ) );
+	if ( bigint_is_geq ( &x1, &x25519_prime ) )
+		bigint_subtract ( &x25519_prime, &x1 );
+	x25519_multiply ( &x1, &x25519_square, &x1 );
+
+	/* Initialise ladder */
+	memcpy ( &x2, &x25519_one, sizeof ( x2 ) );
+	memset ( &z2, 0, sizeof ( z2 ) );
+	memcpy ( &x3, &x1, sizeof ( x3 ) );
+	memcpy ( &z3, &x25519_one, sizeof ( z3 ) );
+	swap = 0;
+
+	/* Perform Montgomery ladder (RFC 7748 section 5) */
+	for ( t = ( ( 8 * X25519_LEN ) - 2 ) ; t >= 0 ; t-- ) {
+		bit = ( ( k[ t / 8 ] >> ( t % 8 ) ) & 1 );
+		swap ^= bit;
+		x25519_swap ( &x2, &x3, swap );
+		x25519_swap ( &z2, &z3, swap );
+		swap = bit;
+		x25519_add ( &x2, &z2, &a );
+		x25519_multiply ( &a, &a, &aa );
+		x25519_subtract ( &x2, &z2, &b );
+		x25519_multiply ( &b, &b, &bb );
+		x25519_subtract ( &aa, &bb, &e );
+		x25519_add ( &x3, &z3, &c );
+		x25519_subtract ( &x3, &z3, &d );
+		x25519_multiply ( &d, &a, &da );
+		x25519_multiply ( &c, &b, &cb );
+		x25519_add ( &da, &cb, &x3 );
+		x25519_multiply ( &x3, &x3, &x3 );
+		x25519_subtract ( &da, &cb, &z3 );
+		x25519_multiply ( &z3, &z3, &z3 );
+		x25519_multiply ( &z3, &x1, &z3 );
+		x25519_multiply ( &aa, &bb, &x2 );
+		x25519_multiply ( &x25519_a24, &e, &z2 );
+		x25519_add ( &z2, &aa, &z2 );
+		x25519_multiply ( &z2, &e, &z2 );
+	}
+	x25519_swap ( &x2, &x3, swap );
+	x25519_swap ( &z2, &z3, swap );
+
+	/* Calculate Z^-1 = Z^(p-2) */
+	memcpy ( &reciprocal, &x25519_one, sizeof ( reciprocal ) );
+	for ( t = ( bigint_max_set_bit ( &x25519_fermat ) - 1 ) ; t >= 0 ; t-- ){
+		x25519_multiply ( &reciprocal, &reciprocal, &reciprocal );
+		if ( bigint_bit_is_set ( &x25519_fermat, t ) )
+			x25519_multiply ( &reciprocal, &z2, &reciprocal );
+	}
+
+	/* Construct result and convert from Montgomery form */
+	bigint_init ( &one, one_raw, sizeof ( one_raw ) );
+	x25519_multiply ( &x2, &reciprocal, &x2 );
+	x25519_multiply ( &x2, &one, &x2 );
+	bigint_done ( &x2, raw, sizeof ( raw ) );
+	for ( i = 0 ; i < X25519_LEN ; i++ )
+		out[i] = raw[ X25519_LEN - 1 - i ];
+
+	/* Fail if result is zero (i.e. a small-order base point) */
+	if ( bigint_is_zero ( &x2 ) ) {
+		DBGC ( &x25519_curve, "X25519 result is zero\n" );
+		return -EPERM;
+	}
+
+	return 0;
+}
+
+/** X25519 elliptic curve */
+struct elliptic_curve x25519_curve = {
+	.name = "x25519",
+	.pointsize = X25519_LEN,
+	.keysize = X25519_LEN,
+	.base = x25519_base,
+	.multiply = x25519_curve_multiply,
+};
@@ -560,6 +560,37 @@ void intel_destroy_ring ( struct intel_nic *intel, struct intel_ring *ring ) {
 	ring->cons = 0;
 }
 
+/**
+ * Size receive descriptor ring
+ *
+ * @v intel		Intel device
+ * @v netdev		Network device
+ * @v fill		Default receive descriptor ring fill level
+ *
+ * This must be called before creating the receive descriptor ring.
+ */
+void intel_size_rx ( struct intel_nic *intel, struct net_device *netdev,
+		     unsigned int fill ) {
+	unsigned int count;
+
+	/* Choose fill level, allowing for a ring of twice this size */
+	fill = netdev_rx_ring ( netdev, fill, ( INTEL_MAX_RX_DESC / 2 ) );
+	if ( ! fill )
+		fill = 1;
+
+	/* Choose ring size.  The ring is aligned on its own size, and
+	 * so must be a power of two.
+	 */
+	count = INTEL_MIN_RX_DESC;
+	while ( count < ( 2 * fill ) )
+		count <<= 1;
+	intel_init_ring ( &intel->rx, count, intel->rx.reg,
+			  intel->rx.describe );
+	intel->rx_fill = fill;
+	DBGC ( intel, "INTEL %p using %d RX descriptors (fill %d)\n",
+	       intel, count, fill );
+}
+
 /**
  * Refill receive descriptor ring
  *
@@ -573,7 +604,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 	unsigned int refilled = 0;
 
 	/* Refill ring */
-	while ( ( intel->rx.prod - intel->rx.cons ) < INTEL_RX_FILL ) {
+	while ( ( intel->rx.prod - intel->rx.cons ) < intel->rx_fill ) {
 
 		/* Allocate I/O buffer */
 		iobuf = alloc_rx_iob ( INTEL_RX_MAX_LEN, intel->dma );
@@ -583,7 +614,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 		}
 
 		/* Get next receive descriptor */
-		rx_idx = ( intel->rx.prod++ % INTEL_NUM_RX_DESC );
+		rx_idx = ( intel->rx.prod++ % intel->rx.count );
 		rx = &intel->rx.desc[rx_idx];
 
 		/* Populate receive descriptor */
@@ -602,7 +633,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 	/* Push descriptors to card, if applicable */
 	if ( refilled ) {
 		wmb();
-		rx_tail = ( intel->rx.prod % INTEL_NUM_RX_DESC );
+		rx_tail = ( intel->rx.prod % intel->rx.count );
 		profile_start ( &intel_vm_refill_profiler );
 		writel ( rx_tail, intel->regs + intel->rx.reg + INTEL_xDT );
 		profile_stop ( &intel_vm_refill_profiler );
@@ -619,7 +650,7 @@ void intel_empty_rx ( struct intel_nic *intel ) {
 	unsigned int i;
 
 	/* Discard unused receive buffers */
-	for ( i = 0 ; i < INTEL_NUM_RX_DESC ; i++ ) {
+	for ( i = 0 ; i < INTEL_MAX_RX_DESC ; i++ ) {
 		if ( intel->rx_iobuf[i] )
 			free_rx_iob ( intel->rx_iobuf[i] );
 		intel->rx_iobuf[i] = NULL;
@@ -657,6 +688,7 @@ static int intel_open ( struct net_device *netdev ) {
 		goto err_create_tx;
 
 	/* Create receive descriptor ring */
+	intel_size_rx ( intel, netdev, INTEL_RX_FILL );
 	if ( ( rc = intel_create_ring ( intel, &intel->rx ) ) != 0 )
 		goto err_create_rx;
 
@@ -816,7 +848,7 @@ void intel_poll_rx ( struct net_device *netdev ) {
 	while ( intel->rx.cons != intel->rx.prod ) {
 
 		/* Get next receive descriptor */
-		rx_idx = ( intel->rx.cons % INTEL_NUM_RX_DESC );
+		rx_idx = ( intel->rx.cons % intel->rx.count );
 		rx = &intel->rx.desc[rx_idx];
 
 		/* Stop if descriptor is still in use */
@@ -950,7 +982,7 @@ static int intel_probe ( struct pci_device *pci ) {
 	intel->flags = pci->id->driver_data;
 	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC, INTEL_TD,
 			  intel_describe_tx );
-	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTEL_RD,
+	intel_init_ring ( &intel->rx, INTEL_MIN_RX_DESC, INTEL_RD,
 			  intel_describe_rx );
 
 	/* Fix up PCI device */
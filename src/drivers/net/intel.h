@@ -141,15 +141,18 @@ struct intel_descriptor {
 /** Receive Descriptor register block */
 #define INTEL_RD 0x02800UL
 
-/** Number of receive descriptors
+/** Minimum number of receive descriptors
  *
  * Minimum value is 8, since the descriptor ring length must be a
  * multiple of 128.
  */
-#define INTEL_NUM_RX_DESC 16
+#define INTEL_MIN_RX_DESC 16
 
-/** Receive descriptor ring fill level */
-#define INTEL_RX_FILL 8
+/** Maximum number of receive descriptors */
+#define INTEL_MAX_RX_DESC 256
+
+/** Default receive descriptor ring fill level */
+#define INTEL_RX_FILL 16
 
 /** Receive buffer length */
 #define INTEL_RX_MAX_LEN 2048
@@ -222,6 +225,8 @@ struct intel_ring {
 
 	/** Register block */
 	unsigned int reg;
+	/** Number of descriptors */
+	unsigned int count;
 	/** Length (in bytes) */
 	size_t len;
 
@@ -248,6 +253,7 @@ intel_init_ring ( struct intel_ring *ring, unsigned int count, unsigned int reg,
 		  void ( * describe ) ( struct intel_descriptor *desc,
 					physaddr_t addr, size_t len ) ) {
 
+	ring->count = count;
 	ring->len = ( count * sizeof ( ring->desc[0] ) );
 	ring->reg = reg;
 	ring->describe = describe;
@@ -303,8 +309,10 @@ struct intel_nic {
 	struct intel_ring tx;
 	/** Receive descriptor ring */
 	struct intel_ring rx;
+	/** Receive descriptor ring fill level */
+	unsigned int rx_fill;
 	/** Receive I/O buffers */
-	struct io_buffer *rx_iobuf[INTEL_NUM_RX_DESC];
+	struct io_buffer *rx_iobuf[INTEL_MAX_RX_DESC];
 };
 
 /** Driver flags */
@@ -354,6 +362,8 @@ extern int intel_create_ring ( struct intel_nic *intel,
 			       struct intel_ring *ring );
 extern void intel_destroy_ring ( struct intel_nic *intel,
 				 struct intel_ring *ring );
+extern void intel_size_rx ( struct intel_nic *intel,
+			    struct net_device *netdev, unsigned int fill );
 extern void intel_refill_rx ( struct intel_nic *intel );
 extern void intel_empty_rx ( struct intel_nic *intel );
 extern int intel_transmit ( struct net_device *netdev,
@@ -189,6 +189,7 @@ static int intelx_open ( struct net_device *netdev ) {
 		goto err_create_tx;
 
 	/* Create receive descriptor ring */
+	intel_size_rx ( intel, netdev, INTELX_RX_FILL );
 	if ( ( rc = intel_create_ring ( intel, &intel->rx ) ) != 0 )
 		goto err_create_rx;
 
@@ -397,7 +398,7 @@ static int intelx_probe ( struct pci_device *pci ) {
 	intel->port = PCI_FUNC ( pci->busdevfn );
 	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC, INTELX_TD,
 			  intel_describe_tx );
-	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTELX_RD,
+	intel_init_ring ( &intel->rx, INTEL_MIN_RX_DESC, INTELX_RD,
 			  intel_describe_rx );
 
 	/* Fix up PCI device */
@@ -71,6 +71,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Receive Descriptor register block */
 #define INTELX_RD 0x01000UL
 
+/** Default receive descriptor ring fill level */
+#define INTELX_RX_FILL 64
+
 /** Receive Descriptor Control Register */
 #define INTELX_RXDCTL_VME	0x40000000UL	/**< Strip VLAN tag */
 
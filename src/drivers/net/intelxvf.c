@@ -280,6 +280,7 @@ static int intelxvf_open ( struct net_device *netdev ) {
 		goto err_create_tx;
 
 	/* Create receive descriptor ring */
+	intel_size_rx ( intel, netdev, INTELX_RX_FILL );
 	if ( ( rc = intel_create_ring ( intel, &intel->rx ) ) != 0 )
 		goto err_create_rx;
 
@@ -449,7 +450,7 @@ static int intelxvf_probe ( struct pci_device *pci ) {
 	intel_init_mbox ( &intel->mbox, INTELXVF_MBCTRL, INTELXVF_MBMEM );
 	intel_init_ring ( &intel->tx, INTEL_NUM_TX_DESC, INTELXVF_TD(0),
 			  intel_describe_tx_adv );
-	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTELXVF_RD(0),
+	intel_init_ring ( &intel->rx, INTEL_MIN_RX_DESC, INTELXVF_RD(0),
 			  intel_describe_rx );
 
 	/* Fix up PCI device */
@@ -78,8 +78,8 @@ enum {
 	QUEUE_NB
 };
 
-/** Max number of pending rx packets */
-#define NUM_RX_BUF 8
+/** Default number of pending rx packets */
+#define NUM_RX_BUF 32
 
 struct virtnet_nic {
 	/** Base pio register address */
@@ -100,6 +100,9 @@ struct virtnet_nic {
 	/** Pending rx packet count */
 	unsigned int rx_num_iobufs;
 
+	/** Max number of pending rx packets */
+	unsigned int rx_max_iobufs;
+
 	/** DMA device */
 	struct dma_device *dma;
 
@@ -151,6 +154,23 @@ static void virtnet_enqueue_iob ( struct net_device *netdev,
 		     virtnet->ioaddr, vq, 1 );
 }
 
+/** Choose number of pending rx packets
+ *
+ * @v netdev		Network device
+ *
+ * Each pending rx packet consumes two descriptors (header and data)
+ * in the rx virtqueue.
+ */
+static void virtnet_size_rx_virtqueue ( struct net_device *netdev ) {
+	struct virtnet_nic *virtnet = netdev->priv;
+	struct vring_virtqueue *vq = &virtnet->virtqueue[RX_INDEX];
+
+	virtnet->rx_max_iobufs = netdev_rx_ring ( netdev, NUM_RX_BUF,
+						  ( vq->vring.num / 2 ) );
+	DBGC ( virtnet, "VIRTIO-NET %p using %d rx buffers (queue size %d)\n",
+	       virtnet, virtnet->rx_max_iobufs, vq->vring.num );
+}
+
 /** Try to keep rx virtqueue filled with iobufs
  *
  * @v netdev		Network device
@@ -159,7 +179,7 @@ static void virtnet_refill_rx_virtqueue ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	size_t len = ( netdev->max_pkt_len + 4 /* VLAN */ );
 
-	while ( virtnet->rx_num_iobufs < NUM_RX_BUF ) {
+	while ( virtnet->rx_num_iobufs < virtnet->rx_max_iobufs ) {
 		struct io_buffer *iobuf;
 
 		/* Try to allocate a buffer, stop for now if out of memory */
@@ -229,6 +249,7 @@ static int virtnet_open_legacy ( struct net_device *netdev ) {
 	/* Initialize rx packets */
 	INIT_LIST_HEAD ( &virtnet->rx_iobufs );
 	virtnet->rx_num_iobufs = 0;
+	virtnet_size_rx_virtqueue ( netdev );
 	virtnet_refill_rx_virtqueue ( netdev );
 
 	/* Disable interrupts before starting */
@@ -300,6 +321,7 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 	/* Initialize rx packets */
 	INIT_LIST_HEAD ( &virtnet->rx_iobufs );
 	virtnet->rx_num_iobufs = 0;
+	virtnet_size_rx_virtqueue ( netdev );
 	virtnet_refill_rx_virtqueue ( netdev );
 	return 0;
 }
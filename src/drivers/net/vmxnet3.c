@@ -214,11 +214,11 @@ static void vmxnet3_refill_rx ( struct net_device *netdev ) {
 	unsigned int generation;
 
 	/* Fill receive ring to specified fill level */
-	while ( vmxnet->count.rx_fill < VMXNET3_RX_FILL ) {
+	while ( vmxnet->count.rx_fill < vmxnet->rx_max_fill ) {
 
 		/* Locate receive descriptor */
-		desc_idx = ( vmxnet->count.rx_prod % VMXNET3_NUM_RX_DESC );
-		generation = ( ( vmxnet->count.rx_prod & VMXNET3_NUM_RX_DESC ) ?
+		desc_idx = ( vmxnet->count.rx_prod % vmxnet->num_rx_desc );
+		generation = ( ( vmxnet->count.rx_prod & vmxnet->num_rx_desc ) ?
 			       0 : cpu_to_le32 ( VMXNET3_RXF_GEN ) );
 		assert ( vmxnet->rx_iobuf[desc_idx] == NULL );
 
@@ -248,7 +248,7 @@ static void vmxnet3_refill_rx ( struct net_device *netdev ) {
 	if ( vmxnet->count.rx_prod != orig_rx_prod ) {
 		wmb();
 		profile_start ( &vmxnet3_vm_refill_profiler );
-		writel ( ( vmxnet->count.rx_prod % VMXNET3_NUM_RX_DESC ),
+		writel ( ( vmxnet->count.rx_prod % vmxnet->num_rx_desc ),
 			 ( vmxnet->pt + VMXNET3_PT_RXPROD ) );
 		profile_stop ( &vmxnet3_vm_refill_profiler );
 		profile_exclude ( &vmxnet3_vm_refill_profiler );
@@ -272,8 +272,8 @@ static void vmxnet3_poll_rx ( struct net_device *netdev ) {
 	while ( 1 ) {
 
 		/* Look for completed descriptors */
-		comp_idx = ( vmxnet->count.rx_cons % VMXNET3_NUM_RX_COMP );
-		generation = ( ( vmxnet->count.rx_cons & VMXNET3_NUM_RX_COMP ) ?
+		comp_idx = ( vmxnet->count.rx_cons % vmxnet->num_rx_desc );
+		generation = ( ( vmxnet->count.rx_cons & vmxnet->num_rx_desc ) ?
 			       0 : cpu_to_le32 ( VMXNET3_RXCF_GEN ) );
 		rx_comp = &vmxnet->dma->rx_comp[comp_idx];
 		if ( generation != ( rx_comp->flags &
@@ -286,7 +286,7 @@ static void vmxnet3_poll_rx ( struct net_device *netdev ) {
 
 		/* Locate corresponding receive descriptor */
 		desc_idx = ( le32_to_cpu ( rx_comp->index ) %
-			     VMXNET3_NUM_RX_DESC );
+			     vmxnet->num_rx_desc );
 		iobuf = vmxnet->rx_iobuf[desc_idx];
 		if ( ! iobuf ) {
 			DBGC ( vmxnet, "VMXNET3 %p completed on empty receive "
@@ -475,6 +475,22 @@ static int vmxnet3_open ( struct net_device *netdev ) {
 	}
 	memset ( vmxnet->dma, 0, sizeof ( *vmxnet->dma ) );
 
+	/* Choose receive ring size and fill level.  The ring size
+	 * must be a power of two (for the generation bit
+	 * calculations) and a multiple of 32, and must exceed the
+	 * fill level so that the producer index never catches up
+	 * with the consumer index.
+	 */
+	vmxnet->rx_max_fill = netdev_rx_ring ( netdev, VMXNET3_RX_FILL,
+					       ( VMXNET3_NUM_RX_DESC - 1 ) );
+	if ( ! vmxnet->rx_max_fill )
+		vmxnet->rx_max_fill = 1;
+	vmxnet->num_rx_desc = VMXNET3_MIN_RX_DESC;
+	while ( vmxnet->num_rx_desc <= vmxnet->rx_max_fill )
+		vmxnet->num_rx_desc <<= 1;
+	DBGC ( vmxnet, "VMXNET3 %p using %d RX descriptors (fill %d)\n",
+	       vmxnet, vmxnet->num_rx_desc, vmxnet->rx_max_fill );
+
 	/* Populate queue descriptors */
 	queues = &vmxnet->dma->queues;
 	queues->tx.cfg.desc_address =
@@ -487,8 +503,8 @@ static int vmxnet3_open ( struct net_device *netdev ) {
 		cpu_to_le64 ( virt_to_bus ( &vmxnet->dma->rx_desc ) );
 	queues->rx.cfg.comp_address =
 		cpu_to_le64 ( virt_to_bus ( &vmxnet->dma->rx_comp ) );
-	queues->rx.cfg.num_desc[0] = cpu_to_le32 ( VMXNET3_NUM_RX_DESC );
-	queues->rx.cfg.num_comp = cpu_to_le32 ( VMXNET3_NUM_RX_COMP );
+	queues->rx.cfg.num_desc[0] = cpu_to_le32 ( vmxnet->num_rx_desc );
+	queues->rx.cfg.num_comp = cpu_to_le32 ( vmxnet->num_rx_desc );
 	queues_bus = virt_to_bus ( queues );
 	DBGC ( vmxnet, "VMXNET3 %p queue descriptors at %08llx+%zx\n",
 	       vmxnet, queues_bus, sizeof ( *queues ) );
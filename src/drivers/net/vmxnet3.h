@@ -423,11 +423,14 @@ struct vmxnet3_queues {
 /** Number of TX completion descriptors */
 #define VMXNET3_NUM_TX_COMP 32
 
-/** Number of RX descriptors */
-#define VMXNET3_NUM_RX_DESC 32
+/** Minimum number of RX descriptors (and RX completion descriptors) */
+#define VMXNET3_MIN_RX_DESC 32
 
-/** Number of RX completion descriptors */
-#define VMXNET3_NUM_RX_COMP 32
+/** Maximum number of RX descriptors */
+#define VMXNET3_NUM_RX_DESC 256
+
+/** Maximum number of RX completion descriptors */
+#define VMXNET3_NUM_RX_COMP VMXNET3_NUM_RX_DESC
 
 /**
  * DMA areas
@@ -478,6 +481,10 @@ struct vmxnet3_nic {
 	struct vmxnet3_dma *dma;
 	/** Producer and consumer counters */
 	struct vmxnet3_counters count;
+	/** Number of RX descriptors (and RX completion descriptors) */
+	unsigned int num_rx_desc;
+	/** Receive ring maximum fill level */
+	unsigned int rx_max_fill;
 	/** Transmit I/O buffers */
 	struct io_buffer *tx_iobuf[VMXNET3_NUM_TX_DESC];
 	/** Receive I/O buffers */
@@ -496,8 +503,8 @@ struct vmxnet3_nic {
 /** Transmit ring maximum fill level */
 #define VMXNET3_TX_FILL ( VMXNET3_NUM_TX_DESC - 1 )
 
-/** Receive ring maximum fill level */
-#define VMXNET3_RX_FILL 8
+/** Default receive ring maximum fill level */
+#define VMXNET3_RX_FILL 32
 
 /** Received packet alignment padding */
 #define NET_IP_ALIGN 2
@@ -221,6 +221,52 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 		bigint_t ( size * 2 ) temp_modulus;			\
 	} ); } )
 
+/**
+ * Calculate Montgomery reduction constant
+ *
+ * @v modulus		Big integer (odd) modulus
+ * @ret inverse		Montgomery reduction constant
+ */
+#define bigint_montgomery_inverse( modulus )				\
+	bigint_montgomery_inverse_raw ( (modulus)->element[0] )
+
+/**
+ * Perform Montgomery multiplication of big integers
+ *
+ * @v multiplicand	Big integer to be multiplied
+ * @v multiplier	Big integer to be multiplied (less than modulus)
+ * @v modulus		Big integer (odd) modulus
+ * @v inverse		Montgomery reduction constant
+ * @v result		Big integer to hold result
+ * @v tmp		Temporary working space
+ */
+#define bigint_montgomery( multiplicand, multiplier, modulus, inverse,	\
+			   result, tmp ) do {				\
+	unsigned int size = bigint_size (multiplicand);			\
+	bigint_montgomery_raw ( (multiplicand)->element,		\
+				(multiplier)->element,			\
+				(modulus)->element, (inverse),		\
+				(result)->element, size, tmp );		\
+	} while ( 0 )
+
+/**
+ * Calculate temporary working space required for Montgomery multiplication
+ *
+ * @v modulus		Big integer modulus
+ * @ret len		Length of temporary working space
+ */
+#define bigint_montgomery_tmp_len( modulus ) ( {			\
+	unsigned int size = bigint_size (modulus);			\
+	sizeof ( bigint_t ( ( 2 * size ) + 1 ) ); } )
+
+/**
+ * Maximum number of precomputed powers used in modular exponentiation
+ *
+ * Sliding window exponentiation precomputes the odd powers of the
+ * base up to ( 2^{k} - 1 ) for a window size of k bits.
+ */
+#define BIGINT_MOD_EXP_MAX_POWERS 16
+
 /**
  * Perform modular exponentiation of big integers
  *
@@ -253,6 +299,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 	sizeof ( struct {						\
 		bigint_t ( size ) temp_base;				\
 		bigint_t ( exponent_size ) temp_exponent;		\
+		bigint_t ( size ) temp_powers[BIGINT_MOD_EXP_MAX_POWERS]; \
 		uint8_t mod_multiply[mod_multiply_len];			\
 	} ); } )
 
@@ -286,11 +333,22 @@ void bigint_multiply_raw ( const bigint_element_t *multiplicand0,
 			   const bigint_element_t *multiplier0,
 			   bigint_element_t *result0,
 			   unsigned int size );
+bigint_element_t
+bigint_multiply_accumulate_raw ( const bigint_element_t *multiplicand0,
+				 bigint_element_t multiplier,
+				 bigint_element_t *value0, unsigned int size );
 void bigint_mod_multiply_raw ( const bigint_element_t *multiplicand0,
 			       const bigint_element_t *multiplier0,
 			       const bigint_element_t *modulus0,
 			       bigint_element_t *result0,
 			       unsigned int size, void *tmp );
+bigint_element_t bigint_montgomery_inverse_raw ( bigint_element_t modulus );
+void bigint_montgomery_raw ( const bigint_element_t *multiplicand0,
+			     const bigint_element_t *multiplier0,
+			     const bigint_element_t *modulus0,
+			     bigint_element_t inverse,
+			     bigint_element_t *result0,
+			     unsigned int size, bigint_element_t *tmp );
 void bigint_mod_exp_raw ( const bigint_element_t *base0,
 			  const bigint_element_t *modulus0,
 			  const bigint_element_t *exponent0,
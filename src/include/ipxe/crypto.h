@@ -12,6 +12,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <stddef.h>
 #include <assert.h>
+#include <ipxe/tables.h>
 
 /** A message digest algorithm */
 struct digest_algorithm {
@@ -195,6 +196,99 @@ struct pubkey_algorithm {
 			  const void *public_key, size_t public_key_len );
 };
 
+/** An elliptic curve */
+struct elliptic_curve {
+	/** Curve name */
+	const char *name;
+	/** Point (and public key) size */
+	size_t pointsize;
+	/** Scalar (and private key) size */
+	size_t keysize;
+	/** Generator base point */
+	const void *base;
+	/** Order of the generator (if applicable) */
+	const void *order;
+	/** Multiply scalar by curve point
+	 *
+	 * @v base		Base point
+	 * @v scalar		Scalar multiple
+	 * @v result		Result point to fill in
+	 * @ret rc		Return status code
+	 */
+	int ( * multiply ) ( const void *base, const void *scalar,
+			     void *result );
+	/** Add curve points as a one-off operation (if applicable)
+	 *
+	 * @v addend		Curve point to add
+	 * @v augend		Curve point to add
+	 * @v result		Curve point to hold result
+	 * @ret rc		Return status code
+	 */
+	int ( * add ) ( const void *addend, const void *augend,
+			void *result );
+};
+
+/** A hardware-accelerated cipher algorithm
+ *
+ * An accelerated cipher algorithm must produce output identical to
+ * the generic algorithm that it replaces, but may use a different
+ * context size and layout.
+ */
+struct cipher_accelerator {
+	/** Generic cipher algorithm */
+	struct cipher_algorithm *generic;
+	/** Accelerated cipher algorithm */
+	struct cipher_algorithm *cipher;
+	/** Check for hardware support
+	 *
+	 * @ret rc		Return status code
+	 */
+	int ( * probe ) ( void );
+};
+
+/** Hardware-accelerated cipher algorithm table */
+#define CIPHER_ACCELERATORS \
+	__table ( struct cipher_accelerator, "cipher_accelerators" )
+
+/** Declare a hardware-accelerated cipher algorithm */
+#define __cipher_accelerator __table_entry ( CIPHER_ACCELERATORS, 01 )
+
+/** A digest block function implementation
+ *
+ * Each digest algorithm family (e.g. SHA-256 and SHA-224) uses the
+ * first usable block function implementation found within the
+ * table.  The generic implementation is always present as a final
+ * fallback.
+ */
+struct digest_accelerator {
+	/** Name */
+	const char *name;
+	/** Generic digest algorithm */
+	struct digest_algorithm *generic;
+	/** Digest data blocks
+	 *
+	 * @v digest		Intermediate digest value (in standard order)
+	 * @v data		Data blocks
+	 * @v count		Number of data blocks
+	 */
+	void ( * blocks ) ( void *digest, const void *data, size_t count );
+	/** Check for hardware support
+	 *
+	 * @ret rc		Return status code
+	 */
+	int ( * probe ) ( void );
+};
+
+/** Digest block function implementation table */
+#define DIGEST_ACCELERATORS \
+	__table ( struct digest_accelerator, "digest_accelerators" )
+
+/** Declare a hardware-accelerated digest block function */
+#define __digest_accelerator __table_entry ( DIGEST_ACCELERATORS, 01 )
+
+/** Declare a generic digest block function */
+#define __digest_generic __table_entry ( DIGEST_ACCELERATORS, 02 )
+
 static inline void digest_init ( struct digest_algorithm *digest,
 				 void *ctx ) {
 	digest->init ( ctx );
@@ -302,6 +396,18 @@ static inline int pubkey_match ( struct pubkey_algorithm *pubkey,
 			       public_key_len );
 }
 
+static inline int elliptic_multiply ( struct elliptic_curve *curve,
+				     const void *base, const void *scalar,
+				     void *result ) {
+	return curve->multiply ( base, scalar, result );
+}
+
+static inline int elliptic_add ( struct elliptic_curve *curve,
+				const void *addend, const void *augend,
+				void *result ) {
+	return curve->add ( addend, augend, result );
+}
+
 extern void digest_null_init ( void *ctx );
 extern void digest_null_update ( void *ctx, const void *src, size_t len );
 extern void digest_null_final ( void *ctx, void *out );
@@ -326,6 +432,11 @@ extern int pubkey_null_verify ( void *ctx, struct digest_algorithm *digest,
 				const void *value, const void *signature ,
 				size_t signature_len );
 
+extern struct cipher_algorithm *
+cipher_accelerated ( struct cipher_algorithm *cipher );
+extern struct digest_accelerator *
+digest_accelerated ( struct digest_algorithm *digest );
+
 extern struct digest_algorithm digest_null;
 extern struct cipher_algorithm cipher_null;
 extern struct pubkey_algorithm pubkey_null;
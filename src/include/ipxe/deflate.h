@@ -81,6 +81,42 @@ enum deflate_format {
 /** Quick lookup shift */
 #define DEFLATE_HUFFMAN_QL_SHIFT ( 16 - DEFLATE_HUFFMAN_QL_BITS )
 
+/** Fast literal/length lookup table index length (in bits)
+ *
+ * This is a policy decision.
+ */
+#define DEFLATE_FAST_LITLEN_BITS 9
+
+/** Fast distance lookup table index length (in bits)
+ *
+ * This is a policy decision.
+ */
+#define DEFLATE_FAST_DISTANCE_BITS 6
+
+/** Maximum number of entries in the fast literal/length lookup table
+ *
+ * This is the largest table that can be required for a valid
+ * alphabet of up to 286 symbols with a primary table index length
+ * of 9 bits.  Alphabets that do not fit (which can arise only from
+ * the use of invalid codes) will be decoded without the fast path.
+ */
+#define DEFLATE_FAST_LITLEN_MAX 852
+
+/** Maximum number of entries in the fast distance lookup table
+ *
+ * This is the largest table that can be required for a valid
+ * alphabet of up to 30 symbols with a primary table index length of
+ * 6 bits.
+ */
+#define DEFLATE_FAST_DISTANCE_MAX 592
+
+/** Output buffer space required by the fast path
+ *
+ * This allows for the longest possible duplicate string, plus up to
+ * seven bytes of overrun from word-at-a-time copying.
+ */
+#define DEFLATE_FAST_OUT_SLACK ( 258 + 7 )
+
 /** Literal/length end of block code */
 #define DEFLATE_LITLEN_END 256
 
@@ -144,6 +180,31 @@ struct deflate_alphabet {
 	uint16_t raw[0];
 };
 
+/** A fast lookup table entry */
+struct deflate_fast {
+	/** Literal byte, base length, base distance, or subtable offset */
+	uint16_t value;
+	/** Number of bits consumed by this entry */
+	uint8_t bits;
+	/** Operation (and number of extra bits or subtable index bits) */
+	uint8_t op;
+};
+
+/** Fast lookup table operation: literal byte */
+#define DEFLATE_FAST_LITERAL 0x00
+
+/** Fast lookup table operation: base length or distance */
+#define DEFLATE_FAST_BASE 0x10
+
+/** Fast lookup table operation: end of block */
+#define DEFLATE_FAST_END 0x20
+
+/** Fast lookup table operation: link to subtable */
+#define DEFLATE_FAST_LINK 0x40
+
+/** Fast lookup table extra bits or subtable index bits mask */
+#define DEFLATE_FAST_BITS_MASK 0x0f
+
 /** A static Huffman alphabet length pattern */
 struct deflate_static_length_pattern {
 	/** Length pair */
@@ -235,6 +296,13 @@ struct deflate {
 	uint8_t lengths[ ( ( DEFLATE_LITLEN_MAX_CODE + 1 ) +
 			   ( DEFLATE_DISTANCE_MAX_CODE + 1 ) +
 			   1 /* round up */ ) / 2 ];
+
+	/** Fast lookup tables are usable for the current block */
+	int fast;
+	/** Fast literal/length lookup table */
+	struct deflate_fast litlen_fast[DEFLATE_FAST_LITLEN_MAX];
+	/** Fast distance lookup table */
+	struct deflate_fast distance_fast[DEFLATE_FAST_DISTANCE_MAX];
 };
 
 /** A chunk of data */
@@ -11,6 +11,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 #include <ipxe/in.h>
+#include <ipxe/list.h>
 
 /** DNS server port */
 #define DNS_PORT 53
@@ -134,6 +135,26 @@ struct dns_rr_cname {
 	struct dns_rr_common common;
 } __attribute__ (( packed ));
 
+/** Type of a DNS "SOA" record */
+#define DNS_TYPE_SOA 6
+
+/** A DNS "SOA" record trailer
+ *
+ * This follows the variable-length MNAME and RNAME fields.
+ */
+struct dns_rr_soa_trailer {
+	/** Serial number */
+	uint32_t serial;
+	/** Refresh interval */
+	uint32_t refresh;
+	/** Retry interval */
+	uint32_t retry;
+	/** Expiry limit */
+	uint32_t expire;
+	/** Minimum time to live (used for negative caching) */
+	uint32_t minimum;
+} __attribute__ (( packed ));
+
 /** A DNS resource record */
 union dns_rr {
 	/** Common fields */
@@ -146,10 +167,48 @@ union dns_rr {
 	struct dns_rr_cname cname;
 };
 
+/** A DNS cache entry */
+struct dns_cache_entry {
+	/** List of DNS cache entries */
+	struct list_head list;
+	/** Initial query type */
+	uint16_t qtype;
+	/** Resolution status code
+	 *
+	 * A nonzero value indicates a negative cache entry.
+	 */
+	int rc;
+	/** Resolved address (if any) */
+	union {
+		struct sockaddr sa;
+		struct sockaddr_in sin;
+		struct sockaddr_in6 sin6;
+	} address;
+	/** Creation time (in ticks) */
+	unsigned long created;
+	/** Lifetime (in ticks) */
+	unsigned long lifetime;
+	/** Name to be resolved */
+	char name[0];
+};
+
+/** Maximum number of DNS cache entries */
+#define DNS_CACHE_MAX 32
+
+/** Maximum DNS cache entry lifetime (in seconds)
+ *
+ * This is a policy decision, which also ensures that lifetimes
+ * expressed in ticks cannot overflow.
+ */
+#define DNS_CACHE_MAX_TTL ( 24 * 60 * 60 )
+
+extern struct list_head dns_cache;
+
 extern int dns_encode ( const char *string, struct dns_name *name );
 extern int dns_decode ( struct dns_name *name, char *data, size_t len );
 extern int dns_compare ( struct dns_name *first, struct dns_name *second );
 extern int dns_copy ( struct dns_name *src, struct dns_name *dst );
 extern int dns_skip ( struct dns_name *name );
+extern void dns_cache_flush ( void );
 
 #endif /* _IPXE_DNS_H */
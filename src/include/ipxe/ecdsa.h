@@ -0,0 +1,27 @@
+#ifndef _IPXE_ECDSA_H
+#define _IPXE_ECDSA_H
+
+/** @file
+ *
+ * Elliptic Curve Digital Signature Algorithm (ECDSA)
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <ipxe/crypto.h>
+
+/** An ECDSA context */
+struct ecdsa_context {
+	/** Elliptic curve */
+	struct elliptic_curve *curve;
+	/** Public key (raw curve point) */
+	void *public;
+};
+
+/** ECDSA context size */
+#define ECDSA_CTX_SIZE sizeof ( struct ecdsa_context )
+
+extern struct pubkey_algorithm ecdsa_algorithm;
+
+#endif /* _IPXE_ECDSA_H */
@@ -295,6 +295,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define ERRFILE_ntp			( ERRFILE_NET | 0x00490000 )
 #define ERRFILE_httpntlm		( ERRFILE_NET | 0x004a0000 )
 #define ERRFILE_eap			( ERRFILE_NET | 0x004b0000 )
+#define ERRFILE_httpmulti		( ERRFILE_NET | 0x004c0000 )
 
 #define ERRFILE_image		      ( ERRFILE_IMAGE | 0x00000000 )
 #define ERRFILE_elf		      ( ERRFILE_IMAGE | 0x00010000 )
@@ -401,6 +402,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define ERRFILE_dynkeymap	      ( ERRFILE_OTHER | 0x00580000 )
 #define ERRFILE_pci_cmd		      ( ERRFILE_OTHER | 0x00590000 )
 #define ERRFILE_dhe		      ( ERRFILE_OTHER | 0x005a0000 )
+#define ERRFILE_weierstrass	      ( ERRFILE_OTHER | 0x005b0000 )
+#define ERRFILE_x25519		      ( ERRFILE_OTHER | 0x005c0000 )
+#define ERRFILE_ecdsa		      ( ERRFILE_OTHER | 0x005d0000 )
+#define ERRFILE_xferbuf_test	      ( ERRFILE_OTHER | 0x005e0000 )
 
 /** @} */
 
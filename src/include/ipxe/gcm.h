@@ -52,15 +52,26 @@ struct gcm_context {
 	union gcm_block ctr;
 	/** Hash key (H) */
 	union gcm_block key;
+	/** Multiply polynomial by hash key in situ
+	 *
+	 * @v key		Hash key
+	 * @v poly		Multiplicand and result
+	 */
+	void ( * multiply ) ( const union gcm_block *key,
+			      union gcm_block *poly );
 	/** Underlying block cipher */
 	struct cipher_algorithm *raw_cipher;
 	/** Underlying block cipher context */
 	uint8_t raw_ctx[0];
 };
 
+extern void gcm_multiply_key ( const union gcm_block *key,
+			       union gcm_block *poly );
 extern void gcm_tag ( struct gcm_context *context, union gcm_block *tag );
 extern int gcm_setkey ( struct gcm_context *context, const void *key,
-			size_t keylen, struct cipher_algorithm *raw_cipher );
+			size_t keylen, struct cipher_algorithm *raw_cipher,
+			void ( * multiply ) ( const union gcm_block *key,
+					      union gcm_block *poly ) );
 extern void gcm_setiv ( struct gcm_context *context, const void *iv,
 			size_t ivlen );
 extern void gcm_encrypt ( struct gcm_context *context, const void *src,
@@ -76,9 +87,10 @@ extern void gcm_decrypt ( struct gcm_context *context, const void *src,
  * @v _raw_cipher	Underlying cipher algorithm
  * @v _raw_context	Context structure for the underlying cipher
  * @v _blocksize	Cipher block size
+ * @v _multiply		Hash key multiplication method
  */
 #define GCM_CIPHER( _gcm_name, _gcm_cipher, _raw_cipher, _raw_context,	\
-		    _blocksize )					\
+		    _blocksize, _multiply )				\
 struct _gcm_name ## _context {						\
 	/** GCM context */						\
 	struct gcm_context gcm;						\
@@ -95,7 +107,8 @@ static int _gcm_name ## _setkey ( void *ctx, const void *key,		\
 	linker_assert ( ( ( void * ) &context->raw ) ==			\
 			( ( void * ) context->gcm.raw_ctx ),		\
 			_gcm_name ## _context_layout_error );		\
-	return gcm_setkey ( &context->gcm, key, keylen, &_raw_cipher );	\
+	return gcm_setkey ( &context->gcm, key, keylen, &_raw_cipher,	\
+			    _multiply );				\
 }									\
 static void _gcm_name ## _setiv ( void *ctx, const void *iv,		\
 				  size_t ivlen ) {			\
@@ -63,6 +63,24 @@ struct http_scheme {
  ******************************************************************************
  */
 
+/** Maximum number of pipelined requests per HTTP connection */
+#define HTTP_PIPELINE_MAX 4
+
+/** A pipelined HTTP request
+ *
+ * This represents a request which has been (or is about to be) sent
+ * on a connection while an earlier request is still awaiting its
+ * response.
+ */
+struct http_pipelined_request {
+	/** HTTP connection */
+	struct http_connection *conn;
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Request has been transmitted */
+	int sent;
+};
+
 /** An HTTP connection
  *
  * This represents a potentially reusable connection to an HTTP
@@ -82,10 +100,35 @@ struct http_connection {
 	struct http_scheme *scheme;
 	/** Transport layer interface */
 	struct interface socket;
-	/** Data transfer interface */
+	/** Data transfer interface
+	 *
+	 * This is attached to the request currently receiving its
+	 * response.
+	 */
 	struct interface xfer;
 	/** Pooled connection */
 	struct pooled_connection pool;
+	/** List of open connections */
+	struct list_head list;
+	/** Flags */
+	unsigned int flags;
+
+	/** Pipelined requests, in order of transmission */
+	struct http_pipelined_request pipeline[HTTP_PIPELINE_MAX];
+	/** Number of pipelined requests */
+	unsigned int pipelined;
+	/** Received data belonging to the next pipelined response */
+	struct io_buffer *unread;
+};
+
+/** HTTP connection flags */
+enum http_connection_flags {
+	/** Current request may be followed by pipelined requests */
+	HTTP_CONN_PIPELINE = 0x0001,
+	/** Connection must not be reused once idle */
+	HTTP_CONN_DEFUNCT = 0x0002,
+	/** Current request has been transmitted */
+	HTTP_CONN_SENT = 0x0004,
 };
 
 /******************************************************************************
@@ -99,6 +142,8 @@ struct http_connection {
 struct http_method {
 	/** Method name (e.g. "GET" or "POST") */
 	const char *name;
+	/** Method is idempotent (and so may be pipelined) */
+	int idempotent;
 };
 
 extern struct http_method http_head;
@@ -439,6 +484,8 @@ struct http_transaction {
 
 	/** Transaction state */
 	struct http_state *state;
+	/** Received data currently being processed (if any) */
+	struct io_buffer *rx;
 	/** Accumulated transfer-decoded length */
 	size_t len;
 	/** Chunk length remaining */
@@ -555,7 +602,12 @@ struct http_authentication {
  */
 
 extern char * http_token ( char **line, char **value );
-extern int http_connect ( struct interface *xfer, struct uri *uri );
+extern int http_connect ( struct interface *xfer, struct uri *uri,
+			  int pipeline );
+extern int http_conn_unread ( struct interface *intf,
+			      struct io_buffer *iobuf );
+#define http_conn_unread_TYPE( object_type ) \
+	typeof ( int ( object_type, struct io_buffer *iobuf ) )
 extern int http_open ( struct interface *xfer, struct http_method *method,
 		       struct uri *uri, struct http_request_range *range,
 		       struct http_request_content *content );
@@ -0,0 +1,74 @@
+#ifndef _IPXE_HTTPMULTI_H
+#define _IPXE_HTTPMULTI_H
+
+/** @file
+ *
+ * Hyper Text Transfer Protocol (HTTP) parallel range downloads
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/list.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/interface.h>
+#include <ipxe/process.h>
+#include <ipxe/uri.h>
+#include <ipxe/http.h>
+
+/** Maximum number of concurrent range downloads */
+#define HTTP_MULTI_MAX_RANGES 16
+
+/** Default range download chunk size */
+#define HTTP_MULTI_CHUNK ( 1024 * 1024 )
+
+/** An HTTP multiplexed range download */
+struct http_multiplexed_range {
+	/** HTTP download multiplexer */
+	struct http_multiplexer *multi;
+	/** List of multiplexed range downloads */
+	struct list_head list;
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Requested range */
+	struct http_request_range range;
+	/** Current position within range */
+	size_t pos;
+};
+
+/** An HTTP download multiplexer */
+struct http_multiplexer {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Probe (or single-stream download) interface */
+	struct interface probe;
+	/** Original URI */
+	struct uri *uri;
+	/** Falling back to a single-stream download */
+	int single;
+
+	/** Total content length */
+	size_t len;
+	/** Range download chunk size */
+	size_t chunk;
+	/** Offset of next range to be requested */
+	size_t offset;
+	/** Length of content received so far */
+	size_t received;
+
+	/** Range download initiation process */
+	struct process process;
+	/** List of busy range downloads */
+	struct list_head busy;
+	/** List of idle range downloads */
+	struct list_head idle;
+	/** Range downloads */
+	struct http_multiplexed_range range[HTTP_MULTI_MAX_RANGES];
+};
+
+extern int http_multi_open ( struct interface *xfer, struct uri *uri );
+
+#endif /* _IPXE_HTTPMULTI_H */
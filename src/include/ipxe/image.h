@@ -19,6 +19,7 @@ struct uri;
 struct pixel_buffer;
 struct asn1_cursor;
 struct image_type;
+struct xfer_buffer;
 
 /** An executable image */
 struct image {
@@ -72,6 +73,9 @@ struct image {
 /** Image will be automatically unregistered after execution */
 #define IMAGE_AUTO_UNREGISTER 0x0008
 
+/** Image data has been placed at its final load address */
+#define IMAGE_PLACED 0x0010
+
 /** An executable image type */
 struct image_type {
 	/** Name of this image type */
@@ -201,6 +205,8 @@ extern int image_asn1 ( struct image *image, size_t offset,
 extern int image_extract ( struct image *image, const char *name,
 			   struct image **extracted );
 extern int image_extract_exec ( struct image *image );
+extern int image_place ( struct image *image, struct xfer_buffer *xferbuf );
+extern void image_unplace ( struct image *image );
 
 /**
  * Increment reference count on an image
@@ -23,6 +23,23 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define IOB_ZLEN 128
 
+/** Smallest I/O buffer cache size class (log2) */
+#define IOB_CACHE_MIN_LOG2 7
+
+/** Largest I/O buffer cache size class (log2) */
+#define IOB_CACHE_MAX_LOG2 12
+
+/** Maximum number of free I/O buffers cached per size class */
+#define IOB_CACHE_MAX 64
+
+/** Maximum total size of cached free I/O buffers, as a fraction of heap
+ *
+ * Cached buffers are not available to other allocations (and are not
+ * included in the free memory figure used by e.g. TCP receive window
+ * tuning), so limit the total to a small fraction of the heap.
+ */
+#define IOB_CACHE_HEAP_FRACTION 8
+
 /**
  * A persistent I/O buffer
  *
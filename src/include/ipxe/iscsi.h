@@ -14,6 +14,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/scsi.h>
 #include <ipxe/chap.h>
 #include <ipxe/refcnt.h>
+#include <ipxe/list.h>
 #include <ipxe/xfer.h>
 #include <ipxe/process.h>
 #include <ipxe/acpi.h>
@@ -121,8 +122,10 @@ struct iscsi_bhs_common_response {
 	uint32_t statsn;
 	/** Expected command sequence number */
 	uint32_t expcmdsn;
+	/** Maximum command sequence number */
+	uint32_t maxcmdsn;
 	/** Fields specific to the PDU type */
-	uint8_t other_d[16];
+	uint8_t other_d[12];
 };
 
 /**
@@ -531,6 +534,67 @@ enum iscsi_rx_state {
 	ISCSI_RX_DATA_PADDING,
 };
 
+/** Maximum number of concurrent iSCSI tasks */
+#define ISCSI_MAX_TASKS 8
+
+/** An iSCSI task */
+struct iscsi_task {
+	/** iSCSI session */
+	struct iscsi_session *iscsi;
+	/** List of busy or idle tasks */
+	struct list_head list;
+	/** SCSI command interface */
+	struct interface data;
+	/** Task flags */
+	unsigned int flags;
+
+	/** SCSI command */
+	struct scsi_cmd command;
+	/** Initiator task tag */
+	uint32_t itt;
+	/** Command sequence number */
+	uint32_t cmdsn;
+	/** Length of immediate data sent with the command */
+	uint32_t immediate_len;
+	/** Length of unsolicited data (including any immediate data) */
+	uint32_t unsolicited_len;
+
+	/** Target transfer tag
+	 *
+	 * This is the tag attached to the in-progress sequence of
+	 * data-out PDUs.
+	 */
+	uint32_t ttt;
+	/** Transfer offset
+	 *
+	 * This is the offset for the in-progress sequence of
+	 * data-out PDUs.
+	 */
+	uint32_t transfer_offset;
+	/** Transfer length
+	 *
+	 * This is the length for the in-progress sequence of
+	 * data-out PDUs.
+	 */
+	uint32_t transfer_len;
+
+	/** Target transfer tag of pending R2T */
+	uint32_t r2t_ttt;
+	/** Transfer offset of pending R2T */
+	uint32_t r2t_offset;
+	/** Transfer length of pending R2T */
+	uint32_t r2t_len;
+};
+
+/** iSCSI task is in use */
+#define ISCSI_TASK_BUSY 0x0001
+
+/** iSCSI task needs to send its SCSI command PDU */
+#define ISCSI_TASK_TX_COMMAND 0x0002
+
+/** iSCSI task needs to send data-out PDUs in response to an R2T */
+#define ISCSI_TASK_TX_R2T 0x0004
+
 /** An iSCSI session */
 struct iscsi_session {
 	/** Reference counter */
@@ -538,8 +602,6 @@ struct iscsi_session {
 
 	/** SCSI command-issuing interface */
 	struct interface control;
-	/** SCSI command interface */
-	struct interface data;
 	/** Transport-layer socket */
 	struct interface socket;
 
@@ -585,36 +647,26 @@ struct iscsi_session {
 	uint16_t isid_iana_qual;
 	/** Initiator task tag
 	 *
-	 * This is the tag of the current command.  It is incremented
-	 * whenever a new command is started.
+	 * This is the tag used for login requests.  It is assigned
+	 * whenever a new connection is opened.
 	 */
 	uint32_t itt;
-	/** Target transfer tag
-	 *
-	 * This is the tag attached to a sequence of data-out PDUs in
-	 * response to an R2T.
-	 */
-	uint32_t ttt;
-	/** Transfer offset
-	 *
-	 * This is the offset for an in-progress sequence of data-out
-	 * PDUs in response to an R2T.
-	 */
-	uint32_t transfer_offset;
-	/** Transfer length
-	 *
-	 * This is the length for an in-progress sequence of data-out
-	 * PDUs in response to an R2T.
-	 */
-	uint32_t transfer_len;
 	/** Command sequence number
 	 *
-	 * This is the sequence number of the current command, used to
-	 * fill out the CmdSN field in iSCSI request PDUs.  It is
-	 * updated with the value of the ExpCmdSN field whenever we
-	 * receive an iSCSI response PDU containing such a field.
+	 * This is the sequence number to be used for the next
+	 * command, used to fill out the CmdSN field in iSCSI request
+	 * PDUs.  It is initialised from the ExpCmdSN field of the
+	 * login response, and is incremented whenever a new command
+	 * is issued.
 	 */
 	uint32_t cmdsn;
+	/** Maximum command sequence number
+	 *
+	 * This is the most recent value of the MaxCmdSN field in an
+	 * iSCSI response PDU.  No command may be issued with a CmdSN
+	 * beyond this value.
+	 */
+	uint32_t maxcmdsn;
 	/** Status sequence number
 	 *
 	 * This is the most recent status sequence number present in
@@ -624,8 +676,15 @@ struct iscsi_session {
 	 */
 	uint32_t statsn;
 	
+	/** Maximum data segment length accepted by the target */
+	size_t max_send_len;
+	/** Maximum amount of unsolicited data accepted by the target */
+	size_t first_burst_len;
+
 	/** Basic header segment for current TX PDU */
 	union iscsi_bhs tx_bhs;
+	/** Task owning the current TX PDU, if any */
+	struct iscsi_task *tx_task;
 	/** State of the TX engine */
 	enum iscsi_tx_state tx_state;
 	/** TX process */
@@ -642,8 +701,12 @@ struct iscsi_session {
 	/** Buffer for received data (not always used) */
 	void *rx_buffer;
 
-	/** Current SCSI command, if any */
-	struct scsi_cmd *command;
+	/** List of busy tasks, in order of issue */
+	struct list_head busy;
+	/** List of idle tasks */
+	struct list_head idle;
+	/** Tasks */
+	struct iscsi_task task[ISCSI_MAX_TASKS];
 
 	/** Target socket address (for boot firmware table) */
 	struct sockaddr target_sockaddr;
@@ -698,6 +761,24 @@ struct iscsi_session {
 /** Target authenticated itself correctly */
 #define ISCSI_STATUS_AUTH_REVERSE_OK 0x00040000
 
+/** Target accepts immediate data */
+#define ISCSI_STATUS_IMMEDIATE_DATA 0x00080000
+
+/** Target accepts unsolicited data-out PDUs */
+#define ISCSI_STATUS_UNSOLICITED_DATA 0x00100000
+
+/** Maximum data segment length that we are prepared to receive */
+#define ISCSI_MAX_RECV_DATA_SEGMENT_LEN 262144
+
+/** Default maximum data segment length (as per RFC 7143) */
+#define ISCSI_DEFAULT_MAX_RECV_DATA_SEGMENT_LEN 8192
+
+/** Maximum data segment length that we will send in a single PDU */
+#define ISCSI_MAX_SEND_DATA_SEGMENT_LEN 16384
+
+/** Maximum amount of unsolicited data that we will send */
+#define ISCSI_FIRST_BURST_LEN 65536
+
 /** Default initiator IQN prefix */
 #define ISCSI_DEFAULT_IQN_PREFIX "iqn.2010-04.org.ipxe"
 
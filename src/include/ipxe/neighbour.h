@@ -39,6 +39,8 @@ struct neighbour {
 	struct refcnt refcnt;
 	/** List of neighbour cache entries */
 	struct list_head list;
+	/** List of neighbour cache entries within hash table bucket */
+	struct list_head hash;
 
 	/** Network device */
 	struct net_device *netdev;
@@ -287,6 +287,9 @@ struct net_device_error {
 /** Maximum number of unique errors that we will keep track of */
 #define NETDEV_MAX_UNIQUE_ERRORS 4
 
+/** Default number of received packets processed per device per poll */
+#define NETDEV_RX_BUDGET 64
+
 /** Network device statistics */
 struct net_device_stats {
 	/** Count of successful completions */
@@ -419,6 +422,29 @@ struct net_device {
 	struct list_head tx_deferred;
 	/** RX packet queue */
 	struct list_head rx_queue;
+	/** Number of packets in RX packet queue */
+	unsigned int rx_queued;
+	/** RX budget
+	 *
+	 * This is the maximum number of received packets that will be
+	 * processed from the RX packet queue in each call to
+	 * net_poll().  This defaults to NETDEV_RX_BUDGET, and may be
+	 * overridden by the driver.
+	 */
+	unsigned int rx_budget;
+	/** RX budget override
+	 *
+	 * This is the RX budget as configured via the "rx-budget"
+	 * setting, or zero to use the driver's RX budget.
+	 */
+	unsigned int rx_budget_override;
+	/** RX ring fill level
+	 *
+	 * This is the number of receive buffers that the driver
+	 * should keep posted to the hardware, as configured via the
+	 * "rx-ring" setting, or zero to use the driver's default.
+	 */
+	unsigned int rx_ring;
 	/** TX statistics */
 	struct net_device_stats tx_stats;
 	/** RX statistics */
@@ -699,6 +725,39 @@ netdev_rx_frozen ( struct net_device *netdev ) {
 	return ( netdev->state & NETDEV_RX_FROZEN );
 }
 
+/**
+ * Get network device receive ring fill level
+ *
+ * @v netdev		Network device
+ * @v fill		Driver default fill level
+ * @v max		Maximum fill level supported by driver
+ * @ret fill		Receive ring fill level
+ */
+static inline __attribute__ (( always_inline )) unsigned int
+netdev_rx_ring ( struct net_device *netdev, unsigned int fill,
+		 unsigned int max ) {
+
+	if ( netdev->rx_ring )
+		fill = netdev->rx_ring;
+	if ( fill > max )
+		fill = max;
+	return fill;
+}
+
+/**
+ * Get network device RX budget
+ *
+ * @v netdev		Network device
+ * @ret budget		RX budget
+ */
+static inline __attribute__ (( always_inline )) unsigned int
+netdev_rx_budget ( struct net_device *netdev ) {
+
+	if ( netdev->rx_budget_override )
+		return netdev->rx_budget_override;
+	return netdev->rx_budget;
+}
+
 extern void netdev_rx_freeze ( struct net_device *netdev );
 extern void netdev_rx_unfreeze ( struct net_device *netdev );
 extern void netdev_link_err ( struct net_device *netdev, int rc );
@@ -719,6 +778,9 @@ extern void netdev_rx_err ( struct net_device *netdev,
 			    struct io_buffer *iobuf, int rc );
 extern void netdev_poll ( struct net_device *netdev );
 extern struct io_buffer * netdev_rx_dequeue ( struct net_device *netdev );
+extern unsigned int netdev_rx_dequeue_batch ( struct net_device *netdev,
+					      struct list_head *batch,
+					      unsigned int max );
 extern struct net_device * alloc_netdev ( size_t priv_size );
 extern int register_netdev ( struct net_device *netdev );
 extern int netdev_open ( struct net_device *netdev );
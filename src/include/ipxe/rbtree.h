@@ -0,0 +1,92 @@
+#ifndef _IPXE_RBTREE_H
+#define _IPXE_RBTREE_H
+
+/** @file
+ *
+ * Red-black trees
+ *
+ * This is an intrusive red-black tree: the tree node is embedded
+ * within the containing structure, and the caller is responsible for
+ * locating the insertion point (by walking the tree according to its
+ * own ordering) before calling rb_insert().
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stddef.h>
+
+/** A red-black tree node */
+struct rb_node {
+	/** Parent node, or NULL if this is the root node */
+	struct rb_node *parent;
+	/** Left child node (containing lower keys), or NULL */
+	struct rb_node *left;
+	/** Right child node (containing higher keys), or NULL */
+	struct rb_node *right;
+	/** Node is red */
+	int red;
+};
+
+/** A red-black tree */
+struct rb_root {
+	/** Root node, or NULL if tree is empty */
+	struct rb_node *node;
+};
+
+/**
+ * Initialise a static red-black tree
+ *
+ * @v root		Red-black tree
+ */
+#define RB_ROOT_INIT( root ) { NULL }
+
+/**
+ * Get the container of a red-black tree node
+ *
+ * @v node		Red-black tree node
+ * @v type		Containing type
+ * @v member		Name of tree node field within containing type
+ * @ret container	Containing object
+ */
+#define rb_entry( node, type, member ) container_of ( node, type, member )
+
+/**
+ * Get the container of a red-black tree node, or NULL
+ *
+ * @v node		Red-black tree node, or NULL
+ * @v type		Containing type
+ * @v member		Name of tree node field within containing type
+ * @ret container	Containing object, or NULL
+ */
+#define rb_entry_or_null( node, type, member ) ( {			\
+	struct rb_node *__node = (node);				\
+	( __node ? rb_entry ( __node, type, member ) : NULL ); } )
+
+/**
+ * Initialise a red-black tree
+ *
+ * @v root		Red-black tree
+ */
+static inline void rb_init ( struct rb_root *root ) {
+	root->node = NULL;
+}
+
+/**
+ * Test whether a red-black tree is empty
+ *
+ * @v root		Red-black tree
+ * @ret empty		Tree is empty
+ */
+static inline int rb_empty ( struct rb_root *root ) {
+	return ( root->node == NULL );
+}
+
+extern void rb_insert ( struct rb_root *root, struct rb_node *node,
+			struct rb_node *parent, struct rb_node **link );
+extern void rb_erase ( struct rb_root *root, struct rb_node *node );
+extern struct rb_node * rb_first ( struct rb_root *root );
+extern struct rb_node * rb_last ( struct rb_root *root );
+extern struct rb_node * rb_next ( struct rb_node *node );
+extern struct rb_node * rb_prev ( struct rb_node *node );
+
+#endif /* _IPXE_RBTREE_H */
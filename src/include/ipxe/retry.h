@@ -19,7 +19,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 /** A retry timer */
 struct retry_timer {
-	/** List of active timers */
+	/** List of running timers within timer wheel slot */
 	struct list_head list;
 	/** Timer is currently running */
 	unsigned int running;
@@ -81,5 +81,6 @@ struct rsa_context {
 #define RSA_CTX_SIZE sizeof ( struct rsa_context )
 
 extern struct pubkey_algorithm rsa_algorithm;
+extern struct pubkey_algorithm rsa_pss_algorithm;
 
 #endif /* _IPXE_RSA_H */
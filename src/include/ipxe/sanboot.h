@@ -39,10 +39,90 @@ struct san_path {
 	/** Path status */
 	int path_rc;
 
+	/** Number of outstanding commands */
+	unsigned int outstanding;
+	/** Average command latency (in scaled ticks) */
+	unsigned long latency;
+
 	/** ACPI descriptor (if applicable) */
 	struct acpi_descriptor *desc;
 };
 
+/** Maximum number of concurrently outstanding SAN device commands */
+#define SAN_MAX_DEPTH 8
+
+/** A SAN device command */
+struct san_command {
+	/** Containing SAN device */
+	struct san_device *sandev;
+	/** Command interface */
+	struct interface command;
+	/** Command status */
+	int rc;
+	/** SAN path used for command */
+	struct san_path *sanpath;
+	/** Command start time (in ticks) */
+	unsigned long started;
+};
+
+/** Number of lines within a SAN device block cache */
+#define SAN_CACHE_LINES 32
+
+/** A SAN device block cache line */
+struct san_cache_line {
+	/** Containing SAN device */
+	struct san_device *sandev;
+	/** Fill command interface */
+	struct interface fill;
+	/** SAN path used for fill */
+	struct san_path *sanpath;
+	/** Fill start time (in ticks) */
+	unsigned long started;
+	/** Starting (underlying) logical block address */
+	uint64_t lba;
+	/** Flags */
+	unsigned int flags;
+	/** Time of last use (in cache accesses) */
+	unsigned long used;
+};
+
+/** SAN device block cache line flags */
+enum san_cache_line_flags {
+	/** Line contains valid data */
+	SAN_LINE_VALID = 0x0001,
+	/** Line is being filled */
+	SAN_LINE_FILLING = 0x0002,
+	/** Line was written to while being filled */
+	SAN_LINE_STALE = 0x0004,
+};
+
+/** A SAN device block cache */
+struct san_cache {
+	/** Cached data, or UNULL if not yet allocated */
+	userptr_t data;
+	/** Number of underlying blocks per line */
+	unsigned int count;
+	/** Number of lines currently being filled */
+	unsigned int filling;
+	/** Fill wait timer */
+	struct retry_timer timer;
+	/** Cache access counter */
+	unsigned long age;
+
+	/** Expected starting (underlying) LBA of next sequential read */
+	uint64_t next_lba;
+	/** Number of consecutive sequential reads */
+	unsigned int sequential;
+
+	/** Number of reads satisfied entirely from existing lines */
+	unsigned long hits;
+	/** Number of other reads */
+	unsigned long misses;
+
+	/** Lines */
+	struct san_cache_line line[SAN_CACHE_LINES];
+};
+
 /** A SAN device */
 struct san_device {
 	/** Reference count */
@@ -55,12 +135,14 @@ struct san_device {
 	/** Flags */
 	unsigned int flags;
 
-	/** Command interface */
-	struct interface command;
+	/** Commands */
+	struct san_command command[SAN_MAX_DEPTH];
+	/** Number of outstanding commands */
+	unsigned int outstanding;
 	/** Command timeout timer */
 	struct retry_timer timer;
-	/** Command status */
-	int command_rc;
+	/** Block cache */
+	struct san_cache cache;
 
 	/** Raw block device capacity */
 	struct block_device_capacity capacity;
@@ -79,6 +79,8 @@ struct sha256_context {
 /** SHA-224 digest size */
 #define SHA224_DIGEST_SIZE ( SHA256_DIGEST_SIZE * 224 / 256 )
 
+extern const uint32_t sha256_k[SHA256_ROUNDS];
+
 extern void sha256_family_init ( struct sha256_context *context,
 				 const struct sha256_digest *init,
 				 size_t digestsize );
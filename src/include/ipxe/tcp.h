@@ -146,6 +146,8 @@ struct tcp_options {
 	const struct tcp_sack_permitted_option *spopt;
 	/** Timestamp option, if present */
 	const struct tcp_timestamp_option *tsopt;
+	/** Selective acknowledgement option, if present */
+	const struct tcp_sack_option *sackopt;
 };
 
 /** @} */
@@ -327,7 +329,7 @@ struct tcp_options {
 #define TCP_MIN_PORT 1
 
 /**
- * Maxmimum advertised TCP window size
+ * Minimum advertised TCP window size
  *
  * The maximum bandwidth on any link is limited by
  *
@@ -345,15 +347,38 @@ struct tcp_options {
  *    c) WAN: expected bandwidth 2MB/s, typical RTT 100ms, minimum
  *       required window 200kB.
  *
- * The maximum possible value for the TCP window size is 1GB (using
- * the maximum window scale of 2**14).  However, it is advisable to
- * keep the window size as small as possible (without limiting
- * bandwidth), since in the event of a lost packet the window size
- * represents the maximum amount that will need to be retransmitted.
+ * It is advisable to keep the window size as small as possible
+ * (without limiting bandwidth), since in the event of a lost packet
+ * the window size represents the maximum amount that will need to be
+ * retransmitted.
  *
- * We therefore choose a maximum window size of 256kB.
+ * We therefore start each connection with a window size of 256kB,
+ * and allow the window to grow (up to TCP_MAX_WINDOW_SIZE) only when
+ * the measured bandwidth-delay product shows that this is required.
  */
-#define TCP_MAX_WINDOW_SIZE	( 256 * 1024 )
+#define TCP_MIN_WINDOW_SIZE	( 256 * 1024 )
+
+/**
+ * Maximum advertised TCP window size
+ *
+ * Faster links with longer round-trip times (e.g. 10 Gigabit
+ * datacentre links with RTTs of several milliseconds) require much
+ * larger windows.  The receive window is automatically tuned to
+ * twice the amount of data delivered within each measured round-trip
+ * time, up to this limit.  (The limit may be reduced for an
+ * individual network device via the "tcp-window" setting.)
+ *
+ * This must be representable using TCP_RX_WINDOW_SCALE.
+ */
+#define TCP_MAX_WINDOW_SIZE	( 16 * 1024 * 1024 )
+
+/**
+ * Default round-trip time used for receive window auto-tuning
+ *
+ * This value is used only if the peer does not support TCP
+ * timestamps, and so no round-trip time measurement is available.
+ */
+#define TCP_DEFAULT_RTT ( TICKS_PER_SEC / 10 )
 
 /**
  * Path MTU
@@ -372,6 +397,30 @@ struct tcp_options {
 #define TCP_PATH_MTU							\
 	( 1280 - 40 /* IPv6 */ - 20 /* TCP */ - 12 /* TCP timestamp */ )
 
+/**
+ * Initial congestion window
+ *
+ * Use an initial window of ten segments, as per RFC 6928.
+ */
+#define TCP_INITIAL_CWND ( 10 * TCP_PATH_MTU )
+
+/**
+ * Maximum transmit window
+ *
+ * Unacknowledged transmitted data must be retained on the transmit
+ * queue (which is allocated from the heap) until it has been
+ * acknowledged.  We therefore limit both the congestion window and
+ * the amount of data that the application may enqueue for
+ * transmission to a small fraction of the total heap size.
+ */
+#define TCP_MAX_SEND_WINDOW ( 64 * 1024 )
+
+/** Number of duplicate ACKs required to trigger fast retransmission */
+#define TCP_DUPACK_THRESHOLD 3
+
+/** Maximum number of received selective acknowledgement blocks retained */
+#define TCP_SACK_SCOREBOARD_MAX 8
+
 /** TCP maximum segment lifetime
  *
  * Currently set to 2 minutes, as per RFC 793.
@@ -187,6 +187,26 @@ struct tcpip_net_protocol {
 /** Declare a TCP/IP network-layer protocol */
 #define __tcpip_net_protocol __table_entry ( TCPIP_NET_PROTOCOLS, 01 )
 
+/** Number of buckets in a TCP/IP connection hash table */
+#define TCPIP_HASH_BUCKETS 64
+
+/**
+ * Calculate TCP/IP connection hash table bucket
+ *
+ * @v port		Local port number
+ * @ret bucket		Hash table bucket index
+ */
+static inline __attribute__ (( always_inline )) unsigned int
+tcpip_hash ( unsigned int port ) {
+
+	/* Local ports are in general allocated randomly, but may
+	 * also be chosen explicitly from well-known ranges.  Fold
+	 * in the upper bits to avoid clustering for the latter.
+	 */
+	return ( ( port ^ ( port >> 6 ) ^ ( port >> 12 ) ) &
+		 ( TCPIP_HASH_BUCKETS - 1 ) );
+}
+
 extern int tcpip_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 		      uint8_t tcpip_proto, struct sockaddr_tcpip *st_src,
 		      struct sockaddr_tcpip *st_dest, uint16_t pshdr_csum,
@@ -46,8 +46,8 @@ struct tls_header {
 /** TLS version 1.2 */
 #define TLS_VERSION_TLS_1_2 0x0303
 
-/** Maximum supported TLS version */
-#define TLS_VERSION_MAX TLS_VERSION_TLS_1_2
+/** TLS version 1.3 */
+#define TLS_VERSION_TLS_1_3 0x0304
 
 /** Change cipher content type */
 #define TLS_TYPE_CHANGE_CIPHER 20
@@ -66,6 +66,7 @@ struct tls_header {
 #define TLS_CLIENT_HELLO 1
 #define TLS_SERVER_HELLO 2
 #define TLS_NEW_SESSION_TICKET 4
+#define TLS_ENCRYPTED_EXTENSIONS 8
 #define TLS_CERTIFICATE 11
 #define TLS_SERVER_KEY_EXCHANGE 12
 #define TLS_CERTIFICATE_REQUEST 13
@@ -73,6 +74,7 @@ struct tls_header {
 #define TLS_CERTIFICATE_VERIFY 15
 #define TLS_CLIENT_KEY_EXCHANGE 16
 #define TLS_FINISHED 20
+#define TLS_KEY_UPDATE 24
 
 /* TLS alert levels */
 #define TLS_ALERT_WARNING 1
@@ -93,6 +95,18 @@ struct tls_header {
 #define TLS_RSA_WITH_AES_256_GCM_SHA384 0x009d
 #define TLS_DHE_RSA_WITH_AES_128_GCM_SHA256 0x009e
 #define TLS_DHE_RSA_WITH_AES_256_GCM_SHA384 0x009f
+#define TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA 0xc009
+#define TLS_ECDHE_ECDSA_WITH_AES_256_CBC_SHA 0xc00a
+#define TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA 0xc013
+#define TLS_ECDHE_RSA_WITH_AES_256_CBC_SHA 0xc014
+#define TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256 0xc023
+#define TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256 0xc027
+#define TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256 0xc02b
+#define TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384 0xc02c
+#define TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256 0xc02f
+#define TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384 0xc030
+#define TLS_AES_128_GCM_SHA256 0x1301
+#define TLS_AES_256_GCM_SHA384 0x1302
 
 /* TLS hash algorithm identifiers */
 #define TLS_MD5_ALGORITHM 1
@@ -101,9 +115,14 @@ struct tls_header {
 #define TLS_SHA256_ALGORITHM 4
 #define TLS_SHA384_ALGORITHM 5
 #define TLS_SHA512_ALGORITHM 6
+#define TLS_INTRINSIC_ALGORITHM 8
 
 /* TLS signature algorithm identifiers */
 #define TLS_RSA_ALGORITHM 1
+#define TLS_ECDSA_ALGORITHM 3
+#define TLS_RSA_PSS_SHA256_ALGORITHM 4
+#define TLS_RSA_PSS_SHA384_ALGORITHM 5
+#define TLS_RSA_PSS_SHA512_ALGORITHM 6
 
 /* TLS server name extension */
 #define TLS_SERVER_NAME 0
@@ -116,12 +135,37 @@ struct tls_header {
 #define TLS_MAX_FRAGMENT_LENGTH_2048 3
 #define TLS_MAX_FRAGMENT_LENGTH_4096 4
 
+/* TLS named curve (supported groups) extension */
+#define TLS_NAMED_CURVE 10
+#define TLS_NAMED_CURVE_SECP256R1 23
+#define TLS_NAMED_CURVE_X25519 29
+
+/* TLS EC point formats extension */
+#define TLS_POINT_FORMATS 11
+#define TLS_POINT_FORMAT_UNCOMPRESSED 0
+
 /* TLS signature algorithms extension */
 #define TLS_SIGNATURE_ALGORITHMS 13
 
 /* TLS session ticket extension */
 #define TLS_SESSION_TICKET 35
 
+/* TLS pre-shared key extension */
+#define TLS_PRE_SHARED_KEY 41
+
+/** Maximum TLSv1.3 session ticket lifetime (in seconds) */
+#define TLS13_MAX_TICKET_LIFETIME ( 7 * 24 * 60 * 60 )
+
+/* TLS supported versions extension */
+#define TLS_SUPPORTED_VERSIONS 43
+
+/* TLS PSK key exchange modes extension */
+#define TLS_PSK_KEY_EXCHANGE_MODES 45
+#define TLS_PSK_DHE_KE 1
+
+/* TLS key share extension */
+#define TLS_KEY_SHARE 51
+
 /* TLS renegotiation information extension */
 #define TLS_RENEGOTIATION_INFO 0xff01
 
@@ -155,6 +199,7 @@ enum tls_tx_pending {
 	TLS_TX_CERTIFICATE_VERIFY = 0x0008,
 	TLS_TX_CHANGE_CIPHER = 0x0010,
 	TLS_TX_FINISHED = 0x0020,
+	TLS_TX_KEY_UPDATE = 0x0040,
 };
 
 /** A TLS key exchange algorithm */
@@ -206,6 +251,8 @@ struct tls_cipher_suite {
 struct tls_cipherspec {
 	/** Cipher suite */
 	struct tls_cipher_suite *suite;
+	/** Bulk encryption cipher algorithm */
+	struct cipher_algorithm *cipher;
 	/** Dynamically-allocated storage */
 	void *dynamic;
 	/** Public key encryption context */
@@ -249,6 +296,29 @@ struct tls_signature_hash_algorithm {
 #define __tls_sig_hash_algorithm					\
 	__table_entry ( TLS_SIG_HASH_ALGORITHMS, 01 )
 
+/** TLS ECCurveType for a named curve */
+#define TLS_NAMED_CURVE_TYPE 3
+
+/** A TLS named curve */
+struct tls_named_curve {
+	/** Elliptic curve */
+	struct elliptic_curve *curve;
+	/** Numeric code (in network-endian order) */
+	uint16_t code;
+	/** Curve point format byte (if any) */
+	uint8_t format;
+	/** Pre-master secret length */
+	uint8_t pre_master_secret_len;
+};
+
+/** TLS named curve table */
+#define TLS_NAMED_CURVES						\
+	__table ( struct tls_named_curve, "tls_named_curves" )
+
+/** Declare a TLS named curve */
+#define __tls_named_curve( pref )					\
+	__table_entry ( TLS_NAMED_CURVES, pref )
+
 /** TLS client random data */
 struct tls_client_random {
 	/** GMT Unix time */
@@ -301,7 +371,15 @@ struct tls_session {
 	void *ticket;
 	/** Length of session ticket */
 	size_t ticket_len;
-	/** Master secret */
+	/** Session ticket pre-shared key digest algorithm (TLSv1.3 only) */
+	struct digest_algorithm *ticket_digest;
+	/** Session ticket receipt time (TLSv1.3 only) */
+	unsigned long ticket_time;
+	/** Session ticket lifetime in seconds (TLSv1.3 only) */
+	uint32_t ticket_lifetime;
+	/** Session ticket age obfuscation value (TLSv1.3 only) */
+	uint32_t ticket_age_add;
+	/** Master secret (or pre-shared key for TLSv1.3) */
 	uint8_t master_secret[48];
 
 	/** List of connections */
@@ -325,6 +403,18 @@ struct tls_connection {
 	void *new_session_ticket;
 	/** Length of new session ticket */
 	size_t new_session_ticket_len;
+	/** Session ticket (as offered in Client Hello) */
+	void *ticket;
+	/** Length of session ticket */
+	size_t ticket_len;
+	/** Obfuscated session ticket age (TLSv1.3 only) */
+	uint32_t ticket_age;
+	/** Pre-shared key digest algorithm (TLSv1.3 only)
+	 *
+	 * This is non-NULL if and only if a pre-shared key is being
+	 * offered or has been accepted by the server.
+	 */
+	struct digest_algorithm *psk_digest;
 
 	/** Plaintext stream */
 	struct interface plainstream;
@@ -341,8 +431,24 @@ struct tls_connection {
 	struct tls_cipherspec rx_cipherspec;
 	/** Next RX cipher specification */
 	struct tls_cipherspec rx_cipherspec_pending;
-	/** Master secret */
+	/** Master secret (or current key schedule secret for TLSv1.3) */
 	uint8_t master_secret[48];
+	/** Client traffic secret (TLSv1.3 only) */
+	uint8_t client_secret[48];
+	/** Server traffic secret (TLSv1.3 only) */
+	uint8_t server_secret[48];
+	/** Client finished key (TLSv1.3 only) */
+	uint8_t finished_key[48];
+	/** Key shares (as offered in Client Hello, TLSv1.3 only)
+	 *
+	 * This comprises the list of key share entries, followed by
+	 * the corresponding private keys.
+	 */
+	void *key_share;
+	/** Length of key share entries */
+	size_t key_share_len;
+	/** Server has been authenticated (TLSv1.3 only) */
+	int authenticated;
 	/** Server random bytes */
 	uint8_t server_random[32];
 	/** Client random bytes */
@@ -420,6 +526,8 @@ struct tls_connection {
 
 extern struct tls_key_exchange_algorithm tls_pubkey_exchange_algorithm;
 extern struct tls_key_exchange_algorithm tls_dhe_exchange_algorithm;
+extern struct tls_key_exchange_algorithm tls_ecdhe_exchange_algorithm;
+extern struct tls_key_exchange_algorithm tls13_exchange_algorithm;
 
 extern int add_tls ( struct interface *xfer, const char *name,
 		     struct x509_root *root, struct private_key *key );
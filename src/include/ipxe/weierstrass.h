@@ -0,0 +1,113 @@
+#ifndef _IPXE_WEIERSTRASS_H
+#define _IPXE_WEIERSTRASS_H
+
+/** @file
+ *
+ * Weierstrass elliptic curves
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/bigint.h>
+#include <ipxe/crypto.h>
+
+/** Uncompressed point format byte (as used in SEC 1 encodings) */
+#define WEIERSTRASS_UNCOMPRESSED 0x04
+
+/**
+ * Calculate number of big integer elements in a field element
+ *
+ * @v len		Length of raw field element
+ * @ret size		Number of big integer elements
+ *
+ * An extra element is included so that the sum of two field elements
+ * can never overflow.
+ */
+#define weierstrass_size( len ) ( bigint_required_size ( len ) + 1 )
+
+/** A Weierstrass elliptic curve
+ *
+ * Only curves of the form y^2 = x^3 - 3x + b over a prime field (such
+ * as the NIST curves) are supported.
+ */
+struct weierstrass_curve {
+	/** Number of big integer elements in each field element */
+	const unsigned int size;
+	/** Length of raw field elements and scalars */
+	const size_t len;
+	/** Field prime (raw big-endian value) */
+	const uint8_t *prime_raw;
+	/** Constant "b" (raw big-endian value) */
+	const uint8_t *b_raw;
+
+	/** Field prime */
+	bigint_element_t *prime;
+	/** Fermat inversion exponent (p - 2) */
+	bigint_element_t *fermat;
+	/** Montgomery conversion constant (R^2 mod p) */
+	bigint_element_t *square;
+	/** One (in Montgomery form) */
+	bigint_element_t *one;
+	/** Constant "b" (in Montgomery form) */
+	bigint_element_t *b;
+	/** Montgomery reduction constant (or zero if not yet calculated) */
+	bigint_element_t inverse;
+};
+
+extern int weierstrass_multiply ( struct weierstrass_curve *curve,
+				  const void *base, const void *scalar,
+				  void *result );
+extern int weierstrass_add_once ( struct weierstrass_curve *curve,
+				  const void *addend, const void *augend,
+				  void *result );
+
+/**
+ * Define a Weierstrass elliptic curve
+ *
+ * @v _name		Curve name
+ * @v _curve		Elliptic curve to define
+ * @v _len		Length of raw field elements and scalars
+ * @v _prime		Field prime (raw big-endian value)
+ * @v _b		Constant "b" (raw big-endian value)
+ * @v _base		Generator base point (raw X||Y value)
+ * @v _order		Order of the generator (raw big-endian value)
+ */
+#define WEIERSTRASS_CURVE( _name, _curve, _len, _prime, _b, _base,	\
+			   _order )					\
+	static bigint_t ( weierstrass_size ( _len ) )			\
+		_name ## _cache[5];					\
+	static struct weierstrass_curve _name ## _weierstrass = {	\
+		.size = weierstrass_size ( _len ),			\
+		.len = (_len),						\
+		.prime_raw = (_prime),					\
+		.b_raw = (_b),						\
+		.prime = _name ## _cache[0].element,			\
+		.fermat = _name ## _cache[1].element,			\
+		.square = _name ## _cache[2].element,			\
+		.one = _name ## _cache[3].element,			\
+		.b = _name ## _cache[4].element,			\
+	};								\
+	static int _name ## _multiply ( const void *base,		\
+					const void *scalar,		\
+					void *result ) {		\
+		return weierstrass_multiply ( &_name ## _weierstrass,	\
+					      base, scalar, result );	\
+	}								\
+	static int _name ## _add ( const void *addend,			\
+				   const void *augend, void *result ) {	\
+		return weierstrass_add_once ( &_name ## _weierstrass,	\
+					      addend, augend, result );	\
+	}								\
+	struct elliptic_curve _curve = {				\
+		.name = #_name,						\
+		.pointsize = ( 2 * (_len) ),				\
+		.keysize = (_len),					\
+		.base = (_base),					\
+		.order = (_order),					\
+		.multiply = _name ## _multiply,				\
+		.add = _name ## _add,					\
+	}
+
+#endif /* _IPXE_WEIERSTRASS_H */
@@ -0,0 +1,19 @@
+#ifndef _IPXE_X25519_H
+#define _IPXE_X25519_H
+
+/** @file
+ *
+ * X25519 key exchange
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <ipxe/crypto.h>
+
+/** X25519 value length */
+#define X25519_LEN ( 256 / 8 )
+
+extern struct elliptic_curve x25519_curve;
+
+#endif /* _IPXE_X25519_H */
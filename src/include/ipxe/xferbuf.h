@@ -21,6 +21,13 @@ struct xfer_buffer {
 	void *data;
 	/** Size of data */
 	size_t len;
+	/** Size of allocated data buffer
+	 *
+	 * This may exceed the size of the data, to allow for
+	 * geometric growth when the final size is not known in
+	 * advance.
+	 */
+	size_t allocated;
 	/** Current offset within data */
 	size_t pos;
 	/** Data transfer buffer operations */
@@ -90,6 +97,7 @@ xferbuf_umalloc_init ( struct xfer_buffer *xferbuf, userptr_t *data ) {
 }
 
 extern void xferbuf_free ( struct xfer_buffer *xferbuf );
+extern void xferbuf_trim ( struct xfer_buffer *xferbuf );
 extern int xferbuf_write ( struct xfer_buffer *xferbuf, size_t offset,
 			   const void *data, size_t len );
 extern int xferbuf_read ( struct xfer_buffer *xferbuf, size_t offset,
@@ -0,0 +1,16 @@
+#ifndef _USR_DNSMGMT_H
+#define _USR_DNSMGMT_H
+
+/** @file
+ *
+ * DNS cache management
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <ipxe/dns.h>
+
+extern void dnsstat ( void );
+
+#endif /* _USR_DNSMGMT_H */
@@ -31,6 +31,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/retry.h>
 #include <ipxe/timer.h>
 #include <ipxe/malloc.h>
+#include <ipxe/init.h>
 #include <ipxe/neighbour.h>
 
 /** @file
@@ -48,11 +49,45 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Neighbour discovery maximum timeout */
 #define NEIGHBOUR_MAX_TIMEOUT ( TICKS_PER_SEC * 3 )
 
-/** The neighbour cache */
+/** Number of buckets in neighbour cache hash table */
+#define NEIGHBOUR_HASH_BUCKETS 32
+
+/** The neighbour cache
+ *
+ * This list is maintained in order of most recent use, and is used
+ * to identify the oldest entry when discarding cached entries.
+ */
 struct list_head neighbours = LIST_HEAD_INIT ( neighbours );
 
+/** Neighbour cache hash table */
+static struct list_head neighbour_hash[NEIGHBOUR_HASH_BUCKETS];
+
 static void neighbour_expired ( struct retry_timer *timer, int over );
 
+/**
+ * Identify neighbour cache hash table bucket
+ *
+ * @v netdev		Network device
+ * @v net_protocol	Network-layer protocol
+ * @v net_dest		Destination network-layer address
+ * @ret bucket		Hash table bucket
+ */
+static struct list_head * neighbour_bucket ( struct net_device *netdev,
+					     struct net_protocol *net_protocol,
+					     const void *net_dest ) {
+	const uint8_t *bytes = net_dest;
+	unsigned int hash = netdev->index;
+	unsigned int i;
+
+	/* Hash network device and destination network-layer address */
+	for ( i = 0 ; i < net_protocol->net_addr_len ; i++ )
+		hash = ( ( hash * 31 ) + bytes[i] );
+	hash ^= ( hash >> 16 );
+	hash ^= ( hash >> 8 );
+
+	return &neighbour_hash[ hash % NEIGHBOUR_HASH_BUCKETS ];
+}
+
 /**
  * Free neighbour cache entry
  *
@@ -101,6 +136,8 @@ static struct neighbour * neighbour_create ( struct net_device *netdev,
 
 	/* Transfer ownership to cache */
 	list_add ( &neighbour->list, &neighbours );
+	list_add ( &neighbour->hash,
+		   neighbour_bucket ( netdev, net_protocol, net_dest ) );
 
 	DBGC ( neighbour, "NEIGHBOUR %s %s %s created\n", netdev->name,
 	       net_protocol->name, net_protocol->ntoa ( net_dest ) );
@@ -118,9 +155,11 @@ static struct neighbour * neighbour_create ( struct net_device *netdev,
 static struct neighbour * neighbour_find ( struct net_device *netdev,
 					   struct net_protocol *net_protocol,
 					   const void *net_dest ) {
+	struct list_head *bucket =
+		neighbour_bucket ( netdev, net_protocol, net_dest );
 	struct neighbour *neighbour;
 
-	list_for_each_entry ( neighbour, &neighbours, list ) {
+	list_for_each_entry ( neighbour, bucket, hash ) {
 		if ( ( neighbour->netdev == netdev ) &&
 		     ( neighbour->net_protocol == net_protocol ) &&
 		     ( memcmp ( neighbour->net_dest, net_dest,
@@ -223,6 +262,7 @@ static void neighbour_destroy ( struct neighbour *neighbour, int rc ) {
 
 	/* Take ownership from cache */
 	list_del ( &neighbour->list );
+	list_del ( &neighbour->hash );
 
 	/* Stop timer */
 	stop_timer ( &neighbour->timer );
@@ -430,3 +470,20 @@ static unsigned int neighbour_discard ( void ) {
 struct cache_discarder neighbour_discarder __cache_discarder (CACHE_EXPENSIVE)={
 	.discard = neighbour_discard,
 };
+
+/**
+ * Initialise neighbour cache
+ *
+ */
+static void neighbour_init ( void ) {
+	unsigned int i;
+
+	/* Initialise hash table */
+	for ( i = 0 ; i < NEIGHBOUR_HASH_BUCKETS ; i++ )
+		INIT_LIST_HEAD ( &neighbour_hash[i] );
+}
+
+/** Neighbour cache initialisation function */
+struct init_fn neighbour_init_fn __init_fn ( INIT_NORMAL ) = {
+	.initialise = neighbour_init,
+};
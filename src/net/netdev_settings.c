@@ -82,6 +82,18 @@ const struct setting mtu_setting __setting ( SETTING_NETDEV, mtu ) = {
 	.tag = DHCP_MTU,
 };
 
+const struct setting rx_ring_setting __setting ( SETTING_NETDEV, rx-ring ) = {
+	.name = "rx-ring",
+	.description = "Receive ring fill level",
+	.type = &setting_type_uint16,
+};
+const struct setting rx_budget_setting __setting ( SETTING_NETDEV,
+						   rx-budget ) = {
+	.name = "rx-budget",
+	.description = "Received packets processed per poll",
+	.type = &setting_type_uint16,
+};
+
 /**
  * Store link-layer address setting
  *
@@ -429,6 +441,14 @@ static int apply_netdev_settings ( void ) {
 		/* Get network device settings */
 		settings = netdev_settings ( netdev );
 
+		/* Get receive ring fill level (applied on next open) */
+		netdev->rx_ring = fetch_uintz_setting ( settings,
+							&rx_ring_setting );
+
+		/* Get RX budget */
+		netdev->rx_budget_override =
+			fetch_uintz_setting ( settings, &rx_budget_setting );
+
 		/* Get MTU */
 		mtu = fetch_uintz_setting ( settings, &mtu_setting );
 
@@ -64,6 +64,10 @@ static struct profiler net_poll_profiler __profiler = { .name = "net.poll" };
 /** Network receive profiler */
 static struct profiler net_rx_profiler __profiler = { .name = "net.rx" };
 
+/** Network receive batch size profiler */
+static struct profiler net_rx_batch_profiler __profiler =
+	{ .name = "net.rx_batch" };
+
 /** Network transmit profiler */
 static struct profiler net_tx_profiler __profiler = { .name = "net.tx" };
 
@@ -519,6 +523,7 @@ void netdev_rx ( struct net_device *netdev, struct io_buffer *iobuf ) {
 
 	/* Enqueue packet */
 	list_add_tail ( &iobuf->list, &netdev->rx_queue );
+	netdev->rx_queued++;
 
 	/* Update statistics counter */
 	netdev_record_stat ( &netdev->rx_stats, 0 );
@@ -598,9 +603,47 @@ struct io_buffer * netdev_rx_dequeue ( struct net_device *netdev ) {
 		return NULL;
 
 	list_del ( &iobuf->list );
+	netdev->rx_queued--;
 	return iobuf;
 }
 
+/**
+ * Remove batch of packets from device's receive queue
+ *
+ * @v netdev		Network device
+ * @v batch		List to which to append packets
+ * @v max		Maximum number of packets to remove
+ * @ret count		Number of packets removed
+ *
+ * Removes up to @c max packets from the head of the device's RX
+ * queue and appends them (in order) to @c batch.  Ownership of the
+ * packets is transferred to the caller.
+ */
+unsigned int netdev_rx_dequeue_batch ( struct net_device *netdev,
+				       struct list_head *batch,
+				       unsigned int max ) {
+	struct io_buffer *iobuf;
+	unsigned int count;
+
+	/* Move entire queue, if possible */
+	if ( netdev->rx_queued <= max ) {
+		count = netdev->rx_queued;
+		list_splice_tail_init ( &netdev->rx_queue, batch );
+		netdev->rx_queued = 0;
+		return count;
+	}
+
+	/* Otherwise, move packets individually */
+	for ( count = 0 ; count < max ; count++ ) {
+		iobuf = list_first_entry ( &netdev->rx_queue, struct io_buffer,
+					   list );
+		list_del ( &iobuf->list );
+		list_add_tail ( &iobuf->list, batch );
+	}
+	netdev->rx_queued -= count;
+	return count;
+}
+
 /**
  * Flush device's receive queue
  *
@@ -694,6 +737,7 @@ struct net_device * alloc_netdev ( size_t priv_len ) {
 		INIT_LIST_HEAD ( &netdev->tx_queue );
 		INIT_LIST_HEAD ( &netdev->tx_deferred );
 		INIT_LIST_HEAD ( &netdev->rx_queue );
+		netdev->rx_budget = NETDEV_RX_BUDGET;
 		netdev_settings_init ( netdev );
 		config = netdev->configs;
 		for_each_table_entry ( configurator, NET_DEVICE_CONFIGURATORS ){
@@ -1099,28 +1143,89 @@ int net_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 }
 
 /**
- * Poll the network stack
+ * Process batch of received packets
  *
- * This polls all interfaces for received packets, and processes
- * packets from the RX queue.
+ * @v netdev		Network device
+ * @v batch		List of received packets
  */
-void net_poll ( void ) {
-	struct net_device *netdev;
+static void net_rx_batch ( struct net_device *netdev,
+			   struct list_head *batch ) {
+	struct ll_protocol *ll_protocol = netdev->ll_protocol;
 	struct io_buffer *iobuf;
-	struct ll_protocol *ll_protocol;
+	struct io_buffer *tmp;
 	const void *ll_dest;
 	const void *ll_source;
 	uint16_t net_proto;
 	unsigned int flags;
 	int rc;
 
-	/* Poll and process each network device */
+	/* Process each packet in turn */
+	list_for_each_entry_safe ( iobuf, tmp, batch, list ) {
+		list_del ( &iobuf->list );
+
+		/* Discard remaining packets if the device has been
+		 * closed (e.g. by a protocol handling an earlier
+		 * packet).
+		 */
+		if ( ! netdev_is_open ( netdev ) ) {
+			netdev_rx_err ( netdev, iobuf, -ECANCELED );
+			continue;
+		}
+
+		DBGC2 ( netdev, "NETDEV %s processing %p (%p+%zx)\n",
+			netdev->name, iobuf, iobuf->data, iob_len ( iobuf ) );
+		profile_start ( &net_rx_profiler );
+
+		/* Remove link-layer header */
+		if ( ( rc = ll_protocol->pull ( netdev, iobuf, &ll_dest,
+						&ll_source, &net_proto,
+						&flags ) ) != 0 ) {
+			free_iob ( iobuf );
+			continue;
+		}
+
+		/* Hand packet to network layer */
+		if ( ( rc = net_rx ( iob_disown ( iobuf ), netdev, net_proto,
+				     ll_dest, ll_source, flags ) ) != 0 ) {
+			/* Record error for diagnosis */
+			netdev_rx_err ( netdev, NULL, rc );
+		}
+		profile_stop ( &net_rx_profiler );
+	}
+}
+
+/**
+ * Poll the network stack
+ *
+ * This polls all interfaces for received packets, and processes
+ * packets from the RX queue.
+ *
+ * At most one RX budget's worth of packets will be processed from
+ * each device, so that a single busy device cannot starve the
+ * others.  Any remaining packets will be processed on the next poll.
+ * A device will not be polled for further packets while its RX queue
+ * already holds a full budget of unprocessed packets, leaving them in
+ * the hardware ring instead.
+ */
+void net_poll ( void ) {
+	struct net_device *netdev;
+	struct list_head batch;
+	unsigned int count;
+
+	/* Poll each network device */
 	list_for_each_entry ( netdev, &net_devices, list ) {
 
-		/* Poll for new packets */
-		profile_start ( &net_poll_profiler );
-		netdev_poll ( netdev );
-		profile_stop ( &net_poll_profiler );
+		/* Poll for new packets, unless already backlogged */
+		if ( ( netdev->rx_queued < netdev_rx_budget ( netdev ) ) ||
+		     netdev_rx_frozen ( netdev ) ) {
+			profile_start ( &net_poll_profiler );
+			netdev_poll ( netdev );
+			profile_stop ( &net_poll_profiler );
+		}
+	}
+
+	/* Process a batch of received packets from each device */
+	list_for_each_entry ( netdev, &net_devices, list ) {
 
 		/* Leave received packets on the queue if receive
 		 * queue processing is currently frozen.  This will
@@ -1131,33 +1236,17 @@ void net_poll ( void ) {
 		if ( netdev_rx_frozen ( netdev ) )
 			continue;
 
-		/* Process all received packets */
-		while ( ( iobuf = netdev_rx_dequeue ( netdev ) ) ) {
-
-			DBGC2 ( netdev, "NETDEV %s processing %p (%p+%zx)\n",
-				netdev->name, iobuf, iobuf->data,
-				iob_len ( iobuf ) );
-			profile_start ( &net_rx_profiler );
-
-			/* Remove link-layer header */
-			ll_protocol = netdev->ll_protocol;
-			if ( ( rc = ll_protocol->pull ( netdev, iobuf,
-							&ll_dest, &ll_source,
-							&net_proto,
-							&flags ) ) != 0 ) {
-				free_iob ( iobuf );
-				continue;
-			}
-
-			/* Hand packet to network layer */
-			if ( ( rc = net_rx ( iob_disown ( iobuf ), netdev,
-					     net_proto, ll_dest,
-					     ll_source, flags ) ) != 0 ) {
-				/* Record error for diagnosis */
-				netdev_rx_err ( netdev, NULL, rc );
-			}
-			profile_stop ( &net_rx_profiler );
-		}
+		/* Dequeue batch of received packets */
+		INIT_LIST_HEAD ( &batch );
+		count = netdev_rx_dequeue_batch ( netdev, &batch,
+						  netdev_rx_budget ( netdev ) );
+		if ( ! count )
+			continue;
+		if ( PROFILING )
+			profile_update ( &net_rx_batch_profiler, count );
+
+		/* Process batch */
+		net_rx_batch ( netdev, &batch );
 	}
 }
 
@@ -48,8 +48,161 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define MIN_TIMEOUT 7
 
-/** List of running timers */
-static LIST_HEAD ( timers );
+/** Number of bits used to index each timer wheel level */
+#define TIMER_WHEEL_BITS 6
+
+/** Number of slots in each timer wheel level */
+#define TIMER_WHEEL_SIZE ( 1 << TIMER_WHEEL_BITS )
+
+/** Timer wheel slot index mask */
+#define TIMER_WHEEL_MASK ( TIMER_WHEEL_SIZE - 1 )
+
+/** Number of timer wheel levels */
+#define TIMER_WHEEL_LEVELS 4
+
+/** Maximum time until expiry representable within the timer wheel */
+#define TIMER_WHEEL_MAX \
+	( ( 1UL << ( TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS ) ) - 1 )
+
+/** Timer wheel
+ *
+ * Running timers are held in a hierarchical timer wheel.  The lowest
+ * level has one slot for each of the next TIMER_WHEEL_SIZE ticks.
+ * Each subsequent level covers a period TIMER_WHEEL_SIZE times
+ * longer, and timers are cascaded down into lower levels as the
+ * wheel turns.  Starting, stopping and expiring a timer therefore
+ * takes constant time, regardless of the number of running timers.
+ */
+static struct list_head timer_wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE];
+
+/** Next tick to be processed by the timer wheel */
+static unsigned long timer_wheel_tick;
+
+/** List of running timers that have reached their expiry time */
+static LIST_HEAD ( timers_due );
+
+/** Number of running timers */
+static unsigned int timer_count;
+
+/**
+ * Add running timer to timer wheel
+ *
+ * @v timer		Retry timer
+ */
+static void timer_add ( struct retry_timer *timer ) {
+	unsigned long expiry = ( timer->start + timer->timeout );
+	unsigned long delta = ( expiry - timer_wheel_tick );
+	struct list_head *slot;
+	unsigned int level;
+
+	/* Add timers that are already due directly to the due list */
+	if ( ( ( signed long ) delta ) < 0 ) {
+		list_add_tail ( &timer->list, &timers_due );
+		return;
+	}
+
+	/* Limit expiry time to the range covered by the timer wheel.
+	 * The timer will be re-added using its true expiry time when
+	 * it is cascaded down from the highest level.
+	 */
+	if ( delta > TIMER_WHEEL_MAX ) {
+		delta = TIMER_WHEEL_MAX;
+		expiry = ( timer_wheel_tick + delta );
+	}
+
+	/* Add to appropriate slot */
+	for ( level = 0 ; ( delta >> ( ( level + 1 ) * TIMER_WHEEL_BITS ) ) ;
+	      level++ ) {}
+	slot = &timer_wheel[level][ ( expiry >> ( level * TIMER_WHEEL_BITS ) )
+				    & TIMER_WHEEL_MASK ];
+	list_add_tail ( &timer->list, slot );
+}
+
+/**
+ * Cascade timers down from a timer wheel slot
+ *
+ * @v slot		Timer wheel slot
+ */
+static void timer_cascade ( struct list_head *slot ) {
+	struct retry_timer *timer;
+	LIST_HEAD ( cascade );
+
+	/* Re-add each timer relative to the current tick.  Detach
+	 * the slot contents first, since a timer may be re-added to
+	 * the same slot.
+	 */
+	list_splice_init ( slot, &cascade );
+	while ( ( timer = list_first_entry ( &cascade, struct retry_timer,
+					     list ) ) != NULL ) {
+		list_del ( &timer->list );
+		timer_add ( timer );
+	}
+}
+
+/**
+ * Turn timer wheel by one tick
+ *
+ * Any timers expiring at the current tick are moved to the due list.
+ */
+static void timer_turn ( void ) {
+	unsigned int index = ( timer_wheel_tick & TIMER_WHEEL_MASK );
+	unsigned int level;
+
+	/* Cascade timers down from higher levels, if applicable */
+	for ( level = 1 ; ( ( index == 0 ) && ( level < TIMER_WHEEL_LEVELS ) ) ;
+	      level++ ) {
+		index = ( ( timer_wheel_tick >> ( level * TIMER_WHEEL_BITS ) )
+			  & TIMER_WHEEL_MASK );
+		timer_cascade ( &timer_wheel[level][index] );
+	}
+
+	/* Move expiring timers to the due list */
+	index = ( timer_wheel_tick & TIMER_WHEEL_MASK );
+	list_splice_tail_init ( &timer_wheel[0][index], &timers_due );
+	timer_wheel_tick++;
+}
+
+/**
+ * Record timer as running
+ *
+ * @v timer		Retry timer
+ * @v now		Current time
+ */
+static void timer_run ( struct retry_timer *timer, unsigned long now ) {
+	unsigned int level;
+	unsigned int index;
+
+	/* Take ownership of timer */
+	ref_get ( timer->refcnt );
+	timer->running = 1;
+
+	/* If this is the only running timer, then the timer wheel is
+	 * empty and may be restarted from the current time.
+	 */
+	if ( timer_count++ )
+		return;
+	timer_wheel_tick = now;
+
+	/* Initialise timer wheel, if not already done */
+	if ( timer_wheel[0][0].next )
+		return;
+	for ( level = 0 ; level < TIMER_WHEEL_LEVELS ; level++ ) {
+		for ( index = 0 ; index < TIMER_WHEEL_SIZE ; index++ )
+			INIT_LIST_HEAD ( &timer_wheel[level][index] );
+	}
+}
+
+/**
+ * Record timer as no longer running
+ *
+ * @v timer		Retry timer
+ */
+static void timer_unrun ( struct retry_timer *timer ) {
+
+	list_del ( &timer->list );
+	timer->running = 0;
+	timer_count--;
+}
 
 /**
  * Start timer with a specified timeout
@@ -62,20 +215,24 @@ static LIST_HEAD ( timers );
  * be stopped and the timer's callback function will be called.
  */
 void start_timer_fixed ( struct retry_timer *timer, unsigned long timeout ) {
+	unsigned long now = currticks();
 
-	/* Add to list of running timers (if applicable) */
-	if ( ! timer->running ) {
-		list_add ( &timer->list, &timers );
-		ref_get ( timer->refcnt );
-		timer->running = 1;
+	/* Remove from timer wheel, or mark as running (as applicable) */
+	if ( timer->running ) {
+		list_del ( &timer->list );
+	} else {
+		timer_run ( timer, now );
 	}
 
 	/* Record start time */
-	timer->start = currticks();
+	timer->start = now;
 
 	/* Record timeout */
 	timer->timeout = timeout;
 
+	/* Add to timer wheel */
+	timer_add ( timer );
+
 	DBGC2 ( timer, "Timer %p started at time %ld (expires at %ld)\n",
 		timer, timer->start, ( timer->start + timer->timeout ) );
 }
@@ -123,9 +280,8 @@ void stop_timer ( struct retry_timer *timer ) {
 	if ( ! timer->running )
 		return;
 
-	list_del ( &timer->list );
+	timer_unrun ( timer );
 	runtime = ( now - timer->start );
-	timer->running = 0;
 	DBGC2 ( timer, "Timer %p stopped at time %ld (ran for %ld)\n",
 		timer, now, runtime );
 
@@ -172,8 +328,7 @@ static void timer_expired ( struct retry_timer *timer ) {
 	DBGC2 ( timer, "Timer %p stopped at time %ld on expiry\n",
 		timer, currticks() );
 	assert ( timer->running );
-	list_del ( &timer->list );
-	timer->running = 0;
+	timer_unrun ( timer );
 	timer->count++;
 
 	/* Back off the timeout value */
@@ -197,19 +352,24 @@ static void timer_expired ( struct retry_timer *timer ) {
 void retry_poll ( void ) {
 	struct retry_timer *timer;
 	unsigned long now = currticks();
-	unsigned long used;
+	LIST_HEAD ( expired );
+
+	/* Turn timer wheel up to and including the current tick */
+	while ( timer_count &&
+		( ( ( signed long ) ( now - timer_wheel_tick ) ) >= 0 ) ) {
+		timer_turn();
+	}
 
-	/* Process at most one timer expiry.  We cannot process
-	 * multiple expiries in one pass, because one timer expiring
-	 * may end up triggering another timer's deletion from the
-	 * list.
+	/* Process all due timers.  An expiry callback may start or
+	 * stop any other timer (including one that is also due), so
+	 * detach the current due list and always process its first
+	 * remaining entry.  Any timer that becomes due as a result
+	 * of an expiry callback will be processed on the next poll.
 	 */
-	list_for_each_entry ( timer, &timers, list ) {
-		used = ( now - timer->start );
-		if ( used >= timer->timeout ) {
-			timer_expired ( timer );
-			break;
-		}
+	list_splice_init ( &timers_due, &expired );
+	while ( ( timer = list_first_entry ( &expired, struct retry_timer,
+					     list ) ) != NULL ) {
+		timer_expired ( timer );
 	}
 }
 
@@ -6,6 +6,7 @@
 #include <byteswap.h>
 #include <ipxe/timer.h>
 #include <ipxe/iobuf.h>
+#include <ipxe/rbtree.h>
 #include <ipxe/malloc.h>
 #include <ipxe/init.h>
 #include <ipxe/retry.h>
@@ -18,6 +19,7 @@
 #include <ipxe/profile.h>
 #include <ipxe/process.h>
 #include <ipxe/job.h>
+#include <ipxe/settings.h>
 #include <ipxe/tcpip.h>
 #include <ipxe/tcp.h>
 
@@ -35,6 +37,8 @@ struct tcp_connection {
 	struct refcnt refcnt;
 	/** List of TCP connections */
 	struct list_head list;
+	/** List of TCP connections within hash table bucket */
+	struct list_head hash;
 
 	/** Flags */
 	unsigned int flags;
@@ -63,9 +67,19 @@ struct tcp_connection {
 	uint32_t snd_seq;
 	/** Unacknowledged sequence count
 	 *
-	 * Equivalent to (SND.NXT-SND.UNA) in RFC 793 terminology.
+	 * Equivalent to (SND.MAX-SND.UNA) in RFC 793 terminology,
+	 * i.e. the total sequence space ever transmitted beyond the
+	 * current sequence number.
 	 */
 	uint32_t snd_sent;
+	/** Next transmission offset
+	 *
+	 * Equivalent to (SND.NXT-SND.UNA) in RFC 793 terminology.
+	 * This is normally equal to the unacknowledged sequence
+	 * count, but is reset to zero following a retransmission
+	 * timeout.
+	 */
+	uint32_t snd_nxt;
 	/** Send window
 	 *
 	 * Equivalent to SND.WND in RFC 793 terminology
@@ -102,14 +116,80 @@ struct tcp_connection {
 	 * Equivalent to Rcv.Wind.Scale in RFC 1323 terminology
 	 */
 	uint8_t rcv_win_scale;
+	/** Maximum receive window
+	 *
+	 * This is the automatically tuned upper bound on the
+	 * advertised receive window.
+	 */
+	uint32_t rcv_win_max;
+	/** Receive window auto-tuning limit */
+	uint32_t rcv_win_limit;
+	/** Receive window auto-tuning measurement start sequence */
+	uint32_t rcv_tune_seq;
+	/** Receive window auto-tuning measurement start time (in ticks) */
+	unsigned long rcv_tune_time;
+	/** Smoothed round-trip time (in ticks, scaled by 8) */
+	unsigned long srtt;
 
 	/** Selective acknowledgement list (in host-endian order) */
 	struct tcp_sack_block sack[TCP_SACK_MAX];
 
+	/** Congestion control algorithm */
+	struct tcp_congestion_control *cc;
+	/** Congestion window
+	 *
+	 * Equivalent to cwnd in RFC 5681 terminology.
+	 */
+	uint32_t cwnd;
+	/** Slow start threshold
+	 *
+	 * Equivalent to ssthresh in RFC 5681 terminology.
+	 */
+	uint32_t ssthresh;
+	/** Congestion avoidance acknowledged byte counter */
+	uint32_t cwnd_acked;
+	/** Number of consecutive duplicate ACKs received */
+	unsigned int dupacks;
+	/** Recovery point (in host-endian order)
+	 *
+	 * Equivalent to "recover" in RFC 6582 terminology.
+	 */
+	uint32_t recover;
+	/** Next SEQ value to consider for retransmission during fast
+	 * recovery (in host-endian order)
+	 */
+	uint32_t rtx_seq;
+	/** Received selective acknowledgement scoreboard
+	 *
+	 * This is a sorted list of non-overlapping blocks (in
+	 * host-endian order) that the peer has reported as received.
+	 */
+	struct tcp_sack_block snd_sack[TCP_SACK_SCOREBOARD_MAX];
+	/** Number of blocks in received selective acknowledgement
+	 * scoreboard
+	 */
+	unsigned int snd_sacks;
+	/** CUBIC congestion window before most recent reduction */
+	uint32_t cubic_wmax;
+	/** CUBIC congestion window at which the cubic function is
+	 * centred
+	 */
+	uint32_t cubic_origin;
+	/** CUBIC Reno-friendly congestion window estimate */
+	uint32_t cubic_west;
+	/** CUBIC time period to reach origin (in ticks) */
+	unsigned long cubic_k;
+	/** CUBIC congestion avoidance epoch start time (in ticks) */
+	unsigned long cubic_epoch;
+
 	/** Transmit queue */
 	struct list_head tx_queue;
-	/** Receive queue */
-	struct list_head rx_queue;
+	/** Receive queue
+	 *
+	 * This is a tree of out-of-order received data ranges,
+	 * ordered by sequence number.
+	 */
+	struct rb_root rx_queue;
 	/** Transmission process */
 	struct process process;
 	/** Retransmission timer */
@@ -135,18 +215,45 @@ enum tcp_flags {
 	TCP_ACK_PENDING = 0x0004,
 	/** TCP selective acknowledgement is enabled */
 	TCP_SACK_ENABLED = 0x0008,
+	/** TCP is in fast recovery */
+	TCP_RECOVERY = 0x0010,
+	/** CUBIC congestion avoidance epoch has started */
+	TCP_CUBIC_EPOCH = 0x0020,
+};
+
+/** A TCP congestion control algorithm */
+struct tcp_congestion_control {
+	/** Name */
+	const char *name;
+	/**
+	 * Increase congestion window during congestion avoidance
+	 *
+	 * @v tcp		TCP connection
+	 * @v acked		Length of newly acknowledged data
+	 */
+	void ( * avoid ) ( struct tcp_connection *tcp, uint32_t acked );
+	/**
+	 * Calculate slow start threshold following congestion
+	 *
+	 * @v tcp		TCP connection
+	 * @ret ssthresh	Slow start threshold
+	 */
+	uint32_t ( * ssthresh ) ( struct tcp_connection *tcp );
 };
 
-/** TCP internal header
+/** A range of contiguous out-of-order received data
  *
- * This is the header that replaces the TCP header for packets
- * enqueued on the receive queue.
+ * Adjacent received packets are coalesced into a single range, so
+ * that the number of ranges in the receive queue is bounded by the
+ * number of holes in the received sequence space rather than by the
+ * number of received packets.
  */
-struct tcp_rx_queued_header {
-	/** SEQ value, in host-endian order
+struct tcp_rx_range {
+	/** Node in receive queue */
+	struct rb_node node;
+	/** SEQ value of start of range, in host-endian order
 	 *
-	 * This represents the SEQ value at the time the packet is
-	 * enqueued, and so excludes the SYN, if present.
+	 * This excludes the SYN, if present.
 	 */
 	uint32_t seq;
 	/** Next SEQ value, in host-endian order */
@@ -158,8 +265,8 @@ struct tcp_rx_queued_header {
 	 * enqueued.
 	 */
 	uint8_t flags;
-	/** Reserved */
-	uint8_t reserved[3];
+	/** I/O buffers, in sequence order */
+	struct list_head iobufs;
 };
 
 /**
@@ -167,6 +274,11 @@ struct tcp_rx_queued_header {
  */
 static LIST_HEAD ( tcp_conns );
 
+/**
+ * Hash table of registered TCP connections, indexed by local port
+ */
+static struct list_head tcp_hash[TCPIP_HASH_BUCKETS];
+
 /** Transmit profiler */
 static struct profiler tcp_tx_profiler __profiler = { .name = "tcp.tx" };
 
@@ -176,6 +288,25 @@ static struct profiler tcp_rx_profiler __profiler = { .name = "tcp.rx" };
 /** Data transfer profiler */
 static struct profiler tcp_xfer_profiler __profiler = { .name = "tcp.xfer" };
 
+/** Demultiplexing profiler */
+static struct profiler tcp_demux_profiler __profiler = { .name = "tcp.demux" };
+
+/** TCP congestion control algorithm setting */
+const struct setting tcp_congestion_setting __setting ( SETTING_NETDEV_EXTRA,
+							 tcp-congestion ) = {
+	.name = "tcp-congestion",
+	.description = "TCP congestion control algorithm",
+	.type = &setting_type_string,
+};
+
+/** TCP receive window limit setting */
+const struct setting tcp_window_setting __setting ( SETTING_NETDEV_EXTRA,
+						     tcp-window ) = {
+	.name = "tcp-window",
+	.description = "Maximum TCP receive window",
+	.type = &setting_type_uint32,
+};
+
 /* Forward declarations */
 static struct process_descriptor tcp_process_desc;
 static struct interface_descriptor tcp_xfer_desc;
@@ -185,6 +316,9 @@ static void tcp_wait_expired ( struct retry_timer *timer, int over );
 static struct tcp_connection * tcp_demux ( unsigned int local_port );
 static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 			uint32_t win );
+static size_t tcp_process_tx_queue ( struct tcp_connection *tcp,
+				     size_t offset, size_t max_len,
+				     struct io_buffer *dest, int remove );
 
 /**
  * Name TCP state
@@ -244,6 +378,332 @@ tcp_dump_flags ( struct tcp_connection *tcp, unsigned int flags ) {
 		DBGC2 ( tcp, " ACK" );
 }
 
+/***************************************************************************
+ *
+ * Congestion control
+ *
+ ***************************************************************************
+ */
+
+/**
+ * Increase congestion window during NewReno congestion avoidance
+ *
+ * @v tcp		TCP connection
+ * @v acked		Length of newly acknowledged data
+ *
+ * Increase the congestion window by one segment per round-trip time,
+ * as per RFC 5681 (using appropriate byte counting).
+ */
+static void tcp_newreno_avoid ( struct tcp_connection *tcp,
+				uint32_t acked ) {
+
+	tcp->cwnd_acked += acked;
+	if ( tcp->cwnd_acked >= tcp->cwnd ) {
+		tcp->cwnd_acked -= tcp->cwnd;
+		tcp->cwnd += TCP_PATH_MTU;
+	}
+}
+
+/**
+ * Calculate NewReno slow start threshold
+ *
+ * @v tcp		TCP connection
+ * @ret ssthresh	Slow start threshold
+ */
+static uint32_t tcp_newreno_ssthresh ( struct tcp_connection *tcp ) {
+	uint32_t ssthresh = ( tcp->snd_sent / 2 );
+
+	/* Use half of the flight size, as per RFC 5681 */
+	if ( ssthresh < ( 2 * TCP_PATH_MTU ) )
+		ssthresh = ( 2 * TCP_PATH_MTU );
+	return ssthresh;
+}
+
+/** NewReno congestion control */
+static struct tcp_congestion_control tcp_newreno = {
+	.name = "newreno",
+	.avoid = tcp_newreno_avoid,
+	.ssthresh = tcp_newreno_ssthresh,
+};
+
+/** CUBIC multiplicative decrease factor (scaled by 1024) */
+#define TCP_CUBIC_BETA 717
+
+/** CUBIC scaling constant (scaled by 1024) */
+#define TCP_CUBIC_C 410
+
+/** CUBIC Reno-friendly additive increase factor (scaled by 1024)
+ *
+ * This is 3 * ( 1 - beta ) / ( 1 + beta ), as per RFC 8312.
+ */
+#define TCP_CUBIC_ALPHA 542
+
+/** Maximum time offset used in CUBIC window calculation (in ticks)
+ *
+ * This limits the range of the cubic function to avoid overflow.
+ */
+#define TCP_CUBIC_MAX_T ( 16 * TICKS_PER_SEC )
+
+/**
+ * Calculate integer cube root
+ *
+ * @v value		Value
+ * @ret root		Cube root (rounded down)
+ *
+ * The value must be less than 2^63.
+ */
+static unsigned long tcp_cbrt ( uint64_t value ) {
+	uint64_t candidate;
+	unsigned long root = 0;
+	int bit;
+
+	for ( bit = 20 ; bit >= 0 ; bit-- ) {
+		candidate = ( root | ( 1UL << bit ) );
+		if ( ( candidate * candidate * candidate ) <= value )
+			root = candidate;
+	}
+	return root;
+}
+
+/**
+ * Increase congestion window during CUBIC congestion avoidance
+ *
+ * @v tcp		TCP connection
+ * @v acked		Length of newly acknowledged data
+ *
+ * Grow the congestion window towards the cubic function
+ *
+ *    W(t) = C * ( t - K )^3 + origin
+ *
+ * as per RFC 8312, or towards the Reno-friendly estimate if larger.
+ */
+static void tcp_cubic_avoid ( struct tcp_connection *tcp, uint32_t acked ) {
+	unsigned long now = currticks();
+	unsigned long rtt;
+	unsigned long t;
+	unsigned long offset;
+	uint64_t cube;
+	uint32_t delta;
+	uint32_t target;
+	uint32_t increment;
+
+	/* Start new epoch, if applicable */
+	if ( ! ( tcp->flags & TCP_CUBIC_EPOCH ) ) {
+		tcp->flags |= TCP_CUBIC_EPOCH;
+		tcp->cubic_epoch = now;
+		tcp->cubic_west = tcp->cwnd;
+		tcp->cwnd_acked = 0;
+		if ( tcp->cwnd < tcp->cubic_wmax ) {
+			cube = ( tcp->cubic_wmax - tcp->cwnd );
+			cube *= ( 1024ULL * TICKS_PER_SEC * TICKS_PER_SEC *
+				  TICKS_PER_SEC );
+			cube /= ( TCP_CUBIC_C * TCP_PATH_MTU );
+			tcp->cubic_k = tcp_cbrt ( cube );
+			tcp->cubic_origin = tcp->cubic_wmax;
+		} else {
+			tcp->cubic_k = 0;
+			tcp->cubic_origin = tcp->cwnd;
+		}
+	}
+
+	/* Calculate cubic window one round-trip time from now */
+	rtt = ( tcp->srtt ? ( tcp->srtt >> 3 ) : TCP_DEFAULT_RTT );
+	t = ( now - tcp->cubic_epoch + rtt );
+	offset = ( ( t > tcp->cubic_k ) ? ( t - tcp->cubic_k ) :
+		   ( tcp->cubic_k - t ) );
+	if ( offset > TCP_CUBIC_MAX_T )
+		offset = TCP_CUBIC_MAX_T;
+	cube = ( ( ( uint64_t ) offset ) * offset * offset );
+	cube = ( ( cube * TCP_CUBIC_C * TCP_PATH_MTU ) /
+		 ( 1024ULL * TICKS_PER_SEC * TICKS_PER_SEC * TICKS_PER_SEC ) );
+	delta = ( ( cube < TCP_MAX_SEND_WINDOW ) ? cube : TCP_MAX_SEND_WINDOW );
+	if ( t > tcp->cubic_k ) {
+		target = ( tcp->cubic_origin + delta );
+	} else {
+		target = ( ( tcp->cubic_origin > delta ) ?
+			   ( tcp->cubic_origin - delta ) : 0 );
+	}
+
+	/* Update Reno-friendly estimate */
+	tcp->cubic_west += ( ( ( ( acked * TCP_CUBIC_ALPHA ) >> 10 ) *
+			       TCP_PATH_MTU ) / tcp->cubic_west );
+	if ( target < tcp->cubic_west )
+		target = tcp->cubic_west;
+
+	/* Grow congestion window towards target, by at most half of
+	 * the acknowledged data length.
+	 */
+	if ( target > tcp->cwnd ) {
+		increment = ( ( ( ( uint64_t ) ( target - tcp->cwnd ) ) *
+				acked ) / tcp->cwnd );
+		if ( increment > ( acked / 2 ) )
+			increment = ( acked / 2 );
+		tcp->cwnd += increment;
+	}
+}
+
+/**
+ * Calculate CUBIC slow start threshold
+ *
+ * @v tcp		TCP connection
+ * @ret ssthresh	Slow start threshold
+ */
+static uint32_t tcp_cubic_ssthresh ( struct tcp_connection *tcp ) {
+	uint32_t ssthresh;
+
+	/* Record window before reduction, allowing for fast convergence */
+	if ( tcp->cwnd < tcp->cubic_wmax ) {
+		tcp->cubic_wmax = ( ( tcp->cwnd * ( 1024 + TCP_CUBIC_BETA ) )
+				    / 2048 );
+	} else {
+		tcp->cubic_wmax = tcp->cwnd;
+	}
+
+	/* End current epoch */
+	tcp->flags &= ~TCP_CUBIC_EPOCH;
+
+	/* Reduce by multiplicative decrease factor */
+	ssthresh = ( ( tcp->cwnd * TCP_CUBIC_BETA ) / 1024 );
+	if ( ssthresh < ( 2 * TCP_PATH_MTU ) )
+		ssthresh = ( 2 * TCP_PATH_MTU );
+	return ssthresh;
+}
+
+/** CUBIC congestion control */
+static struct tcp_congestion_control tcp_cubic = {
+	.name = "cubic",
+	.avoid = tcp_cubic_avoid,
+	.ssthresh = tcp_cubic_ssthresh,
+};
+
+/** TCP congestion control algorithms (default first) */
+static struct tcp_congestion_control *tcp_congestion_controls[] = {
+	&tcp_newreno,
+	&tcp_cubic,
+};
+
+/**
+ * Find TCP congestion control algorithm
+ *
+ * @v settings		Settings block, or NULL
+ * @ret cc		Congestion control algorithm
+ */
+static struct tcp_congestion_control *
+tcp_congestion_find ( struct settings *settings ) {
+	struct tcp_congestion_control *cc;
+	char name[16];
+	unsigned int i;
+
+	/* Use default algorithm if none is specified */
+	cc = tcp_congestion_controls[0];
+	if ( fetch_string_setting ( settings, &tcp_congestion_setting,
+				   name, sizeof ( name ) ) < 0 )
+		return cc;
+
+	/* Identify algorithm */
+	for ( i = 0 ; i < ARRAY_SIZE ( tcp_congestion_controls ) ; i++ ) {
+		if ( strcmp ( tcp_congestion_controls[i]->name, name ) == 0 )
+			return tcp_congestion_controls[i];
+	}
+
+	DBG ( "TCP unknown congestion control algorithm \"%s\"\n", name );
+	return cc;
+}
+
+/**
+ * Increase congestion window after acknowledgement of new data
+ *
+ * @v tcp		TCP connection
+ * @v acked		Length of newly acknowledged data
+ */
+static void tcp_congestion_ack ( struct tcp_connection *tcp,
+				 uint32_t acked ) {
+
+	/* Do nothing if the congestion window is already at maximum */
+	if ( tcp->cwnd >= TCP_MAX_SEND_WINDOW )
+		return;
+
+	/* Use slow start or congestion avoidance as applicable */
+	if ( tcp->cwnd < tcp->ssthresh ) {
+		tcp->cwnd += ( ( acked < TCP_PATH_MTU ) ?
+			       acked : TCP_PATH_MTU );
+	} else {
+		tcp->cc->avoid ( tcp, acked );
+	}
+}
+
+/***************************************************************************
+ *
+ * Receive queue
+ *
+ ***************************************************************************
+ */
+
+/**
+ * Find received data range
+ *
+ * @v tcp		TCP connection
+ * @v seq		SEQ value (in host-endian order)
+ * @ret range		Highest range which does not start after SEQ, or NULL
+ */
+static struct tcp_rx_range * tcp_rx_range_find ( struct tcp_connection *tcp,
+						 uint32_t seq ) {
+	struct rb_node *node = tcp->rx_queue.node;
+	struct tcp_rx_range *range;
+	struct tcp_rx_range *found = NULL;
+
+	while ( node ) {
+		range = rb_entry ( node, struct tcp_rx_range, node );
+		if ( tcp_cmp ( range->seq, seq ) > 0 ) {
+			node = node->left;
+		} else {
+			found = range;
+			node = node->right;
+		}
+	}
+	return found;
+}
+
+/**
+ * Add received data range to receive queue
+ *
+ * @v tcp		TCP connection
+ * @v range		Received data range
+ */
+static void tcp_rx_range_add ( struct tcp_connection *tcp,
+			       struct tcp_rx_range *range ) {
+	struct rb_node **link = &tcp->rx_queue.node;
+	struct rb_node *parent = NULL;
+	struct tcp_rx_range *tmp;
+
+	while ( *link ) {
+		parent = *link;
+		tmp = rb_entry ( parent, struct tcp_rx_range, node );
+		link = ( ( tcp_cmp ( range->seq, tmp->seq ) < 0 ) ?
+			 &parent->left : &parent->right );
+	}
+	rb_insert ( &tcp->rx_queue, &range->node, parent, link );
+}
+
+/**
+ * Remove and free received data range
+ *
+ * @v tcp		TCP connection
+ * @v range		Received data range
+ */
+static void tcp_rx_range_free ( struct tcp_connection *tcp,
+				struct tcp_rx_range *range ) {
+	struct io_buffer *iobuf;
+	struct io_buffer *tmp;
+
+	rb_erase ( &tcp->rx_queue, &range->node );
+	list_for_each_entry_safe ( iobuf, tmp, &range->iobufs, list ) {
+		list_del ( &iobuf->list );
+		free_iob ( iobuf );
+	}
+	free ( range );
+}
+
 /***************************************************************************
  *
  * Open and close
@@ -262,6 +722,25 @@ static int tcp_port_available ( int port ) {
 	return ( tcp_demux ( port ) ? -EADDRINUSE : port );
 }
 
+/**
+ * Determine receive window auto-tuning limit
+ *
+ * @v settings		Settings block, or NULL
+ * @ret limit		Maximum receive window
+ */
+static uint32_t tcp_window_limit ( struct settings *settings ) {
+	unsigned long limit;
+
+	/* Use per-device limit, if specified */
+	if ( ( fetch_uint_setting ( settings, &tcp_window_setting,
+				    &limit ) >= 0 ) &&
+	     ( limit < TCP_MAX_WINDOW_SIZE ) ) {
+		return limit;
+	}
+
+	return TCP_MAX_WINDOW_SIZE;
+}
+
 /**
  * Open a TCP connection
  *
@@ -275,6 +754,8 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	struct sockaddr_tcpip *st_peer = ( struct sockaddr_tcpip * ) peer;
 	struct sockaddr_tcpip *st_local = ( struct sockaddr_tcpip * ) local;
 	struct tcp_connection *tcp;
+	struct net_device *netdev;
+	struct settings *settings;
 	size_t mtu;
 	int port;
 	int rc;
@@ -294,8 +775,11 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	tcp->tcp_state = TCP_STATE_SENT ( TCP_SYN );
 	tcp_dump_state ( tcp );
 	tcp->snd_seq = random();
+	tcp->recover = tcp->snd_seq;
+	tcp->cwnd = TCP_INITIAL_CWND;
+	tcp->ssthresh = ~( ( uint32_t ) 0 );
 	INIT_LIST_HEAD ( &tcp->tx_queue );
-	INIT_LIST_HEAD ( &tcp->rx_queue );
+	rb_init ( &tcp->rx_queue );
 	memcpy ( &tcp->peer, st_peer, sizeof ( tcp->peer ) );
 
 	/* Calculate MSS */
@@ -308,6 +792,20 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	}
 	tcp->mss = ( mtu - sizeof ( struct tcp_header ) );
 
+	/* Apply any per-device settings */
+	netdev = tcpip_netdev ( &tcp->peer );
+	settings = ( netdev ? netdev_settings ( netdev ) : NULL );
+	tcp->cc = tcp_congestion_find ( settings );
+	DBGC ( tcp, "TCP %p using %s congestion control\n",
+	       tcp, tcp->cc->name );
+
+	/* Initialise receive window auto-tuning */
+	tcp->rcv_win_limit = tcp_window_limit ( settings );
+	tcp->rcv_win_max = TCP_MIN_WINDOW_SIZE;
+	if ( tcp->rcv_win_max > tcp->rcv_win_limit )
+		tcp->rcv_win_max = tcp->rcv_win_limit;
+	tcp->rcv_tune_time = currticks();
+
 	/* Bind to local port */
 	port = tcpip_bind ( st_local, tcp_port_available );
 	if ( port < 0 ) {
@@ -330,6 +828,7 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	 */
 	intf_plug_plug ( &tcp->xfer, xfer );
 	list_add ( &tcp->list, &tcp_conns );
+	list_add ( &tcp->hash, &tcp_hash[ tcpip_hash ( tcp->local_port ) ] );
 	return 0;
 
  err:
@@ -347,6 +846,7 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
  * a suitable state, the connection will be deleted.
  */
 static void tcp_close ( struct tcp_connection *tcp, int rc ) {
+	struct tcp_rx_range *range;
 	struct io_buffer *iobuf;
 	struct io_buffer *tmp;
 
@@ -365,9 +865,10 @@ static void tcp_close ( struct tcp_connection *tcp, int rc ) {
 		tcp_dump_state ( tcp );
 
 		/* Free any unprocessed I/O buffers */
-		list_for_each_entry_safe ( iobuf, tmp, &tcp->rx_queue, list ) {
-			list_del ( &iobuf->list );
-			free_iob ( iobuf );
+		while ( ( range = rb_entry_or_null ( rb_first ( &tcp->rx_queue ),
+						     struct tcp_rx_range,
+						     node ) ) ) {
+			tcp_rx_range_free ( tcp, range );
 		}
 
 		/* Free any unsent I/O buffers */
@@ -388,6 +889,7 @@ static void tcp_close ( struct tcp_connection *tcp, int rc ) {
 		stop_timer ( &tcp->keepalive );
 		stop_timer ( &tcp->wait );
 		list_del ( &tcp->list );
+		list_del ( &tcp->hash );
 		ref_put ( &tcp->refcnt );
 		DBGC ( tcp, "TCP %p connection deleted\n", tcp );
 		return;
@@ -430,14 +932,24 @@ static void tcp_close ( struct tcp_connection *tcp, int rc ) {
  * @ret len		Maximum length that can be sent in a single packet
  */
 static size_t tcp_xmit_win ( struct tcp_connection *tcp ) {
+	uint32_t win;
 	size_t len;
 
 	/* Not ready if we're not in a suitable connection state */
 	if ( ! TCP_CAN_SEND_DATA ( tcp->tcp_state ) )
 		return 0;
 
-	/* Length is the minimum of the receiver's window and the path MTU */
-	len = tcp->snd_win;
+	/* Window is the minimum of the receiver's window and the
+	 * congestion window.
+	 */
+	win = tcp->snd_win;
+	if ( win > tcp->cwnd )
+		win = tcp->cwnd;
+
+	/* Length is the remaining window, limited to the path MTU */
+	if ( tcp->snd_nxt >= win )
+		return 0;
+	len = ( win - tcp->snd_nxt );
 	if ( len > TCP_PATH_MTU )
 		len = TCP_PATH_MTU;
 
@@ -451,16 +963,26 @@ static size_t tcp_xmit_win ( struct tcp_connection *tcp ) {
  * @ret len		Length of window
  */
 static size_t tcp_xfer_window ( struct tcp_connection *tcp ) {
+	size_t win;
+	size_t queued;
 
-	/* Not ready if data queue is non-empty.  This imposes a limit
-	 * of only one unACKed packet in the TX queue at any time; we
-	 * do this to conserve memory usage.
-	 */
-	if ( ! list_empty ( &tcp->tx_queue ) )
+	/* Not ready if we're not in a suitable connection state */
+	if ( ! TCP_CAN_SEND_DATA ( tcp->tcp_state ) )
 		return 0;
 
-	/* Return TCP window length */
-	return tcp_xmit_win ( tcp );
+	/* Limit the amount of queued data to the minimum of the
+	 * receiver's window and the congestion window, and to the
+	 * maximum transmit window in order to conserve memory.
+	 */
+	win = tcp->snd_win;
+	if ( win > tcp->cwnd )
+		win = tcp->cwnd;
+	if ( win > TCP_MAX_SEND_WINDOW )
+		win = TCP_MAX_SEND_WINDOW;
+	queued = tcp_process_tx_queue ( tcp, 0, win, NULL, 0 );
+
+	/* Return remaining window length */
+	return ( win - queued );
 }
 
 /**
@@ -473,31 +995,19 @@ static size_t tcp_xfer_window ( struct tcp_connection *tcp ) {
  */
 static uint32_t tcp_sack_block ( struct tcp_connection *tcp, uint32_t seq,
 				 struct tcp_sack_block *sack ) {
-	struct io_buffer *iobuf;
-	struct tcp_rx_queued_header *tcpqhdr;
-	uint32_t left = tcp->rcv_ack;
-	uint32_t right = left;
-
-	/* Find highest block which does not start after SEQ */
-	list_for_each_entry ( iobuf, &tcp->rx_queue, list ) {
-		tcpqhdr = iobuf->data;
-		if ( tcp_cmp ( tcpqhdr->seq, right ) > 0 ) {
-			if ( tcp_cmp ( tcpqhdr->seq, seq ) > 0 )
-				break;
-			left = tcpqhdr->seq;
-		}
-		if ( tcp_cmp ( tcpqhdr->nxt, right ) > 0 )
-			right = tcpqhdr->nxt;
-	}
+	struct tcp_rx_range *range;
 
-	/* Fail if this block does not contain SEQ */
-	if ( tcp_cmp ( right, seq ) < 0 )
+	/* Find highest range which does not start after SEQ */
+	range = tcp_rx_range_find ( tcp, seq );
+
+	/* Fail if this range does not contain SEQ */
+	if ( ( ! range ) || ( tcp_cmp ( range->nxt, seq ) < 0 ) )
 		return 0;
 
 	/* Populate SACK block */
-	sack->left = left;
-	sack->right = right;
-	return ( right - left );
+	sack->left = range->seq;
+	sack->right = range->nxt;
+	return ( range->nxt - range->seq );
 }
 
 /**
@@ -555,30 +1065,41 @@ static unsigned int tcp_sack ( struct tcp_connection *tcp, uint32_t seq ) {
  * Process TCP transmit queue
  *
  * @v tcp		TCP connection
+ * @v offset		Offset within transmit queue
  * @v max_len		Maximum length to process
  * @v dest		I/O buffer to fill with data, or NULL
  * @v remove		Remove data from queue
  * @ret len		Length of data processed
  *
  * This processes at most @c max_len bytes from the TCP connection's
- * transmit queue.  Data will be copied into the @c dest I/O buffer
- * (if provided) and, if @c remove is true, removed from the transmit
- * queue.
+ * transmit queue, starting at @c offset bytes from the start of the
+ * queue.  Data will be copied into the @c dest I/O buffer (if
+ * provided) and, if @c remove is true, removed from the transmit
+ * queue.  Data may be removed only from the start of the queue.
  */
-static size_t tcp_process_tx_queue ( struct tcp_connection *tcp, size_t max_len,
+static size_t tcp_process_tx_queue ( struct tcp_connection *tcp,
+				     size_t offset, size_t max_len,
 				     struct io_buffer *dest, int remove ) {
 	struct io_buffer *iobuf;
 	struct io_buffer *tmp;
 	size_t frag_len;
 	size_t len = 0;
 
+	/* Sanity check */
+	assert ( ! ( remove && offset ) );
+
 	list_for_each_entry_safe ( iobuf, tmp, &tcp->tx_queue, list ) {
 		frag_len = iob_len ( iobuf );
+		if ( offset >= frag_len ) {
+			offset -= frag_len;
+			continue;
+		}
+		frag_len -= offset;
 		if ( frag_len > max_len )
 			frag_len = max_len;
 		if ( dest ) {
-			memcpy ( iob_put ( dest, frag_len ), iobuf->data,
-				 frag_len );
+			memcpy ( iob_put ( dest, frag_len ),
+				 ( iobuf->data + offset ), frag_len );
 		}
 		if ( remove ) {
 			iob_pull ( iobuf, frag_len );
@@ -588,6 +1109,7 @@ static size_t tcp_process_tx_queue ( struct tcp_connection *tcp, size_t max_len,
 				pending_put ( &tcp->pending_data );
 			}
 		}
+		offset = 0;
 		len += frag_len;
 		max_len -= frag_len;
 	}
@@ -595,18 +1117,20 @@ static size_t tcp_process_tx_queue ( struct tcp_connection *tcp, size_t max_len,
 }
 
 /**
- * Transmit any outstanding data (with selective acknowledgement)
+ * Transmit segment
  *
  * @v tcp		TCP connection
+ * @v offset		Offset of segment from current sequence number
+ * @v len		Length of data payload
  * @v sack_seq		SEQ for first selective acknowledgement (if any)
- * 
- * Transmits any outstanding data on the connection.
+ * @ret rc		Return status code
  *
  * Note that even if an error is returned, the retransmission timer
  * will have been started if necessary, and so the stack will
  * eventually attempt to retransmit the failed packet.
  */
-static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
+static int tcp_xmit_segment ( struct tcp_connection *tcp, uint32_t offset,
+			      size_t len, uint32_t sack_seq ) {
 	struct io_buffer *iobuf;
 	struct tcp_header *tcphdr;
 	struct tcp_mss_option *mssopt;
@@ -619,65 +1143,53 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	unsigned int flags;
 	unsigned int sack_count;
 	unsigned int i;
-	size_t len = 0;
 	size_t sack_len;
+	uint32_t seq;
 	uint32_t seq_len;
 	uint32_t max_rcv_win;
 	uint32_t max_representable_win;
 	int rc;
 
-	/* Start profiling */
-	profile_start ( &tcp_tx_profiler );
-
-	/* If retransmission timer is already running, do nothing */
-	if ( timer_running ( &tcp->timer ) )
-		return;
-
-	/* Calculate both the actual (payload) and sequence space
-	 * lengths that we wish to transmit.
+	/* Calculate the sequence space length.  SYN and FIN may be
+	 * sent only at the current sequence number (since we never
+	 * send data with a SYN, and never send a FIN until all data
+	 * has been acknowledged).
 	 */
-	if ( TCP_CAN_SEND_DATA ( tcp->tcp_state ) ) {
-		len = tcp_process_tx_queue ( tcp, tcp_xmit_win ( tcp ),
-					     NULL, 0 );
-	}
-	seq_len = len;
+	seq = ( tcp->snd_seq + offset );
 	flags = TCP_FLAGS_SENDING ( tcp->tcp_state );
+	if ( offset )
+		flags &= ~( TCP_SYN | TCP_FIN );
+	seq_len = len;
 	if ( flags & ( TCP_SYN | TCP_FIN ) ) {
 		/* SYN or FIN consume one byte, and we can never send both */
 		assert ( ! ( ( flags & TCP_SYN ) && ( flags & TCP_FIN ) ) );
 		seq_len++;
 	}
-	tcp->snd_sent = seq_len;
-
-	/* If we have nothing to transmit, stop now */
-	if ( ( seq_len == 0 ) && ! ( tcp->flags & TCP_ACK_PENDING ) )
-		return;
 
 	/* If we are transmitting anything that requires
 	 * acknowledgement (i.e. consumes sequence space), start the
 	 * retransmission timer.  Do this before attempting to
 	 * allocate the I/O buffer, in case allocation itself fails.
 	 */
-	if ( seq_len )
+	if ( seq_len && ! timer_running ( &tcp->timer ) )
 		start_timer ( &tcp->timer );
 
 	/* Allocate I/O buffer */
 	iobuf = alloc_iob ( len + TCP_MAX_HEADER_LEN );
 	if ( ! iobuf ) {
 		DBGC ( tcp, "TCP %p could not allocate iobuf for %08x..%08x "
-		       "%08x\n", tcp, tcp->snd_seq, ( tcp->snd_seq + seq_len ),
-		       tcp->rcv_ack );
-		return;
+		       "%08x\n", tcp, seq, ( seq + seq_len ), tcp->rcv_ack );
+		return -ENOMEM;
 	}
 	iob_reserve ( iobuf, TCP_MAX_HEADER_LEN );
 
 	/* Fill data payload from transmit queue */
-	tcp_process_tx_queue ( tcp, len, iobuf, 0 );
+	tcp_process_tx_queue ( tcp, offset, len, iobuf, 0 );
 
 	/* Expand receive window if possible */
 	max_rcv_win = xfer_window ( &tcp->xfer );
-	if ( max_rcv_win > TCP_MAX_WINDOW_SIZE )
-		max_rcv_win = TCP_MAX_WINDOW_SIZE;
+	if ( max_rcv_win > tcp->rcv_win_max )
+		max_rcv_win = tcp->rcv_win_max;
 	max_representable_win = ( 0xffff << tcp->rcv_win_scale );
 	if ( max_rcv_win > max_representable_win )
 		max_rcv_win = max_representable_win;
@@ -711,7 +1223,7 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 		tsopt->tsopt.tsecr = htonl ( tcp->ts_recent );
 	}
 	if ( ( tcp->flags & TCP_SACK_ENABLED ) &&
-	     ( ! list_empty ( &tcp->rx_queue ) ) &&
+	     ( ! rb_empty ( &tcp->rx_queue ) ) &&
 	     ( ( sack_count = tcp_sack ( tcp, sack_seq ) ) != 0 ) ) {
 		sack_len = ( sack_count * sizeof ( *sack ) );
 		sackopt = iob_push ( iobuf, ( sizeof ( *sackopt ) + sack_len ));
@@ -731,7 +1243,7 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	memset ( tcphdr, 0, sizeof ( *tcphdr ) );
 	tcphdr->src = htons ( tcp->local_port );
 	tcphdr->dest = tcp->peer.st_port;
-	tcphdr->seq = htonl ( tcp->snd_seq );
+	tcphdr->seq = htonl ( seq );
 	tcphdr->ack = htonl ( tcp->rcv_ack );
 	tcphdr->hlen = ( ( payload - iobuf->data ) << 2 );
 	tcphdr->flags = flags;
@@ -746,18 +1258,72 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	tcp_dump_flags ( tcp, tcphdr->flags );
 	DBGC2 ( tcp, "\n" );
 
+	/* Record transmitted sequence space */
+	if ( ( offset + seq_len ) > tcp->snd_nxt )
+		tcp->snd_nxt = ( offset + seq_len );
+	if ( tcp->snd_nxt > tcp->snd_sent )
+		tcp->snd_sent = tcp->snd_nxt;
+
 	/* Transmit packet */
 	if ( ( rc = tcpip_tx ( iobuf, &tcp_protocol, NULL, &tcp->peer, NULL,
 			       &tcphdr->csum ) ) != 0 ) {
 		DBGC ( tcp, "TCP %p could not transmit %08x..%08x %08x: %s\n",
-		       tcp, tcp->snd_seq, ( tcp->snd_seq + tcp->snd_sent ),
-		       tcp->rcv_ack, strerror ( rc ) );
-		return;
+		       tcp, seq, ( seq + seq_len ), tcp->rcv_ack,
+		       strerror ( rc ) );
+		return rc;
 	}
 
 	/* Clear ACK-pending flag */
 	tcp->flags &= ~TCP_ACK_PENDING;
 
+	return 0;
+}
+
+/**
+ * Transmit any outstanding data (with selective acknowledgement)
+ *
+ * @v tcp		TCP connection
+ * @v sack_seq		SEQ for first selective acknowledgement (if any)
+ * 
+ * Transmits as much outstanding data as the send and congestion
+ * windows allow, followed by a pure ACK if required.
+ */
+static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
+	unsigned int flags;
+	size_t len;
+	int sent = 0;
+	int rc;
+
+	/* Start profiling */
+	profile_start ( &tcp_tx_profiler );
+
+	/* Transmit segments until the window is exhausted */
+	while ( 1 ) {
+
+		/* Calculate both the actual (payload) and sequence
+		 * space lengths that we wish to transmit.
+		 */
+		len = tcp_process_tx_queue ( tcp, tcp->snd_nxt,
+					     tcp_xmit_win ( tcp ), NULL, 0 );
+		flags = ( tcp->snd_nxt ? 0 :
+			  TCP_FLAGS_SENDING ( tcp->tcp_state ) );
+		if ( ! ( len || ( flags & ( TCP_SYN | TCP_FIN ) ) ) )
+			break;
+
+		/* Transmit segment */
+		if ( ( rc = tcp_xmit_segment ( tcp, tcp->snd_nxt, len,
+					       sack_seq ) ) != 0 )
+			return;
+		sent = 1;
+	}
+
+	/* Transmit a pure ACK, if required */
+	if ( ( ! sent ) && ( tcp->flags & TCP_ACK_PENDING ) ) {
+		if ( ( rc = tcp_xmit_segment ( tcp, tcp->snd_nxt, 0,
+					       sack_seq ) ) != 0 )
+			return;
+	}
+
 	profile_stop ( &tcp_tx_profiler );
 }
 
@@ -772,6 +1338,55 @@ static void tcp_xmit ( struct tcp_connection *tcp ) {
 	tcp_xmit_sack ( tcp, tcp->rcv_ack );
 }
 
+/**
+ * Retransmit next lost segment during fast recovery
+ *
+ * @v tcp		TCP connection
+ *
+ * The first unacknowledged segment is always considered to be lost.
+ * Any other data is considered to be lost only if it lies in a hole
+ * below a block reported via selective acknowledgement.
+ */
+static void tcp_xmit_lost ( struct tcp_connection *tcp ) {
+	struct tcp_sack_block *sack = NULL;
+	uint32_t seq;
+	uint32_t end;
+	uint32_t len;
+	unsigned int i;
+
+	/* Find next hole, skipping any selectively acknowledged data */
+	seq = tcp->rtx_seq;
+	if ( tcp_cmp ( seq, tcp->snd_seq ) < 0 )
+		seq = tcp->snd_seq;
+	for ( i = 0 ; i < tcp->snd_sacks ; i++ ) {
+		sack = &tcp->snd_sack[i];
+		if ( tcp_cmp ( seq, sack->left ) < 0 )
+			break;
+		if ( tcp_cmp ( seq, sack->right ) < 0 )
+			seq = sack->right;
+	}
+	if ( i < tcp->snd_sacks ) {
+		end = sack->left;
+	} else if ( seq == tcp->snd_seq ) {
+		end = ( seq + TCP_PATH_MTU );
+	} else {
+		return;
+	}
+
+	/* Retransmit (at most) one segment from the hole */
+	len = ( end - seq );
+	if ( len > TCP_PATH_MTU )
+		len = TCP_PATH_MTU;
+	len = tcp_process_tx_queue ( tcp, ( seq - tcp->snd_seq ), len,
+				     NULL, 0 );
+	if ( ! len )
+		return;
+	DBGC ( tcp, "TCP %p retransmitting %08x..%08x\n",
+	       tcp, seq, ( seq + len ) );
+	tcp_xmit_segment ( tcp, ( seq - tcp->snd_seq ), len, tcp->rcv_ack );
+	tcp->rtx_seq = ( seq + len );
+}
+
 /** TCP process descriptor */
 static struct process_descriptor tcp_process_desc =
 	PROC_DESC_ONCE ( struct tcp_connection, process, tcp_xmit );
@@ -805,7 +1420,19 @@ static void tcp_expired ( struct retry_timer *timer, int over ) {
 		tcp_dump_state ( tcp );
 		tcp_close ( tcp, -ETIMEDOUT );
 	} else {
-		/* Otherwise, retransmit the packet */
+		/* Otherwise, treat all outstanding data as lost and
+		 * retransmit, as per RFC 5681.
+		 */
+		if ( TCP_HAS_BEEN_ESTABLISHED ( tcp->tcp_state ) ) {
+			tcp->ssthresh = tcp->cc->ssthresh ( tcp );
+			tcp->cwnd = TCP_PATH_MTU;
+			tcp->cwnd_acked = 0;
+			tcp->recover = ( tcp->snd_seq + tcp->snd_sent );
+		}
+		tcp->flags &= ~TCP_RECOVERY;
+		tcp->dupacks = 0;
+		tcp->snd_sacks = 0;
+		tcp->snd_nxt = 0;
 		tcp_xmit ( tcp );
 	}
 }
@@ -927,9 +1554,10 @@ static int tcp_xmit_reset ( struct tcp_connection *tcp,
  * @ret tcp		TCP connection, or NULL
  */
 static struct tcp_connection * tcp_demux ( unsigned int local_port ) {
+	struct list_head *bucket = &tcp_hash[ tcpip_hash ( local_port ) ];
 	struct tcp_connection *tcp;
 
-	list_for_each_entry ( tcp, &tcp_conns, list ) {
+	list_for_each_entry ( tcp, bucket, hash ) {
 		if ( tcp->local_port == local_port )
 			return tcp;
 	}
@@ -989,7 +1617,8 @@ static int tcp_rx_opts ( struct tcp_connection *tcp,
 			min = sizeof ( *options->spopt );
 			break;
 		case TCP_OPTION_SACK:
-			/* Ignore received SACKs */
+			options->sackopt = data;
+			min = sizeof ( *options->sackopt );
 			break;
 		case TCP_OPTION_TS:
 			options->tsopt = data;
@@ -1074,6 +1703,8 @@ static int tcp_rx_syn ( struct tcp_connection *tcp, uint32_t seq,
 	/* Synchronise sequence numbers on first SYN */
 	if ( ! ( tcp->tcp_state & TCP_STATE_RCVD ( TCP_SYN ) ) ) {
 		tcp->rcv_ack = seq;
+		tcp->rcv_tune_seq = seq;
+		tcp->rcv_tune_time = currticks();
 		if ( options->tsopt )
 			tcp->flags |= TCP_TS_ENABLED;
 		if ( options->spopt )
@@ -1104,6 +1735,159 @@ static int tcp_rx_syn ( struct tcp_connection *tcp, uint32_t seq,
 	return 0;
 }
 
+/**
+ * Add block to received selective acknowledgement scoreboard
+ *
+ * @v tcp		TCP connection
+ * @v left		Left edge of block (in host-endian order)
+ * @v right		Right edge of block (in host-endian order)
+ */
+static void tcp_rx_sack_block ( struct tcp_connection *tcp, uint32_t left,
+				uint32_t right ) {
+	struct tcp_sack_block *sack;
+	unsigned int i;
+
+	/* Absorb any overlapping or adjacent blocks */
+	for ( i = 0 ; i < tcp->snd_sacks ; ) {
+		sack = &tcp->snd_sack[i];
+		if ( ( tcp_cmp ( sack->left, right ) <= 0 ) &&
+		     ( tcp_cmp ( sack->right, left ) >= 0 ) ) {
+			if ( tcp_cmp ( sack->left, left ) < 0 )
+				left = sack->left;
+			if ( tcp_cmp ( sack->right, right ) > 0 )
+				right = sack->right;
+			tcp->snd_sacks--;
+			memmove ( sack, ( sack + 1 ),
+				  ( ( tcp->snd_sacks - i ) *
+				    sizeof ( *sack ) ) );
+		} else {
+			i++;
+		}
+	}
+
+	/* Find insertion point */
+	for ( i = 0 ; i < tcp->snd_sacks ; i++ ) {
+		if ( tcp_cmp ( left, tcp->snd_sack[i].left ) < 0 )
+			break;
+	}
+
+	/* Discard highest block if scoreboard is full */
+	if ( tcp->snd_sacks == TCP_SACK_SCOREBOARD_MAX ) {
+		if ( i == TCP_SACK_SCOREBOARD_MAX )
+			return;
+		tcp->snd_sacks--;
+	}
+
+	/* Insert block */
+	sack = &tcp->snd_sack[i];
+	memmove ( ( sack + 1 ), sack,
+		  ( ( tcp->snd_sacks - i ) * sizeof ( *sack ) ) );
+	sack->left = left;
+	sack->right = right;
+	tcp->snd_sacks++;
+}
+
+/**
+ * Handle TCP received selective acknowledgements
+ *
+ * @v tcp		TCP connection
+ * @v sackopt		Selective acknowledgement option
+ */
+static void tcp_rx_sack ( struct tcp_connection *tcp,
+			  const struct tcp_sack_option *sackopt ) {
+	const struct tcp_sack_block *sack;
+	unsigned int count;
+	uint32_t left;
+	uint32_t right;
+
+	/* Process each block */
+	sack = ( ( ( const void * ) sackopt ) + sizeof ( *sackopt ) );
+	count = ( ( sackopt->length - sizeof ( *sackopt ) ) /
+		  sizeof ( *sack ) );
+	for ( ; count-- ; sack++ ) {
+
+		/* Ignore blocks outside the unacknowledged sequence space */
+		left = ntohl ( sack->left );
+		right = ntohl ( sack->right );
+		if ( ( tcp_cmp ( left, tcp->snd_seq ) <= 0 ) ||
+		     ( tcp_cmp ( right, left ) <= 0 ) ||
+		     ( tcp_cmp ( right, ( tcp->snd_seq +
+					  tcp->snd_sent ) ) > 0 ) ) {
+			continue;
+		}
+
+		/* Add to scoreboard */
+		tcp_rx_sack_block ( tcp, left, right );
+	}
+}
+
+/**
+ * Discard acknowledged blocks from selective acknowledgement scoreboard
+ *
+ * @v tcp		TCP connection
+ */
+static void tcp_rx_sack_trim ( struct tcp_connection *tcp ) {
+	unsigned int discard;
+
+	/* Discard blocks lying entirely below the current SEQ */
+	for ( discard = 0 ; discard < tcp->snd_sacks ; discard++ ) {
+		if ( tcp_cmp ( tcp->snd_sack[discard].right,
+			       tcp->snd_seq ) > 0 )
+			break;
+	}
+	tcp->snd_sacks -= discard;
+	memmove ( tcp->snd_sack, &tcp->snd_sack[discard],
+		  ( tcp->snd_sacks * sizeof ( tcp->snd_sack[0] ) ) );
+
+	/* Trim any partially acknowledged block */
+	if ( tcp->snd_sacks &&
+	     ( tcp_cmp ( tcp->snd_sack[0].left, tcp->snd_seq ) < 0 ) ) {
+		tcp->snd_sack[0].left = tcp->snd_seq;
+	}
+}
+
+/**
+ * Handle TCP received duplicate ACK
+ *
+ * @v tcp		TCP connection
+ */
+static void tcp_rx_dupack ( struct tcp_connection *tcp ) {
+
+	/* Inflate congestion window and retransmit any further lost
+	 * data if already in fast recovery, as per RFC 6582.
+	 */
+	if ( tcp->flags & TCP_RECOVERY ) {
+		tcp->cwnd += TCP_PATH_MTU;
+		tcp_xmit_lost ( tcp );
+		return;
+	}
+
+	/* Do nothing more until the threshold is reached */
+	if ( ++tcp->dupacks < TCP_DUPACK_THRESHOLD )
+		return;
+
+	/* Do not enter fast recovery again until all data that was
+	 * outstanding at the start of the previous recovery (or
+	 * timeout) has been acknowledged.
+	 */
+	if ( tcp_cmp ( ( tcp->snd_seq - 1 ), tcp->recover ) <= 0 )
+		return;
+
+	/* Enter fast recovery */
+	tcp->ssthresh = tcp->cc->ssthresh ( tcp );
+	tcp->cwnd = ( tcp->ssthresh + ( TCP_DUPACK_THRESHOLD * TCP_PATH_MTU ) );
+	tcp->cwnd_acked = 0;
+	tcp->recover = ( tcp->snd_seq + tcp->snd_sent );
+	tcp->rtx_seq = tcp->snd_seq;
+	tcp->flags |= TCP_RECOVERY;
+	DBGC ( tcp, "TCP %p entering fast recovery for %08x..%08x (cwnd %d, "
+	       "ssthresh %d)\n", tcp, tcp->snd_seq, tcp->recover, tcp->cwnd,
+	       tcp->ssthresh );
+
+	/* Retransmit first unacknowledged segment */
+	tcp_xmit_lost ( tcp );
+}
+
 /**
  * Handle TCP received ACK
  *
@@ -1167,11 +1951,39 @@ static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 
 	/* Update SEQ and sent counters */
 	tcp->snd_seq = ack;
-	tcp->snd_sent = 0;
+	tcp->snd_sent -= ack_len;
+	tcp->snd_nxt = ( ( tcp->snd_nxt > ack_len ) ?
+			 ( tcp->snd_nxt - ack_len ) : 0 );
 
 	/* Remove any acknowledged data from transmit queue */
-	tcp_process_tx_queue ( tcp, len, NULL, 1 );
-		
+	tcp_process_tx_queue ( tcp, 0, len, NULL, 1 );
+	tcp_rx_sack_trim ( tcp );
+
+	/* Restart the retransmission timer if data remains outstanding */
+	if ( tcp->snd_sent )
+		start_timer ( &tcp->timer );
+
+	/* Update congestion window */
+	tcp->dupacks = 0;
+	if ( ! ( tcp->flags & TCP_RECOVERY ) ) {
+		tcp_congestion_ack ( tcp, len );
+	} else if ( tcp_cmp ( ack, tcp->recover ) >= 0 ) {
+		/* Full acknowledgement: exit fast recovery and deflate
+		 * congestion window to the slow start threshold.
+		 */
+		tcp->flags &= ~TCP_RECOVERY;
+		tcp->cwnd = tcp->ssthresh;
+		DBGC ( tcp, "TCP %p leaving fast recovery (cwnd %d)\n",
+		       tcp, tcp->cwnd );
+	} else {
+		/* Partial acknowledgement: deflate congestion window
+		 * and retransmit next lost segment, as per RFC 6582.
+		 */
+		tcp->cwnd -= ( ( len < tcp->cwnd ) ? len : tcp->cwnd );
+		tcp->cwnd += TCP_PATH_MTU;
+		tcp_xmit_lost ( tcp );
+	}
+
 	/* Mark SYN/FIN as acknowledged if applicable. */
 	if ( acked_flags )
 		tcp->tcp_state |= TCP_STATE_ACKED ( acked_flags );
@@ -1187,6 +1999,78 @@ static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 	return 0;
 }
 
+/**
+ * Update round-trip time estimate
+ *
+ * @v tcp		TCP connection
+ * @v tsecr		Echoed timestamp (in host-endian order)
+ */
+static void tcp_rx_rtt ( struct tcp_connection *tcp, uint32_t tsecr ) {
+	unsigned long rtt;
+
+	/* Ignore timestamps that we cannot have sent */
+	rtt = ( currticks() - tsecr );
+	if ( ( tsecr == 0 ) || ( rtt > TCP_MSL ) )
+		return;
+
+	/* Round-trip times below the timer resolution count as one tick */
+	if ( ! rtt )
+		rtt = 1;
+
+	/* Update smoothed round-trip time (RFC 6298) */
+	if ( tcp->srtt ) {
+		tcp->srtt -= ( tcp->srtt >> 3 );
+		tcp->srtt += rtt;
+	} else {
+		tcp->srtt = ( rtt << 3 );
+	}
+}
+
+/**
+ * Automatically tune receive window
+ *
+ * @v tcp		TCP connection
+ *
+ * The maximum receive window is grown to twice the amount of data
+ * delivered within the most recent round-trip time, allowing the
+ * sender's congestion window to continue to grow.  Growth is limited
+ * by the per-connection limit and by the amount of free heap memory
+ * (which is where any out-of-order segments will be queued).
+ */
+static void tcp_rx_autotune ( struct tcp_connection *tcp ) {
+	unsigned long now = currticks();
+	unsigned long rtt;
+	uint32_t delivered;
+	uint32_t target;
+
+	/* Wait until a full round-trip time has elapsed */
+	rtt = ( tcp->srtt ? ( ( tcp->srtt + 7 ) >> 3 ) : TCP_DEFAULT_RTT );
+	if ( ( now - tcp->rcv_tune_time ) < rtt )
+		return;
+
+	/* Calculate data delivered and restart measurement */
+	delivered = ( tcp->rcv_ack - tcp->rcv_tune_seq );
+	tcp->rcv_tune_seq = tcp->rcv_ack;
+	tcp->rcv_tune_time = now;
+
+	/* Calculate target window */
+	target = ( ( delivered < ( tcp->rcv_win_limit / 2 ) ) ?
+		   ( 2 * delivered ) : tcp->rcv_win_limit );
+	if ( target <= tcp->rcv_win_max )
+		return;
+
+	/* Limit growth to half of the remaining free heap memory */
+	if ( ( target - tcp->rcv_win_max ) > ( freemem / 2 ) )
+		target = ( tcp->rcv_win_max + ( freemem / 2 ) );
+	if ( target <= tcp->rcv_win_max )
+		return;
+
+	DBGC ( tcp, "TCP %p RX window grown to %dkB (RTT %ld ticks, "
+	       "%dkB delivered)\n", tcp, ( target / 1024 ), rtt,
+	       ( delivered / 1024 ) );
+	tcp->rcv_win_max = target;
+}
+
 /**
  * Handle TCP received data
  *
@@ -1216,6 +2100,9 @@ static int tcp_rx_data ( struct tcp_connection *tcp, uint32_t seq,
 	/* Acknowledge new data */
 	tcp_rx_seq ( tcp, len );
 
+	/* Automatically tune receive window */
+	tcp_rx_autotune ( tcp );
+
 	/* Deliver data to application */
 	profile_start ( &tcp_xfer_profiler );
 	if ( ( rc = xfer_deliver_iob ( &tcp->xfer, iobuf ) ) != 0 ) {
@@ -1284,6 +2171,27 @@ static int tcp_rx_rst ( struct tcp_connection *tcp, uint32_t seq ) {
 	return -ECONNRESET;
 }
 
+/**
+ * Deliver received TCP packet
+ *
+ * @v tcp		TCP connection
+ * @v seq		SEQ value (in host-endian order)
+ * @v flags		TCP flags
+ * @v iobuf		I/O buffer
+ */
+static void tcp_rx_deliver ( struct tcp_connection *tcp, uint32_t seq,
+			     uint8_t flags, struct io_buffer *iobuf ) {
+	size_t len = iob_len ( iobuf );
+
+	/* Handle new data, if any */
+	tcp_rx_data ( tcp, seq, iob_disown ( iobuf ) );
+	seq += len;
+
+	/* Handle FIN, if present */
+	if ( flags & TCP_FIN )
+		tcp_rx_fin ( tcp, seq );
+}
+
 /**
  * Enqueue received TCP packet
  *
@@ -1291,11 +2199,17 @@ static int tcp_rx_rst ( struct tcp_connection *tcp, uint32_t seq ) {
  * @v seq		SEQ value (in host-endian order)
  * @v flags		TCP flags
  * @v iobuf		I/O buffer
+ *
+ * In-order packets received while the receive queue is empty are
+ * delivered immediately.  Out-of-order packets are trimmed to remove
+ * any data already present in the receive queue, and then coalesced
+ * with any adjacent received data ranges.
  */
 static void tcp_rx_enqueue ( struct tcp_connection *tcp, uint32_t seq,
 			     uint8_t flags, struct io_buffer *iobuf ) {
-	struct tcp_rx_queued_header *tcpqhdr;
-	struct io_buffer *queued;
+	struct tcp_rx_range *prev;
+	struct tcp_rx_range *next;
+	struct tcp_rx_range *range;
 	size_t len;
 	uint32_t seq_len;
 	uint32_t nxt;
@@ -1317,25 +2231,90 @@ static void tcp_rx_enqueue ( struct tcp_connection *tcp, uint32_t seq,
 	 */
 	if ( ( ! ( tcp->tcp_state & TCP_STATE_RCVD ( TCP_SYN ) ) ) ||
 	     ( tcp_cmp ( seq, tcp->rcv_ack + tcp->rcv_win ) >= 0 ) ||
-	     ( tcp_cmp ( nxt, tcp->rcv_ack ) < 0 ) ||
+	     ( tcp_cmp ( nxt, tcp->rcv_ack ) <= 0 ) ||
 	     ( seq_len == 0 ) ) {
-		free_iob ( iobuf );
+		goto discard;
+	}
+
+	/* Strip any previously received data */
+	if ( tcp_cmp ( seq, tcp->rcv_ack ) < 0 ) {
+		iob_pull ( iobuf, ( tcp->rcv_ack - seq ) );
+		seq = tcp->rcv_ack;
+	}
+
+	/* Deliver immediately if nothing is queued ahead of this packet */
+	if ( rb_empty ( &tcp->rx_queue ) && ( seq == tcp->rcv_ack ) ) {
+		tcp_rx_deliver ( tcp, seq, flags, iob_disown ( iobuf ) );
 		return;
 	}
 
-	/* Add internal header */
-	tcpqhdr = iob_push ( iobuf, sizeof ( *tcpqhdr ) );
-	tcpqhdr->seq = seq;
-	tcpqhdr->nxt = nxt;
-	tcpqhdr->flags = flags;
+	/* Find neighbouring ranges */
+	prev = tcp_rx_range_find ( tcp, seq );
+	next = rb_entry_or_null ( ( prev ? rb_next ( &prev->node ) :
+				    rb_first ( &tcp->rx_queue ) ),
+				  struct tcp_rx_range, node );
 
-	/* Add to RX queue */
-	list_for_each_entry ( queued, &tcp->rx_queue, list ) {
-		tcpqhdr = queued->data;
-		if ( tcp_cmp ( seq, tcpqhdr->seq ) < 0 )
-			break;
+	/* Nothing may follow a FIN */
+	if ( prev && ( prev->flags & TCP_FIN ) )
+		goto discard;
+
+	/* Trim any data overlapping the preceding range */
+	if ( prev && ( tcp_cmp ( prev->nxt, seq ) > 0 ) ) {
+		if ( tcp_cmp ( prev->nxt, nxt ) >= 0 )
+			goto discard;
+		iob_pull ( iobuf, ( prev->nxt - seq ) );
+		seq = prev->nxt;
 	}
-	list_add_tail ( &iobuf->list, &queued->list );
+
+	/* Discard any following ranges that are entirely covered by
+	 * this packet, and trim any data overlapping the next range.
+	 */
+	while ( next && ( tcp_cmp ( nxt, next->nxt ) >= 0 ) ) {
+		range = next;
+		next = rb_entry_or_null ( rb_next ( &range->node ),
+					  struct tcp_rx_range, node );
+		tcp_rx_range_free ( tcp, range );
+	}
+	if ( next && ( tcp_cmp ( nxt, next->seq ) > 0 ) ) {
+		if ( flags ) {
+			flags = 0;
+			nxt--;
+		}
+		iob_unput ( iobuf, ( nxt - next->seq ) );
+		nxt = next->seq;
+	}
+	if ( ( seq == nxt ) && ( ! flags ) )
+		goto discard;
+
+	/* Add to receive queue, coalescing with adjacent ranges */
+	if ( prev && ( prev->nxt == seq ) ) {
+		list_add_tail ( &iobuf->list, &prev->iobufs );
+		prev->nxt = nxt;
+		prev->flags |= flags;
+		if ( next && ( next->seq == nxt ) ) {
+			list_splice_tail_init ( &next->iobufs, &prev->iobufs );
+			prev->nxt = next->nxt;
+			prev->flags |= next->flags;
+			tcp_rx_range_free ( tcp, next );
+		}
+	} else if ( next && ( next->seq == nxt ) ) {
+		list_add ( &iobuf->list, &next->iobufs );
+		next->seq = seq;
+	} else {
+		range = malloc ( sizeof ( *range ) );
+		if ( ! range )
+			goto discard;
+		range->seq = seq;
+		range->nxt = nxt;
+		range->flags = flags;
+		INIT_LIST_HEAD ( &range->iobufs );
+		list_add ( &iobuf->list, &range->iobufs );
+		tcp_rx_range_add ( tcp, range );
+	}
+	return;
+
+ discard:
+	free_iob ( iobuf );
 }
 
 /**
@@ -1344,41 +2323,39 @@ static void tcp_rx_enqueue ( struct tcp_connection *tcp, uint32_t seq,
  * @v tcp		TCP connection
  */
 static void tcp_process_rx_queue ( struct tcp_connection *tcp ) {
+	struct tcp_rx_range *range;
 	struct io_buffer *iobuf;
-	struct tcp_rx_queued_header *tcpqhdr;
 	uint32_t seq;
 	unsigned int flags;
-	size_t len;
 
 	/* Process all applicable received buffers.  Note that we
-	 * cannot use list_for_each_entry() to iterate over the RX
-	 * queue, since tcp_discard() may remove packets from the RX
-	 * queue while we are processing.
+	 * must remove each buffer from the receive queue before
+	 * delivering it, since tcp_discard() may remove packets from
+	 * the receive queue while we are processing.
 	 */
-	while ( ( iobuf = list_first_entry ( &tcp->rx_queue, struct io_buffer,
-					     list ) ) ) {
+	while ( ( range = rb_entry_or_null ( rb_first ( &tcp->rx_queue ),
+					     struct tcp_rx_range, node ) ) ) {
 
 		/* Stop processing when we hit the first gap */
-		tcpqhdr = iobuf->data;
-		if ( tcp_cmp ( tcpqhdr->seq, tcp->rcv_ack ) > 0 )
+		if ( tcp_cmp ( range->seq, tcp->rcv_ack ) > 0 )
 			break;
 
-		/* Strip internal header and remove from RX queue */
+		/* Remove first buffer from range */
+		iobuf = list_first_entry ( &range->iobufs, struct io_buffer,
+					   list );
+		assert ( iobuf != NULL );
 		list_del ( &iobuf->list );
-		seq = tcpqhdr->seq;
-		flags = tcpqhdr->flags;
-		iob_pull ( iobuf, sizeof ( *tcpqhdr ) );
-		len = iob_len ( iobuf );
-
-		/* Handle new data, if any */
-		tcp_rx_data ( tcp, seq, iob_disown ( iobuf ) );
-		seq += len;
-
-		/* Handle FIN, if present */
-		if ( flags & TCP_FIN ) {
-			tcp_rx_fin ( tcp, seq );
-			seq++;
+		seq = range->seq;
+		range->seq += iob_len ( iobuf );
+		if ( list_empty ( &range->iobufs ) ) {
+			flags = range->flags;
+			tcp_rx_range_free ( tcp, range );
+		} else {
+			flags = 0;
 		}
+
+		/* Deliver buffer */
+		tcp_rx_deliver ( tcp, seq, flags, iobuf );
 	}
 }
 
@@ -1410,6 +2387,7 @@ static int tcp_rx ( struct io_buffer *iobuf,
 	size_t len;
 	uint32_t seq_len;
 	size_t old_xfer_window;
+	int dupack;
 	int rc;
 
 	/* Start profiling */
@@ -1445,15 +2423,20 @@ static int tcp_rx ( struct io_buffer *iobuf,
 	}
 	
 	/* Parse parameters from header and strip header */
+	profile_start ( &tcp_demux_profiler );
 	tcp = tcp_demux ( ntohs ( tcphdr->dest ) );
+	profile_stop ( &tcp_demux_profiler );
 	seq = ntohl ( tcphdr->seq );
 	ack = ntohl ( tcphdr->ack );
 	raw_win = ntohs ( tcphdr->win );
 	flags = tcphdr->flags;
 	if ( ( rc = tcp_rx_opts ( tcp, tcphdr, hlen, &options ) ) != 0 )
 		goto discard;
-	if ( tcp && options.tsopt )
+	if ( tcp && options.tsopt ) {
 		tcp->ts_val = ntohl ( options.tsopt->tsval );
+		if ( flags & TCP_ACK )
+			tcp_rx_rtt ( tcp, ntohl ( options.tsopt->tsecr ) );
+	}
 	iob_pull ( iobuf, hlen );
 	len = iob_len ( iobuf );
 	seq_len = ( len + ( ( flags & TCP_SYN ) ? 1 : 0 ) +
@@ -1479,10 +2462,17 @@ static int tcp_rx ( struct io_buffer *iobuf,
 	/* Handle ACK, if present */
 	if ( flags & TCP_ACK ) {
 		win = ( raw_win << tcp->snd_win_scale );
+		dupack = ( TCP_CAN_SEND_DATA ( tcp->tcp_state ) &&
+			   ( ack == tcp->snd_seq ) && tcp->snd_sent &&
+			   ( seq_len == 0 ) && ( win == tcp->snd_win ) );
+		if ( ( tcp->flags & TCP_SACK_ENABLED ) && options.sackopt )
+			tcp_rx_sack ( tcp, options.sackopt );
 		if ( ( rc = tcp_rx_ack ( tcp, ack, win ) ) != 0 ) {
 			tcp_xmit_reset ( tcp, st_src, tcphdr );
 			goto discard;
 		}
+		if ( dupack )
+			tcp_rx_dupack ( tcp );
 	}
 
 	/* Force an ACK if this packet is out of order */
@@ -1517,7 +2507,7 @@ static int tcp_rx ( struct io_buffer *iobuf,
 	 * queue remains non-empty after processing) then send the ACK
 	 * immediately in order to trigger Fast Retransmission.
 	 */
-	if ( list_empty ( &tcp->rx_queue ) ) {
+	if ( rb_empty ( &tcp->rx_queue ) ) {
 		process_add ( &tcp->process );
 	} else {
 		tcp_xmit_sack ( tcp, seq );
@@ -1558,21 +2548,33 @@ struct tcpip_protocol tcp_protocol __tcpip_protocol = {
  */
 static unsigned int tcp_discard ( void ) {
 	struct tcp_connection *tcp;
+	struct tcp_rx_range *range;
 	struct io_buffer *iobuf;
 	unsigned int discarded = 0;
 
 	/* Try to drop one queued RX packet from each connection */
 	list_for_each_entry ( tcp, &tcp_conns, list ) {
-		list_for_each_entry_reverse ( iobuf, &tcp->rx_queue, list ) {
 
-			/* Remove packet from queue */
-			list_del ( &iobuf->list );
-			free_iob ( iobuf );
+		/* Find last packet in last range, if any */
+		range = rb_entry_or_null ( rb_last ( &tcp->rx_queue ),
+					   struct tcp_rx_range, node );
+		if ( ! range )
+			continue;
+		iobuf = list_last_entry ( &range->iobufs, struct io_buffer,
+					  list );
+		assert ( iobuf != NULL );
 
-			/* Report discard */
-			discarded++;
-			break;
-		}
+		/* Remove packet from range */
+		list_del ( &iobuf->list );
+		range->nxt -= ( iob_len ( iobuf ) +
+				( ( range->flags & TCP_FIN ) ? 1 : 0 ) );
+		range->flags = 0;
+		free_iob ( iobuf );
+		if ( list_empty ( &range->iobufs ) )
+			tcp_rx_range_free ( tcp, range );
+
+		/* Report discard */
+		discarded++;
 	}
 
 	return discarded;
@@ -1659,6 +2661,23 @@ struct startup_fn tcp_startup_fn __startup_fn ( STARTUP_LATE ) = {
 	.shutdown = tcp_shutdown,
 };
 
+/**
+ * Initialise TCP
+ *
+ */
+static void tcp_init ( void ) {
+	unsigned int i;
+
+	/* Initialise connection hash table */
+	for ( i = 0 ; i < TCPIP_HASH_BUCKETS ; i++ )
+		INIT_LIST_HEAD ( &tcp_hash[i] );
+}
+
+/** TCP initialisation function */
+struct init_fn tcp_init_fn __init_fn ( INIT_NORMAL ) = {
+	.initialise = tcp_init,
+};
+
 /***************************************************************************
  *
  * Data transfer interface
@@ -49,6 +49,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** HTTP connection pool */
 static LIST_HEAD ( http_connection_pool );
 
+/** List of open HTTP connections */
+static LIST_HEAD ( http_connections );
+
 /**
  * Identify HTTP scheme
  *
@@ -71,6 +74,38 @@ static struct http_scheme * http_scheme ( struct uri *uri ) {
 	return NULL;
 }
 
+/**
+ * Reset state for a newly attached request
+ *
+ * @v conn		HTTP connection
+ * @v pipeline		Request may be pipelined
+ */
+static void http_conn_attached ( struct http_connection *conn,
+				 int pipeline ) {
+
+	conn->flags &= ~( HTTP_CONN_PIPELINE | HTTP_CONN_SENT );
+	if ( pipeline )
+		conn->flags |= HTTP_CONN_PIPELINE;
+}
+
+/**
+ * Check if HTTP connection can accept a pipelined request
+ *
+ * @v conn		HTTP connection
+ * @ret pipelinable	Connection can accept a pipelined request
+ */
+static int http_conn_pipelinable ( struct http_connection *conn ) {
+
+	/* Pipeline only behind an idempotent request, on a connection
+	 * already proven to be persistent (i.e. recycled from the
+	 * connection pool), and to a limited depth.
+	 */
+	return ( ( conn->flags & HTTP_CONN_PIPELINE ) &&
+		 ( ! ( conn->flags & HTTP_CONN_DEFUNCT ) ) &&
+		 ( conn->pool.flags & POOL_RECYCLED ) &&
+		 ( conn->pipelined < HTTP_PIPELINE_MAX ) );
+}
+
 /**
  * Free HTTP connection
  *
@@ -81,10 +116,38 @@ static void http_conn_free ( struct refcnt *refcnt ) {
 		container_of ( refcnt, struct http_connection, refcnt );
 
 	/* Free connection */
+	free_iob ( conn->unread );
 	uri_put ( conn->uri );
 	free ( conn );
 }
 
+/**
+ * Ask pipelined requests to reopen
+ *
+ * @v conn		HTTP connection
+ * @v first		Index of first pipelined request to reopen
+ *
+ * Pipelined requests which have not yet started to receive a
+ * response may be safely resent on a new connection.
+ */
+static void http_conn_flush ( struct http_connection *conn,
+			      unsigned int first ) {
+	struct http_pipelined_request *pipelined;
+
+	/* Prevent any further pipelining on this connection */
+	conn->flags |= HTTP_CONN_DEFUNCT;
+
+	/* Ask each request to reopen, starting from the last */
+	while ( conn->pipelined > first ) {
+		pipelined = &conn->pipeline[ --conn->pipelined ];
+		DBGC2 ( conn, "HTTPCONN %p reopening pipelined request %d\n",
+			conn, conn->pipelined );
+		pool_reopen ( &pipelined->xfer );
+		intf_restart ( &pipelined->xfer, -ECANCELED );
+		pipelined->sent = 0;
+	}
+}
+
 /**
  * Close HTTP connection
  *
@@ -96,6 +159,13 @@ static void http_conn_close ( struct http_connection *conn, int rc ) {
 	/* Remove from connection pool, if applicable */
 	pool_del ( &conn->pool );
 
+	/* Remove from list of open connections */
+	list_del ( &conn->list );
+	INIT_LIST_HEAD ( &conn->list );
+
+	/* Ask any pipelined requests to reopen */
+	http_conn_flush ( conn, 0 );
+
 	/* Shut down interfaces */
 	intf_shutdown ( &conn->socket, rc );
 	intf_shutdown ( &conn->xfer, rc );
@@ -141,6 +211,20 @@ static int http_conn_socket_deliver ( struct http_connection *conn,
 	return xfer_deliver ( &conn->xfer, iobuf, meta );
 }
 
+/**
+ * Handle transport layer window change
+ *
+ * @v conn		HTTP connection
+ */
+static void http_conn_socket_window_changed ( struct http_connection *conn ) {
+	unsigned int i;
+
+	/* Notify current and all pipelined requests */
+	xfer_window_changed ( &conn->xfer );
+	for ( i = 0 ; i < conn->pipelined ; i++ )
+		xfer_window_changed ( &conn->pipeline[i].xfer );
+}
+
 /**
  * Close HTTP connection transport layer interface
  *
@@ -173,6 +257,103 @@ static void http_conn_xfer_recycle ( struct http_connection *conn ) {
 	DBGC2 ( conn, "HTTPCONN %p keepalive enabled\n", conn );
 }
 
+/**
+ * Transmit request
+ *
+ * @v conn		HTTP connection
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_conn_xfer_deliver ( struct http_connection *conn,
+				    struct io_buffer *iobuf,
+				    struct xfer_metadata *meta ) {
+	int rc;
+
+	/* Transmit request */
+	if ( ( rc = xfer_deliver ( &conn->socket, iob_disown ( iobuf ),
+				   meta ) ) != 0 )
+		return rc;
+	conn->flags |= HTTP_CONN_SENT;
+
+	/* Allow first pipelined request (if any) to be transmitted */
+	if ( conn->pipelined )
+		xfer_window_changed ( &conn->pipeline[0].xfer );
+
+	return 0;
+}
+
+/**
+ * Accept received data belonging to the next pipelined response
+ *
+ * @v conn		HTTP connection
+ * @v iobuf		I/O buffer
+ * @ret rc		Return status code
+ */
+static int http_conn_xfer_unread ( struct http_connection *conn,
+				   struct io_buffer *iobuf ) {
+
+	/* Data with no corresponding request (or in excess of the
+	 * single buffer that can arrive before the current response
+	 * completes) leaves the connection in an unknown state.
+	 */
+	if ( ( conn->pipelined == 0 ) || conn->unread ) {
+		DBGC ( conn, "HTTPCONN %p unexpected data\n", conn );
+		conn->flags |= HTTP_CONN_DEFUNCT;
+		free_iob ( iobuf );
+		return -EPROTO;
+	}
+
+	/* Hold data until the next pipelined request is attached */
+	conn->unread = iobuf;
+
+	return 0;
+}
+
+/**
+ * Attach next pipelined request to data transfer interface
+ *
+ * @v conn		HTTP connection
+ */
+static void http_conn_promote ( struct http_connection *conn ) {
+	struct http_pipelined_request *next = &conn->pipeline[0];
+	unsigned int i;
+
+	/* Sanity check */
+	assert ( conn->pipelined > 0 );
+
+	/* Attach first pipelined request to data transfer interface.
+	 * Treat the connection as freshly recycled, so that the
+	 * request may be reopened if the server closes the
+	 * connection before sending any part of the response.
+	 */
+	intf_plug_plug ( &conn->xfer, next->xfer.dest );
+	http_conn_attached ( conn, 1 );
+	if ( next->sent )
+		conn->flags |= HTTP_CONN_SENT;
+	conn->pool.flags = POOL_RECYCLED;
+
+	/* Move remaining pipelined requests up the queue */
+	for ( i = 1 ; i < conn->pipelined ; i++ ) {
+		intf_plug_plug ( &conn->pipeline[ i - 1 ].xfer,
+				 conn->pipeline[i].xfer.dest );
+		conn->pipeline[ i - 1 ].sent = conn->pipeline[i].sent;
+	}
+	conn->pipelined--;
+	intf_unplug ( &conn->pipeline[conn->pipelined].xfer );
+	conn->pipeline[conn->pipelined].sent = 0;
+	DBGC2 ( conn, "HTTPCONN %p promoted pipelined request (%d more)\n",
+		conn, conn->pipelined );
+
+	/* Deliver any data already received for this response.  Any
+	 * error will be handled by the request itself.
+	 */
+	if ( conn->unread ) {
+		pool_alive ( &conn->pool );
+		xfer_deliver_iob ( &conn->xfer, iob_disown ( conn->unread ) );
+	}
+}
+
 /**
  * Close HTTP connection data transfer interface
  *
@@ -181,26 +362,116 @@ static void http_conn_xfer_recycle ( struct http_connection *conn ) {
  */
 static void http_conn_xfer_close ( struct http_connection *conn, int rc ) {
 
-	/* Add to the connection pool if keepalive is enabled and no
+	/* Close the connection unless keepalive is enabled and no
 	 * error occurred.
 	 */
-	if ( ( rc == 0 ) && pool_is_recyclable ( &conn->pool ) ) {
-		intf_restart ( &conn->xfer, rc );
-		pool_add ( &conn->pool, &http_connection_pool,
-			   HTTP_CONN_EXPIRY );
-		DBGC2 ( conn, "HTTPCONN %p pooled %s://%s\n",
-			conn, conn->scheme->name, conn->uri->host );
+	if ( ( rc != 0 ) || ! pool_is_recyclable ( &conn->pool ) ) {
+		http_conn_close ( conn, rc );
 		return;
 	}
+	intf_restart ( &conn->xfer, rc );
 
-	/* Otherwise, close the connection */
-	http_conn_close ( conn, rc );
+	/* Pass connection to the next pipelined request, if any */
+	if ( conn->pipelined ) {
+		http_conn_promote ( conn );
+		return;
+	}
+
+	/* Close connection if it is not safe to reuse */
+	if ( conn->flags & HTTP_CONN_DEFUNCT ) {
+		http_conn_close ( conn, 0 );
+		return;
+	}
+
+	/* Add to the connection pool */
+	pool_add ( &conn->pool, &http_connection_pool, HTTP_CONN_EXPIRY );
+	DBGC2 ( conn, "HTTPCONN %p pooled %s://%s\n",
+		conn, conn->scheme->name, conn->uri->host );
+}
+
+/**
+ * Check pipelined request transmit window
+ *
+ * @v pipelined		Pipelined request
+ * @ret len		Length of window
+ */
+static size_t http_conn_pipeline_window ( struct http_pipelined_request
+					  *pipelined ) {
+	struct http_connection *conn = pipelined->conn;
+
+	/* Requests must be transmitted in order, and only once */
+	if ( pipelined->sent )
+		return 0;
+	if ( ( pipelined == conn->pipeline ) ?
+	     ( ! ( conn->flags & HTTP_CONN_SENT ) ) : ( ! pipelined[-1].sent ) )
+		return 0;
+
+	return xfer_window ( &conn->socket );
+}
+
+/**
+ * Transmit pipelined request
+ *
+ * @v pipelined		Pipelined request
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_conn_pipeline_deliver ( struct http_pipelined_request
+					*pipelined, struct io_buffer *iobuf,
+					struct xfer_metadata *meta ) {
+	struct http_connection *conn = pipelined->conn;
+	int rc;
+
+	/* Transmit request */
+	if ( ( rc = xfer_deliver ( &conn->socket, iob_disown ( iobuf ),
+				   meta ) ) != 0 )
+		return rc;
+	pipelined->sent = 1;
+
+	/* Allow next pipelined request (if any) to be transmitted */
+	if ( ( pipelined + 1 ) < ( conn->pipeline + conn->pipelined ) )
+		xfer_window_changed ( &pipelined[1].xfer );
+
+	return 0;
+}
+
+/**
+ * Close pipelined request
+ *
+ * @v pipelined		Pipelined request
+ * @v rc		Reason for close
+ */
+static void http_conn_pipeline_close ( struct http_pipelined_request
+				       *pipelined, int rc ) {
+	struct http_connection *conn = pipelined->conn;
+	unsigned int index = ( pipelined - conn->pipeline );
+
+	/* Restart data transfer interface */
+	intf_restart ( &pipelined->xfer, rc );
+
+	/* Do nothing more if this request has already been removed */
+	if ( index >= conn->pipelined )
+		return;
+
+	/* The response to an abandoned request may still arrive, and
+	 * cannot be discarded without being parsed.  Ask all later
+	 * requests to reopen, and close the connection once all
+	 * earlier requests have received their responses.
+	 */
+	DBGC ( conn, "HTTPCONN %p pipelined request %d abandoned: %s\n",
+	       conn, index, strerror ( rc ) );
+	http_conn_flush ( conn, ( index + 1 ) );
+	conn->pipelined = index;
+	pipelined->sent = 0;
 }
 
 /** HTTP connection socket interface operations */
 static struct interface_operation http_conn_socket_operations[] = {
 	INTF_OP ( xfer_deliver, struct http_connection *,
 		  http_conn_socket_deliver ),
+	INTF_OP ( xfer_window_changed, struct http_connection *,
+		  http_conn_socket_window_changed ),
 	INTF_OP ( intf_close, struct http_connection *,
 		  http_conn_socket_close ),
 };
@@ -212,8 +483,12 @@ static struct interface_descriptor http_conn_socket_desc =
 
 /** HTTP connection data transfer interface operations */
 static struct interface_operation http_conn_xfer_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_connection *,
+		  http_conn_xfer_deliver ),
 	INTF_OP ( pool_recycle, struct http_connection *,
 		  http_conn_xfer_recycle ),
+	INTF_OP ( http_conn_unread, struct http_connection *,
+		  http_conn_xfer_unread ),
 	INTF_OP ( intf_close, struct http_connection *,
 		  http_conn_xfer_close ),
 };
@@ -223,21 +498,68 @@ static struct interface_descriptor http_conn_xfer_desc =
 	INTF_DESC_PASSTHRU ( struct http_connection, xfer,
 			     http_conn_xfer_operations, socket );
 
+/** HTTP pipelined request interface operations */
+static struct interface_operation http_conn_pipeline_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_pipelined_request *,
+		  http_conn_pipeline_deliver ),
+	INTF_OP ( xfer_window, struct http_pipelined_request *,
+		  http_conn_pipeline_window ),
+	INTF_OP ( intf_close, struct http_pipelined_request *,
+		  http_conn_pipeline_close ),
+};
+
+/** HTTP pipelined request interface descriptor */
+static struct interface_descriptor http_conn_pipeline_desc =
+	INTF_DESC ( struct http_pipelined_request, xfer,
+		    http_conn_pipeline_operations );
+
+/**
+ * Return unconsumed received data to HTTP connection
+ *
+ * @v intf		Data transfer interface
+ * @v iobuf		I/O buffer
+ * @ret rc		Return status code
+ */
+int http_conn_unread ( struct interface *intf, struct io_buffer *iobuf ) {
+	struct interface *dest;
+	http_conn_unread_TYPE ( void * ) *op =
+		intf_get_dest_op ( intf, http_conn_unread, &dest );
+	void *object = intf_object ( dest );
+	int rc;
+
+	if ( op ) {
+		rc = op ( object, iobuf );
+	} else {
+		/* Default is to discard the data, since there can be
+		 * no pipelined request to receive it.
+		 */
+		free_iob ( iobuf );
+		rc = -EPROTO;
+	}
+
+	intf_put ( dest );
+	return rc;
+}
+
 /**
  * Connect to an HTTP server
  *
  * @v xfer		Data transfer interface
  * @v uri		Connection URI
+ * @v pipeline		Request may be pipelined
  * @ret rc		Return status code
  *
- * HTTP connections are pooled.  The caller should be prepared to
- * receive a pool_reopen() message.
+ * HTTP connections are pooled, and idempotent requests may be
+ * pipelined behind a request that is still awaiting its response.
+ * The caller should be prepared to receive a pool_reopen() message.
  */
-int http_connect ( struct interface *xfer, struct uri *uri ) {
+int http_connect ( struct interface *xfer, struct uri *uri, int pipeline ) {
+	struct http_pipelined_request *pipelined;
 	struct http_connection *conn;
 	struct http_scheme *scheme;
 	struct sockaddr_tcpip server;
 	unsigned int port;
+	unsigned int i;
 	int rc;
 
 	/* Identify scheme */
@@ -274,12 +596,34 @@ int http_connect ( struct interface *xfer, struct uri *uri ) {
 			 */
 			pool_del ( &conn->pool );
 			intf_plug_plug ( &conn->xfer, xfer );
+			http_conn_attached ( conn, pipeline );
 			DBGC2 ( conn, "HTTPCONN %p reused %s://%s:%d\n", conn,
 				conn->scheme->name, conn->uri->host, port );
 			return 0;
 		}
 	}
 
+	/* Look for a busy connection on which this request may be
+	 * pipelined.
+	 */
+	list_for_each_entry ( conn, &http_connections, list ) {
+
+		/* Pipeline request, if possible */
+		if ( pipeline && http_conn_pipelinable ( conn ) &&
+		     ( scheme == conn->scheme ) &&
+		     ( strcmp ( uri->host, conn->uri->host ) == 0 ) &&
+		     ( port == uri_port ( conn->uri, scheme->port ) ) ) {
+
+			/* Attach to parent interface and return */
+			pipelined = &conn->pipeline[ conn->pipelined++ ];
+			intf_plug_plug ( &pipelined->xfer, xfer );
+			DBGC2 ( conn, "HTTPCONN %p pipelined %s://%s:%d (%d "
+				"queued)\n", conn, conn->scheme->name,
+				conn->uri->host, port, conn->pipelined );
+			return 0;
+		}
+	}
+
 	/* Allocate and initialise structure */
 	conn = zalloc ( sizeof ( *conn ) );
 	if ( ! conn ) {
@@ -292,6 +636,13 @@ int http_connect ( struct interface *xfer, struct uri *uri ) {
 	intf_init ( &conn->socket, &http_conn_socket_desc, &conn->refcnt );
 	intf_init ( &conn->xfer, &http_conn_xfer_desc, &conn->refcnt );
 	pool_init ( &conn->pool, http_conn_expired, &conn->refcnt );
+	for ( i = 0 ; i < HTTP_PIPELINE_MAX ; i++ ) {
+		conn->pipeline[i].conn = conn;
+		intf_init ( &conn->pipeline[i].xfer, &http_conn_pipeline_desc,
+			    &conn->refcnt );
+	}
+	http_conn_attached ( conn, pipeline );
+	list_add ( &conn->list, &http_connections );
 
 	/* Open socket */
 	memset ( &server, 0, sizeof ( server ) );
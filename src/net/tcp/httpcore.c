@@ -58,6 +58,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/errortab.h>
 #include <ipxe/efi/efi_path.h>
 #include <ipxe/http.h>
+#include <ipxe/httpmulti.h>
 
 /* Disambiguate the various error causes */
 #define EACCES_401 __einfo_error ( EINFO_EACCES_401 )
@@ -133,11 +134,13 @@ static struct http_transfer_encoding http_transfer_identity;
 /** HTTP HEAD method */
 struct http_method http_head = {
 	.name = "HEAD",
+	.idempotent = 1,
 };
 
 /** HTTP GET method */
 struct http_method http_get = {
 	.name = "GET",
+	.idempotent = 1,
 };
 
 /** HTTP POST method */
@@ -312,7 +315,8 @@ static void http_reopen ( struct http_transaction *http ) {
 	intf_restart ( &http->conn, -ECANCELED );
 
 	/* Reopen connection */
-	if ( ( rc = http_connect ( &http->conn, http->uri ) ) != 0 ) {
+	if ( ( rc = http_connect ( &http->conn, http->uri,
+				   http->request.method->idempotent ) ) != 0 ) {
 		DBGC ( http, "HTTP %p could not reconnect: %s\n",
 		       http, strerror ( rc ) );
 		goto err_connect;
@@ -392,9 +396,15 @@ static int http_conn_deliver ( struct http_transaction *http,
 			       struct xfer_metadata *meta __unused ) {
 	int rc;
 
+	/* Record received data, so that any data following the end
+	 * of the response may be handed back to the connection.
+	 */
+	assert ( http->rx == NULL );
+	http->rx = iobuf;
+
 	/* Handle received data */
 	profile_start ( &http_rx_profiler );
-	while ( iobuf && iob_len ( iobuf ) ) {
+	while ( http->rx && iob_len ( http->rx ) ) {
 
 		/* Sanity check */
 		if ( ( ! http->state ) || ( ! http->state->rx ) ) {
@@ -404,18 +414,20 @@ static int http_conn_deliver ( struct http_transaction *http,
 		}
 
 		/* Receive (some) data */
-		if ( ( rc = http->state->rx ( http, &iobuf ) ) != 0 )
+		if ( ( rc = http->state->rx ( http, &http->rx ) ) != 0 )
 			goto err;
 	}
 
 	/* Free I/O buffer, if applicable */
-	free_iob ( iobuf );
+	free_iob ( http->rx );
+	http->rx = NULL;
 
 	profile_stop ( &http_rx_profiler );
 	return 0;
 
  err:
-	free_iob ( iobuf );
+	free_iob ( http->rx );
+	http->rx = NULL;
 	http_close ( http, rc );
 	return rc;
 }
@@ -520,6 +532,18 @@ __weak int http_block_read_capacity ( struct http_transaction *http __unused,
 	return -ENOTSUP;
 }
 
+/**
+ * Open HTTP GET download (when parallel download is not present)
+ *
+ * @v xfer		Data transfer interface
+ * @v uri		Request URI
+ * @ret rc		Return status code
+ */
+__weak int http_multi_open ( struct interface *xfer, struct uri *uri ) {
+
+	return http_open ( xfer, &http_get, uri, NULL, NULL );
+}
+
 /**
  * Describe as an EFI device path
  *
@@ -668,7 +692,8 @@ int http_open ( struct interface *xfer, struct http_method *method,
 		http->request.host, http->request.uri );
 
 	/* Open connection */
-	if ( ( rc = http_connect ( &http->conn, uri ) ) != 0 ) {
+	if ( ( rc = http_connect ( &http->conn, uri,
+				   method->idempotent ) ) != 0 ) {
 		DBGC ( http, "HTTP %p could not connect: %s\n",
 		       http, strerror ( rc ) );
 		goto err_connect;
@@ -742,6 +767,17 @@ static int http_transfer_complete ( struct http_transaction *http ) {
 	const char *location;
 	int rc;
 
+	/* Hand back any received data following the end of this
+	 * response, since it must belong to a pipelined response.
+	 * Fail if there is no pipelined request to receive it.
+	 */
+	if ( http->rx && iob_len ( http->rx ) &&
+	     ( ( rc = http_conn_unread ( &http->conn,
+					 iob_disown ( http->rx ) ) ) != 0 ) ) {
+		DBGC ( http, "HTTP %p content length overrun\n", http );
+		return -EIO_CONTENT_LENGTH;
+	}
+
 	/* Keep connection alive if applicable */
 	if ( http->response.flags & HTTP_RESPONSE_KEEPALIVE )
 		pool_recycle ( &http->conn );
@@ -1564,24 +1600,42 @@ static int http_init_transfer_identity ( struct http_transaction *http ) {
  */
 static int http_rx_transfer_identity ( struct http_transaction *http,
 				       struct io_buffer **iobuf ) {
+	struct io_buffer *payload;
 	size_t len = iob_len ( *iobuf );
+	size_t remaining;
 	int rc;
 
-	/* Update lengths */
-	http->len += len;
-
-	/* Fail if this transfer would overrun the expected content
-	 * length (if any).
+	/* Use whole/partial buffer as applicable.  Any data beyond
+	 * the expected content length (if any) must belong to a
+	 * pipelined response, and so is left in the original I/O
+	 * buffer.
 	 */
+	remaining = ( http->response.content.len - http->len );
 	if ( ( http->response.flags & HTTP_RESPONSE_CONTENT_LEN ) &&
-	     ( http->len > http->response.content.len ) ) {
-		DBGC ( http, "HTTP %p content length overrun\n", http );
-		return -EIO_CONTENT_LENGTH;
+	     ( len > remaining ) ) {
+
+		/* Partial buffer is to be consumed: copy data to a
+		 * temporary I/O buffer.
+		 */
+		len = remaining;
+		payload = alloc_iob ( len );
+		if ( ! payload )
+			return -ENOMEM;
+		memcpy ( iob_put ( payload, len ), (*iobuf)->data, len );
+		iob_pull ( *iobuf, len );
+
+	} else {
+
+		/* Whole buffer is to be consumed */
+		payload = iob_disown ( *iobuf );
 	}
 
+	/* Update lengths */
+	http->len += len;
+
 	/* Hand off to content encoding */
 	if ( ( rc = xfer_deliver_iob ( &http->transfer,
-				       iob_disown ( *iobuf ) ) ) != 0 )
+				       iob_disown ( payload ) ) ) != 0 )
 		return rc;
 
 	/* Complete transfer if we have received the expected content
@@ -1912,7 +1966,8 @@ static size_t http_params ( struct parameters *params, char *buf, size_t len ) {
  */
 static int http_open_get_uri ( struct interface *xfer, struct uri *uri ) {
 
-	return http_open ( xfer, &http_get, uri, NULL, NULL );
+	/* Use parallel range download, if enabled */
+	return http_multi_open ( xfer, uri );
 }
 
 /**
@@ -0,0 +1,559 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/**
+ * @file
+ *
+ * Hyper Text Transfer Protocol (HTTP) parallel range downloads
+ *
+ * A single TCP connection is limited by its receive window and by
+ * the time taken to recover from packet loss.  Large downloads may
+ * instead be split into fixed-size ranges which are fetched
+ * concurrently over several (pooled) HTTP connections, with each
+ * range being written directly to its final position within the
+ * data transfer buffer.
+ *
+ * Since ranges complete out of order, parallel downloads are used
+ * only when the recipient provides a random-access data transfer
+ * buffer (as used by the downloader).
+ *
+ * The total content length is first obtained via a HEAD request.  If
+ * the length is unknown, or if the server turns out not to honour
+ * range requests, then the download falls back to a single ordinary
+ * GET request.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/job.h>
+#include <ipxe/settings.h>
+#include <ipxe/http.h>
+#include <ipxe/httpmulti.h>
+
+/** Number of concurrent connections setting */
+const struct setting http_connections_setting
+	__setting ( SETTING_MISC, http-connections ) = {
+	.name = "http-connections",
+	.description = "Concurrent HTTP connections per download",
+	.type = &setting_type_uint8,
+};
+
+/** Range download chunk size setting */
+const struct setting http_chunk_setting __setting ( SETTING_MISC,
+						     http-chunk ) = {
+	.name = "http-chunk",
+	.description = "HTTP parallel download chunk size",
+	.type = &setting_type_uint32,
+};
+
+/**
+ * Free HTTP download multiplexer
+ *
+ * @v refcnt		Reference count
+ */
+static void http_multi_free ( struct refcnt *refcnt ) {
+	struct http_multiplexer *multi =
+		container_of ( refcnt, struct http_multiplexer, refcnt );
+
+	uri_put ( multi->uri );
+	free ( multi );
+}
+
+/**
+ * Shut down all range downloads
+ *
+ * @v multi		HTTP download multiplexer
+ * @v rc		Reason for shutdown
+ */
+static void http_multi_stop ( struct http_multiplexer *multi, int rc ) {
+	struct http_multiplexed_range *mrange;
+	struct http_multiplexed_range *tmp;
+
+	/* Stop range download initiation process */
+	process_del ( &multi->process );
+
+	/* Shut down all busy range downloads */
+	list_for_each_entry_safe ( mrange, tmp, &multi->busy, list ) {
+		intf_restart ( &mrange->xfer, rc );
+		list_del ( &mrange->list );
+		list_add_tail ( &mrange->list, &multi->idle );
+	}
+}
+
+/**
+ * Close HTTP download multiplexer
+ *
+ * @v multi		HTTP download multiplexer
+ * @v rc		Reason for close
+ */
+static void http_multi_close ( struct http_multiplexer *multi, int rc ) {
+	unsigned int i;
+
+	/* Stop all range downloads */
+	http_multi_stop ( multi, rc );
+	for ( i = 0 ; i < HTTP_MULTI_MAX_RANGES ; i++ )
+		intf_shutdown ( &multi->range[i].xfer, rc );
+
+	/* Shut down all other interfaces (which may be connected to
+	 * the same object).
+	 */
+	intf_nullify ( &multi->probe ); /* avoid potential loops */
+	intf_shutdown ( &multi->xfer, rc );
+	intf_shutdown ( &multi->probe, rc );
+}
+
+/**
+ * Fall back to a single-stream download
+ *
+ * @v multi		HTTP download multiplexer
+ */
+static void http_multi_single ( struct http_multiplexer *multi ) {
+	int rc;
+
+	/* Stop any range downloads */
+	http_multi_stop ( multi, -ECANCELED );
+
+	/* Open ordinary GET request via the probe interface */
+	intf_restart ( &multi->probe, -ECANCELED );
+	multi->single = 1;
+	DBGC ( multi, "HTTPMULTI %p falling back to single stream\n", multi );
+	if ( ( rc = http_open ( &multi->probe, &http_get, multi->uri, NULL,
+				NULL ) ) != 0 ) {
+		DBGC ( multi, "HTTPMULTI %p could not open: %s\n",
+		       multi, strerror ( rc ) );
+		http_multi_close ( multi, rc );
+		return;
+	}
+}
+
+/**
+ * Report progress of HTTP download
+ *
+ * @v multi		HTTP download multiplexer
+ * @v progress		Progress report to fill in
+ * @ret ongoing_rc	Ongoing job status code (if known)
+ */
+static int http_multi_progress ( struct http_multiplexer *multi,
+				 struct job_progress *progress ) {
+
+	/* Report content received so far, since the data transfer
+	 * buffer position is meaningless for concurrent ranges.
+	 */
+	if ( ! multi->single ) {
+		progress->completed = multi->received;
+		progress->total = multi->len;
+	}
+
+	return 0;
+}
+
+/**
+ * Receive data from probe (or single-stream download)
+ *
+ * @v multi		HTTP download multiplexer
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_multi_probe_deliver ( struct http_multiplexer *multi,
+				      struct io_buffer *iobuf,
+				      struct xfer_metadata *meta ) {
+
+	/* Pass through data from a single-stream download */
+	if ( multi->single )
+		return xfer_deliver ( &multi->xfer, iob_disown ( iobuf ), meta );
+
+	/* A HEAD request delivers no data, but will attempt to
+	 * presize the receive buffer to the content length.
+	 */
+	if ( ( meta->flags & XFER_FL_ABS_OFFSET ) &&
+	     ( ( size_t ) meta->offset > multi->len ) ) {
+		multi->len = meta->offset;
+	}
+	free_iob ( iobuf );
+
+	return 0;
+}
+
+/**
+ * Get probe underlying data transfer buffer
+ *
+ * @v multi		HTTP download multiplexer
+ * @ret xferbuf		Data transfer buffer, or NULL on error
+ */
+static struct xfer_buffer *
+http_multi_probe_buffer ( struct http_multiplexer *multi ) {
+
+	/* Allow access only for a single-stream download */
+	if ( ! multi->single )
+		return NULL;
+
+	return xfer_buffer ( &multi->xfer );
+}
+
+/**
+ * Close probe (or single-stream download) interface
+ *
+ * @v multi		HTTP download multiplexer
+ * @v rc		Reason for close
+ */
+static void http_multi_probe_close ( struct http_multiplexer *multi,
+				     int rc ) {
+
+	/* Completion of a single-stream download completes the
+	 * whole download.
+	 */
+	if ( multi->single ) {
+		http_multi_close ( multi, rc );
+		return;
+	}
+
+	/* Use a single stream if the probe failed or if the content
+	 * is too small to be worth splitting.
+	 */
+	if ( ( rc != 0 ) || ( multi->len <= multi->chunk ) ) {
+		DBGC ( multi, "HTTPMULTI %p probe found length %#zx: %s\n",
+		       multi, multi->len, strerror ( rc ) );
+		http_multi_single ( multi );
+		return;
+	}
+
+	/* Shut down probe interface */
+	intf_restart ( &multi->probe, rc );
+
+	/* Notify recipient of total download size */
+	if ( ( rc = xfer_seek ( &multi->xfer, multi->len ) ) != 0 ) {
+		DBGC ( multi, "HTTPMULTI %p could not presize buffer: %s\n",
+		       multi, strerror ( rc ) );
+		http_multi_close ( multi, rc );
+		return;
+	}
+	DBGC ( multi, "HTTPMULTI %p fetching %#zx bytes in %#zx-byte ranges\n",
+	       multi, multi->len, multi->chunk );
+
+	/* Start range download process */
+	process_add ( &multi->process );
+}
+
+/**
+ * Initiate multiplexed range download
+ *
+ * @v multi		HTTP download multiplexer
+ */
+static void http_multi_step ( struct http_multiplexer *multi ) {
+	struct http_multiplexed_range *mrange;
+	size_t remaining;
+	int rc;
+
+	/* If all ranges have been requested, then stop the initiation
+	 * process.  If there are no remaining range downloads, then
+	 * we are finished.
+	 */
+	if ( multi->offset >= multi->len ) {
+		process_del ( &multi->process );
+		if ( list_empty ( &multi->busy ) )
+			http_multi_close ( multi, 0 );
+		return;
+	}
+
+	/* Stop initiation process if all range downloads are busy */
+	mrange = list_first_entry ( &multi->idle,
+				    struct http_multiplexed_range, list );
+	if ( ! mrange ) {
+		process_del ( &multi->process );
+		return;
+	}
+
+	/* Construct next range */
+	remaining = ( multi->len - multi->offset );
+	mrange->range.start = multi->offset;
+	mrange->range.len = ( ( remaining < multi->chunk ) ?
+			      remaining : multi->chunk );
+	mrange->pos = 0;
+
+	/* Start downloading this range */
+	if ( ( rc = http_open ( &mrange->xfer, &http_get, multi->uri,
+				&mrange->range, NULL ) ) != 0 ) {
+		DBGC ( multi, "HTTPMULTI %p could not start download for "
+		       "[%#zx,%#zx): %s\n", multi, mrange->range.start,
+		       ( mrange->range.start + mrange->range.len ),
+		       strerror ( rc ) );
+		http_multi_close ( multi, rc );
+		return;
+	}
+	multi->offset += mrange->range.len;
+
+	/* Move to list of busy range downloads */
+	list_del ( &mrange->list );
+	list_add_tail ( &mrange->list, &multi->busy );
+}
+
+/**
+ * Close multiplexed range download
+ *
+ * @v mrange		HTTP multiplexed range download
+ * @v rc		Reason for close
+ */
+static void http_multi_range_close ( struct http_multiplexed_range *mrange,
+				     int rc ) {
+	struct http_multiplexer *multi = mrange->multi;
+
+	/* Move to list of idle range downloads */
+	list_del ( &mrange->list );
+	list_add_tail ( &mrange->list, &multi->idle );
+
+	/* Restart data transfer interface */
+	intf_restart ( &mrange->xfer, rc );
+
+	/* Fail if range was not received in its entirety */
+	if ( ( rc == 0 ) && ( mrange->pos != mrange->range.len ) ) {
+		DBGC ( multi, "HTTPMULTI %p range [%#zx,%#zx) underrun\n",
+		       multi, mrange->range.start,
+		       ( mrange->range.start + mrange->range.len ) );
+		rc = -EIO;
+	}
+
+	/* If any error occurred before content has been received,
+	 * then fall back to a single-stream download; otherwise
+	 * terminate the whole multiplexer.
+	 */
+	if ( rc != 0 ) {
+		DBGC ( multi, "HTTPMULTI %p range [%#zx,%#zx) failed: %s\n",
+		       multi, mrange->range.start,
+		       ( mrange->range.start + mrange->range.len ),
+		       strerror ( rc ) );
+		if ( multi->received ) {
+			http_multi_close ( multi, rc );
+		} else {
+			http_multi_single ( multi );
+		}
+		return;
+	}
+
+	/* Restart range download initiation process */
+	process_add ( &multi->process );
+}
+
+/**
+ * Receive data from multiplexed range download
+ *
+ * @v mrange		HTTP multiplexed range download
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_multi_range_deliver ( struct http_multiplexed_range *mrange,
+				      struct io_buffer *iobuf,
+				      struct xfer_metadata *meta ) {
+	struct http_multiplexer *multi = mrange->multi;
+	struct xfer_metadata range_meta;
+	size_t len = iob_len ( iobuf );
+	size_t pos;
+	int rc;
+
+	/* Calculate position within range */
+	pos = mrange->pos;
+	if ( meta->flags & XFER_FL_ABS_OFFSET )
+		pos = 0;
+	pos += meta->offset;
+
+	/* Check any attempt to presize the receive buffer, since a
+	 * server that ignores the range request will report the
+	 * length of the whole content.
+	 */
+	if ( ! len ) {
+		if ( pos > mrange->range.len ) {
+			DBGC ( multi, "HTTPMULTI %p range [%#zx,%#zx) got "
+			       "length %#zx\n", multi, mrange->range.start,
+			       ( mrange->range.start + mrange->range.len ),
+			       pos );
+			rc = -ERANGE;
+			goto err;
+		}
+		free_iob ( iobuf );
+		return 0;
+	}
+
+	/* Fail if data overruns the requested range */
+	if ( ( pos > mrange->range.len ) ||
+	     ( len > ( mrange->range.len - pos ) ) ) {
+		DBGC ( multi, "HTTPMULTI %p range [%#zx,%#zx) overrun\n",
+		       multi, mrange->range.start,
+		       ( mrange->range.start + mrange->range.len ) );
+		rc = -ERANGE;
+		goto err;
+	}
+	mrange->pos = ( pos + len );
+	multi->received += len;
+
+	/* Deliver at absolute position, since ranges are concurrent */
+	memset ( &range_meta, 0, sizeof ( range_meta ) );
+	range_meta.flags = XFER_FL_ABS_OFFSET;
+	range_meta.offset = ( mrange->range.start + pos );
+	return xfer_deliver ( &multi->xfer, iob_disown ( iobuf ),
+			      &range_meta );
+
+ err:
+	free_iob ( iobuf );
+	http_multi_range_close ( mrange, rc );
+	return rc;
+}
+
+/** Data transfer interface operations */
+static struct interface_operation http_multi_xfer_operations[] = {
+	INTF_OP ( job_progress, struct http_multiplexer *,
+		  http_multi_progress ),
+	INTF_OP ( intf_close, struct http_multiplexer *, http_multi_close ),
+};
+
+/** Data transfer interface descriptor */
+static struct interface_descriptor http_multi_xfer_desc =
+	INTF_DESC_PASSTHRU ( struct http_multiplexer, xfer,
+			     http_multi_xfer_operations, probe );
+
+/** Probe interface operations */
+static struct interface_operation http_multi_probe_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_multiplexer *,
+		  http_multi_probe_deliver ),
+	INTF_OP ( xfer_buffer, struct http_multiplexer *,
+		  http_multi_probe_buffer ),
+	INTF_OP ( intf_close, struct http_multiplexer *,
+		  http_multi_probe_close ),
+};
+
+/** Probe interface descriptor */
+static struct interface_descriptor http_multi_probe_desc =
+	INTF_DESC_PASSTHRU ( struct http_multiplexer, probe,
+			     http_multi_probe_operations, xfer );
+
+/** Range download data transfer interface operations */
+static struct interface_operation http_multi_range_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_multiplexed_range *,
+		  http_multi_range_deliver ),
+	INTF_OP ( intf_close, struct http_multiplexed_range *,
+		  http_multi_range_close ),
+};
+
+/** Range download data transfer interface descriptor */
+static struct interface_descriptor http_multi_range_desc =
+	INTF_DESC ( struct http_multiplexed_range, xfer,
+		    http_multi_range_operations );
+
+/** Range download initiation process descriptor */
+static struct process_descriptor http_multi_process_desc =
+	PROC_DESC ( struct http_multiplexer, process, http_multi_step );
+
+/**
+ * Open HTTP GET download, using parallel ranges if enabled
+ *
+ * @v xfer		Data transfer interface
+ * @v uri		Request URI
+ * @ret rc		Return status code
+ */
+int http_multi_open ( struct interface *xfer, struct uri *uri ) {
+	struct http_multiplexer *multi;
+	struct http_multiplexed_range *mrange;
+	unsigned long connections;
+	unsigned long chunk;
+	unsigned int i;
+	int rc;
+
+	/* Use an ordinary GET request unless multiple connections
+	 * are enabled.
+	 */
+	connections = fetch_uintz_setting ( NULL, &http_connections_setting );
+	if ( connections <= 1 )
+		return http_open ( xfer, &http_get, uri, NULL, NULL );
+	if ( connections > HTTP_MULTI_MAX_RANGES )
+		connections = HTTP_MULTI_MAX_RANGES;
+	chunk = fetch_uintz_setting ( NULL, &http_chunk_setting );
+	if ( ! chunk )
+		chunk = HTTP_MULTI_CHUNK;
+
+	/* Allocate and initialise structure */
+	multi = zalloc ( sizeof ( *multi ) );
+	if ( ! multi ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	ref_init ( &multi->refcnt, http_multi_free );
+	intf_init ( &multi->xfer, &http_multi_xfer_desc, &multi->refcnt );
+	intf_init ( &multi->probe, &http_multi_probe_desc, &multi->refcnt );
+	multi->uri = uri_get ( uri );
+	multi->chunk = chunk;
+	process_init_stopped ( &multi->process, &http_multi_process_desc,
+			       &multi->refcnt );
+	INIT_LIST_HEAD ( &multi->busy );
+	INIT_LIST_HEAD ( &multi->idle );
+	for ( i = 0 ; i < HTTP_MULTI_MAX_RANGES ; i++ ) {
+		mrange = &multi->range[i];
+		mrange->multi = multi;
+		INIT_LIST_HEAD ( &mrange->list );
+		if ( i < connections )
+			list_add_tail ( &mrange->list, &multi->idle );
+		intf_init ( &mrange->xfer, &http_multi_range_desc,
+			    &multi->refcnt );
+	}
+
+	/* Attach to parent interface */
+	intf_plug_plug ( &multi->xfer, xfer );
+
+	/* Ranges arrive out of order, and so may be delivered only
+	 * to a recipient with a random-access data transfer buffer.
+	 * Use an ordinary GET request for any other recipient.
+	 */
+	if ( ! xfer_buffer ( &multi->xfer ) ) {
+		DBGC ( multi, "HTTPMULTI %p has no data transfer buffer\n",
+		       multi );
+		intf_unplug ( &multi->xfer );
+		intf_unplug ( xfer );
+		ref_put ( &multi->refcnt );
+		return http_open ( xfer, &http_get, uri, NULL, NULL );
+	}
+
+	/* Start a HEAD request to retrieve the content length */
+	if ( ( rc = http_open ( &multi->probe, &http_head, uri, NULL,
+				NULL ) ) != 0 ) {
+		DBGC ( multi, "HTTPMULTI %p could not open: %s\n",
+		       multi, strerror ( rc ) );
+		goto err_open;
+	}
+
+	/* Mortalise self and return */
+	ref_put ( &multi->refcnt );
+	return 0;
+
+ err_open:
+	intf_unplug ( &multi->xfer );
+	intf_unplug ( xfer );
+	http_multi_close ( multi, rc );
+	ref_put ( &multi->refcnt );
+ err_alloc:
+	return rc;
+}
@@ -142,11 +142,16 @@ FEATURE ( FEATURE_PROTOCOL, "iSCSI", DHCP_EB_FEATURE_ISCSI, 1 );
 	__einfo_error ( EINFO_EPROTO_VALUE_REJECTED )
 #define EINFO_EPROTO_VALUE_REJECTED					\
 	__einfo_uniqify ( EINFO_EPROTO, 0x06, "Parameter rejected" )
+#define EPROTO_UNKNOWN_TASK \
+	__einfo_error ( EINFO_EPROTO_UNKNOWN_TASK )
+#define EINFO_EPROTO_UNKNOWN_TASK \
+	__einfo_uniqify ( EINFO_EPROTO, 0x07, "Unknown task tag" )
 
 static void iscsi_start_tx ( struct iscsi_session *iscsi );
 static void iscsi_start_login ( struct iscsi_session *iscsi );
-static void iscsi_start_data_out ( struct iscsi_session *iscsi,
+static void iscsi_start_data_out ( struct iscsi_task *task,
 				   unsigned int datasn );
+static void iscsi_tx_next ( struct iscsi_session *iscsi );
 
 /**
  * Finish receiving PDU data into buffer
@@ -206,7 +211,6 @@ static void iscsi_free ( struct refcnt *refcnt ) {
 	free ( iscsi->target_password );
 	chap_finish ( &iscsi->chap );
 	iscsi_rx_buffered_data_done ( iscsi );
-	free ( iscsi->command );
 	free ( iscsi );
 }
 
@@ -217,6 +221,7 @@ static void iscsi_free ( struct refcnt *refcnt ) {
  * @v rc		Reason for close
  */
 static void iscsi_close ( struct iscsi_session *iscsi, int rc ) {
+	unsigned int i;
 
 	/* A TCP graceful close is still an error from our point of view */
 	if ( rc == 0 )
@@ -227,20 +232,57 @@ static void iscsi_close ( struct iscsi_session *iscsi, int rc ) {
 	/* Stop transmission process */
 	process_del ( &iscsi->process );
 
+	/* Nullify all task interfaces to avoid potential loops */
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ )
+		intf_nullify ( &iscsi->task[i].data );
+
 	/* Shut down interfaces */
-	intfs_shutdown ( rc, &iscsi->socket, &iscsi->control, &iscsi->data,
-			 NULL );
+	intfs_shutdown ( rc, &iscsi->socket, &iscsi->control, NULL );
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ )
+		intf_shutdown ( &iscsi->task[i].data, rc );
 }
 
 /**
  * Assign new iSCSI initiator task tag
  *
- * @v iscsi		iSCSI session
+ * @ret itt		Initiator task tag
  */
-static void iscsi_new_itt ( struct iscsi_session *iscsi ) {
+static uint32_t iscsi_new_itt ( void ) {
 	static uint16_t itt_idx;
 
-	iscsi->itt = ( ISCSI_TAG_MAGIC | (++itt_idx) );
+	return ( ISCSI_TAG_MAGIC | (++itt_idx) );
+}
+
+/**
+ * Find iSCSI task by initiator task tag
+ *
+ * @v iscsi		iSCSI session
+ * @v itt		Initiator task tag
+ * @ret task		iSCSI task, or NULL if not found
+ */
+static struct iscsi_task * iscsi_find_task ( struct iscsi_session *iscsi,
+					     uint32_t itt ) {
+	struct iscsi_task *task;
+
+	list_for_each_entry ( task, &iscsi->busy, list ) {
+		if ( task->itt == itt )
+			return task;
+	}
+	return NULL;
+}
+
+/**
+ * Calculate maximum length of a transmitted data segment
+ *
+ * @v iscsi		iSCSI session
+ * @ret max_len		Maximum data segment length
+ */
+static size_t iscsi_max_send_len ( struct iscsi_session *iscsi ) {
+
+	/* Limit to both the target's and our own maximum */
+	if ( iscsi->max_send_len > ISCSI_MAX_SEND_DATA_SEGMENT_LEN )
+		return ISCSI_MAX_SEND_DATA_SEGMENT_LEN;
+	return iscsi->max_send_len;
 }
 
 /**
@@ -279,7 +321,11 @@ static int iscsi_open_connection ( struct iscsi_session *iscsi ) {
 	iscsi->isid_iana_qual = ( random() & 0xffff );
 
 	/* Assign fresh initiator task tag */
-	iscsi_new_itt ( iscsi );
+	iscsi->itt = iscsi_new_itt();
+
+	/* Assume default values for target's data transfer limits */
+	iscsi->max_send_len = ISCSI_DEFAULT_MAX_RECV_DATA_SEGMENT_LEN;
+	iscsi->first_burst_len = ISCSI_FIRST_BURST_LEN;
 
 	/* Initiate login */
 	iscsi_start_login ( iscsi );
@@ -317,37 +363,38 @@ static void iscsi_close_connection ( struct iscsi_session *iscsi, int rc ) {
 /**
  * Mark iSCSI SCSI operation as complete
  *
- * @v iscsi		iSCSI session
+ * @v task		iSCSI task
  * @v rc		Return status code
  * @v rsp		SCSI response, if any
  *
  * Note that iscsi_scsi_done() will not close the connection, and must
- * therefore be called only when the internal state machines are in an
- * appropriate state, otherwise bad things may happen on the next call
- * to iscsi_scsi_command().  The general rule is to call
- * iscsi_scsi_done() only at the end of receiving a PDU; at this point
- * the TX and RX engines should both be idle.
+ * therefore be called only when the RX engine is in an appropriate
+ * state.  The general rule is to call iscsi_scsi_done() only at the
+ * end of receiving a PDU.  The TX engine may still be busy sending a
+ * PDU on behalf of another task (or, if the target has terminated
+ * the command early, on behalf of this task).
  */
-static void iscsi_scsi_done ( struct iscsi_session *iscsi, int rc,
+static void iscsi_scsi_done ( struct iscsi_task *task, int rc,
 			      struct scsi_rsp *rsp ) {
-	uint32_t itt = iscsi->itt;
-
-	assert ( iscsi->tx_state == ISCSI_TX_IDLE );
+	struct iscsi_session *iscsi = task->iscsi;
+	uint32_t itt = task->itt;
 
-	/* Clear command */
-	free ( iscsi->command );
-	iscsi->command = NULL;
+	/* Return task to idle list */
+	task->flags = 0;
+	list_del ( &task->list );
+	list_add_tail ( &task->list, &iscsi->idle );
 
 	/* Send SCSI response, if any */
 	if ( rsp )
-		scsi_response ( &iscsi->data, rsp );
+		scsi_response ( &task->data, rsp );
 
 	/* Close SCSI command, if this is still the same command.  (It
 	 * is possible that the command interface has already been
-	 * closed as a result of the SCSI response we sent.)
+	 * closed as a result of the SCSI response we sent, and that
+	 * the task has since been reused for a new command.)
 	 */
-	if ( iscsi->itt == itt )
-		intf_restart ( &iscsi->data, rc );
+	if ( task->itt == itt )
+		intf_restart ( &task->data, rc );
 }
 
 /****************************************************************************
@@ -359,42 +406,82 @@ static void iscsi_scsi_done ( struct iscsi_session *iscsi, int rc,
 /**
  * Build iSCSI SCSI command BHS
  *
- * @v iscsi		iSCSI session
+ * @v task		iSCSI task
  *
  * We don't currently support bidirectional commands (i.e. with both
  * Data-In and Data-Out segments); these would require providing code
  * to generate an AHS, and there doesn't seem to be any need for it at
  * the moment.
  */
-static void iscsi_start_command ( struct iscsi_session *iscsi ) {
+static void iscsi_start_command ( struct iscsi_task *task ) {
+	struct iscsi_session *iscsi = task->iscsi;
 	struct iscsi_bhs_scsi_command *command = &iscsi->tx_bhs.scsi_command;
 
-	assert ( ! ( iscsi->command->data_in && iscsi->command->data_out ) );
+	assert ( ! ( task->command.data_in && task->command.data_out ) );
 
 	/* Construct BHS and initiate transmission */
 	iscsi_start_tx ( iscsi );
+	iscsi->tx_task = task;
 	command->opcode = ISCSI_OPCODE_SCSI_COMMAND;
-	command->flags = ( ISCSI_FLAG_FINAL |
-			   ISCSI_COMMAND_ATTR_SIMPLE );
-	if ( iscsi->command->data_in )
+	command->flags = ISCSI_COMMAND_ATTR_SIMPLE;
+	if ( task->unsolicited_len == task->immediate_len )
+		command->flags |= ISCSI_FLAG_FINAL;
+	if ( task->command.data_in )
 		command->flags |= ISCSI_COMMAND_FLAG_READ;
-	if ( iscsi->command->data_out )
+	if ( task->command.data_out )
 		command->flags |= ISCSI_COMMAND_FLAG_WRITE;
-	/* lengths left as zero */
-	memcpy ( &command->lun, &iscsi->command->lun,
-		 sizeof ( command->lun ) );
-	command->itt = htonl ( iscsi->itt );
-	command->exp_len = htonl ( iscsi->command->data_in_len |
-				   iscsi->command->data_out_len );
-	command->cmdsn = htonl ( iscsi->cmdsn );
+	ISCSI_SET_LENGTHS ( command->lengths, 0, task->immediate_len );
+	memcpy ( &command->lun, &task->command.lun, sizeof ( command->lun ) );
+	command->itt = htonl ( task->itt );
+	command->exp_len = htonl ( task->command.data_in_len |
+				   task->command.data_out_len );
+	command->cmdsn = htonl ( task->cmdsn );
 	command->expstatsn = htonl ( iscsi->statsn + 1 );
-	memcpy ( &command->cdb, &iscsi->command->cdb, sizeof ( command->cdb ));
-	DBGC2 ( iscsi, "iSCSI %p start " SCSI_CDB_FORMAT " %s %#zx\n",
-		iscsi, SCSI_CDB_DATA ( command->cdb ),
-		( iscsi->command->data_in ? "in" : "out" ),
-		( iscsi->command->data_in ?
-		  iscsi->command->data_in_len :
-		  iscsi->command->data_out_len ) );
+	memcpy ( &command->cdb, &task->command.cdb, sizeof ( command->cdb ) );
+	DBGC2 ( iscsi, "iSCSI %p tag %08x start " SCSI_CDB_FORMAT " %s %#zx\n",
+		iscsi, task->itt, SCSI_CDB_DATA ( command->cdb ),
+		( task->command.data_in ? "in" : "out" ),
+		( task->command.data_in ?
+		  task->command.data_in_len : task->command.data_out_len ) );
+}
+
+/**
+ * Get iSCSI task owning the current TX PDU
+ *
+ * @v iscsi		iSCSI session
+ * @ret task		iSCSI task, or NULL
+ *
+ * A target may terminate a command before we have finished sending
+ * the associated data.  This returns NULL if the task that owned the
+ * current TX PDU has since completed.
+ */
+static struct iscsi_task * iscsi_tx_task ( struct iscsi_session *iscsi ) {
+	struct iscsi_task *task = iscsi->tx_task;
+
+	if ( task && ( task->flags & ISCSI_TASK_BUSY ) &&
+	     ( task->itt == ntohl ( iscsi->tx_bhs.common.itt ) ) ) {
+		return task;
+	}
+	return NULL;
+}
+
+/**
+ * Complete iSCSI SCSI command PDU transmission
+ *
+ * @v iscsi		iSCSI session
+ */
+static void iscsi_scsi_command_done ( struct iscsi_session *iscsi ) {
+	struct iscsi_task *task = iscsi_tx_task ( iscsi );
+
+	/* Do nothing unless unsolicited data-out PDUs are required */
+	if ( ! ( task && ( task->unsolicited_len > task->immediate_len ) ) )
+		return;
+
+	/* Start sending unsolicited data-out PDUs */
+	task->ttt = ISCSI_TAG_RESERVED;
+	task->transfer_offset = task->immediate_len;
+	task->transfer_len = ( task->unsolicited_len - task->immediate_len );
+	iscsi_start_data_out ( task, 0 );
 }
 
 /**
@@ -411,6 +498,7 @@ static int iscsi_rx_scsi_response ( struct iscsi_session *iscsi,
 				    size_t remaining ) {
 	struct iscsi_bhs_scsi_response *response
 		= &iscsi->rx_bhs.scsi_response;
+	struct iscsi_task *task;
 	struct scsi_rsp rsp;
 	uint32_t residual_count;
 	size_t data_len;
@@ -445,8 +533,16 @@ static int iscsi_rx_scsi_response ( struct iscsi_session *iscsi,
 	if ( response->response != ISCSI_RESPONSE_COMMAND_COMPLETE )
 		return -EIO;
 
+	/* Identify task */
+	task = iscsi_find_task ( iscsi, ntohl ( response->itt ) );
+	if ( ! task ) {
+		DBGC ( iscsi, "iSCSI %p response for unknown tag %08x\n",
+		       iscsi, ntohl ( response->itt ) );
+		return -EPROTO_UNKNOWN_TASK;
+	}
+
 	/* Mark as completed */
-	iscsi_scsi_done ( iscsi, 0, &rsp );
+	iscsi_scsi_done ( task, 0, &rsp );
 	return 0;
 }
 
@@ -463,14 +559,22 @@ static int iscsi_rx_data_in ( struct iscsi_session *iscsi,
 			      const void *data, size_t len,
 			      size_t remaining ) {
 	struct iscsi_bhs_data_in *data_in = &iscsi->rx_bhs.data_in;
+	struct iscsi_task *task;
 	unsigned long offset;
 
+	/* Identify task */
+	task = iscsi_find_task ( iscsi, ntohl ( data_in->itt ) );
+	if ( ! task ) {
+		DBGC ( iscsi, "iSCSI %p data-in for unknown tag %08x\n",
+		       iscsi, ntohl ( data_in->itt ) );
+		return -EPROTO_UNKNOWN_TASK;
+	}
+
 	/* Copy data to data-in buffer */
 	offset = ntohl ( data_in->offset ) + iscsi->rx_offset;
-	assert ( iscsi->command != NULL );
-	assert ( iscsi->command->data_in );
-	assert ( ( offset + len ) <= iscsi->command->data_in_len );
-	copy_to_user ( iscsi->command->data_in, offset, data, len );
+	assert ( task->command.data_in );
+	assert ( ( offset + len ) <= task->command.data_in_len );
+	copy_to_user ( task->command.data_in, offset, data, len );
 
 	/* Wait for whole SCSI response to arrive */
 	if ( remaining )
@@ -478,10 +582,10 @@ static int iscsi_rx_data_in ( struct iscsi_session *iscsi,
 
 	/* Mark as completed if status is present */
 	if ( data_in->flags & ISCSI_DATA_FLAG_STATUS ) {
-		assert ( ( offset + len ) == iscsi->command->data_in_len );
+		assert ( ( offset + len ) == task->command.data_in_len );
 		assert ( data_in->flags & ISCSI_FLAG_FINAL );
 		/* iSCSI cannot return an error status via a data-in */
-		iscsi_scsi_done ( iscsi, 0, NULL );
+		iscsi_scsi_done ( task, 0, NULL );
 	}
 
 	return 0;
@@ -500,12 +604,26 @@ static int iscsi_rx_r2t ( struct iscsi_session *iscsi,
 			  const void *data __unused, size_t len __unused,
 			  size_t remaining __unused ) {
 	struct iscsi_bhs_r2t *r2t = &iscsi->rx_bhs.r2t;
+	struct iscsi_task *task;
+
+	/* Identify task */
+	task = iscsi_find_task ( iscsi, ntohl ( r2t->itt ) );
+	if ( ! task ) {
+		DBGC ( iscsi, "iSCSI %p R2T for unknown tag %08x\n",
+		       iscsi, ntohl ( r2t->itt ) );
+		return -EPROTO_UNKNOWN_TASK;
+	}
 
-	/* Record transfer parameters and trigger first data-out */
-	iscsi->ttt = ntohl ( r2t->ttt );
-	iscsi->transfer_offset = ntohl ( r2t->offset );
-	iscsi->transfer_len = ntohl ( r2t->len );
-	iscsi_start_data_out ( iscsi, 0 );
+	/* Record transfer parameters and schedule data-out.  We
+	 * allow only a single outstanding R2T per task, but the
+	 * preceding sequence of unsolicited data-out PDUs may still
+	 * be in progress.
+	 */
+	task->r2t_ttt = ntohl ( r2t->ttt );
+	task->r2t_offset = ntohl ( r2t->offset );
+	task->r2t_len = ntohl ( r2t->len );
+	task->flags |= ISCSI_TASK_TX_R2T;
+	iscsi_tx_next ( iscsi );
 
 	return 0;
 }
@@ -513,40 +631,45 @@ static int iscsi_rx_r2t ( struct iscsi_session *iscsi,
 /**
  * Build iSCSI data-out BHS
  *
- * @v iscsi		iSCSI session
+ * @v task		iSCSI task
  * @v datasn		Data sequence number within the transfer
  *
  */
-static void iscsi_start_data_out ( struct iscsi_session *iscsi,
+static void iscsi_start_data_out ( struct iscsi_task *task,
 				   unsigned int datasn ) {
+	struct iscsi_session *iscsi = task->iscsi;
 	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+	unsigned long max_len;
 	unsigned long offset;
 	unsigned long remaining;
 	unsigned long len;
 
-	/* We always send 512-byte Data-Out PDUs; this removes the
-	 * need to worry about the target's MaxRecvDataSegmentLength.
+	/* Send the largest PDUs permitted by the target.  The maximum
+	 * length cannot change during the full feature phase, so the
+	 * offset can be calculated from the data sequence number.
 	 */
-	offset = datasn * 512;
-	remaining = iscsi->transfer_len - offset;
+	max_len = iscsi_max_send_len ( iscsi );
+	offset = datasn * max_len;
+	remaining = task->transfer_len - offset;
 	len = remaining;
-	if ( len > 512 )
-		len = 512;
+	if ( len > max_len )
+		len = max_len;
 
 	/* Construct BHS and initiate transmission */
 	iscsi_start_tx ( iscsi );
+	iscsi->tx_task = task;
 	data_out->opcode = ISCSI_OPCODE_DATA_OUT;
 	if ( len == remaining )
 		data_out->flags = ( ISCSI_FLAG_FINAL );
 	ISCSI_SET_LENGTHS ( data_out->lengths, 0, len );
-	data_out->lun = iscsi->command->lun;
-	data_out->itt = htonl ( iscsi->itt );
-	data_out->ttt = htonl ( iscsi->ttt );
+	data_out->lun = task->command.lun;
+	data_out->itt = htonl ( task->itt );
+	data_out->ttt = htonl ( task->ttt );
 	data_out->expstatsn = htonl ( iscsi->statsn + 1 );
 	data_out->datasn = htonl ( datasn );
-	data_out->offset = htonl ( iscsi->transfer_offset + offset );
-	DBGC ( iscsi, "iSCSI %p start data out DataSN %#x len %#lx\n",
-	       iscsi, datasn, len );
+	data_out->offset = htonl ( task->transfer_offset + offset );
+	DBGC ( iscsi, "iSCSI %p tag %08x start data out DataSN %#x len %#lx\n",
+	       iscsi, task->itt, datasn, len );
 }
 
 /**
@@ -557,46 +680,82 @@ static void iscsi_start_data_out ( struct iscsi_session *iscsi,
  */
 static void iscsi_data_out_done ( struct iscsi_session *iscsi ) {
 	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+	struct iscsi_task *task = iscsi_tx_task ( iscsi );
 
 	/* If we haven't reached the end of the sequence, start
 	 * sending the next data-out PDU.
 	 */
-	if ( ! ( data_out->flags & ISCSI_FLAG_FINAL ) )
-		iscsi_start_data_out ( iscsi, ntohl ( data_out->datasn ) + 1 );
+	if ( task && ! ( data_out->flags & ISCSI_FLAG_FINAL ) )
+		iscsi_start_data_out ( task, ntohl ( data_out->datasn ) + 1 );
 }
 
 /**
- * Send iSCSI data-out data segment
+ * Send iSCSI write data segment
  *
  * @v iscsi		iSCSI session
+ * @v offset		Offset within write data
  * @ret rc		Return status code
+ *
+ * This is used for both data-out PDUs and for immediate data within
+ * SCSI command PDUs.
  */
-static int iscsi_tx_data_out ( struct iscsi_session *iscsi ) {
-	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+static int iscsi_tx_write_data ( struct iscsi_session *iscsi,
+				 unsigned long offset ) {
+	struct iscsi_bhs_common *common = &iscsi->tx_bhs.common;
+	struct iscsi_task *task = iscsi_tx_task ( iscsi );
 	struct io_buffer *iobuf;
-	unsigned long offset;
 	size_t len;
 	size_t pad_len;
 
-	offset = ntohl ( data_out->offset );
-	len = ISCSI_DATA_LEN ( data_out->lengths );
-	pad_len = ISCSI_DATA_PAD_LEN ( data_out->lengths );
-
-	assert ( iscsi->command != NULL );
-	assert ( iscsi->command->data_out );
-	assert ( ( offset + len ) <= iscsi->command->data_out_len );
+	len = ISCSI_DATA_LEN ( common->lengths );
+	pad_len = ISCSI_DATA_PAD_LEN ( common->lengths );
 
 	iobuf = xfer_alloc_iob ( &iscsi->socket, ( len + pad_len ) );
 	if ( ! iobuf )
 		return -ENOMEM;
-	
-	copy_from_user ( iob_put ( iobuf, len ),
-			 iscsi->command->data_out, offset, len );
+
+	/* Send padding in place of data if the task has completed */
+	if ( task ) {
+		assert ( task->command.data_out );
+		assert ( ( offset + len ) <= task->command.data_out_len );
+		copy_from_user ( iob_put ( iobuf, len ),
+				 task->command.data_out, offset, len );
+	} else {
+		memset ( iob_put ( iobuf, len ), 0, len );
+	}
 	memset ( iob_put ( iobuf, pad_len ), 0, pad_len );
 
 	return xfer_deliver_iob ( &iscsi->socket, iobuf );
 }
 
+/**
+ * Send iSCSI data-out data segment
+ *
+ * @v iscsi		iSCSI session
+ * @ret rc		Return status code
+ */
+static int iscsi_tx_data_out ( struct iscsi_session *iscsi ) {
+	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+
+	return iscsi_tx_write_data ( iscsi, ntohl ( data_out->offset ) );
+}
+
+/**
+ * Send iSCSI SCSI command immediate data segment
+ *
+ * @v iscsi		iSCSI session
+ * @ret rc		Return status code
+ */
+static int iscsi_tx_scsi_command ( struct iscsi_session *iscsi ) {
+	struct iscsi_bhs_scsi_command *command = &iscsi->tx_bhs.scsi_command;
+
+	/* Do nothing unless we are sending immediate data */
+	if ( ! ISCSI_DATA_LEN ( command->lengths ) )
+		return 0;
+
+	return iscsi_tx_write_data ( iscsi, 0 );
+}
+
 /**
  * Receive data segment of an iSCSI NOP-In
  *
@@ -646,21 +805,23 @@ static int iscsi_rx_nop_in ( struct iscsi_session *iscsi,
  *     HeaderDigest=None
  *     DataDigest=None
  *     MaxConnections=1 (irrelevant; we make only one connection anyway) [4]
- *     InitialR2T=Yes [1]
- *     ImmediateData=No (irrelevant; we never send immediate data) [4]
- *     MaxRecvDataSegmentLength=8192 (default; we don't care) [3]
+ *     InitialR2T=No [1]
+ *     ImmediateData=Yes [1]
+ *     MaxRecvDataSegmentLength=262144 [6]
  *     MaxBurstLength=262144 (default; we don't care) [3]
- *     FirstBurstLength=65536 (irrelevant due to other settings) [5]
+ *     FirstBurstLength=65536 (default) [1] [5]
  *     DefaultTime2Wait=0 [2]
  *     DefaultTime2Retain=0 [2]
- *     MaxOutstandingR2T=1
+ *     MaxOutstandingR2T=1 (per task)
  *     DataPDUInOrder=Yes
  *     DataSequenceInOrder=Yes
  *     ErrorRecoveryLevel=0
  *
- * [1] InitialR2T has an OR resolution function, so the target may
- * force us to use it.  We therefore simplify our logic by always
- * using it.
+ * [1] InitialR2T has an OR resolution function and ImmediateData
+ * has an AND resolution function, so the target may force us to
+ * wait for an R2T before sending any write data.  We send
+ * unsolicited data (up to FirstBurstLength, which has a MIN
+ * resolution function) only if the target's response permits it.
  *
  * [2] These ensure that we can safely start a new task once we have
  * reconnected after a failure, without having to manually tidy up
@@ -676,10 +837,16 @@ static int iscsi_rx_nop_in ( struct iscsi_session *iscsi,
  * unless they are supplied, so we explicitly specify the default
  * values.
  *
- * [5] FirstBurstLength is defined to be irrelevant since we already
- * force InitialR2T=Yes and ImmediateData=No, but some targets
+ * [5] FirstBurstLength is defined to be irrelevant if the target
+ * forces InitialR2T=Yes and ImmediateData=No, but some targets
  * (notably LIO as of kernel 4.11) fail unless it is specified, so we
- * explicitly specify the default value.
+ * always specify it explicitly.
+ *
+ * [6] MaxRecvDataSegmentLength is a declaration of our own receive
+ * limit.  Data-in PDUs are copied directly into the data buffer, so
+ * we can accept large PDUs and thereby reduce the per-PDU overhead.
+ * The target's declaration limits the size of the data-out PDUs and
+ * immediate data that we send.
  */
 static int iscsi_build_login_request_strings ( struct iscsi_session *iscsi,
 					       void *data, size_t len ) {
@@ -734,18 +901,20 @@ static int iscsi_build_login_request_strings ( struct iscsi_session *iscsi,
 				    "HeaderDigest=None%c"
 				    "DataDigest=None%c"
 				    "MaxConnections=1%c"
-				    "InitialR2T=Yes%c"
-				    "ImmediateData=No%c"
-				    "MaxRecvDataSegmentLength=8192%c"
+				    "InitialR2T=No%c"
+				    "ImmediateData=Yes%c"
+				    "MaxRecvDataSegmentLength=%d%c"
 				    "MaxBurstLength=262144%c"
-				    "FirstBurstLength=65536%c"
+				    "FirstBurstLength=%d%c"
 				    "DefaultTime2Wait=0%c"
 				    "DefaultTime2Retain=0%c"
 				    "MaxOutstandingR2T=1%c"
 				    "DataPDUInOrder=Yes%c"
 				    "DataSequenceInOrder=Yes%c"
 				    "ErrorRecoveryLevel=0%c",
-				    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 );
+				    0, 0, 0, 0, 0,
+				    ISCSI_MAX_RECV_DATA_SEGMENT_LEN, 0, 0,
+				    ISCSI_FIRST_BURST_LEN, 0, 0, 0, 0, 0, 0, 0 );
 	}
 
 	return used;
@@ -1128,6 +1297,107 @@ static int iscsi_handle_chap_r_value ( struct iscsi_session *iscsi,
 	return rc;
 }
 
+/**
+ * Handle iSCSI InitialR2T text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		InitialR2T value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_initialr2t_value ( struct iscsi_session *iscsi,
+					   const char *value ) {
+
+	/* Allow unsolicited data-out PDUs only if target agrees */
+	if ( strcmp ( value, "No" ) == 0 ) {
+		iscsi->status |= ISCSI_STATUS_UNSOLICITED_DATA;
+	} else {
+		iscsi->status &= ~ISCSI_STATUS_UNSOLICITED_DATA;
+	}
+	return 0;
+}
+
+/**
+ * Handle iSCSI ImmediateData text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		ImmediateData value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_immediatedata_value ( struct iscsi_session *iscsi,
+					      const char *value ) {
+
+	/* Allow immediate data only if target agrees */
+	if ( strcmp ( value, "Yes" ) == 0 ) {
+		iscsi->status |= ISCSI_STATUS_IMMEDIATE_DATA;
+	} else {
+		iscsi->status &= ~ISCSI_STATUS_IMMEDIATE_DATA;
+	}
+	return 0;
+}
+
+/**
+ * Parse iSCSI length text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		Length value
+ * @v len		Length to fill in
+ * @ret rc		Return status code
+ */
+static int iscsi_parse_len_value ( struct iscsi_session *iscsi,
+				   const char *value, size_t *len ) {
+	unsigned long parsed;
+	char *end;
+
+	/* Parse value, which must be at least 512 bytes */
+	parsed = strtoul ( value, &end, 0 );
+	if ( *end || ( parsed < 512 ) ) {
+		DBGC ( iscsi, "iSCSI %p invalid length \"%s\"\n",
+		       iscsi, value );
+		return -EPROTO_INVALID_KEY_VALUE_PAIR;
+	}
+	*len = parsed;
+
+	return 0;
+}
+
+/**
+ * Handle iSCSI MaxRecvDataSegmentLength text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		MaxRecvDataSegmentLength value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_maxrecvdatasegmentlength_value ( struct iscsi_session
+							 *iscsi,
+							 const char *value ) {
+
+	/* Record target's receive limit */
+	return iscsi_parse_len_value ( iscsi, value, &iscsi->max_send_len );
+}
+
+/**
+ * Handle iSCSI FirstBurstLength text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		FirstBurstLength value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_firstburstlength_value ( struct iscsi_session *iscsi,
+						 const char *value ) {
+	int rc;
+
+	/* Record negotiated unsolicited data limit */
+	if ( ( rc = iscsi_parse_len_value ( iscsi, value,
+					    &iscsi->first_burst_len ) ) != 0 )
+		return rc;
+
+	/* Never exceed the value that we offered */
+	if ( iscsi->first_burst_len > ISCSI_FIRST_BURST_LEN )
+		iscsi->first_burst_len = ISCSI_FIRST_BURST_LEN;
+
+	return 0;
+}
+
 /** An iSCSI text string that we want to handle */
 struct iscsi_string_type {
 	/** String key
@@ -1154,6 +1424,11 @@ static struct iscsi_string_type iscsi_string_types[] = {
 	{ "CHAP_C", iscsi_handle_chap_c_value },
 	{ "CHAP_N", iscsi_handle_chap_n_value },
 	{ "CHAP_R", iscsi_handle_chap_r_value },
+	{ "InitialR2T", iscsi_handle_initialr2t_value },
+	{ "ImmediateData", iscsi_handle_immediatedata_value },
+	{ "MaxRecvDataSegmentLength",
+	  iscsi_handle_maxrecvdatasegmentlength_value },
+	{ "FirstBurstLength", iscsi_handle_firstburstlength_value },
 	{ NULL, NULL }
 };
 
@@ -1404,6 +1679,7 @@ static void iscsi_start_tx ( struct iscsi_session *iscsi ) {
 
 	/* Initialise TX BHS */
 	memset ( &iscsi->tx_bhs, 0, sizeof ( iscsi->tx_bhs ) );
+	iscsi->tx_task = NULL;
 
 	/* Flag TX engine to start transmitting */
 	iscsi->tx_state = ISCSI_TX_BHS;
@@ -1412,6 +1688,43 @@ static void iscsi_start_tx ( struct iscsi_session *iscsi ) {
 	iscsi_tx_resume ( iscsi );
 }
 
+/**
+ * Start up next pending TX PDU, if any
+ *
+ * @v iscsi		iSCSI session
+ *
+ * Tasks are serviced in the order in which they were issued, so that
+ * SCSI command PDUs are always sent in CmdSN order.
+ */
+static void iscsi_tx_next ( struct iscsi_session *iscsi ) {
+	struct iscsi_task *task;
+
+	/* Do nothing if TX engine is busy */
+	if ( iscsi->tx_state != ISCSI_TX_IDLE )
+		return;
+
+	/* Find first task with something to send */
+	list_for_each_entry ( task, &iscsi->busy, list ) {
+
+		/* Send SCSI command, if applicable */
+		if ( task->flags & ISCSI_TASK_TX_COMMAND ) {
+			task->flags &= ~ISCSI_TASK_TX_COMMAND;
+			iscsi_start_command ( task );
+			return;
+		}
+
+		/* Send data-out PDUs in response to R2T, if applicable */
+		if ( task->flags & ISCSI_TASK_TX_R2T ) {
+			task->flags &= ~ISCSI_TASK_TX_R2T;
+			task->ttt = task->r2t_ttt;
+			task->transfer_offset = task->r2t_offset;
+			task->transfer_len = task->r2t_len;
+			iscsi_start_data_out ( task, 0 );
+			return;
+		}
+	}
+}
+
 /**
  * Transmit nothing
  *
@@ -1446,6 +1759,8 @@ static int iscsi_tx_data ( struct iscsi_session *iscsi ) {
 	struct iscsi_bhs_common *common = &iscsi->tx_bhs.common;
 
 	switch ( common->opcode & ISCSI_OPCODE_MASK ) {
+	case ISCSI_OPCODE_SCSI_COMMAND:
+		return iscsi_tx_scsi_command ( iscsi );
 	case ISCSI_OPCODE_DATA_OUT:
 		return iscsi_tx_data_out ( iscsi );
 	case ISCSI_OPCODE_LOGIN_REQUEST:
@@ -1472,6 +1787,9 @@ static void iscsi_tx_done ( struct iscsi_session *iscsi ) {
 	iscsi_tx_pause ( iscsi );
 
 	switch ( common->opcode & ISCSI_OPCODE_MASK ) {
+	case ISCSI_OPCODE_SCSI_COMMAND:
+		iscsi_scsi_command_done ( iscsi );
+		break;
 	case ISCSI_OPCODE_DATA_OUT:
 		iscsi_data_out_done ( iscsi );
 		break;
@@ -1482,6 +1800,9 @@ static void iscsi_tx_done ( struct iscsi_session *iscsi ) {
 		/* No action */
 		break;
 	}
+
+	/* Start next PDU, if any */
+	iscsi_tx_next ( iscsi );
 }
 
 /**
@@ -1617,9 +1938,19 @@ static int iscsi_rx_data ( struct iscsi_session *iscsi, const void *data,
 			   size_t len, size_t remaining ) {
 	struct iscsi_bhs_common_response *response
 		= &iscsi->rx_bhs.common_response;
+	uint32_t maxcmdsn = ntohl ( response->maxcmdsn );
 
-	/* Update cmdsn and statsn */
-	iscsi->cmdsn = ntohl ( response->expcmdsn );
+	/* Update cmdsn, maxcmdsn and statsn.  The command sequence
+	 * number is initialised by the login response, and is
+	 * thereafter incremented as each command is issued.
+	 */
+	if ( ( response->opcode & ISCSI_OPCODE_MASK ) ==
+	     ISCSI_OPCODE_LOGIN_RESPONSE ) {
+		iscsi->cmdsn = ntohl ( response->expcmdsn );
+		iscsi->maxcmdsn = maxcmdsn;
+	} else if ( ( ( int32_t ) ( maxcmdsn - iscsi->maxcmdsn ) ) > 0 ) {
+		iscsi->maxcmdsn = maxcmdsn;
+	}
 	iscsi->statsn = ntohl ( response->statsn );
 
 	switch ( response->opcode & ISCSI_OPCODE_MASK ) {
@@ -1798,15 +2129,27 @@ static struct interface_descriptor iscsi_socket_desc =
  * @ret len		Length of window
  */
 static size_t iscsi_scsi_window ( struct iscsi_session *iscsi ) {
+	struct iscsi_task *task;
+	int32_t cmds;
+	size_t len = 0;
 
-	if ( ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) ==
-	       ISCSI_STATUS_FULL_FEATURE_PHASE ) &&
-	     ( iscsi->command == NULL ) ) {
-		/* We cannot handle concurrent commands */
-		return 1;
-	} else {
+	/* Refuse commands until login is complete */
+	if ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) !=
+	     ISCSI_STATUS_FULL_FEATURE_PHASE )
 		return 0;
-	}
+
+	/* Limit to number of idle tasks */
+	list_for_each_entry ( task, &iscsi->idle, list )
+		len++;
+
+	/* Limit to target's command window */
+	cmds = ( ( int32_t ) ( iscsi->maxcmdsn - iscsi->cmdsn ) + 1 );
+	if ( cmds < 0 )
+		cmds = 0;
+	if ( len > ( ( size_t ) cmds ) )
+		len = cmds;
+
+	return len;
 }
 
 /**
@@ -1820,31 +2163,56 @@ static size_t iscsi_scsi_window ( struct iscsi_session *iscsi ) {
 static int iscsi_scsi_command ( struct iscsi_session *iscsi,
 				struct interface *parent,
 				struct scsi_cmd *command ) {
+	struct iscsi_task *task;
+	size_t len;
 
-	/* This iSCSI implementation cannot handle multiple concurrent
-	 * commands or commands arriving before login is complete.
+	/* Refuse commands arriving before login is complete, or
+	 * beyond the number of tasks that we (and the target) are
+	 * able to handle concurrently.
 	 */
 	if ( iscsi_scsi_window ( iscsi ) == 0 ) {
-		DBGC ( iscsi, "iSCSI %p cannot handle concurrent commands\n",
+		DBGC ( iscsi, "iSCSI %p cannot accept further commands\n",
 		       iscsi );
 		return -EOPNOTSUPP;
 	}
 
-	/* Store command */
-	iscsi->command = malloc ( sizeof ( *command ) );
-	if ( ! iscsi->command )
-		return -ENOMEM;
-	memcpy ( iscsi->command, command, sizeof ( *command ) );
+	/* Allocate task */
+	task = list_first_entry ( &iscsi->idle, struct iscsi_task, list );
+	assert ( task != NULL );
+	list_del ( &task->list );
+	list_add_tail ( &task->list, &iscsi->busy );
+
+	/* Store command and assign new ITT and CmdSN */
+	memcpy ( &task->command, command, sizeof ( task->command ) );
+	task->itt = iscsi_new_itt();
+	task->cmdsn = iscsi->cmdsn++;
+	task->flags = ( ISCSI_TASK_BUSY | ISCSI_TASK_TX_COMMAND );
+
+	/* Determine how much data may be sent without waiting for an
+	 * R2T, as negotiated during login.
+	 */
+	task->immediate_len = 0;
+	task->unsolicited_len = 0;
+	len = command->data_out_len;
+	if ( len > iscsi->first_burst_len )
+		len = iscsi->first_burst_len;
+	if ( iscsi->status & ISCSI_STATUS_UNSOLICITED_DATA )
+		task->unsolicited_len = len;
+	if ( iscsi->status & ISCSI_STATUS_IMMEDIATE_DATA ) {
+		if ( len > iscsi_max_send_len ( iscsi ) )
+			len = iscsi_max_send_len ( iscsi );
+		task->immediate_len = len;
+		if ( task->unsolicited_len < len )
+			task->unsolicited_len = len;
+	}
 
-	/* Assign new ITT */
-	iscsi_new_itt ( iscsi );
+	/* Attach to parent interface */
+	intf_plug_plug ( &task->data, parent );
 
-	/* Start sending command */
-	iscsi_start_command ( iscsi );
+	/* Start sending command, if possible */
+	iscsi_tx_next ( iscsi );
 
-	/* Attach to parent interface and return */
-	intf_plug_plug ( &iscsi->data, parent );
-	return iscsi->itt;
+	return task->itt;
 }
 
 /**
@@ -1874,29 +2242,30 @@ static struct interface_descriptor iscsi_control_desc =
 /**
  * Close iSCSI command
  *
- * @v iscsi		iSCSI session
+ * @v task		iSCSI task
  * @v rc		Reason for close
  */
-static void iscsi_command_close ( struct iscsi_session *iscsi, int rc ) {
+static void iscsi_command_close ( struct iscsi_task *task, int rc ) {
+	struct iscsi_session *iscsi = task->iscsi;
 
 	/* Restart interface */
-	intf_restart ( &iscsi->data, rc );
+	intf_restart ( &task->data, rc );
 
 	/* Treat unsolicited command closures mid-command as fatal,
 	 * because we have no code to handle partially-completed PDUs.
 	 */
-	if ( iscsi->command != NULL )
+	if ( task->flags & ISCSI_TASK_BUSY )
 		iscsi_close ( iscsi, ( ( rc == 0 ) ? -ECANCELED : rc ) );
 }
 
 /** iSCSI SCSI command interface operations */
 static struct interface_operation iscsi_data_op[] = {
-	INTF_OP ( intf_close, struct iscsi_session *, iscsi_command_close ),
+	INTF_OP ( intf_close, struct iscsi_task *, iscsi_command_close ),
 };
 
 /** iSCSI SCSI command interface descriptor */
 static struct interface_descriptor iscsi_data_desc =
-	INTF_DESC ( struct iscsi_session, data, iscsi_data_op );
+	INTF_DESC ( struct iscsi_task, data, iscsi_data_op );
 
 /****************************************************************************
  *
@@ -2116,6 +2485,8 @@ static int iscsi_check_auth ( struct iscsi_session *iscsi ) {
  */
 static int iscsi_open ( struct interface *parent, struct uri *uri ) {
 	struct iscsi_session *iscsi;
+	struct iscsi_task *task;
+	unsigned int i;
 	int rc;
 
 	/* Sanity check */
@@ -2132,10 +2503,17 @@ static int iscsi_open ( struct interface *parent, struct uri *uri ) {
 	}
 	ref_init ( &iscsi->refcnt, iscsi_free );
 	intf_init ( &iscsi->control, &iscsi_control_desc, &iscsi->refcnt );
-	intf_init ( &iscsi->data, &iscsi_data_desc, &iscsi->refcnt );
 	intf_init ( &iscsi->socket, &iscsi_socket_desc, &iscsi->refcnt );
 	process_init_stopped ( &iscsi->process, &iscsi_process_desc,
 			       &iscsi->refcnt );
+	INIT_LIST_HEAD ( &iscsi->busy );
+	INIT_LIST_HEAD ( &iscsi->idle );
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ ) {
+		task = &iscsi->task[i];
+		task->iscsi = iscsi;
+		intf_init ( &task->data, &iscsi_data_desc, &iscsi->refcnt );
+		list_add_tail ( &task->list, &iscsi->idle );
+	}
 	acpi_init ( &iscsi->desc, &ibft_model, &iscsi->refcnt );
 
 	/* Parse root path */
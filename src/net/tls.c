@@ -50,6 +50,8 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #include <ipxe/validator.h>
 #include <ipxe/job.h>
 #include <ipxe/dhe.h>
+#include <ipxe/hkdf.h>
+#include <ipxe/timer.h>
 #include <ipxe/tls.h>
 #include <config/crypto.h>
 
@@ -110,6 +112,19 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #define EINFO_EINVAL_KEY_EXCHANGE					\
 	__einfo_uniqify ( EINFO_EINVAL, 0x0f,				\
 			  "Invalid Server Key Exchange record" )
+#define EINVAL_CERTIFICATE_VERIFY					\
+	__einfo_error ( EINFO_EINVAL_CERTIFICATE_VERIFY )
+#define EINFO_EINVAL_CERTIFICATE_VERIFY					\
+	__einfo_uniqify ( EINFO_EINVAL, 0x10,				\
+			  "Invalid Certificate Verify record" )
+#define EINVAL_KEY_UPDATE __einfo_error ( EINFO_EINVAL_KEY_UPDATE )
+#define EINFO_EINVAL_KEY_UPDATE						\
+	__einfo_uniqify ( EINFO_EINVAL, 0x11,				\
+			  "Invalid Key Update record" )
+#define EINVAL_CONTENT_TYPE __einfo_error ( EINFO_EINVAL_CONTENT_TYPE )
+#define EINFO_EINVAL_CONTENT_TYPE					\
+	__einfo_uniqify ( EINFO_EINVAL, 0x12,				\
+			  "Invalid inner content type" )
 #define EIO_ALERT __einfo_error ( EINFO_EIO_ALERT )
 #define EINFO_EIO_ALERT							\
 	__einfo_uniqify ( EINFO_EIO, 0x01,				\
@@ -158,6 +173,14 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #define EINFO_ENOTSUP_VERSION						\
 	__einfo_uniqify ( EINFO_ENOTSUP, 0x04,				\
 			  "Unsupported protocol version" )
+#define ENOTSUP_CURVE __einfo_error ( EINFO_ENOTSUP_CURVE )
+#define EINFO_ENOTSUP_CURVE						\
+	__einfo_uniqify ( EINFO_ENOTSUP, 0x05,				\
+			  "Unsupported elliptic curve" )
+#define ENOTSUP_RETRY __einfo_error ( EINFO_ENOTSUP_RETRY )
+#define EINFO_ENOTSUP_RETRY						\
+	__einfo_uniqify ( EINFO_ENOTSUP, 0x06,				\
+			  "Hello Retry Request not supported" )
 #define EPERM_ALERT __einfo_error ( EINFO_EPERM_ALERT )
 #define EINFO_EPERM_ALERT						\
 	__einfo_uniqify ( EINFO_EPERM, 0x01,				\
@@ -182,6 +205,14 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #define EINFO_EPERM_KEY_EXCHANGE					\
 	__einfo_uniqify ( EINFO_EPERM, 0x06,				\
 			  "ServerKeyExchange verification failed" )
+#define EPERM_DOWNGRADE __einfo_error ( EINFO_EPERM_DOWNGRADE )
+#define EINFO_EPERM_DOWNGRADE						\
+	__einfo_uniqify ( EINFO_EPERM, 0x07,				\
+			  "Illegal protocol version downgrade" )
+#define EPERM_AUTH __einfo_error ( EINFO_EPERM_AUTH )
+#define EINFO_EPERM_AUTH						\
+	__einfo_uniqify ( EINFO_EPERM, 0x08,				\
+			  "Server not authenticated" )
 #define EPROTO_VERSION __einfo_error ( EINFO_EPROTO_VERSION )
 #define EINFO_EPROTO_VERSION						\
 	__einfo_uniqify ( EINFO_EPROTO, 0x01,				\
@@ -268,6 +299,65 @@ tls_version ( struct tls_connection *tls, unsigned int version ) {
 		 ( tls->version >= version ) );
 }
 
+/**
+ * Check for TLSv1.3
+ *
+ * @v tls		TLS connection
+ * @ret is_tls13	TLS connection is using TLSv1.3
+ *
+ * Optimise down to a compile-time constant false result if TLSv1.3
+ * support is not enabled.  Note that the connection version remains
+ * at the maximum supported version until a Server Hello is received.
+ */
+static inline __attribute__ (( always_inline )) int
+tls13 ( struct tls_connection *tls ) {
+	return ( ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_3 ) &&
+		 tls_version ( tls, TLS_VERSION_TLS_1_3 ) );
+}
+
+/**
+ * Get legacy protocol version
+ *
+ * @v version		TLS version
+ * @ret legacy		Legacy protocol version
+ *
+ * TLSv1.3 continues to use the TLSv1.2 version number within record
+ * headers and within the Client Hello.
+ */
+static inline __attribute__ (( always_inline )) unsigned int
+tls_legacy_version ( unsigned int version ) {
+	return ( ( version > TLS_VERSION_TLS_1_2 ) ?
+		 TLS_VERSION_TLS_1_2 : version );
+}
+
+/**
+ * Determine if TLS connection is ready to transmit application data
+ *
+ * @v tls		TLS connection
+ * @ret is_ready	TLS connection is ready to transmit
+ *
+ * Application data may be transmitted before the server Finished
+ * has been received (RFC 7918 "False Start"), provided that the
+ * cipher suite uses both an AEAD cipher and a forward-secret key
+ * exchange.  The server's certificate will already have been
+ * validated before the client Finished is sent.
+ */
+static int tls_tx_ready ( struct tls_connection *tls ) {
+	struct tls_cipher_suite *suite = tls->tx_cipherspec.suite;
+
+	/* Not ready until client has finished */
+	if ( is_pending ( &tls->client_negotiation ) )
+		return 0;
+
+	/* Ready if server has also finished */
+	if ( ! is_pending ( &tls->server_negotiation ) )
+		return 1;
+
+	/* Allow False Start only for suitable cipher suites */
+	return ( is_auth_cipher ( tls->tx_cipherspec.cipher ) &&
+		 ( suite->exchange != &tls_pubkey_exchange_algorithm ) );
+}
+
 /******************************************************************************
  *
  * Hybrid MD5+SHA1 hash as used by TLSv1.1 and earlier
@@ -378,6 +468,8 @@ static void free_tls ( struct refcnt *refcnt ) {
 
 	/* Free dynamically-allocated resources */
 	free ( tls->new_session_ticket );
+	free ( tls->ticket );
+	free ( tls->key_share );
 	tls_clear_cipher ( tls, &tls->tx_cipherspec );
 	tls_clear_cipher ( tls, &tls->tx_cipherspec_pending );
 	tls_clear_cipher ( tls, &tls->rx_cipherspec );
@@ -689,7 +781,7 @@ static int tls_generate_keys ( struct tls_connection *tls ) {
 	key += hash_size;
 
 	/* TX key */
-	if ( ( rc = cipher_setkey ( tx_cipherspec->suite->cipher,
+	if ( ( rc = cipher_setkey ( tx_cipherspec->cipher,
 				    tx_cipherspec->cipher_ctx,
 				    key, key_size ) ) != 0 ) {
 		DBGC ( tls, "TLS %p could not set TX key: %s\n",
@@ -701,7 +793,7 @@ static int tls_generate_keys ( struct tls_connection *tls ) {
 	key += key_size;
 
 	/* RX key */
-	if ( ( rc = cipher_setkey ( rx_cipherspec->suite->cipher,
+	if ( ( rc = cipher_setkey ( rx_cipherspec->cipher,
 				    rx_cipherspec->cipher_ctx,
 				    key, key_size ) ) != 0 ) {
 		DBGC ( tls, "TLS %p could not set TX key: %s\n",
@@ -858,6 +950,7 @@ static void tls_clear_cipher ( struct tls_connection *tls __unused,
 	free ( cipherspec->dynamic );
 	memset ( cipherspec, 0, sizeof ( *cipherspec ) );
 	cipherspec->suite = &tls_cipher_suite_null;
+	cipherspec->cipher = tls_cipher_suite_null.cipher;
 }
 
 /**
@@ -872,13 +965,16 @@ static int tls_set_cipher ( struct tls_connection *tls,
 			    struct tls_cipherspec *cipherspec,
 			    struct tls_cipher_suite *suite ) {
 	struct pubkey_algorithm *pubkey = suite->pubkey;
-	struct cipher_algorithm *cipher = suite->cipher;
+	struct cipher_algorithm *cipher;
 	size_t total;
 	void *dynamic;
 
 	/* Clear out old cipher contents, if any */
 	tls_clear_cipher ( tls, cipherspec );
 
+	/* Use hardware-accelerated cipher, if available */
+	cipher = cipher_accelerated ( suite->cipher );
+
 	/* Allocate dynamic storage */
 	total = ( pubkey->ctxsize + cipher->ctxsize + suite->mac_len +
 		  suite->fixed_iv_len );
@@ -899,6 +995,7 @@ static int tls_set_cipher ( struct tls_connection *tls,
 
 	/* Store parameters */
 	cipherspec->suite = suite;
+	cipherspec->cipher = cipher;
 
 	return 0;
 }
@@ -969,6 +1066,235 @@ static int tls_change_cipher ( struct tls_connection *tls,
 	return 0;
 }
 
+/******************************************************************************
+ *
+ * TLSv1.3 key schedule
+ *
+ ******************************************************************************
+ */
+
+/**
+ * Check for TLSv1.3 cipher suite
+ *
+ * @v suite		Cipher suite
+ * @ret is_tls13	Cipher suite is a TLSv1.3 cipher suite
+ */
+static inline __attribute__ (( always_inline )) int
+tls13_suite ( struct tls_cipher_suite *suite ) {
+	return ( ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_3 ) &&
+		 ( suite->exchange == &tls13_exchange_algorithm ) );
+}
+
+/**
+ * Construct TLSv1.3 per-record nonce
+ *
+ * @v iv		Initialisation vector to update
+ * @v len		Length of initialisation vector
+ * @v seq		Record sequence number
+ */
+static void tls13_nonce ( uint8_t *iv, size_t len, uint64_t seq ) {
+	unsigned int i;
+
+	/* XOR sequence number into least significant bytes */
+	for ( i = 0 ; i < sizeof ( seq ) ; i++ ) {
+		iv[ len - i - 1 ] ^= ( seq & 0xff );
+		seq >>= 8;
+	}
+}
+
+/**
+ * Expand TLSv1.3 secret (HKDF-Expand-Label)
+ *
+ * @v tls		TLS connection
+ * @v digest		Digest algorithm
+ * @v secret		Secret
+ * @v label		Label (excluding "tls13 " prefix)
+ * @v context		Context
+ * @v context_len	Length of context
+ * @v out		Output buffer
+ * @v out_len		Length of output buffer
+ */
+static void tls13_expand_label ( struct tls_connection *tls,
+				 struct digest_algorithm *digest,
+				 const void *secret, const char *label,
+				 const void *context, size_t context_len,
+				 void *out, size_t out_len ) {
+	static const char prefix[] = "tls13 ";
+	size_t prefix_len = ( sizeof ( prefix ) - 1 /* NUL */ );
+	size_t label_len = strlen ( label );
+	struct {
+		uint16_t len;
+		uint8_t label_len;
+		char label[ prefix_len + label_len ];
+		uint8_t context_len;
+		uint8_t context[context_len];
+	} __attribute__ (( packed )) info;
+
+	/* Construct HkdfLabel */
+	info.len = htons ( out_len );
+	info.label_len = sizeof ( info.label );
+	memcpy ( info.label, prefix, prefix_len );
+	memcpy ( &info.label[prefix_len], label, label_len );
+	info.context_len = sizeof ( info.context );
+	memcpy ( info.context, context, sizeof ( info.context ) );
+
+	/* Expand secret */
+	hkdf_expand ( digest, secret, digest->digestsize, &info,
+		      sizeof ( info ), out, out_len );
+	DBGC2 ( tls, "TLS %p %s \"%s\":\n", tls, digest->name, label );
+	DBGC2_HD ( tls, out, out_len );
+}
+
+/**
+ * Derive TLSv1.3 secret (Derive-Secret)
+ *
+ * @v tls		TLS connection
+ * @v digest		Digest algorithm
+ * @v secret		Secret
+ * @v label		Label (excluding "tls13 " prefix)
+ * @v hash		Transcript hash, or NULL for an empty transcript
+ * @v out		Output buffer
+ */
+static void tls13_derive_secret ( struct tls_connection *tls,
+				  struct digest_algorithm *digest,
+				  const void *secret, const char *label,
+				  const void *hash, void *out ) {
+	uint8_t ctx[digest->ctxsize];
+	uint8_t empty[digest->digestsize];
+
+	/* Calculate empty transcript hash, if applicable */
+	if ( ! hash ) {
+		digest_init ( digest, ctx );
+		digest_final ( digest, ctx, empty );
+		hash = empty;
+	}
+
+	/* Expand secret */
+	tls13_expand_label ( tls, digest, secret, label, hash,
+			     digest->digestsize, out, digest->digestsize );
+}
+
+/**
+ * Advance TLSv1.3 key schedule to next secret
+ *
+ * @v tls		TLS connection
+ * @v ikm		Input keying material, or NULL for zeros
+ * @v ikm_len		Length of input keying material
+ *
+ * The current key schedule secret is held in the master secret.
+ */
+static void tls13_next_secret ( struct tls_connection *tls,
+				const void *ikm, size_t ikm_len ) {
+	struct digest_algorithm *digest = tls->handshake_digest;
+	uint8_t zero[digest->digestsize];
+
+	/* Use zeros for absent input keying material */
+	if ( ! ikm ) {
+		memset ( zero, 0, sizeof ( zero ) );
+		ikm = zero;
+		ikm_len = sizeof ( zero );
+	}
+
+	/* Calculate next secret */
+	tls13_derive_secret ( tls, digest, tls->master_secret, "derived",
+			      NULL, tls->master_secret );
+	hkdf_extract ( digest, tls->master_secret, digest->digestsize,
+		       ikm, ikm_len, tls->master_secret );
+	DBGC ( tls, "TLS %p key schedule secret:\n", tls );
+	DBGC_HD ( tls, tls->master_secret, digest->digestsize );
+}
+
+/**
+ * Derive TLSv1.3 traffic secrets
+ *
+ * @v tls		TLS connection
+ * @v client		Client secret label
+ * @v server		Server secret label
+ *
+ * The traffic secrets are derived from the current key schedule
+ * secret and the handshake transcript so far.
+ */
+static void tls13_traffic_secrets ( struct tls_connection *tls,
+				    const char *client, const char *server ) {
+	struct digest_algorithm *digest = tls->handshake_digest;
+	uint8_t hash[digest->digestsize];
+
+	/* Calculate transcript hash */
+	tls_verify_handshake ( tls, hash );
+
+	/* Derive traffic secrets */
+	tls13_derive_secret ( tls, digest, tls->master_secret, client, hash,
+			      tls->client_secret );
+	tls13_derive_secret ( tls, digest, tls->master_secret, server, hash,
+			      tls->server_secret );
+}
+
+/**
+ * Activate TLSv1.3 traffic keys
+ *
+ * @v tls		TLS connection
+ * @v suite		Cipher suite
+ * @v secret		Traffic secret
+ * @v pending		Pending cipher specification
+ * @v active		Active cipher specification to replace, or NULL
+ * @ret rc		Return status code
+ */
+static int tls13_set_keys ( struct tls_connection *tls,
+			    struct tls_cipher_suite *suite, const void *secret,
+			    struct tls_cipherspec *pending,
+			    struct tls_cipherspec *active ) {
+	struct digest_algorithm *digest = suite->handshake;
+	uint8_t key[suite->key_len];
+	int rc;
+
+	/* Set cipher suite */
+	if ( ( rc = tls_set_cipher ( tls, pending, suite ) ) != 0 )
+		return rc;
+
+	/* Derive key and initialisation vector */
+	tls13_expand_label ( tls, digest, secret, "key", NULL, 0,
+			     key, sizeof ( key ) );
+	tls13_expand_label ( tls, digest, secret, "iv", NULL, 0,
+			     pending->fixed_iv, suite->fixed_iv_len );
+	if ( ( rc = cipher_setkey ( pending->cipher, pending->cipher_ctx,
+				    key, sizeof ( key ) ) ) != 0 ) {
+		DBGC ( tls, "TLS %p could not set key: %s\n",
+		       tls, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Activate cipher specification, if applicable */
+	if ( active && ( ( rc = tls_change_cipher ( tls, pending,
+						    active ) ) != 0 ) ) {
+		return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Update TLSv1.3 traffic secret
+ *
+ * @v tls		TLS connection
+ * @v secret		Traffic secret to update
+ * @v pending		Pending cipher specification
+ * @v active		Active cipher specification to replace
+ * @ret rc		Return status code
+ */
+static int tls13_update_keys ( struct tls_connection *tls, void *secret,
+			       struct tls_cipherspec *pending,
+			       struct tls_cipherspec *active ) {
+	struct tls_cipher_suite *suite = active->suite;
+	struct digest_algorithm *digest = suite->handshake;
+
+	/* Calculate next generation of traffic secret */
+	tls13_expand_label ( tls, digest, secret, "traffic upd", NULL, 0,
+			     secret, digest->digestsize );
+
+	/* Activate new traffic keys */
+	return tls13_set_keys ( tls, suite, secret, pending, active );
+}
+
 /******************************************************************************
  *
  * Signature and hash algorithms
@@ -1004,38 +1330,104 @@ tls_signature_hash_algorithm ( struct pubkey_algorithm *pubkey,
 }
 
 /**
- * Find TLS signature algorithm
+ * Identify TLS signature and hash algorithm
  *
  * @v code		Signature and hash algorithm identifier
- * @ret pubkey		Public key algorithm, or NULL
+ * @ret sig_hash	Signature and hash algorithm, or NULL
+ *
+ * The signature and hash algorithm identifier must be matched as a
+ * whole, since the RSA-PSS signature schemes reuse values from the
+ * hash algorithm identifier space.
  */
-static struct pubkey_algorithm *
-tls_signature_hash_pubkey ( struct tls_signature_hash_id code ) {
+static struct tls_signature_hash_algorithm *
+tls_find_signature_hash ( struct tls_signature_hash_id code ) {
 	struct tls_signature_hash_algorithm *sig_hash;
 
 	/* Identify signature and hash algorithm */
 	for_each_table_entry ( sig_hash, TLS_SIG_HASH_ALGORITHMS ) {
-		if ( sig_hash->code.signature == code.signature )
-			return sig_hash->pubkey;
+		if ( ( sig_hash->code.hash == code.hash ) &&
+		     ( sig_hash->code.signature == code.signature ) ) {
+			return sig_hash;
+		}
 	}
 
 	return NULL;
 }
 
 /**
- * Find TLS hash algorithm
+ * Verify signature using server certificate
  *
- * @v code		Signature and hash algorithm identifier
- * @ret digest		Digest algorithm, or NULL
+ * @v tls		TLS connection
+ * @v pubkey		Public-key algorithm
+ * @v digest		Digest algorithm
+ * @v hash		Digest value
+ * @v signature		Signature
+ * @v signature_len	Length of signature
+ * @ret rc		Return status code
  */
-static struct digest_algorithm *
-tls_signature_hash_digest ( struct tls_signature_hash_id code ) {
-	struct tls_signature_hash_algorithm *sig_hash;
+static int tls_verify_signature ( struct tls_connection *tls,
+				  struct pubkey_algorithm *pubkey,
+				  struct digest_algorithm *digest,
+				  const void *hash, const void *signature,
+				  size_t signature_len ) {
+	struct x509_certificate *cert = x509_first ( tls->chain );
+	uint8_t ctx[pubkey->ctxsize];
+	int rc;
 
-	/* Identify signature and hash algorithm */
-	for_each_table_entry ( sig_hash, TLS_SIG_HASH_ALGORITHMS ) {
-		if ( sig_hash->code.hash == code.hash )
-			return sig_hash->digest;
+	/* Sanity check */
+	if ( ! cert ) {
+		DBGC ( tls, "TLS %p has no server certificate\n", tls );
+		rc = -EPERM_AUTH;
+		goto err_cert;
+	}
+
+	/* Initialise public-key algorithm */
+	if ( ( rc = pubkey_init ( pubkey, ctx,
+				  cert->subject.public_key.raw.data,
+				  cert->subject.public_key.raw.len ) ) != 0 ) {
+		DBGC ( tls, "TLS %p cannot initialise %s public key: %s\n",
+		       tls, pubkey->name, strerror ( rc ) );
+		goto err_init;
+	}
+
+	/* Verify signature */
+	if ( ( rc = pubkey_verify ( pubkey, ctx, digest, hash, signature,
+				    signature_len ) ) != 0 ) {
+		DBGC ( tls, "TLS %p %s-%s signature verification failed: %s\n",
+		       tls, pubkey->name, digest->name, strerror ( rc ) );
+		goto err_verify;
+	}
+
+ err_verify:
+	pubkey_final ( pubkey, ctx );
+ err_init:
+ err_cert:
+	return rc;
+}
+
+/******************************************************************************
+ *
+ * Named curves
+ *
+ ******************************************************************************
+ */
+
+/** Number of supported named curves */
+#define TLS_NUM_NAMED_CURVES table_num_entries ( TLS_NAMED_CURVES )
+
+/**
+ * Find TLS named curve
+ *
+ * @v code		Named curve identifier (in network-endian order)
+ * @ret named		Named curve, or NULL
+ */
+static struct tls_named_curve * tls_find_named_curve ( unsigned int code ) {
+	struct tls_named_curve *named;
+
+	/* Identify named curve */
+	for_each_table_entry ( named, TLS_NAMED_CURVES ) {
+		if ( named->code == code )
+			return named;
 	}
 
 	return NULL;
@@ -1107,6 +1499,110 @@ static int tls_send_handshake ( struct tls_connection *tls,
 	return tls_send_plaintext ( tls, TLS_TYPE_HANDSHAKE, data, len );
 }
 
+/**
+ * Calculate TLSv1.3 pre-shared key binder
+ *
+ * @v tls		TLS connection
+ * @v hello		Partial Client Hello record
+ * @v len		Length of partial Client Hello record
+ * @v binder		Binder to fill in
+ *
+ * The pre-shared key must already be present in the master secret.
+ */
+static void tls13_binder ( struct tls_connection *tls, const void *hello,
+			   size_t len, void *binder ) {
+	struct digest_algorithm *digest = tls->psk_digest;
+	uint8_t ctx[ hmac_ctxsize ( digest ) ];
+	uint8_t secret[digest->digestsize];
+	uint8_t hash[digest->digestsize];
+
+	/* Calculate early secret, binder key, and finished key */
+	hkdf_extract ( digest, NULL, 0, tls->master_secret, sizeof ( secret ),
+		       secret );
+	tls13_derive_secret ( tls, digest, secret, "res binder", NULL,
+			      secret );
+	tls13_expand_label ( tls, digest, secret, "finished", NULL, 0,
+			     secret, sizeof ( secret ) );
+
+	/* Calculate hash of partial Client Hello */
+	digest_init ( digest, ctx );
+	digest_update ( digest, ctx, hello, len );
+	digest_final ( digest, ctx, hash );
+
+	/* Calculate binder */
+	hmac_init ( digest, ctx, secret, sizeof ( secret ) );
+	hmac_update ( digest, ctx, hash, sizeof ( hash ) );
+	hmac_final ( digest, ctx, binder );
+}
+
+/**
+ * Generate TLSv1.3 key shares
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ *
+ * A key share is generated for every supported named curve, to avoid
+ * the need to handle a Hello Retry Request.  The list of key share
+ * entries is followed immediately by the corresponding private keys.
+ */
+static int tls13_generate_key_shares ( struct tls_connection *tls ) {
+	struct tls_named_curve *named;
+	struct elliptic_curve *curve;
+	struct {
+		uint16_t group;
+		uint16_t len;
+		uint8_t public[0];
+	} __attribute__ (( packed )) *entry;
+	size_t offset;
+	size_t len = 0;
+	size_t keys_len = 0;
+	void *private;
+	int rc;
+
+	/* Calculate length of key shares and private keys */
+	for_each_table_entry ( named, TLS_NAMED_CURVES ) {
+		curve = named->curve;
+		len += ( sizeof ( *entry ) + ( named->format ? 1 : 0 ) +
+			 curve->pointsize );
+		keys_len += curve->keysize;
+	}
+
+	/* Allocate key shares and private keys */
+	free ( tls->key_share );
+	tls->key_share_len = 0;
+	tls->key_share = malloc ( len + keys_len );
+	if ( ! tls->key_share )
+		return -ENOMEM;
+	tls->key_share_len = len;
+
+	/* Generate key shares */
+	entry = tls->key_share;
+	private = ( tls->key_share + len );
+	for_each_table_entry ( named, TLS_NAMED_CURVES ) {
+		curve = named->curve;
+		offset = ( named->format ? 1 : 0 );
+		entry->group = named->code;
+		entry->len = htons ( offset + curve->pointsize );
+		if ( named->format )
+			entry->public[0] = named->format;
+		if ( ( rc = tls_generate_random ( tls, private,
+						  curve->keysize ) ) != 0 )
+			return rc;
+		if ( ( rc = elliptic_multiply ( curve, curve->base, private,
+						&entry->public[offset] ) )
+		     != 0 ) {
+			DBGC ( tls, "TLS %p could not generate ephemeral %s "
+			       "key: %s\n", tls, curve->name, strerror ( rc ) );
+			return rc;
+		}
+		entry = ( ( ( void * ) entry ) + sizeof ( *entry ) + offset +
+			  curve->pointsize );
+		private += curve->keysize;
+	}
+
+	return 0;
+}
+
 /**
  * Digest or transmit Client Hello record
  *
@@ -1120,6 +1616,11 @@ static int tls_client_hello ( struct tls_connection *tls,
 						 size_t len ) ) {
 	struct tls_session *session = tls->session;
 	size_t name_len = strlen ( session->name );
+	unsigned int ecc = ( TLS_NUM_NAMED_CURVES ? 1 : 0 );
+	unsigned int tls13_ext =
+		( ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_3 ) ? 1 : 0 );
+	unsigned int psk = ( tls->psk_digest ? 1 : 0 );
+	size_t binder_len = ( psk ? tls->psk_digest->digestsize : 0 );
 	struct {
 		uint32_t type_length;
 		uint16_t version;
@@ -1154,6 +1655,22 @@ static int tls_client_hello ( struct tls_connection *tls,
 				struct tls_signature_hash_id
 					code[TLS_NUM_SIG_HASH_ALGORITHMS];
 			} __attribute__ (( packed )) signature_algorithms;
+			struct {
+				uint16_t type;
+				uint16_t len;
+				struct {
+					uint16_t len;
+					uint16_t code[TLS_NUM_NAMED_CURVES];
+				} __attribute__ (( packed )) data;
+			} __attribute__ (( packed )) named_curve[ecc];
+			struct {
+				uint16_t type;
+				uint16_t len;
+				struct {
+					uint8_t len;
+					uint8_t format[1];
+				} __attribute__ (( packed )) data;
+			} __attribute__ (( packed )) point_formats[ecc];
 			uint16_t renegotiation_info_type;
 			uint16_t renegotiation_info_len;
 			struct {
@@ -1164,12 +1681,56 @@ static int tls_client_hello ( struct tls_connection *tls,
 			uint16_t session_ticket_type;
 			uint16_t session_ticket_len;
 			struct {
-				uint8_t data[session->ticket_len];
+				uint8_t data[ psk ? 0 : tls->ticket_len ];
 			} __attribute__ (( packed )) session_ticket;
+			struct {
+				uint16_t type;
+				uint16_t len;
+				struct {
+					uint8_t len;
+					uint16_t version[ TLS_VERSION_MAX -
+							  TLS_VERSION_MIN + 1 ];
+				} __attribute__ (( packed )) data;
+			} __attribute__ (( packed )) versions[tls13_ext];
+			struct {
+				uint16_t type;
+				uint16_t len;
+				struct {
+					uint8_t len;
+					uint8_t mode[1];
+				} __attribute__ (( packed )) data;
+			} __attribute__ (( packed )) psk_modes[tls13_ext];
+			struct {
+				uint16_t type;
+				uint16_t len;
+				struct {
+					uint16_t len;
+					uint8_t data[tls->key_share_len];
+				} __attribute__ (( packed )) data;
+			} __attribute__ (( packed )) key_share[tls13_ext];
+			struct {
+				uint16_t type;
+				uint16_t len;
+				struct {
+					uint16_t identities_len;
+					struct {
+						uint16_t len;
+						uint8_t data[tls->ticket_len];
+						uint32_t age;
+					} __attribute__ (( packed )) ids[1];
+					uint16_t binders_len;
+					struct {
+						uint8_t len;
+						uint8_t data[binder_len];
+					} __attribute__ (( packed )) binders[1];
+				} __attribute__ (( packed )) data;
+			} __attribute__ (( packed )) pre_shared_key[psk];
 		} __attribute__ (( packed )) extensions;
 	} __attribute__ (( packed )) hello;
 	struct tls_cipher_suite *suite;
 	struct tls_signature_hash_algorithm *sighash;
+	struct tls_named_curve *named;
+	void *binders;
 	unsigned int i;
 
 	/* Construct record */
@@ -1177,7 +1738,7 @@ static int tls_client_hello ( struct tls_connection *tls,
 	hello.type_length = ( cpu_to_le32 ( TLS_CLIENT_HELLO ) |
 			      htonl ( sizeof ( hello ) -
 				      sizeof ( hello.type_length ) ) );
-	hello.version = htons ( TLS_VERSION_MAX );
+	hello.version = htons ( tls_legacy_version ( TLS_VERSION_MAX ) );
 	memcpy ( &hello.random, &tls->client_random, sizeof ( hello.random ) );
 	hello.session_id_len = tls->session_id_len;
 	memcpy ( hello.session_id, tls->session_id,
@@ -1211,6 +1772,24 @@ static int tls_client_hello ( struct tls_connection *tls,
 		= htons ( sizeof ( hello.extensions.signature_algorithms.code));
 	i = 0 ; for_each_table_entry ( sighash, TLS_SIG_HASH_ALGORITHMS )
 		hello.extensions.signature_algorithms.code[i++] = sighash->code;
+	if ( ecc ) {
+		typeof ( hello.extensions.named_curve[0] ) *named_curve =
+			&hello.extensions.named_curve[0];
+		typeof ( hello.extensions.point_formats[0] ) *point_formats =
+			&hello.extensions.point_formats[0];
+
+		named_curve->type = htons ( TLS_NAMED_CURVE );
+		named_curve->len = htons ( sizeof ( named_curve->data ) );
+		named_curve->data.len =
+			htons ( sizeof ( named_curve->data.code ) );
+		i = 0 ; for_each_table_entry ( named, TLS_NAMED_CURVES )
+			named_curve->data.code[i++] = named->code;
+		point_formats->type = htons ( TLS_POINT_FORMATS );
+		point_formats->len = htons ( sizeof ( point_formats->data ) );
+		point_formats->data.len =
+			sizeof ( point_formats->data.format );
+		point_formats->data.format[0] = TLS_POINT_FORMAT_UNCOMPRESSED;
+	}
 	hello.extensions.renegotiation_info_type
 		= htons ( TLS_RENEGOTIATION_INFO );
 	hello.extensions.renegotiation_info_len
@@ -1222,8 +1801,63 @@ static int tls_client_hello ( struct tls_connection *tls,
 	hello.extensions.session_ticket_type = htons ( TLS_SESSION_TICKET );
 	hello.extensions.session_ticket_len
 		= htons ( sizeof ( hello.extensions.session_ticket ) );
-	memcpy ( hello.extensions.session_ticket.data, session->ticket,
+	memcpy ( hello.extensions.session_ticket.data, tls->ticket,
 		 sizeof ( hello.extensions.session_ticket.data ) );
+	if ( tls13_ext ) {
+		typeof ( hello.extensions.versions[0] ) *versions =
+			&hello.extensions.versions[0];
+		typeof ( hello.extensions.psk_modes[0] ) *psk_modes =
+			&hello.extensions.psk_modes[0];
+		typeof ( hello.extensions.key_share[0] ) *key_share =
+			&hello.extensions.key_share[0];
+
+		versions->type = htons ( TLS_SUPPORTED_VERSIONS );
+		versions->len = htons ( sizeof ( versions->data ) );
+		versions->data.len = sizeof ( versions->data.version );
+		for ( i = 0 ; i < ( sizeof ( versions->data.version ) /
+				    sizeof ( versions->data.version[0] ) ) ;
+		      i++ ) {
+			versions->data.version[i] =
+				htons ( TLS_VERSION_MAX - i );
+		}
+		psk_modes->type = htons ( TLS_PSK_KEY_EXCHANGE_MODES );
+		psk_modes->len = htons ( sizeof ( psk_modes->data ) );
+		psk_modes->data.len = sizeof ( psk_modes->data.mode );
+		psk_modes->data.mode[0] = TLS_PSK_DHE_KE;
+		key_share->type = htons ( TLS_KEY_SHARE );
+		key_share->len = htons ( sizeof ( key_share->data ) );
+		key_share->data.len = htons ( sizeof ( key_share->data.data ) );
+		memcpy ( key_share->data.data, tls->key_share,
+			 sizeof ( key_share->data.data ) );
+	}
+	if ( psk ) {
+		typeof ( hello.extensions.pre_shared_key[0] ) *pre_shared_key =
+			&hello.extensions.pre_shared_key[0];
+		typeof ( pre_shared_key->data.ids[0] ) *identity =
+			&pre_shared_key->data.ids[0];
+		typeof ( pre_shared_key->data.binders[0] ) *binder =
+			&pre_shared_key->data.binders[0];
+
+		/* The pre-shared key extension must be the final
+		 * extension, since the binder is calculated over the
+		 * Client Hello up to (but excluding) the list of
+		 * binders.
+		 */
+		pre_shared_key->type = htons ( TLS_PRE_SHARED_KEY );
+		pre_shared_key->len = htons ( sizeof ( pre_shared_key->data ) );
+		pre_shared_key->data.identities_len =
+			htons ( sizeof ( pre_shared_key->data.ids ) );
+		identity->len = htons ( sizeof ( identity->data ) );
+		memcpy ( identity->data, tls->ticket,
+			 sizeof ( identity->data ) );
+		identity->age = htonl ( tls->ticket_age );
+		pre_shared_key->data.binders_len =
+			htons ( sizeof ( pre_shared_key->data.binders ) );
+		binder->len = sizeof ( binder->data );
+		binders = &pre_shared_key->data.binders_len;
+		tls13_binder ( tls, &hello, ( binders - ( ( void * ) &hello ) ),
+			       binder->data );
+	}
 
 	return action ( tls, &hello, sizeof ( hello ) );
 }
@@ -1246,12 +1880,17 @@ static int tls_send_client_hello ( struct tls_connection *tls ) {
  * @ret rc		Return status code
  */
 static int tls_send_certificate ( struct tls_connection *tls ) {
+	unsigned int tls13_ext = ( tls13 ( tls ) ? 1 : 0 );
 	struct {
 		tls24_t length;
 		uint8_t data[0];
 	} __attribute__ (( packed )) *certificate;
+	struct {
+		uint16_t len;
+	} __attribute__ (( packed )) extensions[tls13_ext];
 	struct {
 		uint32_t type_length;
+		uint8_t context_len[tls13_ext];
 		tls24_t length;
 		typeof ( *certificate ) certificates[0];
 	} __attribute__ (( packed )) *certificates;
@@ -1260,11 +1899,14 @@ static int tls_send_certificate ( struct tls_connection *tls ) {
 	size_t len;
 	int rc;
 
-	/* Calculate length of client certificates */
+	/* Calculate length of client certificates (each followed by
+	 * an empty list of extensions for TLSv1.3).
+	 */
 	len = 0;
 	list_for_each_entry ( link, &tls->certs->links, list ) {
 		cert = link->cert;
-		len += ( sizeof ( *certificate ) + cert->raw.len );
+		len += ( sizeof ( *certificate ) + cert->raw.len +
+			 sizeof ( extensions ) );
 		DBGC ( tls, "TLS %p sending client certificate %s\n",
 		       tls, x509_name ( cert ) );
 	}
@@ -1288,7 +1930,7 @@ static int tls_send_certificate ( struct tls_connection *tls ) {
 		tls_set_uint24 ( &certificate->length, cert->raw.len );
 		memcpy ( certificate->data, cert->raw.data, cert->raw.len );
 		certificate = ( ( ( void * ) certificate->data ) +
-				cert->raw.len );
+				cert->raw.len + sizeof ( extensions ) );
 	}
 
 	/* Transmit record */
@@ -1325,7 +1967,8 @@ static int tls_send_client_key_exchange_pubkey ( struct tls_connection *tls ) {
 	int rc;
 
 	/* Generate pre-master secret */
-	pre_master_secret.version = htons ( TLS_VERSION_MAX );
+	pre_master_secret.version =
+		htons ( tls_legacy_version ( TLS_VERSION_MAX ) );
 	if ( ( rc = tls_generate_random ( tls, &pre_master_secret.random,
 			  ( sizeof ( pre_master_secret.random ) ) ) ) != 0 ) {
 		return rc;
@@ -1373,21 +2016,19 @@ struct tls_key_exchange_algorithm tls_pubkey_exchange_algorithm = {
 };
 
 /**
- * Transmit Client Key Exchange record using DHE key exchange
+ * Verify Diffie-Hellman parameter signature
  *
  * @v tls		TLS connection
+ * @v param_len		Diffie-Hellman parameter length
  * @ret rc		Return status code
  */
-static int tls_send_client_key_exchange_dhe ( struct tls_connection *tls ) {
+static int tls_verify_dh_params ( struct tls_connection *tls,
+				  size_t param_len ) {
 	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec_pending;
+	struct tls_signature_hash_algorithm *sig_hash;
 	struct pubkey_algorithm *pubkey;
 	struct digest_algorithm *digest;
 	int use_sig_hash = tls_version ( tls, TLS_VERSION_TLS_1_2 );
-	uint8_t private[ sizeof ( tls->client_random.random ) ];
-	const struct {
-		uint16_t len;
-		uint8_t data[0];
-	} __attribute__ (( packed )) *dh_val[3];
 	const struct {
 		struct tls_signature_hash_id sig_hash[use_sig_hash];
 		uint16_t signature_len;
@@ -1395,29 +2036,14 @@ static int tls_send_client_key_exchange_dhe ( struct tls_connection *tls ) {
 	} __attribute__ (( packed )) *sig;
 	const void *data;
 	size_t remaining;
-	size_t frag_len;
-	unsigned int i;
 	int rc;
 
-	/* Parse ServerKeyExchange */
-	data = tls->server_key;
-	remaining = tls->server_key_len;
-	for ( i = 0 ; i < ( sizeof ( dh_val ) / sizeof ( dh_val[0] ) ) ; i++ ){
-		dh_val[i] = data;
-		if ( ( sizeof ( *dh_val[i] ) > remaining ) ||
-		     ( ntohs ( dh_val[i]->len ) > ( remaining -
-						    sizeof ( *dh_val[i] ) ) )){
-			DBGC ( tls, "TLS %p received underlength "
-			       "ServerKeyExchange\n", tls );
-			DBGC_HDA ( tls, 0, tls->server_key,
-				   tls->server_key_len );
-			rc = -EINVAL_KEY_EXCHANGE;
-			goto err_header;
-		}
-		frag_len = ( sizeof ( *dh_val[i] ) + ntohs ( dh_val[i]->len ));
-		data += frag_len;
-		remaining -= frag_len;
-	}
+	/* Signature follows parameters */
+	assert ( param_len <= tls->server_key_len );
+	data = ( tls->server_key + param_len );
+	remaining = ( tls->server_key_len - param_len );
+
+	/* Parse signature from ServerKeyExchange */
 	sig = data;
 	if ( ( sizeof ( *sig ) > remaining ) ||
 	     ( ntohs ( sig->signature_len ) > ( remaining -
@@ -1425,30 +2051,23 @@ static int tls_send_client_key_exchange_dhe ( struct tls_connection *tls ) {
 		DBGC ( tls, "TLS %p received underlength ServerKeyExchange\n",
 		       tls );
 		DBGC_HDA ( tls, 0, tls->server_key, tls->server_key_len );
-		rc = -EINVAL_KEY_EXCHANGE;
-		goto err_header;
+		return -EINVAL_KEY_EXCHANGE;
 	}
 
 	/* Identify signature and hash algorithm */
 	if ( use_sig_hash ) {
-		pubkey = tls_signature_hash_pubkey ( sig->sig_hash[0] );
-		digest = tls_signature_hash_digest ( sig->sig_hash[0] );
-		if ( ( ! pubkey ) || ( ! digest ) ) {
+		sig_hash = tls_find_signature_hash ( sig->sig_hash[0] );
+		if ( ! sig_hash ) {
 			DBGC ( tls, "TLS %p ServerKeyExchange unsupported "
 			       "signature and hash algorithm\n", tls );
-			rc = -ENOTSUP_SIG_HASH;
-			goto err_sig_hash;
-		}
-		if ( pubkey != cipherspec->suite->pubkey ) {
-			DBGC ( tls, "TLS %p ServerKeyExchange incorrect "
-			       "signature algorithm %s (expected %s)\n", tls,
-			       pubkey->name, cipherspec->suite->pubkey->name );
-			rc = -EPERM_KEY_EXCHANGE;
-			goto err_sig_hash;
+			return -ENOTSUP_SIG_HASH;
 		}
+		pubkey = sig_hash->pubkey;
+		digest = sig_hash->digest;
 	} else {
 		pubkey = cipherspec->suite->pubkey;
-		digest = &md5_sha1_algorithm;
+		digest = ( ( pubkey == &rsa_algorithm ) ?
+			   &md5_sha1_algorithm : &sha1_algorithm );
 	}
 
 	/* Verify signature */
@@ -1464,22 +2083,67 @@ static int tls_send_client_key_exchange_dhe ( struct tls_connection *tls ) {
 				sizeof ( tls->client_random ) );
 		digest_update ( digest, ctx, tls->server_random,
 				sizeof ( tls->server_random ) );
-		digest_update ( digest, ctx, tls->server_key,
-				( tls->server_key_len - remaining ) );
+		digest_update ( digest, ctx, tls->server_key, param_len );
 		digest_final ( digest, ctx, hash );
 
-		/* Verify signature */
-		if ( ( rc = pubkey_verify ( pubkey, cipherspec->pubkey_ctx,
-					    digest, hash, signature,
-					    signature_len ) ) != 0 ) {
+		/* Verify signature using server certificate */
+		if ( ( rc = tls_verify_signature ( tls, pubkey, digest, hash,
+						   signature,
+						   signature_len ) ) != 0 ) {
 			DBGC ( tls, "TLS %p ServerKeyExchange failed "
 			       "verification\n", tls );
 			DBGC_HDA ( tls, 0, tls->server_key,
 				   tls->server_key_len );
-			rc = -EPERM_KEY_EXCHANGE;
-			goto err_verify;
+			return -EPERM_KEY_EXCHANGE;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Transmit Client Key Exchange record using DHE key exchange
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls_send_client_key_exchange_dhe ( struct tls_connection *tls ) {
+	uint8_t private[ sizeof ( tls->client_random.random ) ];
+	const struct {
+		uint16_t len;
+		uint8_t data[0];
+	} __attribute__ (( packed )) *dh_val[3];
+	const void *data;
+	size_t remaining;
+	size_t frag_len;
+	size_t param_len;
+	unsigned int i;
+	int rc;
+
+	/* Parse ServerKeyExchange */
+	data = tls->server_key;
+	remaining = tls->server_key_len;
+	for ( i = 0 ; i < ( sizeof ( dh_val ) / sizeof ( dh_val[0] ) ) ; i++ ){
+		dh_val[i] = data;
+		if ( ( sizeof ( *dh_val[i] ) > remaining ) ||
+		     ( ntohs ( dh_val[i]->len ) > ( remaining -
+						    sizeof ( *dh_val[i] ) ) )){
+			DBGC ( tls, "TLS %p received underlength "
+			       "ServerKeyExchange\n", tls );
+			DBGC_HDA ( tls, 0, tls->server_key,
+				   tls->server_key_len );
+			rc = -EINVAL_KEY_EXCHANGE;
+			goto err_header;
 		}
+		frag_len = ( sizeof ( *dh_val[i] ) + ntohs ( dh_val[i]->len ));
+		data += frag_len;
+		remaining -= frag_len;
 	}
+	param_len = ( tls->server_key_len - remaining );
+
+	/* Verify parameter signature */
+	if ( ( rc = tls_verify_dh_params ( tls, param_len ) ) != 0 )
+		goto err_verify;
 
 	/* Generate Diffie-Hellman private key */
 	if ( ( rc = tls_generate_random ( tls, private,
@@ -1560,7 +2224,6 @@ static int tls_send_client_key_exchange_dhe ( struct tls_connection *tls ) {
  err_alloc:
  err_random:
  err_verify:
- err_sig_hash:
  err_header:
 	return rc;
 }
@@ -1571,6 +2234,145 @@ struct tls_key_exchange_algorithm tls_dhe_exchange_algorithm = {
 	.exchange = tls_send_client_key_exchange_dhe,
 };
 
+/**
+ * Transmit Client Key Exchange record using ECDHE key exchange
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls_send_client_key_exchange_ecdhe ( struct tls_connection *tls ) {
+	struct tls_named_curve *named;
+	struct elliptic_curve *curve;
+	const struct {
+		uint8_t curve_type;
+		uint16_t named_curve;
+		uint8_t public_len;
+		uint8_t public[0];
+	} __attribute__ (( packed )) *ecdh;
+	size_t param_len;
+	size_t pointsize;
+	size_t keysize;
+	size_t offset;
+	int rc;
+
+	/* Parse ServerKeyExchange record */
+	ecdh = tls->server_key;
+	if ( ( sizeof ( *ecdh ) > tls->server_key_len ) ||
+	     ( ecdh->public_len > ( tls->server_key_len - sizeof ( *ecdh ) ))){
+		DBGC ( tls, "TLS %p received underlength ServerKeyExchange\n",
+		       tls );
+		DBGC_HDA ( tls, 0, tls->server_key, tls->server_key_len );
+		return -EINVAL_KEY_EXCHANGE;
+	}
+	param_len = ( sizeof ( *ecdh ) + ecdh->public_len );
+
+	/* Verify parameter signature */
+	if ( ( rc = tls_verify_dh_params ( tls, param_len ) ) != 0 )
+		return rc;
+
+	/* Identify named curve */
+	if ( ecdh->curve_type != TLS_NAMED_CURVE_TYPE ) {
+		DBGC ( tls, "TLS %p unsupported curve type %d\n",
+		       tls, ecdh->curve_type );
+		DBGC_HDA ( tls, 0, tls->server_key, tls->server_key_len );
+		return -ENOTSUP_CURVE;
+	}
+	named = tls_find_named_curve ( ecdh->named_curve );
+	if ( ! named ) {
+		DBGC ( tls, "TLS %p unsupported named curve %d\n",
+		       tls, ntohs ( ecdh->named_curve ) );
+		DBGC_HDA ( tls, 0, tls->server_key, tls->server_key_len );
+		return -ENOTSUP_CURVE;
+	}
+	curve = named->curve;
+	pointsize = curve->pointsize;
+	keysize = curve->keysize;
+	offset = ( named->format ? 1 : 0 );
+	DBGC ( tls, "TLS %p using named curve %s\n", tls, curve->name );
+
+	/* Check key length and format */
+	if ( ( ecdh->public_len != ( offset + pointsize ) ) ||
+	     ( named->format && ( ecdh->public[0] != named->format ) ) ) {
+		DBGC ( tls, "TLS %p invalid %s key\n", tls, curve->name );
+		DBGC_HDA ( tls, 0, tls->server_key, tls->server_key_len );
+		return -EINVAL_KEY_EXCHANGE;
+	}
+
+	/* Construct pre-master secret and ClientKeyExchange record */
+	{
+		uint8_t private[keysize];
+		uint8_t pre_master_secret[pointsize];
+		struct {
+			uint32_t type_length;
+			uint8_t public_len;
+			uint8_t public[ offset + pointsize ];
+		} __attribute__ (( packed )) key_xchg;
+
+		/* Generate ephemeral private key */
+		if ( ( rc = tls_generate_random ( tls, private,
+						  sizeof ( private ) ) ) != 0){
+			return rc;
+		}
+
+		/* Exchange keys */
+		if ( ( rc = elliptic_multiply ( curve, curve->base, private,
+						&key_xchg.public[offset] ) )
+		     != 0 ) {
+			DBGC ( tls, "TLS %p could not generate ephemeral %s "
+			       "key: %s\n", tls, curve->name, strerror ( rc ) );
+			return rc;
+		}
+		if ( ( rc = elliptic_multiply ( curve, &ecdh->public[offset],
+						private,
+						pre_master_secret ) ) != 0 ) {
+			DBGC ( tls, "TLS %p could not exchange %s key: %s\n",
+			       tls, curve->name, strerror ( rc ) );
+			return rc;
+		}
+
+		/* Generate master secret */
+		tls_generate_master_secret ( tls, pre_master_secret,
+					     named->pre_master_secret_len );
+
+		/* Generate keys */
+		if ( ( rc = tls_generate_keys ( tls ) ) != 0 ) {
+			DBGC ( tls, "TLS %p could not generate keys: %s\n",
+			       tls, strerror ( rc ) );
+			return rc;
+		}
+
+		/* Transmit Client Key Exchange record */
+		key_xchg.type_length =
+			( cpu_to_le32 ( TLS_CLIENT_KEY_EXCHANGE ) |
+			  htonl ( sizeof ( key_xchg ) -
+				  sizeof ( key_xchg.type_length ) ) );
+		key_xchg.public_len = sizeof ( key_xchg.public );
+		if ( named->format )
+			key_xchg.public[0] = named->format;
+		if ( ( rc = tls_send_handshake ( tls, &key_xchg,
+						 sizeof ( key_xchg ) ) ) != 0 ){
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+/** Ephemeral Elliptic Curve Diffie-Hellman key exchange algorithm */
+struct tls_key_exchange_algorithm tls_ecdhe_exchange_algorithm = {
+	.name = "ecdhe",
+	.exchange = tls_send_client_key_exchange_ecdhe,
+};
+
+/** TLSv1.3 key exchange algorithm
+ *
+ * TLSv1.3 exchanges keys via the key share extensions within the
+ * Client Hello and Server Hello, and has no Client Key Exchange.
+ */
+struct tls_key_exchange_algorithm tls13_exchange_algorithm = {
+	.name = "tls13",
+};
+
 /**
  * Transmit Client Key Exchange record
  *
@@ -1585,6 +2387,35 @@ static int tls_send_client_key_exchange ( struct tls_connection *tls ) {
 	return suite->exchange->exchange ( tls );
 }
 
+/**
+ * Calculate TLSv1.3 Certificate Verify digest
+ *
+ * @v tls		TLS connection
+ * @v digest		Digest algorithm
+ * @v context		Context string
+ * @v out		Output buffer
+ */
+static void tls13_verify_digest ( struct tls_connection *tls,
+				  struct digest_algorithm *digest,
+				  const char *context, void *out ) {
+	uint8_t hash[tls->handshake_digest->digestsize];
+	uint8_t ctx[digest->ctxsize];
+	uint8_t pad[64];
+
+	/* Calculate transcript hash */
+	tls_verify_handshake ( tls, hash );
+
+	/* Calculate digest over padding, context string (including
+	 * the terminating NUL separator), and transcript hash.
+	 */
+	memset ( pad, ' ', sizeof ( pad ) );
+	digest_init ( digest, ctx );
+	digest_update ( digest, ctx, pad, sizeof ( pad ) );
+	digest_update ( digest, ctx, context, ( strlen ( context ) + 1 ) );
+	digest_update ( digest, ctx, hash, sizeof ( hash ) );
+	digest_final ( digest, ctx, out );
+}
+
 /**
  * Transmit Certificate Verify record
  *
@@ -1601,8 +2432,21 @@ static int tls_send_certificate_verify ( struct tls_connection *tls ) {
 	struct tls_signature_hash_algorithm *sig_hash = NULL;
 	int rc;
 
-	/* Generate digest to be signed */
-	tls_verify_handshake ( tls, digest_out );
+	/* Generate digest to be signed.  TLSv1.3 prohibits the use
+	 * of PKCS#1 v1.5 signatures, and so requires RSA-PSS for RSA
+	 * keys (which uses an identical key format).
+	 */
+	if ( tls13 ( tls ) ) {
+		tls13_verify_digest ( tls, digest,
+				      "TLS 1.3, client CertificateVerify",
+				      digest_out );
+		if ( pubkey == &rsa_algorithm ) {
+			assert ( rsa_pss_algorithm.ctxsize == pubkey->ctxsize );
+			pubkey = &rsa_pss_algorithm;
+		}
+	} else {
+		tls_verify_handshake ( tls, digest_out );
+	}
 
 	/* Initialise public-key algorithm */
 	if ( ( rc = pubkey_init ( pubkey, ctx, key->data, key->len ) ) != 0 ) {
@@ -1687,6 +2531,58 @@ static int tls_send_change_cipher ( struct tls_connection *tls ) {
 				    change_cipher, sizeof ( change_cipher ) );
 }
 
+/**
+ * Transmit TLSv1.3 Finished record
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls13_send_finished ( struct tls_connection *tls ) {
+	struct digest_algorithm *digest = tls->handshake_digest;
+	struct {
+		uint32_t type_length;
+		uint8_t verify_data[digest->digestsize];
+	} __attribute__ (( packed )) finished;
+	uint8_t ctx[ hmac_ctxsize ( digest ) ];
+	uint8_t hash[digest->digestsize];
+	int rc;
+
+	/* Construct client verification data */
+	tls_verify_handshake ( tls, hash );
+	hmac_init ( digest, ctx, tls->finished_key, digest->digestsize );
+	hmac_update ( digest, ctx, hash, sizeof ( hash ) );
+	hmac_final ( digest, ctx, finished.verify_data );
+
+	/* Construct record */
+	finished.type_length = ( cpu_to_le32 ( TLS_FINISHED ) |
+				 htonl ( sizeof ( finished ) -
+					 sizeof ( finished.type_length ) ) );
+
+	/* Transmit record */
+	if ( ( rc = tls_send_handshake ( tls, &finished,
+					 sizeof ( finished ) ) ) != 0 )
+		return rc;
+
+	/* Activate application traffic keys */
+	if ( ( rc = tls_change_cipher ( tls, &tls->tx_cipherspec_pending,
+					&tls->tx_cipherspec ) ) != 0 ) {
+		DBGC ( tls, "TLS %p could not activate TX cipher: %s\n",
+		       tls, strerror ( rc ) );
+		return rc;
+	}
+	tls->tx_seq = 0;
+
+	/* Derive resumption master secret */
+	tls_verify_handshake ( tls, hash );
+	tls13_derive_secret ( tls, digest, tls->master_secret, "res master",
+			      hash, tls->master_secret );
+
+	/* Mark client as finished */
+	pending_put ( &tls->client_negotiation );
+
+	return 0;
+}
+
 /**
  * Transmit Finished record
  *
@@ -1702,6 +2598,10 @@ static int tls_send_finished ( struct tls_connection *tls ) {
 	uint8_t digest_out[ digest->digestsize ];
 	int rc;
 
+	/* Handle TLSv1.3 separately */
+	if ( tls13 ( tls ) )
+		return tls13_send_finished ( tls );
+
 	/* Construct client verification data */
 	tls_verify_handshake ( tls, digest_out );
 	tls_prf_label ( tls, &tls->master_secret, sizeof ( tls->master_secret ),
@@ -1727,6 +2627,40 @@ static int tls_send_finished ( struct tls_connection *tls ) {
 	return 0;
 }
 
+/**
+ * Transmit TLSv1.3 Key Update record
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls13_send_key_update ( struct tls_connection *tls ) {
+	struct {
+		uint32_t type_length;
+		uint8_t request;
+	} __attribute__ (( packed )) key_update;
+	int rc;
+
+	/* Construct record */
+	key_update.type_length = ( cpu_to_le32 ( TLS_KEY_UPDATE ) |
+				   htonl ( sizeof ( key_update ) -
+					   sizeof ( key_update.type_length )));
+	key_update.request = 0;
+
+	/* Transmit record (which is not part of the handshake digest) */
+	if ( ( rc = tls_send_plaintext ( tls, TLS_TYPE_HANDSHAKE, &key_update,
+					 sizeof ( key_update ) ) ) != 0 )
+		return rc;
+
+	/* Update client application traffic keys */
+	if ( ( rc = tls13_update_keys ( tls, tls->client_secret,
+					&tls->tx_cipherspec_pending,
+					&tls->tx_cipherspec ) ) != 0 )
+		return rc;
+	tls->tx_seq = 0;
+
+	return 0;
+}
+
 /**
  * Receive new Change Cipher record
  *
@@ -1745,6 +2679,12 @@ static int tls_new_change_cipher ( struct tls_connection *tls,
 		return -EINVAL_CHANGE_CIPHER;
 	}
 
+	/* TLSv1.3 servers may send a meaningless Change Cipher for
+	 * middlebox compatibility.
+	 */
+	if ( tls13 ( tls ) )
+		return 0;
+
 	if ( ( rc = tls_change_cipher ( tls, &tls->rx_cipherspec_pending,
 					&tls->rx_cipherspec ) ) != 0 ) {
 		DBGC ( tls, "TLS %p could not activate RX cipher: %s\n",
@@ -1826,6 +2766,98 @@ static int tls_new_hello_request ( struct tls_connection *tls,
 	return 0;
 }
 
+/**
+ * Receive TLSv1.3 Server Hello key exchange
+ *
+ * @v tls		TLS connection
+ * @v data		Key share extension (or NULL)
+ * @v len		Length of key share extension
+ * @v psk		Server selected our pre-shared key
+ * @ret rc		Return status code
+ */
+static int tls13_server_hello ( struct tls_connection *tls,
+				const void *data, size_t len, int psk ) {
+	struct digest_algorithm *digest = tls->handshake_digest;
+	const struct {
+		uint16_t group;
+		uint16_t len;
+		uint8_t public[0];
+	} __attribute__ (( packed )) *key_share = data;
+	struct tls_named_curve *named;
+	struct elliptic_curve *curve;
+	uint8_t zero[digest->digestsize];
+	const void *private;
+	size_t offset;
+	int rc;
+
+	/* Check pre-shared key selection */
+	if ( psk ) {
+		if ( tls->psk_digest != digest ) {
+			DBGC ( tls, "TLS %p server selected incompatible "
+			       "pre-shared key\n", tls );
+			return -EINVAL_HELLO;
+		}
+		DBGC ( tls, "TLS %p resuming session ticket\n", tls );
+		tls->authenticated = 1;
+	} else {
+		tls->psk_digest = NULL;
+	}
+
+	/* Calculate early secret from pre-shared key, if any */
+	memset ( zero, 0, sizeof ( zero ) );
+	hkdf_extract ( digest, NULL, 0, ( psk ? tls->master_secret : zero ),
+		       digest->digestsize, tls->master_secret );
+
+	/* Parse key share */
+	if ( ( ! key_share ) || ( sizeof ( *key_share ) > len ) ||
+	     ( ntohs ( key_share->len ) != ( len - sizeof ( *key_share ) ) ) ){
+		DBGC ( tls, "TLS %p received missing or invalid key share\n",
+		       tls );
+		DBGC_HD ( tls, data, len );
+		return -EINVAL_HELLO;
+	}
+
+	/* Identify named curve and corresponding private key */
+	private = ( tls->key_share + tls->key_share_len );
+	for_each_table_entry ( named, TLS_NAMED_CURVES ) {
+		if ( named->code == key_share->group )
+			break;
+		private += named->curve->keysize;
+	}
+	if ( named >= table_end ( TLS_NAMED_CURVES ) ) {
+		DBGC ( tls, "TLS %p unsupported named curve %d\n",
+		       tls, ntohs ( key_share->group ) );
+		return -ENOTSUP_CURVE;
+	}
+	curve = named->curve;
+	offset = ( named->format ? 1 : 0 );
+	DBGC ( tls, "TLS %p using named curve %s\n", tls, curve->name );
+
+	/* Check key length and format */
+	if ( ( ntohs ( key_share->len ) != ( offset + curve->pointsize ) ) ||
+	     ( named->format && ( key_share->public[0] != named->format ) ) ) {
+		DBGC ( tls, "TLS %p invalid %s key\n", tls, curve->name );
+		DBGC_HD ( tls, data, len );
+		return -EINVAL_HELLO;
+	}
+
+	/* Calculate shared secret and handshake secret */
+	{
+		uint8_t shared[curve->pointsize];
+
+		if ( ( rc = elliptic_multiply ( curve,
+						&key_share->public[offset],
+						private, shared ) ) != 0 ) {
+			DBGC ( tls, "TLS %p could not exchange %s key: %s\n",
+			       tls, curve->name, strerror ( rc ) );
+			return rc;
+		}
+		tls13_next_secret ( tls, shared, named->pre_master_secret_len );
+	}
+
+	return 0;
+}
+
 /**
  * Receive new Server Hello handshake record
  *
@@ -1861,6 +2893,22 @@ static int tls_new_server_hello ( struct tls_connection *tls,
 		uint8_t len;
 		uint8_t data[0];
 	} __attribute__ (( packed )) *reneg = NULL;
+	const struct {
+		uint16_t version;
+	} __attribute__ (( packed )) *supported_version = NULL;
+	const struct {
+		uint16_t identity;
+	} __attribute__ (( packed )) *psk = NULL;
+	static const uint8_t hello_retry_request[32] = {
+		0xcf, 0x21, 0xad, 0x74, 0xe5, 0x9a, 0x61, 0x11,
+		0xbe, 0x1d, 0x8c, 0x02, 0x1e, 0x65, 0xb8, 0x91,
+		0xc2, 0xa2, 0x11, 0x16, 0x7a, 0xbb, 0x8c, 0x5e,
+		0x07, 0x9e, 0x09, 0xe2, 0xc8, 0xa8, 0x33, 0x9c,
+	};
+	static const char downgrade[7] = "DOWNGRD";
+	const uint8_t *sentinel;
+	const void *key_share = NULL;
+	size_t key_share_len = 0;
 	uint16_t version;
 	size_t exts_len;
 	size_t ext_len;
@@ -1925,12 +2973,39 @@ static int tls_new_server_hello ( struct tls_connection *tls,
 					return -EINVAL_HELLO;
 				}
 				break;
+			case htons ( TLS_SUPPORTED_VERSIONS ) :
+				supported_version = ( ( void * ) ext->data );
+				if ( ext_len != sizeof ( *supported_version ) ){
+					DBGC ( tls, "TLS %p received invalid "
+					       "supported version\n", tls );
+					DBGC_HD ( tls, data, len );
+					return -EINVAL_HELLO;
+				}
+				break;
+			case htons ( TLS_KEY_SHARE ) :
+				key_share = ext->data;
+				key_share_len = ext_len;
+				break;
+			case htons ( TLS_PRE_SHARED_KEY ) :
+				psk = ( ( void * ) ext->data );
+				if ( ( sizeof ( *psk ) != ext_len ) ||
+				     ( psk->identity != 0 ) ||
+				     ( ! tls->psk_digest ) ) {
+					DBGC ( tls, "TLS %p received invalid "
+					       "pre-shared key\n", tls );
+					DBGC_HD ( tls, data, len );
+					return -EINVAL_HELLO;
+				}
+				break;
 			}
 		}
 	}
 
-	/* Check and store protocol version */
-	version = ntohs ( hello_a->version );
+	/* Check and store protocol version (which will be in the
+	 * supported versions extension for TLSv1.3 and later).
+	 */
+	version = ntohs ( supported_version ? supported_version->version :
+			  hello_a->version );
 	if ( version < TLS_VERSION_MIN ) {
 		DBGC ( tls, "TLS %p does not support protocol version %d.%d\n",
 		       tls, ( version >> 8 ), ( version & 0xff ) );
@@ -1946,10 +3021,45 @@ static int tls_new_server_hello ( struct tls_connection *tls,
 	DBGC ( tls, "TLS %p using protocol version %d.%d\n",
 	       tls, ( version >> 8 ), ( version & 0xff ) );
 
+	/* Reject Hello Retry Request, since we always provide key
+	 * shares for every supported named curve.
+	 */
+	if ( tls13 ( tls ) &&
+	     ( memcmp ( hello_a->random, hello_retry_request,
+			sizeof ( hello_a->random ) ) == 0 ) ) {
+		DBGC ( tls, "TLS %p received unsupported Hello Retry "
+		       "Request\n", tls );
+		return -ENOTSUP_RETRY;
+	}
+
+	/* Check for downgrade protection sentinel */
+	sentinel = &hello_a->random[ sizeof ( hello_a->random ) -
+				     sizeof ( downgrade ) - 1 ];
+	if ( ( memcmp ( sentinel, downgrade, sizeof ( downgrade ) ) == 0 ) &&
+	     ( ( ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_3 ) &&
+		 ( version < TLS_VERSION_TLS_1_3 ) &&
+		 ( sentinel[ sizeof ( downgrade ) ] == 0x01 ) ) ||
+	       ( ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_2 ) &&
+		 ( version < TLS_VERSION_TLS_1_2 ) &&
+		 ( sentinel[ sizeof ( downgrade ) ] == 0x00 ) ) ) ) {
+		DBGC ( tls, "TLS %p server illegally downgraded protocol "
+		       "version\n", tls );
+		return -EPERM_DOWNGRADE;
+	}
+
 	/* Select cipher suite */
 	if ( ( rc = tls_select_cipher ( tls, hello_b->cipher_suite ) ) != 0 )
 		return rc;
 
+	/* Check that cipher suite is appropriate for protocol version */
+	if ( tls13_suite ( tls->rx_cipherspec_pending.suite ) !=
+	     tls13 ( tls ) ) {
+		DBGC ( tls, "TLS %p cipher suite %04x invalid for protocol "
+		       "version %d.%d\n", tls, ntohs ( hello_b->cipher_suite ),
+		       ( version >> 8 ), ( version & 0xff ) );
+		return -ENOTSUP_CIPHER;
+	}
+
 	/* Add preceding Client Hello to handshake digest */
 	if ( ( rc = tls_client_hello ( tls, tls_add_handshake ) ) != 0 )
 		return rc;
@@ -1958,6 +3068,12 @@ static int tls_new_server_hello ( struct tls_connection *tls,
 	memcpy ( &tls->server_random, &hello_a->random,
 		 sizeof ( tls->server_random ) );
 
+	/* TLSv1.3 has neither session ID resumption nor renegotiation */
+	if ( tls13 ( tls ) ) {
+		return tls13_server_hello ( tls, key_share, key_share_len,
+					    ( psk != NULL ) );
+	}
+
 	/* Check session ID */
 	if ( hello_a->session_id_len &&
 	     ( hello_a->session_id_len == tls->session_id_len ) &&
@@ -2011,6 +3127,83 @@ static int tls_new_server_hello ( struct tls_connection *tls,
 	return 0;
 }
 
+/**
+ * Receive TLSv1.3 New Session Ticket handshake record
+ *
+ * @v tls		TLS connection
+ * @v data		Plaintext handshake record
+ * @v len		Length of plaintext handshake record
+ * @ret rc		Return status code
+ */
+static int tls13_new_session_ticket ( struct tls_connection *tls,
+				      const void *data, size_t len ) {
+	struct tls_session *session = tls->session;
+	struct digest_algorithm *digest = tls->handshake_digest;
+	const struct {
+		uint32_t lifetime;
+		uint32_t age_add;
+		uint8_t len;
+		uint8_t nonce[0];
+	} __attribute__ (( packed )) *header = data;
+	const struct {
+		uint16_t len;
+		uint8_t ticket[0];
+	} __attribute__ (( packed )) *ticket;
+	const uint8_t *nonce = header->nonce;
+	size_t remaining = len;
+	size_t nonce_len;
+	size_t ticket_len;
+	void *copy;
+
+	/* Parse header, nonce, and ticket */
+	if ( sizeof ( *header ) > remaining )
+		goto err_underlength;
+	remaining -= sizeof ( *header );
+	nonce_len = header->len;
+	if ( ( nonce_len + sizeof ( *ticket ) ) > remaining )
+		goto err_underlength;
+	remaining -= ( nonce_len + sizeof ( *ticket ) );
+	ticket = ( ( void * ) ( nonce + nonce_len ) );
+	ticket_len = ntohs ( ticket->len );
+	if ( ticket_len > remaining )
+		goto err_underlength;
+
+	/* Ignore tickets that arrive mid-handshake or cannot be used */
+	if ( is_pending ( &tls->client_negotiation ) ||
+	     ( header->lifetime == 0 ) || ( ticket_len == 0 ) ) {
+		DBGC ( tls, "TLS %p ignoring New Session Ticket\n", tls );
+		return 0;
+	}
+
+	/* Record ticket */
+	copy = malloc ( ticket_len );
+	if ( ! copy )
+		return -ENOMEM;
+	memcpy ( copy, ticket->ticket, ticket_len );
+	free ( session->ticket );
+	session->ticket = copy;
+	session->ticket_len = ticket_len;
+	session->ticket_digest = digest;
+	session->ticket_time = currticks();
+	session->ticket_lifetime = ntohl ( header->lifetime );
+	session->ticket_age_add = ntohl ( header->age_add );
+	session->id_len = 0;
+	DBGC ( tls, "TLS %p new session ticket:\n", tls );
+	DBGC_HDA ( tls, 0, session->ticket, session->ticket_len );
+
+	/* Derive pre-shared key from resumption master secret */
+	tls13_expand_label ( tls, digest, tls->master_secret, "resumption",
+			     nonce, nonce_len, session->master_secret,
+			     digest->digestsize );
+
+	return 0;
+
+ err_underlength:
+	DBGC ( tls, "TLS %p received underlength New Session Ticket\n", tls );
+	DBGC_HD ( tls, data, len );
+	return -EINVAL_TICKET;
+}
+
 /**
  * Receive New Session Ticket handshake record
  *
@@ -2028,6 +3221,10 @@ static int tls_new_session_ticket ( struct tls_connection *tls,
 	} __attribute__ (( packed )) *new_session_ticket = data;
 	size_t ticket_len;
 
+	/* Handle TLSv1.3 separately */
+	if ( tls13 ( tls ) )
+		return tls13_new_session_ticket ( tls, data, len );
+
 	/* Parse header */
 	if ( sizeof ( *new_session_ticket ) > len ) {
 		DBGC ( tls, "TLS %p received underlength New Session Ticket\n",
@@ -2112,6 +3309,32 @@ static int tls_parse_chain ( struct tls_connection *tls,
 		}
 		record_len = ( sizeof ( *certificate ) + certificate_len );
 
+		/* Skip per-certificate extensions (TLSv1.3 only) */
+		if ( tls13 ( tls ) ) {
+			const struct {
+				uint16_t len;
+				uint8_t data[0];
+			} __attribute__ (( packed )) *exts =
+				( data + record_len );
+
+			if ( ( record_len + sizeof ( *exts ) ) > remaining ) {
+				DBGC ( tls, "TLS %p underlength certificate "
+				       "extensions:\n", tls );
+				DBGC_HDA ( tls, 0, data, remaining );
+				rc = -EINVAL_CERTIFICATE;
+				goto err_underlength;
+			}
+			record_len += ( sizeof ( *exts ) +
+					ntohs ( exts->len ) );
+			if ( record_len > remaining ) {
+				DBGC ( tls, "TLS %p overlength certificate "
+				       "extensions:\n", tls );
+				DBGC_HDA ( tls, 0, data, remaining );
+				rc = -EINVAL_CERTIFICATE;
+				goto err_overlength;
+			}
+		}
+
 		/* Add certificate to chain */
 		if ( ( rc = x509_append_raw ( tls->chain, certificate->data,
 					      certificate_len ) ) != 0 ) {
@@ -2150,6 +3373,10 @@ static int tls_parse_chain ( struct tls_connection *tls,
  */
 static int tls_new_certificate ( struct tls_connection *tls,
 				 const void *data, size_t len ) {
+	const struct {
+		uint8_t len;
+		uint8_t data[0];
+	} __attribute__ (( packed )) *context = data;
 	const struct {
 		tls24_t length;
 		uint8_t certificates[0];
@@ -2157,6 +3384,19 @@ static int tls_new_certificate ( struct tls_connection *tls,
 	size_t certificates_len;
 	int rc;
 
+	/* Skip certificate request context (TLSv1.3 only) */
+	if ( tls13 ( tls ) ) {
+		if ( ( sizeof ( *context ) > len ) ||
+		     ( context->len > ( len - sizeof ( *context ) ) ) ) {
+			DBGC ( tls, "TLS %p received invalid Server "
+			       "Certificate context\n", tls );
+			DBGC_HD ( tls, data, len );
+			return -EINVAL_CERTIFICATES;
+		}
+		certificate = ( ( void * ) &context->data[context->len] );
+		len -= ( sizeof ( *context ) + context->len );
+	}
+
 	/* Parse header */
 	if ( sizeof ( *certificate ) > len ) {
 		DBGC ( tls, "TLS %p received underlength Server Certificate\n",
@@ -2180,6 +3420,80 @@ static int tls_new_certificate ( struct tls_connection *tls,
 	return 0;
 }
 
+/**
+ * Receive new Certificate Verify handshake record
+ *
+ * @v tls		TLS connection
+ * @v data		Plaintext handshake record
+ * @v len		Length of plaintext handshake record
+ * @ret rc		Return status code
+ */
+static int tls_new_certificate_verify ( struct tls_connection *tls,
+					const void *data, size_t len ) {
+	const struct {
+		struct tls_signature_hash_id sig_hash;
+		uint16_t len;
+		uint8_t signature[0];
+	} __attribute__ (( packed )) *verify = data;
+	struct tls_signature_hash_algorithm *sig_hash;
+	struct digest_algorithm *digest;
+	int rc;
+
+	/* Sanity checks */
+	if ( ! tls13 ( tls ) ) {
+		DBGC ( tls, "TLS %p received unexpected Certificate Verify\n",
+		       tls );
+		return -EINVAL_CERTIFICATE_VERIFY;
+	}
+	if ( ( sizeof ( *verify ) > len ) ||
+	     ( ntohs ( verify->len ) != ( len - sizeof ( *verify ) ) ) ) {
+		DBGC ( tls, "TLS %p received invalid Certificate Verify\n",
+		       tls );
+		DBGC_HD ( tls, data, len );
+		return -EINVAL_CERTIFICATE_VERIFY;
+	}
+
+	/* Identify signature and hash algorithm.  TLSv1.3 prohibits
+	 * the use of PKCS#1 v1.5 signatures.
+	 */
+	sig_hash = tls_find_signature_hash ( verify->sig_hash );
+	if ( ( ! sig_hash ) || ( sig_hash->pubkey == &rsa_algorithm ) ) {
+		DBGC ( tls, "TLS %p unsupported signature and hash "
+		       "algorithm %d.%d\n", tls, verify->sig_hash.signature,
+		       verify->sig_hash.hash );
+		return -ENOTSUP_SIG_HASH;
+	}
+	digest = sig_hash->digest;
+
+	/* Verify signature */
+	{
+		uint8_t hash[digest->digestsize];
+
+		tls13_verify_digest ( tls, digest,
+				      "TLS 1.3, server CertificateVerify",
+				      hash );
+		if ( ( rc = tls_verify_signature ( tls, sig_hash->pubkey,
+						   digest, hash,
+						   verify->signature,
+						   ntohs ( verify->len ) ) )
+		     != 0 ) {
+			return -EPERM_VERIFY;
+		}
+	}
+	tls->authenticated = 1;
+
+	/* Begin certificate validation */
+	if ( ( rc = create_validator ( &tls->validator, tls->chain,
+				       tls->root ) ) != 0 ) {
+		DBGC ( tls, "TLS %p could not start certificate validation: "
+		       "%s\n", tls, strerror ( rc ) );
+		return rc;
+	}
+	pending_get ( &tls->validation );
+
+	return 0;
+}
+
 /**
  * Receive new Server Key Exchange handshake record
  *
@@ -2310,6 +3624,71 @@ static int tls_new_server_hello_done ( struct tls_connection *tls,
 	return 0;
 }
 
+/**
+ * Receive new TLSv1.3 Finished handshake record
+ *
+ * @v tls		TLS connection
+ * @v data		Plaintext handshake record
+ * @v len		Length of plaintext handshake record
+ * @ret rc		Return status code
+ */
+static int tls13_new_finished ( struct tls_connection *tls,
+				const void *data, size_t len ) {
+	struct tls_session *session = tls->session;
+	struct digest_algorithm *digest = tls->handshake_digest;
+	uint8_t ctx[ hmac_ctxsize ( digest ) ];
+	uint8_t key[digest->digestsize];
+	uint8_t hash[digest->digestsize];
+	uint8_t verify[digest->digestsize];
+
+	/* Sanity checks */
+	if ( ! tls->authenticated ) {
+		DBGC ( tls, "TLS %p received Finished before authentication\n",
+		       tls );
+		return -EPERM_AUTH;
+	}
+	if ( len != sizeof ( verify ) ) {
+		DBGC ( tls, "TLS %p received invalid Finished\n", tls );
+		DBGC_HD ( tls, data, len );
+		return -EINVAL_FINISHED;
+	}
+
+	/* Verify data */
+	tls13_expand_label ( tls, digest, tls->server_secret, "finished",
+			     NULL, 0, key, sizeof ( key ) );
+	tls_verify_handshake ( tls, hash );
+	hmac_init ( digest, ctx, key, sizeof ( key ) );
+	hmac_update ( digest, ctx, hash, sizeof ( hash ) );
+	hmac_final ( digest, ctx, verify );
+	if ( memcmp ( verify, data, sizeof ( verify ) ) != 0 ) {
+		DBGC ( tls, "TLS %p verification failed\n", tls );
+		return -EPERM_VERIFY;
+	}
+
+	/* Mark server as finished */
+	pending_put ( &tls->server_negotiation );
+
+	/* If we are resuming a session (i.e. if no certificate
+	 * validation is required), then schedule transmission of
+	 * Finished.
+	 */
+	if ( tls->psk_digest )
+		tls->tx_pending |= TLS_TX_FINISHED;
+	tls_tx_resume ( tls );
+
+	/* Move to end of session's connection list and allow other
+	 * connections to start making progress.
+	 */
+	list_del ( &tls->list );
+	list_add_tail ( &tls->list, &session->conn );
+	tls_tx_resume_all ( session );
+
+	/* Send notification of a window change */
+	xfer_window_changed ( &tls->plainstream );
+
+	return 0;
+}
+
 /**
  * Receive new Finished handshake record
  *
@@ -2328,6 +3707,10 @@ static int tls_new_finished ( struct tls_connection *tls,
 	} __attribute__ (( packed )) *finished = data;
 	uint8_t digest_out[ digest->digestsize ];
 
+	/* Handle TLSv1.3 separately */
+	if ( tls13 ( tls ) )
+		return tls13_new_finished ( tls, data, len );
+
 	/* Sanity check */
 	if ( sizeof ( *finished ) != len ) {
 		DBGC ( tls, "TLS %p received overlength Finished\n", tls );
@@ -2371,8 +3754,14 @@ static int tls_new_finished ( struct tls_connection *tls,
 		free ( session->ticket );
 		session->ticket = tls->new_session_ticket;
 		session->ticket_len = tls->new_session_ticket_len;
+		session->ticket_digest = NULL;
 		tls->new_session_ticket = NULL;
 		tls->new_session_ticket_len = 0;
+	} else if ( session->ticket_digest ) {
+		free ( session->ticket );
+		session->ticket = NULL;
+		session->ticket_len = 0;
+		session->ticket_digest = NULL;
 	}
 
 	/* Move to end of session's connection list and allow other
@@ -2388,6 +3777,116 @@ static int tls_new_finished ( struct tls_connection *tls,
 	return 0;
 }
 
+/**
+ * Receive new Key Update handshake record
+ *
+ * @v tls		TLS connection
+ * @v data		Plaintext handshake record
+ * @v len		Length of plaintext handshake record
+ * @ret rc		Return status code
+ */
+static int tls_new_key_update ( struct tls_connection *tls,
+				const void *data, size_t len ) {
+	const struct {
+		uint8_t request;
+	} __attribute__ (( packed )) *key_update = data;
+
+	/* Sanity checks */
+	if ( ( ! tls13 ( tls ) ) || is_pending ( &tls->server_negotiation ) ){
+		DBGC ( tls, "TLS %p received unexpected Key Update\n", tls );
+		return -EINVAL_KEY_UPDATE;
+	}
+	if ( ( sizeof ( *key_update ) != len ) || ( key_update->request > 1 ) ){
+		DBGC ( tls, "TLS %p received invalid Key Update\n", tls );
+		DBGC_HD ( tls, data, len );
+		return -EINVAL_KEY_UPDATE;
+	}
+
+	/* Schedule our own Key Update, if requested */
+	if ( key_update->request ) {
+		tls->tx_pending |= TLS_TX_KEY_UPDATE;
+		tls_tx_resume ( tls );
+	}
+
+	return 0;
+}
+
+/**
+ * Update TLSv1.3 key schedule after receiving Handshake record
+ *
+ * @v tls		TLS connection
+ * @v type		Handshake record type
+ * @v more		More handshake data follows within the same record
+ * @ret rc		Return status code
+ *
+ * This is called after the handshake record has been added to the
+ * handshake digest.
+ */
+static int tls13_rx_handshake ( struct tls_connection *tls,
+				unsigned int type, int more ) {
+	struct tls_cipher_suite *suite = tls->rx_cipherspec_pending.suite;
+	int rc;
+
+	/* Key changes must coincide with a record boundary */
+	if ( more && ( ( type == TLS_SERVER_HELLO ) ||
+		       ( type == TLS_FINISHED ) ||
+		       ( type == TLS_KEY_UPDATE ) ) ) {
+		DBGC ( tls, "TLS %p received handshake type %d mid-record\n",
+		       tls, type );
+		return -EINVAL_HANDSHAKE;
+	}
+
+	switch ( type ) {
+	case TLS_SERVER_HELLO:
+		/* Activate handshake traffic keys */
+		tls13_traffic_secrets ( tls, "c hs traffic", "s hs traffic" );
+		tls13_expand_label ( tls, suite->handshake, tls->client_secret,
+				     "finished", NULL, 0, tls->finished_key,
+				     suite->handshake->digestsize );
+		if ( ( rc = tls13_set_keys ( tls, suite, tls->server_secret,
+					     &tls->rx_cipherspec_pending,
+					     &tls->rx_cipherspec ) ) != 0 )
+			return rc;
+		if ( ( rc = tls13_set_keys ( tls, suite, tls->client_secret,
+					     &tls->tx_cipherspec_pending,
+					     &tls->tx_cipherspec ) ) != 0 )
+			return rc;
+		tls->rx_seq = ~( ( uint64_t ) 0 );
+		tls->tx_seq = 0;
+		break;
+	case TLS_FINISHED:
+		/* Activate server application traffic keys, and
+		 * prepare client application traffic keys for use
+		 * after our own Finished has been sent.
+		 */
+		suite = tls->rx_cipherspec.suite;
+		tls13_next_secret ( tls, NULL, 0 );
+		tls13_traffic_secrets ( tls, "c ap traffic", "s ap traffic" );
+		if ( ( rc = tls13_set_keys ( tls, suite, tls->server_secret,
+					     &tls->rx_cipherspec_pending,
+					     &tls->rx_cipherspec ) ) != 0 )
+			return rc;
+		if ( ( rc = tls13_set_keys ( tls, suite, tls->client_secret,
+					     &tls->tx_cipherspec_pending,
+					     NULL ) ) != 0 )
+			return rc;
+		tls->rx_seq = ~( ( uint64_t ) 0 );
+		break;
+	case TLS_KEY_UPDATE:
+		/* Update server application traffic keys */
+		if ( ( rc = tls13_update_keys ( tls, tls->server_secret,
+						&tls->rx_cipherspec_pending,
+						&tls->rx_cipherspec ) ) != 0 )
+			return rc;
+		tls->rx_seq = ~( ( uint64_t ) 0 );
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
 /**
  * Receive new Handshake record
  *
@@ -2441,9 +3940,17 @@ static int tls_new_handshake ( struct tls_connection *tls,
 			rc = tls_new_session_ticket ( tls, payload,
 						      payload_len );
 			break;
+		case TLS_ENCRYPTED_EXTENSIONS:
+			/* We have no use for any encrypted extensions */
+			rc = 0;
+			break;
 		case TLS_CERTIFICATE:
 			rc = tls_new_certificate ( tls, payload, payload_len );
 			break;
+		case TLS_CERTIFICATE_VERIFY:
+			rc = tls_new_certificate_verify ( tls, payload,
+							  payload_len );
+			break;
 		case TLS_SERVER_KEY_EXCHANGE:
 			rc = tls_new_server_key_exchange ( tls, payload,
 							   payload_len );
@@ -2459,6 +3966,9 @@ static int tls_new_handshake ( struct tls_connection *tls,
 		case TLS_FINISHED:
 			rc = tls_new_finished ( tls, payload, payload_len );
 			break;
+		case TLS_KEY_UPDATE:
+			rc = tls_new_key_update ( tls, payload, payload_len );
+			break;
 		default:
 			DBGC ( tls, "TLS %p ignoring handshake type %d\n",
 			       tls, handshake->type );
@@ -2476,6 +3986,14 @@ static int tls_new_handshake ( struct tls_connection *tls,
 		if ( rc != 0 )
 			return rc;
 
+		/* Update TLSv1.3 key schedule, if applicable */
+		if ( tls13 ( tls ) &&
+		     ( ( rc = tls13_rx_handshake ( tls, handshake->type,
+						   ( record_len != remaining ) )
+			 ) != 0 ) ) {
+			return rc;
+		}
+
 		/* Move to next handshake record */
 		data += record_len;
 		remaining -= record_len;
@@ -2662,7 +4180,7 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 				const void *data, size_t len ) {
 	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec;
 	struct tls_cipher_suite *suite = cipherspec->suite;
-	struct cipher_algorithm *cipher = suite->cipher;
+	struct cipher_algorithm *cipher = cipherspec->cipher;
 	struct digest_algorithm *digest = suite->digest;
 	struct {
 		uint8_t fixed[suite->fixed_iv_len];
@@ -2676,20 +4194,26 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 	size_t ciphertext_len;
 	size_t padding_len;
 	uint8_t mac[digest->digestsize];
+	unsigned int inner = ( tls13_suite ( suite ) ? 1 : 0 );
+	void *aad = &authhdr;
+	size_t aad_len = sizeof ( authhdr );
 	void *tmp;
 	int rc;
 
 	/* Construct initialisation vector */
 	memcpy ( iv.fixed, cipherspec->fixed_iv, sizeof ( iv.fixed ) );
 	tls_generate_random ( tls, iv.record, sizeof ( iv.record ) );
+	if ( inner )
+		tls13_nonce ( iv.fixed, sizeof ( iv.fixed ), tls->tx_seq );
 
 	/* Construct authentication data */
 	authhdr.seq = cpu_to_be64 ( tls->tx_seq );
 	authhdr.header.type = type;
-	authhdr.header.version = htons ( tls->version );
+	authhdr.header.version = htons ( tls_legacy_version ( tls->version ) );
 	authhdr.header.length = htons ( len );
 
 	/* Calculate padding length */
+	plaintext_len += inner;
 	plaintext_len += suite->mac_len;
 	if ( is_block_cipher ( cipher ) ) {
 		padding_len = ( ( ( cipher->blocksize - 1 ) &
@@ -2712,6 +4236,10 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 	tmp = plaintext;
 	memcpy ( tmp, data, len );
 	tmp += len;
+	if ( inner ) {
+		*( ( uint8_t * ) tmp ) = type;
+		tmp += inner;
+	}
 	if ( suite->mac_len )
 		tls_hmac ( cipherspec, &authhdr, data, len, mac );
 	memcpy ( tmp, mac, suite->mac_len );
@@ -2722,18 +4250,31 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 	DBGC2 ( tls, "Sending plaintext data:\n" );
 	DBGC2_HD ( tls, plaintext, plaintext_len );
 
+	/* Calculate ciphertext length */
+	ciphertext_len = ( sizeof ( *tlshdr ) + sizeof ( iv.record ) +
+			   plaintext_len + cipher->authsize );
+
+	/* TLSv1.3 conceals the record type within an outer header,
+	 * which forms the entirety of the authentication data.
+	 */
+	if ( inner ) {
+		authhdr.header.type = TLS_TYPE_DATA;
+		authhdr.header.length =
+			htons ( ciphertext_len - sizeof ( *tlshdr ) );
+		aad = &authhdr.header;
+		aad_len = sizeof ( authhdr.header );
+	}
+
 	/* Set initialisation vector */
 	cipher_setiv ( cipher, cipherspec->cipher_ctx, &iv, sizeof ( iv ) );
 
 	/* Process authentication data, if applicable */
 	if ( is_auth_cipher ( cipher ) ) {
-		cipher_encrypt ( cipher, cipherspec->cipher_ctx, &authhdr,
-				 NULL, sizeof ( authhdr ) );
+		cipher_encrypt ( cipher, cipherspec->cipher_ctx, aad,
+				 NULL, aad_len );
 	}
 
 	/* Allocate ciphertext */
-	ciphertext_len = ( sizeof ( *tlshdr ) + sizeof ( iv.record ) +
-			   plaintext_len + cipher->authsize );
 	ciphertext = xfer_alloc_iob ( &tls->cipherstream, ciphertext_len );
 	if ( ! ciphertext ) {
 		DBGC ( tls, "TLS %p could not allocate %zd bytes for "
@@ -2744,8 +4285,8 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 
 	/* Assemble ciphertext */
 	tlshdr = iob_put ( ciphertext, sizeof ( *tlshdr ) );
-	tlshdr->type = type;
-	tlshdr->version = htons ( tls->version );
+	tlshdr->type = authhdr.header.type;
+	tlshdr->version = authhdr.header.version;
 	tlshdr->length = htons ( ciphertext_len - sizeof ( *tlshdr ) );
 	memcpy ( iob_put ( ciphertext, sizeof ( iv.record ) ), iv.record,
 		 sizeof ( iv.record ) );
@@ -2824,7 +4365,7 @@ static int tls_new_ciphertext ( struct tls_connection *tls,
 				struct list_head *rx_data ) {
 	struct tls_cipherspec *cipherspec = &tls->rx_cipherspec;
 	struct tls_cipher_suite *suite = cipherspec->suite;
-	struct cipher_algorithm *cipher = suite->cipher;
+	struct cipher_algorithm *cipher = cipherspec->cipher;
 	struct digest_algorithm *digest = suite->digest;
 	size_t len = ntohs ( tlshdr->length );
 	struct {
@@ -2837,6 +4378,11 @@ static int tls_new_ciphertext ( struct tls_connection *tls,
 	struct io_buffer *first;
 	struct io_buffer *last;
 	struct io_buffer *iobuf;
+	unsigned int inner = tls13_suite ( suite );
+	unsigned int type = tlshdr->type;
+	void *aad = &authhdr;
+	size_t aad_len = sizeof ( authhdr );
+	uint8_t *trailer;
 	void *mac;
 	void *auth;
 	size_t check_len;
@@ -2858,6 +4404,8 @@ static int tls_new_ciphertext ( struct tls_connection *tls,
 	memcpy ( iv.record, first->data, sizeof ( iv.record ) );
 	iob_pull ( first, sizeof ( iv.record ) );
 	len -= sizeof ( iv.record );
+	if ( inner )
+		tls13_nonce ( iv.fixed, sizeof ( iv.fixed ), tls->rx_seq );
 
 	/* Extract unencrypted authentication tag */
 	if ( iob_len ( last ) < cipher->authsize ) {
@@ -2876,13 +4424,21 @@ static int tls_new_ciphertext ( struct tls_connection *tls,
 	authhdr.header.version = tlshdr->version;
 	authhdr.header.length = htons ( len );
 
+	/* TLSv1.3 uses the outer record header as the authentication
+	 * data.
+	 */
+	if ( inner ) {
+		aad = tlshdr;
+		aad_len = sizeof ( *tlshdr );
+	}
+
 	/* Set initialisation vector */
 	cipher_setiv ( cipher, cipherspec->cipher_ctx, &iv, sizeof ( iv ) );
 
 	/* Process authentication data, if applicable */
 	if ( is_auth_cipher ( cipher ) ) {
-		cipher_decrypt ( cipher, cipherspec->cipher_ctx, &authhdr,
-				 NULL, sizeof ( authhdr ) );
+		cipher_decrypt ( cipher, cipherspec->cipher_ctx, aad,
+				 NULL, aad_len );
 	}
 
 	/* Decrypt the received data */
@@ -2945,8 +4501,34 @@ static int tls_new_ciphertext ( struct tls_connection *tls,
 		return -EINVAL_MAC;
 	}
 
+	/* Strip padding and extract inner record type (TLSv1.3 only).
+	 * The inner record type is the last non-zero byte, which may
+	 * lie within any of the received data buffers.
+	 */
+	if ( inner ) {
+		type = 0;
+		while ( ( ! type ) &&
+			( iobuf = list_last_entry ( rx_data, struct io_buffer,
+						    list ) ) ) {
+			while ( ( ! type ) && iob_len ( iobuf ) ) {
+				trailer = ( iobuf->tail - 1 );
+				type = *trailer;
+				iob_unput ( iobuf, 1 );
+			}
+			if ( ! iob_len ( iobuf ) ) {
+				list_del ( &iobuf->list );
+				free_iob ( iobuf );
+			}
+		}
+		if ( ! type ) {
+			DBGC ( tls, "TLS %p received record with no content "
+			       "type\n", tls );
+			return -EINVAL_CONTENT_TYPE;
+		}
+	}
+
 	/* Process plaintext record */
-	if ( ( rc = tls_new_record ( tls, tlshdr->type, rx_data ) ) != 0 )
+	if ( ( rc = tls_new_record ( tls, type, rx_data ) ) != 0 )
 		return rc;
 
 	return 0;
@@ -2968,7 +4550,7 @@ static int tls_new_ciphertext ( struct tls_connection *tls,
 static size_t tls_plainstream_window ( struct tls_connection *tls ) {
 
 	/* Block window unless we are ready to accept data */
-	if ( ! tls_ready ( tls ) )
+	if ( ! tls_tx_ready ( tls ) )
 		return 0;
 
 	return xfer_window ( &tls->cipherstream );
@@ -2988,7 +4570,7 @@ static int tls_plainstream_deliver ( struct tls_connection *tls,
 	int rc;
 	
 	/* Refuse unless we are ready to accept data */
-	if ( ! tls_ready ( tls ) ) {
+	if ( ! tls_tx_ready ( tls ) ) {
 		rc = -ENOTCONN;
 		goto done;
 	}
@@ -3050,7 +4632,7 @@ static struct interface_descriptor tls_plainstream_desc =
  */
 static int tls_newdata_process_header ( struct tls_connection *tls ) {
 	struct tls_cipherspec *cipherspec = &tls->rx_cipherspec;
-	struct cipher_algorithm *cipher = cipherspec->suite->cipher;
+	struct cipher_algorithm *cipher = cipherspec->cipher;
 	size_t iv_len = cipherspec->suite->record_iv_len;
 	size_t data_len = ntohs ( tls->rx_header.length );
 	size_t remaining = data_len;
@@ -3145,13 +4727,20 @@ static int tls_newdata_process_data ( struct tls_connection *tls ) {
 	if ( iob_tailroom ( iobuf ) )
 		return 0;
 
-	/* Process record */
-	if ( ( rc = tls_new_ciphertext ( tls, &tls->rx_header,
-					 &tls->rx_data ) ) != 0 )
-		return rc;
-
-	/* Increment RX sequence number */
-	tls->rx_seq += 1;
+	/* Process record.  TLSv1.3 Change Cipher records are never
+	 * encrypted, and do not consume a sequence number.
+	 */
+	if ( tls13_suite ( tls->rx_cipherspec.suite ) &&
+	     ( tls->rx_header.type == TLS_TYPE_CHANGE_CIPHER ) ) {
+		if ( ( rc = tls_new_record ( tls, tls->rx_header.type,
+					     &tls->rx_data ) ) != 0 )
+			return rc;
+	} else {
+		if ( ( rc = tls_new_ciphertext ( tls, &tls->rx_header,
+						 &tls->rx_data ) ) != 0 )
+			return rc;
+		tls->rx_seq += 1;
+	}
 
 	/* Return to header state */
 	assert ( list_empty ( &tls->rx_data ) );
@@ -3294,6 +4883,20 @@ static void tls_validator_done ( struct tls_connection *tls, int rc ) {
 		goto err;
 	}
 
+	/* TLSv1.3 has no key exchange following certificate
+	 * validation: schedule Certificate, Certificate Verify, and
+	 * Finished.
+	 */
+	if ( tls13 ( tls ) ) {
+		tls->tx_pending |= TLS_TX_FINISHED;
+		if ( tls->certs ) {
+			tls->tx_pending |= ( TLS_TX_CERTIFICATE |
+					     TLS_TX_CERTIFICATE_VERIFY );
+		}
+		tls_tx_resume ( tls );
+		return;
+	}
+
 	/* Initialise public key algorithm */
 	if ( ( rc = pubkey_init ( pubkey, cipherspec->pubkey_ctx,
 				  cert->subject.public_key.raw.data,
@@ -3362,6 +4965,50 @@ static void tls_tx_step ( struct tls_connection *tls ) {
 			if ( is_pending ( &conn->server_negotiation ) )
 				return;
 		}
+		/* Record session ticket */
+		free ( tls->ticket );
+		tls->ticket = NULL;
+		tls->ticket_len = 0;
+		tls->psk_digest = NULL;
+		if ( session->ticket_len ) {
+			tls->ticket = malloc ( session->ticket_len );
+			if ( ! tls->ticket ) {
+				rc = -ENOMEM;
+				goto err;
+			}
+			memcpy ( tls->ticket, session->ticket,
+				 session->ticket_len );
+			tls->ticket_len = session->ticket_len;
+		}
+		/* Use TLSv1.3 session ticket as a pre-shared key, if
+		 * it has not yet expired.
+		 */
+		if ( session->ticket_digest ) {
+			unsigned long age = ( currticks() -
+					      session->ticket_time );
+			unsigned long lifetime = session->ticket_lifetime;
+
+			if ( lifetime > TLS13_MAX_TICKET_LIFETIME )
+				lifetime = TLS13_MAX_TICKET_LIFETIME;
+			if ( age < ( lifetime * TICKS_PER_SEC ) ) {
+				tls->psk_digest = session->ticket_digest;
+				memcpy ( tls->master_secret,
+					 session->master_secret,
+					 sizeof ( tls->master_secret ) );
+				tls->ticket_age =
+					( ( age * 1000 / TICKS_PER_SEC ) +
+					  session->ticket_age_add );
+			} else {
+				tls->ticket_len = 0;
+			}
+		}
+		/* Generate TLSv1.3 key shares */
+		if ( ( TLS_VERSION_MAX >= TLS_VERSION_TLS_1_3 ) &&
+		     ( ( rc = tls13_generate_key_shares ( tls ) ) != 0 ) ) {
+			DBGC ( tls, "TLS %p could not generate key shares: "
+			       "%s\n", tls, strerror ( rc ) );
+			goto err;
+		}
 		/* Record or generate session ID and associated master secret */
 		if ( session->id_len ) {
 			/* Attempt to resume an existing session */
@@ -3385,6 +5032,11 @@ static void tls_tx_step ( struct tls_connection *tls ) {
 			goto err;
 		}
 		tls->tx_pending &= ~TLS_TX_CLIENT_HELLO;
+	} else if ( tls13 ( tls ) && is_pending ( &tls->server_negotiation ) ){
+		/* TLSv1.3 client handshake messages must wait until
+		 * the server handshake is complete.
+		 */
+		return;
 	} else if ( tls->tx_pending & TLS_TX_CERTIFICATE ) {
 		/* Send Certificate */
 		if ( ( rc = tls_send_certificate ( tls ) ) != 0 ) {
@@ -3433,6 +5085,14 @@ static void tls_tx_step ( struct tls_connection *tls ) {
 			goto err;
 		}
 		tls->tx_pending &= ~TLS_TX_FINISHED;
+	} else if ( tls->tx_pending & TLS_TX_KEY_UPDATE ) {
+		/* Send Key Update, and then update the keys in use */
+		if ( ( rc = tls13_send_key_update ( tls ) ) != 0 ) {
+			DBGC ( tls, "TLS %p could not send Key Update: %s\n",
+			       tls, strerror ( rc ) );
+			goto err;
+		}
+		tls->tx_pending &= ~TLS_TX_KEY_UPDATE;
 	}
 
 	/* Reschedule process if pending transmissions remain,
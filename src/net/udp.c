@@ -10,6 +10,8 @@
 #include <ipxe/open.h>
 #include <ipxe/uri.h>
 #include <ipxe/netdevice.h>
+#include <ipxe/init.h>
+#include <ipxe/profile.h>
 #include <ipxe/udp.h>
 
 /** @file
@@ -39,9 +41,17 @@ struct udp_connection {
 };
 
 /**
- * List of registered UDP connections
+ * Hash table of registered UDP connections, indexed by local port
  */
-static LIST_HEAD ( udp_conns );
+static struct list_head udp_hash[TCPIP_HASH_BUCKETS];
+
+/**
+ * List of registered promiscuous UDP connections
+ */
+static LIST_HEAD ( udp_promisc_conns );
+
+/** Demultiplexing profiler */
+static struct profiler udp_demux_profiler __profiler = { .name = "udp.demux" };
 
 /* Forward declatations */
 static struct interface_descriptor udp_xfer_desc;
@@ -54,9 +64,10 @@ struct tcpip_protocol udp_protocol __tcpip_protocol;
  * @ret port		Local port number, or negative error
  */
 static int udp_port_available ( int port ) {
+	struct list_head *bucket = &udp_hash[ tcpip_hash ( port ) ];
 	struct udp_connection *udp;
 
-	list_for_each_entry ( udp, &udp_conns, list ) {
+	list_for_each_entry ( udp, bucket, list ) {
 		if ( udp->local.st_port == htons ( port ) )
 			return -EADDRINUSE;
 	}
@@ -111,7 +122,11 @@ static int udp_open_common ( struct interface *xfer,
 	 * list and return
 	 */
 	intf_plug_plug ( &udp->xfer, xfer );
-	list_add ( &udp->list, &udp_conns );
+	if ( promisc ) {
+		list_add ( &udp->list, &udp_promisc_conns );
+	} else {
+		list_add ( &udp->list, &udp_hash[ tcpip_hash ( port ) ] );
+	}
 	return 0;
 
  err:
@@ -223,12 +238,18 @@ static int udp_tx ( struct udp_connection *udp, struct io_buffer *iobuf,
  *
  * @v local		Local address
  * @ret udp		UDP connection, or NULL
+ *
+ * A connection bound to the local port takes precedence over any
+ * promiscuous connection.
  */
 static struct udp_connection * udp_demux ( struct sockaddr_tcpip *local ) {
 	static const struct sockaddr_tcpip empty_sockaddr = { .pad = { 0, } };
+	struct list_head *bucket =
+		&udp_hash[ tcpip_hash ( ntohs ( local->st_port ) ) ];
 	struct udp_connection *udp;
 
-	list_for_each_entry ( udp, &udp_conns, list ) {
+	/* Check for a connection bound to this local port */
+	list_for_each_entry ( udp, bucket, list ) {
 		if ( ( ( udp->local.st_family == local->st_family ) ||
 		       ( udp->local.st_family == 0 ) ) &&
 		     ( ( udp->local.st_port == local->st_port ) ||
@@ -240,7 +261,12 @@ static struct udp_connection * udp_demux ( struct sockaddr_tcpip *local ) {
 			return udp;
 		}
 	}
-	return NULL;
+
+	/* Otherwise, use the most recently opened promiscuous
+	 * connection, if any
+	 */
+	return list_first_entry ( &udp_promisc_conns, struct udp_connection,
+				  list );
 }
 
 /**
@@ -298,7 +324,9 @@ static int udp_rx ( struct io_buffer *iobuf,
 	/* Parse parameters from header and strip header */
 	st_src->st_port = udphdr->src;
 	st_dest->st_port = udphdr->dest;
+	profile_start ( &udp_demux_profiler );
 	udp = udp_demux ( st_dest );
+	profile_stop ( &udp_demux_profiler );
 	iob_unput ( iobuf, ( iob_len ( iobuf ) - ulen ) );
 	iob_pull ( iobuf, sizeof ( *udphdr ) );
 
@@ -325,6 +353,23 @@ static int udp_rx ( struct io_buffer *iobuf,
 	return rc;
 }
 
+/**
+ * Initialise UDP
+ *
+ */
+static void udp_init ( void ) {
+	unsigned int i;
+
+	/* Initialise connection hash table */
+	for ( i = 0 ; i < TCPIP_HASH_BUCKETS ; i++ )
+		INIT_LIST_HEAD ( &udp_hash[i] );
+}
+
+/** UDP initialisation function */
+struct init_fn udp_init_fn __init_fn ( INIT_NORMAL ) = {
+	.initialise = udp_init,
+};
+
 struct tcpip_protocol udp_protocol __tcpip_protocol = {
 	.name = "UDP",
 	.rx = udp_rx,
@@ -29,12 +29,16 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <ctype.h>
 #include <errno.h>
 #include <byteswap.h>
 #include <ipxe/refcnt.h>
 #include <ipxe/iobuf.h>
+#include <ipxe/malloc.h>
+#include <ipxe/process.h>
+#include <ipxe/timer.h>
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
 #include <ipxe/resolv.h>
@@ -90,6 +94,12 @@ static unsigned int dns_count;
 /** The DNS search list */
 static struct dns_name dns_search;
 
+/** DNS cache */
+struct list_head dns_cache = LIST_HEAD_INIT ( dns_cache );
+
+/** Number of DNS cache entries */
+static unsigned int dns_cache_count;
+
 /**
  * Encode a DNS name using RFC1035 encoding
  *
@@ -467,6 +477,16 @@ struct dns_request {
 	} address;
 	/** Initial query type */
 	uint16_t qtype;
+	/** Name to be resolved, as originally supplied */
+	char *original;
+	/** Minimum time to live of records used in the answer */
+	uint32_t ttl;
+	/** Minimum negative caching time to live of responses */
+	uint32_t negative_ttl;
+	/** Cached answer completion process */
+	struct process process;
+	/** Cached status code */
+	int rc;
 	/** Buffer for current query */
 	struct {
 		/** Query header */
@@ -492,6 +512,158 @@ struct dns_request {
 	unsigned int recursion;
 };
 
+/**
+ * Remove DNS cache entry
+ *
+ * @v entry		DNS cache entry
+ */
+static void dns_cache_del ( struct dns_cache_entry *entry ) {
+
+	DBGC2 ( &dns_cache, "DNS cache removing %s type %s\n",
+		entry->name, dns_type ( entry->qtype ) );
+	list_del ( &entry->list );
+	dns_cache_count--;
+	free ( entry );
+}
+
+/**
+ * Find DNS cache entry
+ *
+ * @v name		Name to be resolved
+ * @v qtype		Initial query type
+ * @ret entry		DNS cache entry, or NULL if not found
+ */
+static struct dns_cache_entry * dns_cache_find ( const char *name,
+						 uint16_t qtype ) {
+	struct dns_cache_entry *entry;
+	struct dns_cache_entry *tmp;
+	unsigned long now = currticks();
+
+	list_for_each_entry_safe ( entry, tmp, &dns_cache, list ) {
+
+		/* Discard expired entries */
+		if ( ( now - entry->created ) >= entry->lifetime ) {
+			dns_cache_del ( entry );
+			continue;
+		}
+
+		/* Check for a matching entry */
+		if ( ( entry->qtype == qtype ) &&
+		     ( strcasecmp ( entry->name, name ) == 0 ) ) {
+
+			/* Move to start of cache */
+			list_del ( &entry->list );
+			list_add ( &entry->list, &dns_cache );
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Add answer to DNS cache
+ *
+ * @v dns		DNS request
+ * @v rc		Resolution status code
+ * @v ttl		Time to live (in seconds)
+ */
+static void dns_cache_add ( struct dns_request *dns, int rc, uint32_t ttl ) {
+	struct dns_cache_entry *entry;
+	size_t name_len;
+
+	/* Do not cache answers which must not be reused */
+	if ( ! ttl )
+		return;
+	if ( ttl > DNS_CACHE_MAX_TTL )
+		ttl = DNS_CACHE_MAX_TTL;
+
+	/* Remove any existing entry */
+	entry = dns_cache_find ( dns->original, dns->qtype );
+	if ( entry )
+		dns_cache_del ( entry );
+
+	/* Remove oldest entry, if cache is full */
+	if ( dns_cache_count >= DNS_CACHE_MAX ) {
+		dns_cache_del ( list_last_entry ( &dns_cache,
+						  struct dns_cache_entry,
+						  list ) );
+	}
+
+	/* Allocate and populate entry */
+	name_len = ( strlen ( dns->original ) + 1 /* NUL */ );
+	entry = zalloc ( sizeof ( *entry ) + name_len );
+	if ( ! entry )
+		return;
+	entry->qtype = dns->qtype;
+	entry->rc = rc;
+	memcpy ( &entry->address, &dns->address, sizeof ( entry->address ) );
+	entry->created = currticks();
+	entry->lifetime = ( ttl * TICKS_PER_SEC );
+	memcpy ( entry->name, dns->original, name_len );
+
+	/* Add to cache */
+	list_add ( &entry->list, &dns_cache );
+	dns_cache_count++;
+	DBGC ( &dns_cache, "DNS cache added %s type %s (%s) for %ds\n",
+	       entry->name, dns_type ( entry->qtype ),
+	       ( rc ? strerror ( rc ) : sock_ntoa ( &entry->address.sa ) ),
+	       ttl );
+}
+
+/**
+ * Flush DNS cache
+ *
+ */
+void dns_cache_flush ( void ) {
+	struct dns_cache_entry *entry;
+	struct dns_cache_entry *tmp;
+
+	list_for_each_entry_safe ( entry, tmp, &dns_cache, list )
+		dns_cache_del ( entry );
+}
+
+/**
+ * Discard some cached DNS entries
+ *
+ * @ret discarded	Number of cached items discarded
+ */
+static unsigned int dns_cache_discard ( void ) {
+	struct dns_cache_entry *entry;
+
+	/* Drop oldest cache entry, if any */
+	entry = list_last_entry ( &dns_cache, struct dns_cache_entry, list );
+	if ( entry ) {
+		dns_cache_del ( entry );
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+/**
+ * DNS cache discarder
+ *
+ * DNS cache entries are deemed to have a low replacement cost, since
+ * they can be recreated by a single query.
+ */
+struct cache_discarder dns_cache_discarder __cache_discarder ( CACHE_CHEAP ) = {
+	.discard = dns_cache_discard,
+};
+
+/**
+ * Update minimum time to live of records used in the answer
+ *
+ * @v dns		DNS request
+ * @v rr		Resource record
+ */
+static void dns_ttl ( struct dns_request *dns, union dns_rr *rr ) {
+	uint32_t ttl = ntohl ( rr->common.ttl );
+
+	if ( ttl < dns->ttl )
+		dns->ttl = ttl;
+}
+
 /**
  * Mark DNS request as complete
  *
@@ -500,8 +672,9 @@ struct dns_request {
  */
 static void dns_done ( struct dns_request *dns, int rc ) {
 
-	/* Stop the retry timer */
+	/* Stop the retry timer and cached answer process */
 	stop_timer ( &dns->timer );
+	process_del ( &dns->process );
 
 	/* Shut down interfaces */
 	intf_shutdown ( &dns->socket, rc );
@@ -519,6 +692,9 @@ static void dns_resolved ( struct dns_request *dns ) {
 	DBGC ( dns, "DNS %p found address %s\n",
 	       dns, sock_ntoa ( &dns->address.sa ) );
 
+	/* Add to cache */
+	dns_cache_add ( dns, 0, dns->ttl );
+
 	/* Return resolved address */
 	resolv_done ( &dns->resolv, &dns->address.sa );
 
@@ -671,12 +847,15 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 	struct dns_header *query = &dns->buf.query;
 	unsigned int qtype = dns->question->qtype;
 	struct dns_name buf;
+	struct dns_rr_soa_trailer *soa;
 	union dns_rr *rr;
 	int offset;
 	size_t answer_offset;
 	size_t next_offset;
 	size_t rdlength;
 	size_t name_len;
+	uint32_t negative_ttl = 0;
+	uint32_t ttl;
 	int rc;
 
 	/* Sanity check */
@@ -753,6 +932,20 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 			goto done;
 		}
 
+		/* Record negative caching time to live from any SOA
+		 * record (RFC 2308 section 5).
+		 */
+		if ( ( rr->common.type == htons ( DNS_TYPE_SOA ) ) &&
+		     ( rdlength >= sizeof ( *soa ) ) ) {
+			soa = ( ( ( void * ) rr ) + sizeof ( rr->common ) +
+				rdlength - sizeof ( *soa ) );
+			ttl = ntohl ( rr->common.ttl );
+			negative_ttl = ntohl ( soa->minimum );
+			if ( ttl < negative_ttl )
+				negative_ttl = ttl;
+			continue;
+		}
+
 		/* Skip non-matching names */
 		if ( dns_compare ( &buf, &dns->name ) != 0 ) {
 			DBGC2 ( dns, "DNS %p ignoring response for %s type "
@@ -777,6 +970,7 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 			memcpy ( &dns->address.sin6.sin6_addr,
 				 &rr->aaaa.in6_addr,
 				 sizeof ( dns->address.sin6.sin6_addr ) );
+			dns_ttl ( dns, rr );
 			dns_resolved ( dns );
 			rc = 0;
 			goto done;
@@ -792,6 +986,7 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 			}
 			dns->address.sin.sin_family = AF_INET;
 			dns->address.sin.sin_addr = rr->a.in_addr;
+			dns_ttl ( dns, rr );
 			dns_resolved ( dns );
 			rc = 0;
 			goto done;
@@ -808,6 +1003,7 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 			}
 
 			/* Found a CNAME record; update query and recurse */
+			dns_ttl ( dns, rr );
 			buf.offset = ( offset + sizeof ( rr->cname ) );
 			DBGC ( dns, "DNS %p found CNAME %s\n",
 			       dns, dns_name ( &buf ) );
@@ -836,6 +1032,12 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 	 */
 	stop_timer ( &dns->timer );
 
+	/* Record negative caching time to live.  Responses without
+	 * an SOA record must not be cached.
+	 */
+	if ( negative_ttl < dns->negative_ttl )
+		dns->negative_ttl = negative_ttl;
+
 	/* Determine what to do next based on the type of query we
 	 * issued and the response we received
 	 */
@@ -878,6 +1080,7 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 		if ( dns->search.offset == dns->search.len ) {
 			DBGC ( dns, "DNS %p found no CNAME record\n", dns );
 			rc = -ENXIO_NO_RECORD;
+			dns_cache_add ( dns, rc, dns->negative_ttl );
 			dns_done ( dns, rc );
 			goto done;
 		}
@@ -944,6 +1147,25 @@ static int dns_progress ( struct dns_request *dns,
 	return 0;
 }
 
+/**
+ * Complete DNS request using cached answer
+ *
+ * @v dns		DNS request
+ */
+static void dns_step ( struct dns_request *dns ) {
+
+	/* Return resolved address, if applicable */
+	if ( dns->rc == 0 )
+		resolv_done ( &dns->resolv, &dns->address.sa );
+
+	/* Mark operation as complete */
+	dns_done ( dns, dns->rc );
+}
+
+/** DNS cached answer process descriptor */
+static struct process_descriptor dns_process_desc =
+	PROC_DESC_ONCE ( struct dns_request, process, dns_step );
+
 /** DNS socket interface operations */
 static struct interface_operation dns_socket_operations[] = {
 	INTF_OP ( xfer_deliver, struct dns_request *, dns_xfer_deliver ),
@@ -974,9 +1196,11 @@ static struct interface_descriptor dns_resolv_desc =
  */
 static int dns_resolv ( struct interface *resolv,
 			const char *name, struct sockaddr *sa ) {
+	struct dns_cache_entry *entry;
 	struct dns_request *dns;
 	struct dns_header *query;
 	size_t search_len;
+	size_t original_len;
 	int name_len;
 	int rc;
 
@@ -992,7 +1216,8 @@ static int dns_resolv ( struct interface *resolv,
 	search_len = ( strchr ( name, '.' ) ? 0 : dns_search.len );
 
 	/* Allocate DNS structure */
-	dns = zalloc ( sizeof ( *dns ) + search_len );
+	original_len = ( strlen ( name ) + 1 /* NUL */ );
+	dns = zalloc ( sizeof ( *dns ) + search_len + original_len );
 	if ( ! dns ) {
 		rc = -ENOMEM;
 		goto err_alloc_dns;
@@ -1001,15 +1226,41 @@ static int dns_resolv ( struct interface *resolv,
 	intf_init ( &dns->resolv, &dns_resolv_desc, &dns->refcnt );
 	intf_init ( &dns->socket, &dns_socket_desc, &dns->refcnt );
 	timer_init ( &dns->timer, dns_timer_expired, &dns->refcnt );
+	process_init_stopped ( &dns->process, &dns_process_desc,
+			       &dns->refcnt );
 	memcpy ( &dns->address.sa, sa, sizeof ( dns->address.sa ) );
 	dns->search.data = ( ( ( void * ) dns ) + sizeof ( *dns ) );
 	dns->search.len = search_len;
 	memcpy ( dns->search.data, dns_search.data, search_len );
+	dns->original = ( dns->search.data + search_len );
+	memcpy ( dns->original, name, original_len );
+	dns->ttl = DNS_CACHE_MAX_TTL;
+	dns->negative_ttl = DNS_CACHE_MAX_TTL;
 
 	/* Determine initial query type */
 	dns->qtype = ( ( dns6.count != 0 ) ?
 		       htons ( DNS_TYPE_AAAA ) : htons ( DNS_TYPE_A ) );
 
+	/* Use cached answer, if available */
+	entry = dns_cache_find ( name, dns->qtype );
+	if ( entry ) {
+		DBGC ( dns, "DNS %p using cached answer for %s\n",
+		       dns, name );
+		dns->rc = entry->rc;
+		if ( entry->address.sa.sa_family == AF_INET6 ) {
+			dns->address.sin6.sin6_family = AF_INET6;
+			memcpy ( &dns->address.sin6.sin6_addr,
+				 &entry->address.sin6.sin6_addr,
+				 sizeof ( dns->address.sin6.sin6_addr ) );
+		} else if ( entry->address.sa.sa_family == AF_INET ) {
+			dns->address.sin.sin_family = AF_INET;
+			dns->address.sin.sin_addr =
+				entry->address.sin.sin_addr;
+		}
+		process_add ( &dns->process );
+		goto attach;
+	}
+
 	/* Construct query */
 	query = &dns->buf.query;
 	query->flags = htons ( DNS_FLAG_RD );
@@ -1038,6 +1289,7 @@ static int dns_resolv ( struct interface *resolv,
 	/* Start timer to trigger first packet */
 	start_timer_nodelay ( &dns->timer );
 
+ attach:
 	/* Attach parent interface, mortalise self, and return */
 	intf_plug_plug ( &dns->resolv, resolv );
 	ref_put ( &dns->refcnt );
@@ -1145,11 +1397,11 @@ const struct setting dnssl_setting __setting ( SETTING_IP_EXTRA, dnssl ) = {
  *
  */
 static void apply_dns_servers ( void ) {
+	struct dns_server old4 = dns4;
+	struct dns_server old6 = dns6;
 	int len;
 
-	/* Free existing server addresses */
-	free ( dns4.data );
-	free ( dns6.data );
+	/* Clear existing server addresses */
 	dns4.data = NULL;
 	dns6.data = NULL;
 	dns4.count = 0;
@@ -1163,6 +1415,19 @@ static void apply_dns_servers ( void ) {
 	if ( len >= 0 )
 		dns6.count = ( len / sizeof ( dns6.in6[0] ) );
 	dns_count = ( dns4.count + dns6.count );
+
+	/* Flush DNS cache if server addresses have changed */
+	if ( ( dns4.count != old4.count ) || ( dns6.count != old6.count ) ||
+	     ( memcmp ( dns4.in, old4.in,
+			( dns4.count * sizeof ( dns4.in[0] ) ) ) != 0 ) ||
+	     ( memcmp ( dns6.in6, old6.in6,
+			( dns6.count * sizeof ( dns6.in6[0] ) ) ) != 0 ) ) {
+		dns_cache_flush();
+	}
+
+	/* Free old server addresses */
+	free ( old4.data );
+	free ( old6.data );
 }
 
 /**
@@ -1170,18 +1435,18 @@ static void apply_dns_servers ( void ) {
  *
  */
 static void apply_dns_search ( void ) {
+	struct dns_name old = dns_search;
 	char *localdomain;
 	int len;
 
-	/* Free existing search list */
-	free ( dns_search.data );
+	/* Clear existing search list */
 	memset ( &dns_search, 0, sizeof ( dns_search ) );
 
 	/* Fetch DNS search list */
 	len = fetch_raw_setting_copy ( NULL, &dnssl_setting, &dns_search.data );
 	if ( len >= 0 ) {
 		dns_search.len = len;
-		return;
+		goto done;
 	}
 
 	/* If no DNS search list exists, try to fetch the local domain */
@@ -1196,8 +1461,17 @@ static void apply_dns_search ( void ) {
 			}
 		}
 		free ( localdomain );
-		return;
 	}
+
+ done:
+	/* Flush DNS cache if search list has changed */
+	if ( ( dns_search.len != old.len ) ||
+	     ( memcmp ( dns_search.data, old.data, old.len ) != 0 ) ) {
+		dns_cache_flush();
+	}
+
+	/* Free old search list */
+	free ( old.data );
 }
 
 /**
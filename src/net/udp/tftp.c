@@ -76,6 +76,9 @@ FEATURE ( FEATURE_PROTOCOL, "TFTP", DHCP_EB_FEATURE_TFTP, 1 );
 #define EINVAL_MC_INVALID_PORT __einfo_error ( EINFO_EINVAL_MC_INVALID_PORT )
 #define EINFO_EINVAL_MC_INVALID_PORT __einfo_uniqify \
 	( EINFO_EINVAL, 0x07, "Invalid multicast port" )
+#define EINVAL_WINDOWSIZE __einfo_error ( EINFO_EINVAL_WINDOWSIZE )
+#define EINFO_EINVAL_WINDOWSIZE __einfo_uniqify \
+	( EINFO_EINVAL, 0x08, "Invalid windowsize" )
 
 /**
  * A TFTP request
@@ -109,6 +112,24 @@ struct tftp_request {
 	 * "tsize" option, this value will be zero.
 	 */
 	unsigned long tsize;
+	/** Window size
+	 *
+	 * This is the "windowsize" option (RFC 7440) negotiated with
+	 * the TFTP server.  If the TFTP server does not support the
+	 * "windowsize" option, this will be one (i.e. every block is
+	 * acknowledged).
+	 */
+	unsigned int windowsize;
+	/** Number of contiguous blocks most recently acknowledged */
+	unsigned int acked;
+	/** Number of contiguous blocks at most recently reported gap
+	 *
+	 * This is stored plus one, so that zero indicates that no gap
+	 * has yet been reported.
+	 */
+	unsigned int gap;
+	/** Number of loss events detected within a window */
+	unsigned int losses;
 	
 	/** Server port
 	 *
@@ -154,11 +175,32 @@ enum {
 	TFTP_FL_RRQ_MULTICAST = 0x0004,
 	/** Perform MTFTP recovery on timeout */
 	TFTP_FL_MTFTP_RECOVERY = 0x0008,
+	/** Request windowsize option */
+	TFTP_FL_RRQ_WINDOW = 0x0010,
+	/** Windowsize option has been acknowledged */
+	TFTP_FL_WINDOW = 0x0020,
 };
 
+/** Reciprocal of proportion of lossy windows at which to reduce window size
+ *
+ * Occasional random packet loss is expected; a window size which
+ * loses blocks in more than one window out of every eight is
+ * considered to be too large.
+ */
+#define TFTP_WINDOW_LOSS_RATIO 8
+
 /** Maximum number of MTFTP open requests before falling back to TFTP */
 #define MTFTP_MAX_TIMEOUTS 3
 
+/** Window size to request for new TFTP transfers
+ *
+ * This is adjusted at the end of each windowed transfer: halved
+ * following a transfer in which a significant proportion of windows
+ * lost blocks (e.g. because each burst of blocks overran the network
+ * device's receive ring), and increased otherwise.
+ */
+static unsigned int tftp_windowsize = TFTP_MAX_WINDOWSIZE;
+
 /** Client profiler */
 static struct profiler tftp_client_profiler __profiler =
 	{ .name = "tftp.client" };
@@ -181,6 +223,33 @@ static void tftp_free ( struct refcnt *refcnt ) {
 	free ( tftp );
 }
 
+/**
+ * Adapt window size for subsequent transfers
+ *
+ * @v tftp		TFTP connection
+ */
+static void tftp_adapt_window ( struct tftp_request *tftp ) {
+	unsigned int windows;
+
+	/* Do nothing unless a window size was negotiated */
+	if ( ! ( tftp->flags & TFTP_FL_WINDOW ) )
+		return;
+
+	/* Decrease window size multiplicatively if too many windows
+	 * lost blocks, otherwise increase window size additively.
+	 */
+	windows = ( ( tftp->bitmap.length / tftp->windowsize ) + 1 );
+	if ( ( tftp->losses * TFTP_WINDOW_LOSS_RATIO ) > windows ) {
+		tftp_windowsize = ( ( tftp->windowsize + 1 ) / 2 );
+	} else if ( tftp->windowsize >= tftp_windowsize ) {
+		tftp_windowsize = ( tftp->windowsize + 1 );
+	}
+	if ( tftp_windowsize > TFTP_MAX_WINDOWSIZE )
+		tftp_windowsize = TFTP_MAX_WINDOWSIZE;
+	DBGC ( tftp, "TFTP %p saw %d losses at windowsize %d; next windowsize "
+	       "%d\n", tftp, tftp->losses, tftp->windowsize, tftp_windowsize );
+}
+
 /**
  * Mark TFTP request as complete
  *
@@ -192,6 +261,10 @@ static void tftp_done ( struct tftp_request *tftp, int rc ) {
 	DBGC ( tftp, "TFTP %p finished with status %d (%s)\n",
 	       tftp, rc, strerror ( rc ) );
 
+	/* Adapt window size following a successful transfer */
+	if ( rc == 0 )
+		tftp_adapt_window ( tftp );
+
 	/* Stop the retry timer */
 	stop_timer ( &tftp->timer );
 
@@ -220,6 +293,12 @@ static int tftp_reopen ( struct tftp_request *tftp ) {
 	/* Reset peer address */
 	memset ( &tftp->peer, 0, sizeof ( tftp->peer ) );
 
+	/* Reset window size (which will be renegotiated) */
+	tftp->flags &= ~TFTP_FL_WINDOW;
+	tftp->windowsize = 1;
+	tftp->acked = 0;
+	tftp->gap = 0;
+
 	/* Open socket */
 	memset ( &server, 0, sizeof ( server ) );
 	server.st_port = htons ( tftp->port );
@@ -349,6 +428,7 @@ static int tftp_send_rrq ( struct tftp_request *tftp ) {
 		+ 5 + 1 /* "octet" + NUL */
 		+ 7 + 1 + 5 + 1 /* "blksize" + NUL + ddddd + NUL */
 		+ 5 + 1 + 1 + 1 /* "tsize" + NUL + "0" + NUL */ 
+		+ 10 + 1 + 5 + 1 /* "windowsize" + NUL + ddddd + NUL */
 		+ 9 + 1 + 1 /* "multicast" + NUL + NUL */ );
 	iobuf = xfer_alloc_iob ( &tftp->socket, len );
 	if ( ! iobuf )
@@ -370,6 +450,12 @@ static int tftp_send_rrq ( struct tftp_request *tftp ) {
 					    "blksize%c%zd%ctsize%c0",
 					    0, blksize, 0, 0 ) + 1 );
 	}
+	if ( tftp->flags & TFTP_FL_RRQ_WINDOW ) {
+		iob_put ( iobuf, snprintf ( iobuf->tail,
+					    iob_tailroom ( iobuf ),
+					    "windowsize%c%d", 0,
+					    tftp_windowsize ) + 1 );
+	}
 	if ( tftp->flags & TFTP_FL_RRQ_MULTICAST ) {
 		iob_put ( iobuf, snprintf ( iobuf->tail,
 					    iob_tailroom ( iobuf ),
@@ -398,6 +484,7 @@ static int tftp_send_ack ( struct tftp_request *tftp ) {
 
 	/* Determine next required block number */
 	block = bitmap_first_gap ( &tftp->bitmap );
+	tftp->acked = block;
 	DBGC2 ( tftp, "TFTP %p sending ACK for block %d\n", tftp, block );
 
 	/* Allocate buffer */
@@ -510,7 +597,8 @@ static void tftp_timer_expired ( struct retry_timer *timer, int fail ) {
 			if ( tftp->mtftp_timeouts > MTFTP_MAX_TIMEOUTS ) {
 				DBGC ( tftp, "TFTP %p falling back to plain "
 				       "TFTP\n", tftp );
-				tftp->flags = TFTP_FL_RRQ_SIZES;
+				tftp->flags = ( TFTP_FL_RRQ_SIZES |
+						TFTP_FL_RRQ_WINDOW );
 
 				/* Close multicast socket */
 				intf_restart ( &tftp->mc_socket, 0 );
@@ -539,6 +627,10 @@ static void tftp_timer_expired ( struct retry_timer *timer, int fail ) {
 			rc = -ETIMEDOUT;
 			goto err;
 		}
+
+		/* A timeout within a window indicates lost blocks */
+		if ( tftp->windowsize > 1 )
+			tftp->losses++;
 	}
 	tftp_send_packet ( tftp );
 	return;
@@ -589,6 +681,29 @@ static int tftp_process_tsize ( struct tftp_request *tftp, char *value ) {
 	return 0;
 }
 
+/**
+ * Process TFTP "windowsize" option
+ *
+ * @v tftp		TFTP connection
+ * @v value		Option value
+ * @ret rc		Return status code
+ */
+static int tftp_process_windowsize ( struct tftp_request *tftp,
+				     char *value ) {
+	char *end;
+
+	tftp->windowsize = strtoul ( value, &end, 10 );
+	if ( *end || ( tftp->windowsize == 0 ) ) {
+		DBGC ( tftp, "TFTP %p got invalid windowsize \"%s\"\n",
+		       tftp, value );
+		return -EINVAL_WINDOWSIZE;
+	}
+	tftp->flags |= TFTP_FL_WINDOW;
+	DBGC ( tftp, "TFTP %p windowsize=%d\n", tftp, tftp->windowsize );
+
+	return 0;
+}
+
 /**
  * Process TFTP "multicast" option
  *
@@ -673,6 +788,7 @@ struct tftp_option {
 static struct tftp_option tftp_options[] = {
 	{ "blksize", tftp_process_blksize },
 	{ "tsize", tftp_process_tsize },
+	{ "windowsize", tftp_process_windowsize },
 	{ "multicast", tftp_process_multicast },
 	{ NULL, NULL }
 };
@@ -776,6 +892,55 @@ static int tftp_rx_oack ( struct tftp_request *tftp, void *buf, size_t len ) {
 	return rc;
 }
 
+/**
+ * Check if received block should be acknowledged
+ *
+ * @v tftp		TFTP connection
+ * @v block		Block index
+ * @ret ack		Block should be acknowledged
+ */
+static int tftp_ack_due ( struct tftp_request *tftp, unsigned int block ) {
+	unsigned int gap = bitmap_first_gap ( &tftp->bitmap );
+
+	/* Acknowledge every block if no window is in use */
+	if ( tftp->windowsize <= 1 )
+		return 1;
+
+	/* Acknowledge the final block */
+	if ( bitmap_full ( &tftp->bitmap ) )
+		return 1;
+
+	/* Reacknowledge a retransmitted final block of the previous
+	 * window, since our acknowledgement may have been lost.  Do
+	 * not do so if we reported a gap within the previous window,
+	 * since the retransmission was then solicited by that report
+	 * and reacknowledging would trigger a further retransmission.
+	 */
+	if ( ( block + 1 ) == tftp->acked ) {
+		return ( ( tftp->gap == 0 ) ||
+			 ( tftp->gap > tftp->acked ) ||
+			 ( ( tftp->gap + tftp->windowsize ) <= tftp->acked ) );
+	}
+
+	/* Acknowledge the last contiguous block as soon as a gap
+	 * appears, to allow the server to restart the window without
+	 * waiting for a timeout (RFC 7440 section 4).  This applies
+	 * even if the gap is at the start of the window.  Acknowledge
+	 * each gap only once.
+	 */
+	if ( block > gap ) {
+		if ( ( gap + 1 ) == tftp->gap )
+			return 0;
+		tftp->gap = ( gap + 1 );
+		DBGC ( tftp, "TFTP %p lost block %d\n", tftp, gap );
+		tftp->losses++;
+		return 1;
+	}
+
+	/* Acknowledge the end of each window */
+	return ( ( gap - tftp->acked ) >= tftp->windowsize );
+}
+
 /**
  * Receive DATA
  *
@@ -789,7 +954,9 @@ static int tftp_rx_data ( struct tftp_request *tftp,
 			  struct io_buffer *iobuf ) {
 	struct tftp_data *data = iobuf->data;
 	struct xfer_metadata meta;
+	unsigned int next;
 	unsigned int block;
+	int16_t delta;
 	off_t offset;
 	size_t data_len;
 	int rc;
@@ -802,14 +969,23 @@ static int tftp_rx_data ( struct tftp_request *tftp,
 		goto done;
 	}
 
-	/* Calculate block number */
-	block = ( ( bitmap_first_gap ( &tftp->bitmap ) + 1 ) & ~0xffff );
-	if ( data->block == 0 && block == 0 ) {
+	/* Calculate block number.  A window of blocks may straddle a
+	 * block number wraparound, so interpret the block number
+	 * relative to the next expected block.
+	 */
+	next = ( bitmap_first_gap ( &tftp->bitmap ) + 1 );
+	if ( tftp->windowsize > 1 ) {
+		delta = ( ntohs ( data->block ) - next );
+		block = ( next + delta );
+	} else {
+		block = ( ( next & ~0xffff ) + ntohs ( data->block ) );
+	}
+	if ( ( block == 0 ) || ( block > ( next + 0xffff ) ) ) {
 		DBGC ( tftp, "TFTP %p received data block 0\n", tftp );
 		rc = -EINVAL;
 		goto done;
 	}
-	block += ( ntohs ( data->block ) - 1 );
+	block--;
 
 	/* Stop profiling server turnaround if applicable */
 	if ( block )
@@ -844,8 +1020,15 @@ static int tftp_rx_data ( struct tftp_request *tftp,
 	/* Mark block as received */
 	bitmap_set ( &tftp->bitmap, block );
 
-	/* Acknowledge block */
-	tftp_send_packet ( tftp );
+	/* Acknowledge block, if applicable, or wait for the remainder
+	 * of the window.
+	 */
+	if ( tftp_ack_due ( tftp, block ) ) {
+		tftp_send_packet ( tftp );
+	} else {
+		stop_timer ( &tftp->timer );
+		start_timer ( &tftp->timer );
+	}
 
 	/* Stop profiling client turnaround */
 	profile_stop ( &tftp_client_profiler );
@@ -1138,7 +1321,8 @@ static int tftp_core_open ( struct interface *xfer, struct uri *uri,
  */
 static int tftp_open ( struct interface *xfer, struct uri *uri ) {
 	return tftp_core_open ( xfer, uri, TFTP_PORT, NULL,
-				TFTP_FL_RRQ_SIZES );
+				( TFTP_FL_RRQ_SIZES |
+				  TFTP_FL_RRQ_WINDOW ) );
 
 }
 
@@ -32,14 +32,22 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /* Forcibly enable assertions */
 #undef NDEBUG
 
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <ipxe/bigint.h>
+#include <ipxe/profile.h>
 #include <ipxe/test.h>
 
 /** Define inline big integer */
 #define BIGINT(...) { __VA_ARGS__ }
 
+/** Number of sample iterations for profiling */
+#define PROFILE_COUNT 16
+
+/** Size of modular exponentiation used for profiling (in bytes) */
+#define BIGINT_MOD_EXP_PROFILE_LEN 256
+
 /* Provide global functions to allow inspection of generated assembly code */
 
 void bigint_init_sample ( bigint_element_t *value0, unsigned int size,
@@ -556,6 +564,51 @@ void bigint_mod_exp_sample ( const bigint_element_t *base0,
 		      sizeof ( result_raw ) ) == 0 );			\
 	} while ( 0 )
 
+/**
+ * Calculate modular exponentiation cost
+ *
+ * @ret cost		Cost (in cycles per exponentiation)
+ */
+static unsigned long bigint_mod_exp_cost ( void ) {
+	static uint8_t random[3][BIGINT_MOD_EXP_PROFILE_LEN];
+	unsigned int size =
+		bigint_required_size ( BIGINT_MOD_EXP_PROFILE_LEN );
+	bigint_t ( size ) base;
+	bigint_t ( size ) modulus;
+	bigint_t ( size ) exponent;
+	bigint_t ( size ) result;
+	size_t tmp_len = bigint_mod_exp_tmp_len ( &modulus, &exponent );
+	uint8_t tmp[tmp_len];
+	struct profiler profiler;
+	unsigned int i;
+	unsigned int j;
+
+	/* Fill values with pseudo-random data, using an odd modulus
+	 * with the top bit set (as for an RSA public key).
+	 */
+	srand ( 0x1234568 );
+	for ( i = 0 ; i < ( sizeof ( random ) / sizeof ( random[0] ) ) ; i++ ) {
+		for ( j = 0 ; j < sizeof ( random[0] ) ; j++ )
+			random[i][j] = rand();
+	}
+	random[1][0] |= 0x80;
+	random[1][ sizeof ( random[1] ) - 1 ] |= 0x01;
+	random[0][0] &= 0x7f;
+	bigint_init ( &base, random[0], sizeof ( random[0] ) );
+	bigint_init ( &modulus, random[1], sizeof ( random[1] ) );
+	bigint_init ( &exponent, random[2], sizeof ( random[2] ) );
+
+	/* Profile modular exponentiation */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		profile_start ( &profiler );
+		bigint_mod_exp ( &base, &modulus, &exponent, &result, tmp );
+		profile_stop ( &profiler );
+	}
+
+	return profile_mean ( &profiler );
+}
+
 /**
  * Perform big integer self-tests
  *
@@ -2432,6 +2485,69 @@ static void bigint_test_exec ( void ) {
 				     0xfa, 0x83, 0xd4, 0x7c, 0xe9, 0x77,
 				     0x46, 0x91, 0x3a, 0x50, 0x0d, 0x6a,
 				     0x25, 0xd0 ) );
+	bigint_mod_exp_ok ( BIGINT ( 0x5b, 0xf2, 0x07, 0x6d, 0x66, 0xa6,
+				     0xb6, 0xa8, 0x9c, 0x1d, 0x4e, 0x91,
+				     0x05, 0xe0, 0x43, 0x36, 0x7e, 0x19,
+				     0xb5, 0x4f, 0xb1, 0x11, 0xd1, 0x56,
+				     0x6f, 0x97, 0x8f, 0x0b, 0x6d, 0x58,
+				     0x1a, 0x30 ),
+			    BIGINT ( 0xb4, 0xc5, 0x81, 0xc8, 0xf0, 0xaf,
+				     0x45, 0xa4, 0x55, 0xd7, 0x41, 0xdc,
+				     0xea, 0x80, 0x7a, 0x8b, 0x30, 0x7a,
+				     0x8c, 0xa1, 0x66, 0x07, 0xf2, 0x86,
+				     0x95, 0x7b, 0xe9, 0xc4, 0x50, 0xba,
+				     0xfc, 0x5b ),
+			    BIGINT ( 0xad, 0x2a, 0x74, 0x70, 0x71, 0xd6,
+				     0x3f, 0xb7, 0x96, 0xa9, 0x5c, 0x3c,
+				     0xf9, 0x37, 0x54, 0xe3, 0xa6, 0x11,
+				     0x89, 0xff, 0xad, 0x6f, 0x0b, 0x6e,
+				     0xda, 0x72, 0xc7, 0xc5, 0x20, 0x1f,
+				     0xea, 0xa3 ),
+			    BIGINT ( 0x47, 0x03, 0xc8, 0x7f, 0xc5, 0xd5,
+				     0x27, 0x88, 0x0e, 0x2b, 0x1b, 0x81,
+				     0x20, 0x6a, 0x7a, 0xff, 0xef, 0xe2,
+				     0xa9, 0x2e, 0x38, 0x65, 0xb6, 0xee,
+				     0x7e, 0x2f, 0xf1, 0x8b, 0xc4, 0xb6,
+				     0xae, 0x97 ) );
+	bigint_mod_exp_ok ( BIGINT ( 0x08, 0xd6, 0x62, 0xfa, 0x26, 0x98,
+				     0x4d, 0x76, 0x7e, 0x46, 0xa6, 0x09,
+				     0xa2, 0x8b, 0x83, 0x9a, 0xab, 0x62,
+				     0x33, 0xef, 0xf2, 0xb2, 0xbe, 0x3d,
+				     0x33, 0x7a, 0xce, 0x32, 0xa7, 0x0b,
+				     0x39, 0xd8, 0x50, 0xb0, 0x56, 0x01,
+				     0xd2, 0x4a, 0x2b, 0xa2, 0x82, 0xa5,
+				     0x01, 0xc2, 0x57, 0xc4, 0xa3, 0x6e,
+				     0xc2, 0xc0, 0xee, 0xac, 0x4f, 0x2c,
+				     0xbd, 0xe1, 0x6f, 0x14, 0x7a, 0x2c,
+				     0x90, 0x5b, 0xbd, 0x59, 0x57 ),
+			    BIGINT ( 0xae, 0x66, 0x3a, 0xc6, 0xe1, 0xc4,
+				     0xe4, 0xfa, 0x77, 0x68, 0x93, 0xdd,
+				     0x26, 0x6b, 0x94, 0x9d, 0x94, 0xa1,
+				     0xfc, 0x61, 0x90, 0x42, 0x9e, 0xf9,
+				     0xd8, 0xa1, 0x36, 0x92, 0x34, 0x3a,
+				     0x1d, 0x47, 0x01, 0xa0, 0x02, 0x4f,
+				     0x92, 0x3e, 0x44, 0x49, 0x55, 0x23,
+				     0xf9, 0x4e, 0x57, 0x17, 0xac, 0x83,
+				     0xca, 0x07, 0x29, 0x66, 0xa1, 0x42,
+				     0x15, 0xfe, 0x52, 0x34, 0xa4, 0x13,
+				     0xc8, 0x78, 0xbb, 0x5d, 0xb9 ),
+			    BIGINT ( 0xf2, 0x1a, 0x5d, 0xfe, 0xca, 0xa3,
+				     0x50, 0xe1, 0x11 ),
+			    BIGINT ( 0x7e, 0x96, 0x92, 0x82, 0x0e, 0x72,
+				     0xd4, 0xb0, 0x40, 0xe9, 0xf4, 0x5c,
+				     0x65, 0xd5, 0x53, 0x2c, 0x0a, 0xe3,
+				     0x3c, 0x04, 0xb9, 0x3c, 0x0f, 0x4a,
+				     0x11, 0x53, 0x3b, 0x71, 0x88, 0x83,
+				     0x8f, 0x5f, 0xf6, 0xc8, 0xbb, 0xd6,
+				     0x93, 0x1c, 0xa1, 0x02, 0x51, 0xb7,
+				     0x73, 0x1e, 0x03, 0x3c, 0x3e, 0x4b,
+				     0xc9, 0x8c, 0x41, 0x3b, 0x8f, 0x88,
+				     0x27, 0x83, 0x87, 0x33, 0x75, 0x03,
+				     0x09, 0x02, 0xa7, 0xa4, 0xb9 ) );
+
+	/* Speed tests */
+	DBG ( "BIGINT %d-bit modular exponentiation required %ld cycles\n",
+	      ( BIGINT_MOD_EXP_PROFILE_LEN * 8 ), bigint_mod_exp_cost() );
 }
 
 /** Big integer self-test */
@@ -172,6 +172,8 @@ void cipher_decrypt_okx ( struct cipher_test *test, const char *file,
 void cipher_okx ( struct cipher_test *test, const char *file,
 		  unsigned int line ) {
 	struct cipher_algorithm *cipher = test->cipher;
+	struct cipher_algorithm *accel;
+	struct cipher_test accel_test;
 	size_t len = test->len;
 
 	/* Sanity checks */
@@ -184,6 +186,14 @@ void cipher_okx ( struct cipher_test *test, const char *file,
 
 	/* Report decryption test result */
 	cipher_decrypt_okx ( test, file, line );
+
+	/* Repeat tests using hardware-accelerated cipher, if available */
+	accel = cipher_accelerated ( cipher );
+	if ( accel != cipher ) {
+		memcpy ( &accel_test, test, sizeof ( accel_test ) );
+		accel_test.cipher = accel;
+		cipher_okx ( &accel_test, file, line );
+	}
 }
 
 /**
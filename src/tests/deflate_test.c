@@ -35,9 +35,17 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <assert.h>
 #include <ipxe/deflate.h>
+#include <ipxe/profile.h>
 #include <ipxe/test.h>
 
+/** Number of sample iterations for profiling */
+#define PROFILE_COUNT 16
+
+/** Length of generated test data */
+#define DEFLATE_GENERATED_LEN 65536
+
 /** A DEFLATE test */
 struct deflate_test {
 	/** Compression format */
@@ -143,6 +151,321 @@ static struct deflate_test_fragments zlib_fragments[] = {
 	{ { 48, -1UL } },
 };
 
+/* Generated data fragment list */
+static struct deflate_test_fragments generated_fragments[] = {
+	{ { 1, 7, 8, 9, 1021, 3, 4096, -1UL } },
+	{ { 8, 8, 8, 8, 8, 8, 8, -1UL } },
+	{ { 64, 1, 64, 2, 64, 3, 64, -1UL } },
+};
+
+/** A Huffman code length run (used for generating test data) */
+struct deflate_test_length_run {
+	/** Code length */
+	uint8_t bits;
+	/** Number of consecutive symbols with this code length */
+	uint8_t count;
+};
+
+/** Generated data literal/length code lengths
+ *
+ * This is a complete Huffman alphabet including both very short and
+ * maximum-length (15-bit) symbols, to exercise all levels of the
+ * decoder's lookup tables.
+ */
+static struct deflate_test_length_run deflate_test_litlen[] = {
+	{ 12, 1 }, { 15, 31 }, { 7, 96 }, { 10, 1 }, { 11, 127 },
+	{ 12, 1 }, { 5, 1 }, { 6, 7 }, { 8, 8 }, { 9, 2 }, { 10, 10 },
+	{ 15, 1 }, { 0, 0 }
+};
+
+/** Generated data distance code lengths */
+static struct deflate_test_length_run deflate_test_distance[] = {
+	{ 6, 1 }, { 7, 3 }, { 4, 1 }, { 5, 7 }, { 3, 1 }, { 4, 7 },
+	{ 5, 1 }, { 6, 5 }, { 8, 1 }, { 9, 1 }, { 10, 2 }, { 0, 0 }
+};
+
+/** Number of generated data literal/length codes */
+#define DEFLATE_TEST_LITLEN_COUNT 286
+
+/** Number of generated data distance codes */
+#define DEFLATE_TEST_DISTANCE_COUNT 30
+
+/** A DEFLATE test data generator */
+struct deflate_test_generator {
+	/** Compressed data */
+	uint8_t *data;
+	/** Maximum length of compressed data */
+	size_t max_len;
+	/** Length of compressed data */
+	size_t len;
+	/** Accumulator */
+	uint32_t accumulator;
+	/** Number of bits within the accumulator */
+	unsigned int bits;
+	/** Code lengths */
+	uint8_t lengths[ DEFLATE_TEST_LITLEN_COUNT +
+			 DEFLATE_TEST_DISTANCE_COUNT ];
+	/** Huffman codes */
+	uint16_t codes[ DEFLATE_TEST_LITLEN_COUNT +
+			DEFLATE_TEST_DISTANCE_COUNT ];
+};
+
+/**
+ * Append bits to generated data
+ *
+ * @v gen		Generator
+ * @v value		Value
+ * @v bits		Length of value (in bits)
+ */
+static void deflate_test_put ( struct deflate_test_generator *gen,
+			       unsigned int value, unsigned int bits ) {
+
+	gen->accumulator |= ( value << gen->bits );
+	gen->bits += bits;
+	while ( gen->bits >= 8 ) {
+		assert ( gen->len < gen->max_len );
+		gen->data[ gen->len++ ] = gen->accumulator;
+		gen->accumulator >>= 8;
+		gen->bits -= 8;
+	}
+}
+
+/**
+ * Append Huffman-coded symbol to generated data
+ *
+ * @v gen		Generator
+ * @v index		Symbol index within code lengths
+ */
+static void deflate_test_put_symbol ( struct deflate_test_generator *gen,
+				      unsigned int index ) {
+	unsigned int bits = gen->lengths[index];
+	unsigned int huf = gen->codes[index];
+	unsigned int reversed = 0;
+
+	/* Huffman codes are stored starting with the MSB */
+	while ( bits-- ) {
+		reversed = ( ( reversed << 1 ) | ( huf & 1 ) );
+		huf >>= 1;
+	}
+	deflate_test_put ( gen, reversed, gen->lengths[index] );
+}
+
+/**
+ * Construct Huffman alphabet for generated data
+ *
+ * @v gen		Generator
+ * @v runs		Code length runs
+ * @v offset		Starting offset within code lengths
+ * @v count		Number of symbols
+ */
+static void deflate_test_alphabet ( struct deflate_test_generator *gen,
+				    struct deflate_test_length_run *runs,
+				    unsigned int offset, unsigned int count ) {
+	uint8_t *lengths = &gen->lengths[offset];
+	uint16_t *codes = &gen->codes[offset];
+	unsigned int huf = 0;
+	unsigned int bits;
+	unsigned int i;
+
+	/* Expand code length runs */
+	for ( ; runs->count ; runs++ ) {
+		memset ( lengths, runs->bits, runs->count );
+		lengths += runs->count;
+	}
+	assert ( lengths == &gen->lengths[ offset + count ] );
+	lengths = &gen->lengths[offset];
+
+	/* Assign canonical Huffman codes */
+	for ( bits = 1 ; bits <= DEFLATE_HUFFMAN_BITS ; bits++ ) {
+		for ( i = 0 ; i < count ; i++ ) {
+			if ( lengths[i] == bits )
+				codes[i] = huf++;
+		}
+		huf <<= 1;
+	}
+	assert ( huf == ( 1 << ( DEFLATE_HUFFMAN_BITS + 1 ) ) );
+}
+
+/**
+ * Choose random symbol from generated data alphabet
+ *
+ * @v gen		Generator
+ * @v offset		Starting offset within code lengths
+ * @v count		Number of symbols
+ * @ret index		Symbol index within alphabet
+ *
+ * Symbols are chosen with the probabilities implied by their code
+ * lengths, so that the generated data resembles the output of a
+ * real compressor.
+ */
+static unsigned int deflate_test_choose ( struct deflate_test_generator *gen,
+					  unsigned int offset,
+					  unsigned int count ) {
+	int weight = ( rand() & ( ( 1 << DEFLATE_HUFFMAN_BITS ) - 1 ) );
+	unsigned int i;
+
+	for ( i = 0 ; i < count ; i++ ) {
+		weight -= ( ( 1 << DEFLATE_HUFFMAN_BITS ) >>
+			    gen->lengths[ offset + i ] );
+		if ( weight < 0 )
+			break;
+	}
+	assert ( i < count );
+	return i;
+}
+
+/**
+ * Calculate length or distance for a generated data symbol
+ *
+ * @v code		Length or distance code
+ * @v base		Base value for first code
+ * @v group		Number of codes sharing each number of extra bits
+ * @v bits		Number of extra bits to fill in
+ * @ret base		Base value for this code
+ */
+static unsigned int deflate_test_base ( unsigned int code, unsigned int base,
+					unsigned int group,
+					unsigned int *bits ) {
+	unsigned int i;
+
+	for ( i = 0 ; i <= code ; i++ ) {
+		*bits = ( i / group );
+		if ( *bits )
+			( *bits )--;
+		if ( i < code )
+			base += ( 1 << *bits );
+	}
+	return base;
+}
+
+/**
+ * Generate test data
+ *
+ * @v test		DEFLATE test to fill in
+ * @v compressed	Compressed data buffer
+ * @v max_len		Length of compressed data buffer
+ * @v expected		Expected uncompressed data buffer
+ * @v len		Length of expected uncompressed data
+ *
+ * Generate a single dynamic Huffman block containing pseudo-random
+ * literals and duplicate strings.
+ */
+static void deflate_test_generate ( struct deflate_test *test,
+				    uint8_t *compressed, size_t max_len,
+				    uint8_t *expected, size_t len ) {
+	struct deflate_test_generator gen;
+	unsigned int code;
+	unsigned int len_bits;
+	unsigned int distance_code;
+	unsigned int distance_bits;
+	unsigned int dup_len;
+	unsigned int dup_distance;
+	unsigned int len_extra;
+	unsigned int distance_extra;
+	size_t offset = 0;
+	unsigned int i;
+
+	/* Initialise generator */
+	memset ( &gen, 0, sizeof ( gen ) );
+	gen.data = compressed;
+	gen.max_len = max_len;
+	deflate_test_alphabet ( &gen, deflate_test_litlen, 0,
+				DEFLATE_TEST_LITLEN_COUNT );
+	deflate_test_alphabet ( &gen, deflate_test_distance,
+				DEFLATE_TEST_LITLEN_COUNT,
+				DEFLATE_TEST_DISTANCE_COUNT );
+	srand ( 0x1234568 );
+
+	/* Construct final dynamic block header */
+	deflate_test_put ( &gen, ( ( 1 << DEFLATE_HEADER_BFINAL_BIT ) |
+				   ( DEFLATE_HEADER_BTYPE_DYNAMIC <<
+				     DEFLATE_HEADER_BTYPE_LSB ) ),
+			   DEFLATE_HEADER_BITS );
+	deflate_test_put ( &gen, ( DEFLATE_TEST_LITLEN_COUNT - 257 ), 5 );
+	deflate_test_put ( &gen, ( DEFLATE_TEST_DISTANCE_COUNT - 1 ), 5 );
+	deflate_test_put ( &gen, ( 19 - 4 ), 4 );
+
+	/* Use a code length alphabet in which code lengths 0-15 each
+	 * have a four-bit Huffman code equal to the code length, and
+	 * the repetition codes 16-18 (which are listed first) are
+	 * unused.
+	 */
+	for ( i = 0 ; i < 19 ; i++ )
+		deflate_test_put ( &gen, ( ( i < 3 ) ? 0 : 4 ),
+				   DEFLATE_CODELEN_BITS );
+	for ( i = 0 ; i < ( sizeof ( gen.lengths ) /
+			    sizeof ( gen.lengths[0] ) ) ; i++ ) {
+		code = gen.lengths[i];
+		deflate_test_put ( &gen, ( ( ( code & 1 ) << 3 ) |
+					   ( ( code & 2 ) << 1 ) |
+					   ( ( code & 4 ) >> 1 ) |
+					   ( ( code & 8 ) >> 3 ) ), 4 );
+	}
+
+	/* Construct data */
+	while ( offset < len ) {
+
+		/* Choose literal/length symbol */
+		code = deflate_test_choose ( &gen, 0,
+					     DEFLATE_TEST_LITLEN_COUNT );
+
+		/* Handle literals */
+		if ( code < DEFLATE_LITLEN_END ) {
+			deflate_test_put_symbol ( &gen, code );
+			expected[ offset++ ] = code;
+			continue;
+		} else if ( code == DEFLATE_LITLEN_END ) {
+			continue;
+		}
+
+		/* Choose duplicate string length */
+		if ( code == 285 ) {
+			len_bits = 0;
+			dup_len = 258;
+		} else {
+			dup_len = deflate_test_base ( ( code - 257 ), 3, 4,
+						      &len_bits );
+		}
+		len_extra = ( rand() & ( ( 1 << len_bits ) - 1 ) );
+		dup_len += len_extra;
+
+		/* Choose duplicate string distance */
+		distance_code =
+			deflate_test_choose ( &gen, DEFLATE_TEST_LITLEN_COUNT,
+					      DEFLATE_TEST_DISTANCE_COUNT );
+		dup_distance = deflate_test_base ( distance_code, 1, 2,
+						   &distance_bits );
+		distance_extra = ( rand() & ( ( 1 << distance_bits ) - 1 ) );
+		dup_distance += distance_extra;
+
+		/* Skip any duplicate strings that would not fit */
+		if ( ( dup_distance > offset ) ||
+		     ( dup_len > ( len - offset ) ) ) {
+			continue;
+		}
+
+		/* Construct duplicate string */
+		deflate_test_put_symbol ( &gen, code );
+		deflate_test_put ( &gen, len_extra, len_bits );
+		deflate_test_put_symbol ( &gen, ( DEFLATE_TEST_LITLEN_COUNT +
+						  distance_code ) );
+		deflate_test_put ( &gen, distance_extra, distance_bits );
+		for ( i = 0 ; i < dup_len ; i++, offset++ )
+			expected[offset] = expected[ offset - dup_distance ];
+	}
+
+	/* Construct end of block and pad to a whole byte */
+	deflate_test_put_symbol ( &gen, DEFLATE_LITLEN_END );
+	deflate_test_put ( &gen, 0, 7 );
+
+	/* Fill in test */
+	test->format = DEFLATE_RAW;
+	test->compressed = compressed;
+	test->compressed_len = gen.len;
+	test->expected = expected;
+	test->expected_len = len;
+}
+
 /**
  * Report DEFLATE test result
  *
@@ -156,7 +479,7 @@ static void deflate_okx ( struct deflate *deflate,
 			  struct deflate_test *test,
 			  struct deflate_test_fragments *frags,
 			  const char *file, unsigned int line ) {
-	uint8_t data[ test->expected_len ];
+	uint8_t *data;
 	struct deflate_chunk in;
 	struct deflate_chunk out;
 	size_t frag_len = -1UL;
@@ -164,11 +487,18 @@ static void deflate_okx ( struct deflate *deflate,
 	size_t remaining = test->compressed_len;
 	unsigned int i;
 
+	/* Allocate output buffer (may be too large for stack) */
+	data = malloc ( test->expected_len );
+	okx ( data != NULL, file, line );
+	if ( ! data )
+		return;
+
 	/* Initialise decompressor */
 	deflate_init ( deflate, test->format );
 
 	/* Initialise output chunk */
-	deflate_chunk_init ( &out, virt_to_user ( data ), 0, sizeof ( data ) );
+	deflate_chunk_init ( &out, virt_to_user ( data ), 0,
+			     test->expected_len );
 
 	/* Process input (in fragments, if applicable) */
 	for ( i = 0 ; i < ( sizeof ( frags->len ) /
@@ -203,15 +533,92 @@ static void deflate_okx ( struct deflate *deflate,
 	okx ( out.offset == test->expected_len, file, line );
 	okx ( memcmp ( data, test->expected, test->expected_len ) == 0,
 	     file, line );
+
+	/* Free output buffer */
+	free ( data );
 }
 #define deflate_ok( deflate, test, frags ) \
 	deflate_okx ( deflate, test, frags, __FILE__, __LINE__ )
 
+/**
+ * Report DEFLATE length calculation test result
+ *
+ * @v deflate		Decompressor
+ * @v test		Deflate test
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void deflate_len_okx ( struct deflate *deflate,
+			      struct deflate_test *test,
+			      const char *file, unsigned int line ) {
+	struct deflate_chunk in;
+	struct deflate_chunk out;
+
+	/* Initialise decompressor */
+	deflate_init ( deflate, test->format );
+
+	/* Calculate length without an output buffer */
+	deflate_chunk_init ( &in, virt_to_user ( test->compressed ), 0,
+			     test->compressed_len );
+	deflate_chunk_init ( &out, UNULL, 0, 0 );
+	okx ( deflate_inflate ( deflate, &in, &out ) == 0, file, line );
+	okx ( deflate_finished ( deflate ), file, line );
+	okx ( in.offset == test->compressed_len, file, line );
+	okx ( out.offset == test->expected_len, file, line );
+}
+#define deflate_len_ok( deflate, test ) \
+	deflate_len_okx ( deflate, test, __FILE__, __LINE__ )
+
+/**
+ * Calculate decompression cost
+ *
+ * @v deflate		Decompressor
+ * @v test		Deflate test
+ * @ret cost		Cost (in cycles per decompressed byte)
+ */
+static unsigned long deflate_cost ( struct deflate *deflate,
+				    struct deflate_test *test ) {
+	static uint8_t data[DEFLATE_GENERATED_LEN]; /* Too large for stack */
+	struct deflate_chunk in;
+	struct deflate_chunk out;
+	struct profiler profiler;
+	unsigned long cost;
+	unsigned int i;
+	int rc;
+
+	/* Sanity check */
+	assert ( test->expected_len <= sizeof ( data ) );
+
+	/* Profile decompression */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		deflate_init ( deflate, test->format );
+		deflate_chunk_init ( &in, virt_to_user ( test->compressed ), 0,
+				     test->compressed_len );
+		deflate_chunk_init ( &out, virt_to_user ( data ), 0,
+				     test->expected_len );
+		profile_start ( &profiler );
+		rc = deflate_inflate ( deflate, &in, &out );
+		profile_stop ( &profiler );
+		assert ( rc == 0 );
+		assert ( deflate_finished ( deflate ) );
+	}
+
+	/* Round to nearest whole number of cycles per byte */
+	cost = ( ( profile_mean ( &profiler ) + ( test->expected_len / 2 ) ) /
+		 test->expected_len );
+
+	return cost;
+}
+
 /**
  * Perform DEFLATE self-test
  *
  */
 static void deflate_test_exec ( void ) {
+	static uint8_t compressed[DEFLATE_GENERATED_LEN];
+	static uint8_t expected[DEFLATE_GENERATED_LEN];
+	struct deflate_test generated;
 	struct deflate *deflate;
 	unsigned int i;
 
@@ -237,6 +644,22 @@ static void deflate_test_exec ( void ) {
 				    sizeof ( zlib_fragments[0] ) ) ; i++ ) {
 			deflate_ok ( deflate, &zlib, &zlib_fragments[i] );
 		}
+
+		/* Test generated data */
+		deflate_test_generate ( &generated, compressed,
+					sizeof ( compressed ), expected,
+					sizeof ( expected ) );
+		deflate_ok ( deflate, &generated, NULL );
+		for ( i = 0 ; i < ( sizeof ( generated_fragments ) /
+				    sizeof ( generated_fragments[0] ) ) ; i++ ){
+			deflate_ok ( deflate, &generated,
+				     &generated_fragments[i] );
+		}
+		deflate_len_ok ( deflate, &generated );
+
+		/* Speed test */
+		DBG ( "DEFLATE required %ld cycles per byte\n",
+		      deflate_cost ( deflate, &generated ) );
 	}
 
 	/* Free shared structure */
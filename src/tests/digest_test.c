@@ -36,6 +36,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <string.h>
 #include <ipxe/crypto.h>
 #include <ipxe/profile.h>
+#include <ipxe/timer.h>
 #include "digest_test.h"
 
 /** Maximum number of digest test fragments */
@@ -57,6 +58,24 @@ static struct digest_test_fragments digest_test_fragments[] = {
 /** Number of sample iterations for profiling */
 #define PROFILE_COUNT 16
 
+/** Minimum duration of throughput measurements */
+#define RATE_TICKS ( TICKS_PER_SEC / 4 )
+
+/** Pseudo-random data for profiling (too large for stack) */
+static uint8_t digest_test_random[8192];
+
+/**
+ * Fill profiling buffer with pseudo-random data
+ *
+ */
+static void digest_test_fill ( void ) {
+	unsigned int i;
+
+	srand ( 0x1234568 );
+	for ( i = 0 ; i < sizeof ( digest_test_random ) ; i++ )
+		digest_test_random[i] = rand();
+}
+
 /**
  * Report a digest fragmented test result
  *
@@ -129,7 +148,6 @@ void digest_okx ( struct digest_test *test, const char *file,
  * @ret cost		Cost (in cycles per byte)
  */
 unsigned long digest_cost ( struct digest_algorithm *digest ) {
-	static uint8_t random[8192]; /* Too large for stack */
 	uint8_t ctx[digest->ctxsize];
 	uint8_t out[digest->digestsize];
 	struct profiler profiler;
@@ -137,23 +155,116 @@ unsigned long digest_cost ( struct digest_algorithm *digest ) {
 	unsigned int i;
 
 	/* Fill buffer with pseudo-random data */
-	srand ( 0x1234568 );
-	for ( i = 0 ; i < sizeof ( random ) ; i++ )
-		random[i] = rand();
+	digest_test_fill();
 
 	/* Profile digest calculation */
 	memset ( &profiler, 0, sizeof ( profiler ) );
 	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
 		profile_start ( &profiler );
 		digest_init ( digest, ctx );
-		digest_update ( digest, ctx, random, sizeof ( random ) );
+		digest_update ( digest, ctx, digest_test_random,
+				sizeof ( digest_test_random ) );
 		digest_final ( digest, ctx, out );
 		profile_stop ( &profiler );
 	}
 
 	/* Round to nearest whole number of cycles per byte */
-	cost = ( ( profile_mean ( &profiler ) + ( sizeof ( random ) / 2 ) ) /
-		 sizeof ( random ) );
+	cost = ( ( profile_mean ( &profiler ) +
+		   ( sizeof ( digest_test_random ) / 2 ) ) /
+		 sizeof ( digest_test_random ) );
 
 	return cost;
 }
+
+/**
+ * Calculate digest algorithm throughput
+ *
+ * @v digest		Digest algorithm
+ * @ret rate		Throughput (in MB/s)
+ */
+unsigned long digest_rate ( struct digest_algorithm *digest ) {
+	uint8_t ctx[digest->ctxsize];
+	uint8_t out[digest->digestsize];
+	unsigned long start;
+	unsigned long elapsed;
+	unsigned long long total = 0;
+
+	/* Fill buffer with pseudo-random data */
+	digest_test_fill();
+
+	/* Digest data until sufficient time has elapsed */
+	digest_init ( digest, ctx );
+	start = currticks();
+	do {
+		digest_update ( digest, ctx, digest_test_random,
+				sizeof ( digest_test_random ) );
+		total += sizeof ( digest_test_random );
+		elapsed = ( currticks() - start );
+	} while ( elapsed < RATE_TICKS );
+	digest_final ( digest, ctx, out );
+
+	return ( ( total * TICKS_PER_SEC ) / ( elapsed * 1024 * 1024 ) );
+}
+
+/**
+ * Report digest block function implementation test results
+ *
+ * @v digest		Generic digest algorithm
+ * @v file		Test code file
+ * @v line		Test code line
+ *
+ * Every usable implementation of the digest block function is
+ * checked against the implementation selected for use by the
+ * digest algorithm (which is itself verified by the test vectors).
+ */
+void digest_accel_okx ( struct digest_algorithm *digest, const char *file,
+			unsigned int line ) {
+	struct digest_accelerator *accel;
+	struct digest_accelerator *selected;
+	size_t count = ( sizeof ( digest_test_random ) / digest->blocksize );
+	uint8_t init[digest->digestsize];
+	uint8_t expected[digest->digestsize];
+	uint8_t actual[digest->digestsize];
+	struct profiler profiler;
+	unsigned int i;
+
+	/* Identify selected implementation */
+	selected = digest_accelerated ( digest );
+	okx ( selected != NULL, file, line );
+	if ( ! selected )
+		return;
+
+	/* Construct arbitrary initial digest value and expected result */
+	digest_test_fill();
+	memcpy ( init, digest_test_random, sizeof ( init ) );
+	memcpy ( expected, init, sizeof ( expected ) );
+	selected->blocks ( expected, digest_test_random, count );
+
+	/* Check each usable implementation */
+	for_each_table_entry ( accel, DIGEST_ACCELERATORS ) {
+		if ( accel->generic != digest )
+			continue;
+		if ( accel->probe && ( accel->probe() != 0 ) )
+			continue;
+
+		/* Check result */
+		memcpy ( actual, init, sizeof ( actual ) );
+		accel->blocks ( actual, digest_test_random, count );
+		okx ( memcmp ( actual, expected, sizeof ( actual ) ) == 0,
+		      file, line );
+
+		/* Report cost */
+		memset ( &profiler, 0, sizeof ( profiler ) );
+		for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+			profile_start ( &profiler );
+			accel->blocks ( actual, digest_test_random, count );
+			profile_stop ( &profiler );
+		}
+		DBGC ( digest, "DIGEST %s (%s%s) required %ld cycles per "
+		       "byte\n", digest->name, accel->name,
+		       ( ( accel == selected ) ? ", selected" : "" ),
+		       ( ( profile_mean ( &profiler ) +
+			   ( sizeof ( digest_test_random ) / 2 ) ) /
+			 sizeof ( digest_test_random ) ) );
+	}
+}
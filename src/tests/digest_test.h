@@ -108,8 +108,14 @@ struct digest_test {
  */
 #define digest_ok(test) digest_okx ( test, __FILE__, __LINE__ )
 
+#define digest_accel_ok(digest) \
+	digest_accel_okx ( digest, __FILE__, __LINE__ )
+
 extern void digest_okx ( struct digest_test *test, const char *file,
 			 unsigned int line );
+extern void digest_accel_okx ( struct digest_algorithm *digest,
+			       const char *file, unsigned int line );
 extern unsigned long digest_cost ( struct digest_algorithm *digest );
+extern unsigned long digest_rate ( struct digest_algorithm *digest );
 
 #endif /* _DIGEST_TEST_H */
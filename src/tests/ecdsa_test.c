@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * ECDSA self-tests
+ *
+ * Test vectors are taken from the P-256 examples in RFC 6979 section
+ * A.2.5.
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <string.h>
+#include <ipxe/crypto.h>
+#include <ipxe/asn1.h>
+#include <ipxe/ecdsa.h>
+#include <ipxe/test.h>
+#include "pubkey_test.h"
+
+/** Define inline plaintext data */
+#define PLAINTEXT(...) { __VA_ARGS__ }
+
+/** Define inline signature data */
+#define SIGNATURE(...) { __VA_ARGS__ }
+
+/** An ECDSA signature self-test */
+struct ecdsa_signature_test {
+	/** Public key */
+	const void *public;
+	/** Public key length */
+	size_t public_len;
+	/** Plaintext */
+	const void *plaintext;
+	/** Plaintext length */
+	size_t plaintext_len;
+	/** Signature algorithm */
+	struct asn1_algorithm *algorithm;
+	/** Signature */
+	const void *signature;
+	/** Signature length */
+	size_t signature_len;
+};
+
+/**
+ * Define an ECDSA signature test
+ *
+ * @v name		Test name
+ * @v PUBLIC		Public key
+ * @v PLAINTEXT		Plaintext
+ * @v ALGORITHM		Signature algorithm
+ * @v SIGNATURE		Signature
+ * @ret test		Signature test
+ */
+#define ECDSA_SIGNATURE_TEST( name, PUBLIC, PLAINTEXT, ALGORITHM,	\
+			      SIGNATURE )				\
+	static const uint8_t name ## _plaintext[] = PLAINTEXT;		\
+	static const uint8_t name ## _signature[] = SIGNATURE;		\
+	static struct ecdsa_signature_test name = {			\
+		.public = PUBLIC,					\
+		.public_len = sizeof ( PUBLIC ),			\
+		.plaintext = name ## _plaintext,			\
+		.plaintext_len = sizeof ( name ## _plaintext ),		\
+		.algorithm = ALGORITHM,					\
+		.signature = name ## _signature,			\
+		.signature_len = sizeof ( name ## _signature ),		\
+	}
+
+/**
+ * Report ECDSA signature test result
+ *
+ * @v test		ECDSA signature test
+ * @v mismatch		ECDSA signature test using different plaintext
+ */
+#define ecdsa_signature_ok( test, mismatch ) do {			\
+	struct digest_algorithm *digest = (test)->algorithm->digest;	\
+	uint8_t bad_signature[ (test)->signature_len ];			\
+	pubkey_verify_ok ( &ecdsa_algorithm, (test)->public,		\
+			   (test)->public_len, digest,			\
+			   (test)->plaintext, (test)->plaintext_len,	\
+			   (test)->signature, (test)->signature_len );	\
+	pubkey_verify_fail_ok ( &ecdsa_algorithm, (test)->public,	\
+				(test)->public_len, digest,		\
+				(mismatch)->plaintext,			\
+				(mismatch)->plaintext_len,		\
+				(test)->signature,			\
+				(test)->signature_len );		\
+	memcpy ( bad_signature, (test)->signature,			\
+		 sizeof ( bad_signature ) );				\
+	bad_signature[ sizeof ( bad_signature ) - 1 ] ^= 0x01;		\
+	pubkey_verify_fail_ok ( &ecdsa_algorithm, (test)->public,	\
+				(test)->public_len, digest,		\
+				(test)->plaintext,			\
+				(test)->plaintext_len, bad_signature,	\
+				sizeof ( bad_signature ) );		\
+	memset ( bad_signature, 0, sizeof ( bad_signature ) );		\
+	pubkey_verify_fail_ok ( &ecdsa_algorithm, (test)->public,	\
+				(test)->public_len, digest,		\
+				(test)->plaintext,			\
+				(test)->plaintext_len, bad_signature,	\
+				sizeof ( bad_signature ) );		\
+	} while ( 0 )
+
+/** RFC 6979 section A.2.5 public key */
+static const uint8_t rfc6979_public[] = {
+	0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a, 0x86,
+	0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08, 0x2a,
+	0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03,
+	0x42, 0x00, 0x04, 0x60, 0xfe, 0xd4, 0xba, 0x25,
+	0x5a, 0x9d, 0x31, 0xc9, 0x61, 0xeb, 0x74, 0xc6,
+	0x35, 0x6d, 0x68, 0xc0, 0x49, 0xb8, 0x92, 0x3b,
+	0x61, 0xfa, 0x6c, 0xe6, 0x69, 0x62, 0x2e, 0x60,
+	0xf2, 0x9f, 0xb6, 0x79, 0x03, 0xfe, 0x10, 0x08,
+	0xb8, 0xbc, 0x99, 0xa4, 0x1a, 0xe9, 0xe9, 0x56,
+	0x28, 0xbc, 0x64, 0xf2, 0xf1, 0xb2, 0x0c, 0x2d,
+	0x7e, 0x9f, 0x51, 0x77, 0xa3, 0xc2, 0x94, 0xd4,
+	0x46, 0x22, 0x99
+};
+
+/** RFC 6979 section A.2.5 "sample" signed using SHA-256 */
+ECDSA_SIGNATURE_TEST ( sample_sha256, rfc6979_public,
+	PLAINTEXT ( 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65 ),
+	&ecdsa_with_sha256_algorithm,
+	SIGNATURE ( 0x30, 0x46, 0x02, 0x21, 0x00, 0xef, 0xd4, 0x8b,
+		    0x2a, 0xac, 0xb6, 0xa8, 0xfd, 0x11, 0x40, 0xdd,
+		    0x9c, 0xd4, 0x5e, 0x81, 0xd6, 0x9d, 0x2c, 0x87,
+		    0x7b, 0x56, 0xaa, 0xf9, 0x91, 0xc3, 0x4d, 0x0e,
+		    0xa8, 0x4e, 0xaf, 0x37, 0x16, 0x02, 0x21, 0x00,
+		    0xf7, 0xcb, 0x1c, 0x94, 0x2d, 0x65, 0x7c, 0x41,
+		    0xd4, 0x36, 0xc7, 0xa1, 0xb6, 0xe2, 0x9f, 0x65,
+		    0xf3, 0xe9, 0x00, 0xdb, 0xb9, 0xaf, 0xf4, 0x06,
+		    0x4d, 0xc4, 0xab, 0x2f, 0x84, 0x3a, 0xcd, 0xa8 ) );
+
+/** RFC 6979 section A.2.5 "sample" signed using SHA-384 */
+ECDSA_SIGNATURE_TEST ( sample_sha384, rfc6979_public,
+	PLAINTEXT ( 0x73, 0x61, 0x6d, 0x70, 0x6c, 0x65 ),
+	&ecdsa_with_sha384_algorithm,
+	SIGNATURE ( 0x30, 0x44, 0x02, 0x20, 0x0e, 0xaf, 0xea, 0x03,
+		    0x9b, 0x20, 0xe9, 0xb4, 0x23, 0x09, 0xfb, 0x1d,
+		    0x89, 0xe2, 0x13, 0x05, 0x7c, 0xbf, 0x97, 0x3d,
+		    0xc0, 0xcf, 0xc8, 0xf1, 0x29, 0xed, 0xdd, 0xc8,
+		    0x00, 0xef, 0x77, 0x19, 0x02, 0x20, 0x48, 0x61,
+		    0xf0, 0x49, 0x1e, 0x69, 0x98, 0xb9, 0x45, 0x51,
+		    0x93, 0xe3, 0x4e, 0x7b, 0x0d, 0x28, 0x4d, 0xdd,
+		    0x71, 0x49, 0xa7, 0x4b, 0x95, 0xb9, 0x26, 0x1f,
+		    0x13, 0xab, 0xde, 0x94, 0x09, 0x54 ) );
+
+/** RFC 6979 section A.2.5 "test" signed using SHA-256 */
+ECDSA_SIGNATURE_TEST ( test_sha256, rfc6979_public,
+	PLAINTEXT ( 0x74, 0x65, 0x73, 0x74 ),
+	&ecdsa_with_sha256_algorithm,
+	SIGNATURE ( 0x30, 0x45, 0x02, 0x21, 0x00, 0xf1, 0xab, 0xb0,
+		    0x23, 0x51, 0x83, 0x51, 0xcd, 0x71, 0xd8, 0x81,
+		    0x56, 0x7b, 0x1e, 0xa6, 0x63, 0xed, 0x3e, 0xfc,
+		    0xf6, 0xc5, 0x13, 0x2b, 0x35, 0x4f, 0x28, 0xd3,
+		    0xb0, 0xb7, 0xd3, 0x83, 0x67, 0x02, 0x20, 0x01,
+		    0x9f, 0x41, 0x13, 0x74, 0x2a, 0x2b, 0x14, 0xbd,
+		    0x25, 0x92, 0x6b, 0x49, 0xc6, 0x49, 0x15, 0x5f,
+		    0x26, 0x7e, 0x60, 0xd3, 0x81, 0x4b, 0x4c, 0x0c,
+		    0xc8, 0x42, 0x50, 0xe4, 0x6f, 0x00, 0x83 ) );
+
+/**
+ * Perform ECDSA self-tests
+ *
+ */
+static void ecdsa_test_exec ( void ) {
+
+	ecdsa_signature_ok ( &sample_sha256, &test_sha256 );
+	ecdsa_signature_ok ( &sample_sha384, &test_sha256 );
+	ecdsa_signature_ok ( &test_sha256, &sample_sha256 );
+}
+
+/** ECDSA self-test */
+struct self_test ecdsa_test __self_test = {
+	.name = "ecdsa",
+	.exec = ecdsa_test_exec,
+};
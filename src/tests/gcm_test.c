@@ -363,6 +363,7 @@ CIPHER_TEST ( gcm_test_18, &aes_gcm_algorithm, GCM_KEY_256,
  */
 static void gcm_test_exec ( void ) {
 	struct cipher_algorithm *gcm = &aes_gcm_algorithm;
+	struct cipher_algorithm *accel = cipher_accelerated ( gcm );
 	unsigned int keylen;
 
 	/* Correctness tests */
@@ -391,6 +392,14 @@ static void gcm_test_exec ( void ) {
 		      keylen, cipher_cost_encrypt ( gcm, ( keylen / 8 ) ) );
 		DBG ( "AES-%d-GCM decryption required %ld cycles per byte\n",
 		      keylen, cipher_cost_decrypt ( gcm, ( keylen / 8 ) ) );
+		if ( accel == gcm )
+			continue;
+		DBG ( "AES-%d-GCM (%s) encryption required %ld cycles per "
+		      "byte\n", keylen, accel->name,
+		      cipher_cost_encrypt ( accel, ( keylen / 8 ) ) );
+		DBG ( "AES-%d-GCM (%s) decryption required %ld cycles per "
+		      "byte\n", keylen, accel->name,
+		      cipher_cost_decrypt ( accel, ( keylen / 8 ) ) );
 	}
 }
 
@@ -99,6 +99,38 @@ static inline void alloc_iob_fail_okx ( size_t len, size_t align, size_t offset,
 #define alloc_iob_fail_ok( len, align, offset ) \
 	alloc_iob_fail_okx ( len, align, offset, __FILE__, __LINE__ )
 
+/**
+ * Report I/O buffer cache reuse test result
+ *
+ * @v len		Length of first buffer
+ * @v reuse_len		Length of second buffer
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static inline void alloc_iob_reuse_okx ( size_t len, size_t reuse_len,
+					 const char *file, unsigned int line ) {
+	struct io_buffer *iobuf;
+	struct io_buffer *reused;
+
+	/* Allocate and free I/O buffer */
+	iobuf = alloc_iob ( len );
+	okx ( iobuf != NULL, file, line );
+	okx ( iob_tailroom ( iobuf ) >= len, file, line );
+	memset ( iob_put ( iobuf, len ), 0x55, len );
+	free_iob ( iobuf );
+
+	/* Allocate another I/O buffer of the same size class */
+	reused = alloc_iob ( reuse_len );
+	okx ( reused == iobuf, file, line );
+	okx ( iob_len ( reused ) == 0, file, line );
+	okx ( iob_headroom ( reused ) == 0, file, line );
+	okx ( iob_tailroom ( reused ) >= reuse_len, file, line );
+	memset ( iob_put ( reused, reuse_len ), 0xaa, reuse_len );
+	free_iob ( reused );
+}
+#define alloc_iob_reuse_ok( len, reuse_len ) \
+	alloc_iob_reuse_okx ( len, reuse_len, __FILE__, __LINE__ )
+
 /**
  * Perform I/O buffer self-tests
  *
@@ -122,6 +154,13 @@ static void iobuf_test_exec ( void ) {
 	alloc_iob_ok ( 2048, 2048, 0 );
 	alloc_iob_ok ( 2048, 2048, -10 );
 
+	/* Check reuse of cached buffers */
+	alloc_iob_reuse_ok ( 0, 100 );
+	alloc_iob_reuse_ok ( 130, 140 );
+	alloc_iob_reuse_ok ( 1500, 1600 );
+	alloc_iob_reuse_ok ( 2048, 2000 );
+	alloc_iob_reuse_ok ( 3000, 3500 );
+
 	/* Excessively large or excessively aligned allocations should fail */
 	alloc_iob_fail_ok ( -1UL, 0, 0 );
 	alloc_iob_fail_ok ( -1UL, 1024, 0 );
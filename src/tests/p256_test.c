@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * NIST P-256 elliptic curve self-tests
+ *
+ * The RFC 6979 test vectors are taken from the P-256 key pair and
+ * "sample" ephemeral key given in RFC 6979 section A.2.5.
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <ipxe/p256.h>
+#include <ipxe/test.h>
+#include "elliptic_test.h"
+
+/** Multiplication of generator by one */
+ELLIPTIC_MULTIPLY_TEST ( generator_one, &p256_curve,
+	BASE_GENERATOR,
+	SCALAR ( 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 ),
+	EXPECTED ( 0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47,
+		   0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+		   0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0,
+		   0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96,
+		   0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b,
+		   0x8e, 0xe7, 0xeb, 0x4a, 0x7c, 0x0f, 0x9e, 0x16,
+		   0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce,
+		   0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5 ) );
+
+/** Multiplication of generator by two */
+ELLIPTIC_MULTIPLY_TEST ( generator_two, &p256_curve,
+	BASE_GENERATOR,
+	SCALAR ( 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02 ),
+	EXPECTED ( 0x7c, 0xf2, 0x7b, 0x18, 0x8d, 0x03, 0x4f, 0x7e,
+		   0x8a, 0x52, 0x38, 0x03, 0x04, 0xb5, 0x1a, 0xc3,
+		   0xc0, 0x89, 0x69, 0xe2, 0x77, 0xf2, 0x1b, 0x35,
+		   0xa6, 0x0b, 0x48, 0xfc, 0x47, 0x66, 0x99, 0x78,
+		   0x07, 0x77, 0x55, 0x10, 0xdb, 0x8e, 0xd0, 0x40,
+		   0x29, 0x3d, 0x9a, 0xc6, 0x9f, 0x74, 0x30, 0xdb,
+		   0xba, 0x7d, 0xad, 0xe6, 0x3c, 0xe9, 0x82, 0x29,
+		   0x9e, 0x04, 0xb7, 0x9d, 0x22, 0x78, 0x73, 0xd1 ) );
+
+/** Multiplication of generator by (n-1) */
+ELLIPTIC_MULTIPLY_TEST ( generator_negate, &p256_curve,
+	BASE_GENERATOR,
+	SCALAR ( 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+		 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		 0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84,
+		 0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x50 ),
+	EXPECTED ( 0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47,
+		   0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+		   0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0,
+		   0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96,
+		   0xb0, 0x1c, 0xbd, 0x1c, 0x01, 0xe5, 0x80, 0x65,
+		   0x71, 0x18, 0x14, 0xb5, 0x83, 0xf0, 0x61, 0xe9,
+		   0xd4, 0x31, 0xcc, 0xa9, 0x94, 0xce, 0xa1, 0x31,
+		   0x34, 0x49, 0xbf, 0x97, 0xc8, 0x40, 0xae, 0x0a ) );
+
+/** Multiplication of generator by n (yielding point at infinity) */
+ELLIPTIC_MULTIPLY_TEST ( generator_order, &p256_curve,
+	BASE_GENERATOR,
+	SCALAR ( 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+		 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		 0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84,
+		 0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51 ),
+	EXPECTED_FAIL );
+
+/** RFC 6979 section A.2.5 public key */
+ELLIPTIC_MULTIPLY_TEST ( rfc6979_public, &p256_curve,
+	BASE_GENERATOR,
+	SCALAR ( 0xc9, 0xaf, 0xa9, 0xd8, 0x45, 0xba, 0x75, 0x16,
+		 0x6b, 0x5c, 0x21, 0x57, 0x67, 0xb1, 0xd6, 0x93,
+		 0x4e, 0x50, 0xc3, 0xdb, 0x36, 0xe8, 0x9b, 0x12,
+		 0x7b, 0x8a, 0x62, 0x2b, 0x12, 0x0f, 0x67, 0x21 ),
+	EXPECTED ( 0x60, 0xfe, 0xd4, 0xba, 0x25, 0x5a, 0x9d, 0x31,
+		   0xc9, 0x61, 0xeb, 0x74, 0xc6, 0x35, 0x6d, 0x68,
+		   0xc0, 0x49, 0xb8, 0x92, 0x3b, 0x61, 0xfa, 0x6c,
+		   0xe6, 0x69, 0x62, 0x2e, 0x60, 0xf2, 0x9f, 0xb6,
+		   0x79, 0x03, 0xfe, 0x10, 0x08, 0xb8, 0xbc, 0x99,
+		   0xa4, 0x1a, 0xe9, 0xe9, 0x56, 0x28, 0xbc, 0x64,
+		   0xf2, 0xf1, 0xb2, 0x0c, 0x2d, 0x7e, 0x9f, 0x51,
+		   0x77, 0xa3, 0xc2, 0x94, 0xd4, 0x46, 0x22, 0x99 ) );
+
+/** Multiplication of RFC 6979 section A.2.5 public key */
+ELLIPTIC_MULTIPLY_TEST ( rfc6979_multiple, &p256_curve,
+	BASE ( 0x60, 0xfe, 0xd4, 0xba, 0x25, 0x5a, 0x9d, 0x31,
+	       0xc9, 0x61, 0xeb, 0x74, 0xc6, 0x35, 0x6d, 0x68,
+	       0xc0, 0x49, 0xb8, 0x92, 0x3b, 0x61, 0xfa, 0x6c,
+	       0xe6, 0x69, 0x62, 0x2e, 0x60, 0xf2, 0x9f, 0xb6,
+	       0x79, 0x03, 0xfe, 0x10, 0x08, 0xb8, 0xbc, 0x99,
+	       0xa4, 0x1a, 0xe9, 0xe9, 0x56, 0x28, 0xbc, 0x64,
+	       0xf2, 0xf1, 0xb2, 0x0c, 0x2d, 0x7e, 0x9f, 0x51,
+	       0x77, 0xa3, 0xc2, 0x94, 0xd4, 0x46, 0x22, 0x99 ),
+	SCALAR ( 0xa6, 0xe3, 0xc5, 0x7d, 0xd0, 0x1a, 0xbe, 0x90,
+		 0x08, 0x65, 0x38, 0x39, 0x83, 0x55, 0xdd, 0x4c,
+		 0x3b, 0x17, 0xaa, 0x87, 0x33, 0x82, 0xb0, 0xf2,
+		 0x4d, 0x61, 0x29, 0x49, 0x3d, 0x8a, 0xad, 0x60 ),
+	EXPECTED ( 0x3f, 0xfb, 0xbd, 0x4f, 0xe4, 0x96, 0xa3, 0x0e,
+		   0xa4, 0x56, 0x82, 0x2f, 0x31, 0xc2, 0x1e, 0x76,
+		   0x48, 0x24, 0x62, 0xfc, 0xa1, 0x19, 0xbe, 0xce,
+		   0x40, 0x3a, 0xbf, 0x00, 0xbe, 0xd5, 0x0f, 0xbb,
+		   0xce, 0xbc, 0x80, 0x2d, 0x04, 0x53, 0xd7, 0xe0,
+		   0xa8, 0x95, 0x2d, 0x0c, 0x49, 0xd0, 0x62, 0xa2,
+		   0xbf, 0xae, 0x99, 0x1f, 0x6d, 0x5b, 0x5d, 0x4a,
+		   0x46, 0xec, 0xdf, 0x83, 0x33, 0xd4, 0x80, 0x69 ) );
+
+/** Multiplication of a point not on the curve */
+ELLIPTIC_MULTIPLY_TEST ( invalid_point, &p256_curve,
+	BASE ( 0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47,
+	       0xf8, 0xbc, 0xe6, 0xe5, 0x63, 0xa4, 0x40, 0xf2,
+	       0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0,
+	       0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96,
+	       0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b,
+	       0x8e, 0xe7, 0xeb, 0x4a, 0x7c, 0x0f, 0x9e, 0x16,
+	       0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce,
+	       0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf4 ),
+	SCALAR ( 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02 ),
+	EXPECTED_FAIL );
+
+/**
+ * Perform P-256 self-tests
+ *
+ */
+static void p256_test_exec ( void ) {
+
+	elliptic_multiply_ok ( &generator_one );
+	elliptic_multiply_ok ( &generator_two );
+	elliptic_multiply_ok ( &generator_negate );
+	elliptic_multiply_ok ( &generator_order );
+	elliptic_multiply_ok ( &rfc6979_public );
+	elliptic_multiply_ok ( &rfc6979_multiple );
+	elliptic_multiply_ok ( &invalid_point );
+}
+
+/** P-256 self-test */
+struct self_test p256_test __self_test = {
+	.name = "p256",
+	.exec = p256_test_exec,
+};
@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Red-black tree tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ipxe/rbtree.h>
+#include <ipxe/list.h>
+#include <ipxe/profile.h>
+#include <ipxe/test.h>
+
+/** Number of test elements */
+#define RBTREE_TEST_COUNT 512
+
+/** Number of sample iterations for profiling */
+#define PROFILE_COUNT 16
+
+/** A red-black tree test element */
+struct rbtree_test {
+	/** Tree node */
+	struct rb_node node;
+	/** List of elements (used for comparison profiling) */
+	struct list_head list;
+	/** Key */
+	unsigned long key;
+};
+
+/** Test elements */
+static struct rbtree_test rbtree_tests[RBTREE_TEST_COUNT];
+
+/** Test tree */
+static struct rb_root rbtree_test_root = RB_ROOT_INIT ( rbtree_test_root );
+
+/** Test list */
+static LIST_HEAD ( rbtree_test_list );
+
+/**
+ * Insert element into test tree
+ *
+ * @v root		Red-black tree
+ * @v element		Test element
+ */
+static void rbtree_test_insert ( struct rb_root *root,
+				 struct rbtree_test *element ) {
+	struct rb_node **link = &root->node;
+	struct rb_node *parent = NULL;
+	struct rbtree_test *tmp;
+
+	while ( *link ) {
+		parent = *link;
+		tmp = rb_entry ( parent, struct rbtree_test, node );
+		link = ( ( element->key < tmp->key ) ?
+			 &parent->left : &parent->right );
+	}
+	rb_insert ( root, &element->node, parent, link );
+}
+
+/**
+ * Find element in test tree
+ *
+ * @v root		Red-black tree
+ * @v key		Key
+ * @ret element		Test element, or NULL
+ */
+static struct rbtree_test * rbtree_test_find ( struct rb_root *root,
+					       unsigned long key ) {
+	struct rb_node *node = root->node;
+	struct rbtree_test *element;
+
+	while ( node ) {
+		element = rb_entry ( node, struct rbtree_test, node );
+		if ( key < element->key ) {
+			node = node->left;
+		} else if ( key > element->key ) {
+			node = node->right;
+		} else {
+			return element;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Insert element into sorted test list
+ *
+ * @v list		List
+ * @v element		Test element
+ */
+static void rbtree_test_list_insert ( struct list_head *list,
+				      struct rbtree_test *element ) {
+	struct rbtree_test *tmp;
+
+	list_for_each_entry ( tmp, list, list ) {
+		if ( element->key < tmp->key )
+			break;
+	}
+	list_add_tail ( &element->list, &tmp->list );
+}
+
+/**
+ * Check red-black tree invariants for a subtree
+ *
+ * @v node		Subtree root, or NULL
+ * @v parent		Expected parent node
+ * @v count		Node count to update
+ * @ret height		Black height of subtree, or negative on error
+ */
+static int rbtree_test_check_subtree ( struct rb_node *node,
+				       struct rb_node *parent,
+				       unsigned int *count ) {
+	int left;
+	int right;
+
+	/* NULL leaves are black */
+	if ( ! node )
+		return 1;
+	( *count )++;
+
+	/* Check parent linkage */
+	if ( node->parent != parent )
+		return -1;
+
+	/* Red nodes may not have red children */
+	if ( node->red &&
+	     ( ( node->left && node->left->red ) ||
+	       ( node->right && node->right->red ) ) ) {
+		return -1;
+	}
+
+	/* Both subtrees must have equal black heights */
+	left = rbtree_test_check_subtree ( node->left, node, count );
+	right = rbtree_test_check_subtree ( node->right, node, count );
+	if ( ( left < 0 ) || ( right < 0 ) || ( left != right ) )
+		return -1;
+
+	return ( left + ( node->red ? 0 : 1 ) );
+}
+
+/**
+ * Check red-black tree invariants and ordering
+ *
+ * @v root		Red-black tree
+ * @v expected		Expected number of nodes
+ * @ret ok		Tree is valid
+ */
+static int rbtree_test_check ( struct rb_root *root, unsigned int expected ) {
+	struct rbtree_test *element;
+	struct rbtree_test *prev = NULL;
+	struct rb_node *node;
+	unsigned int count = 0;
+	unsigned int walked = 0;
+
+	/* Root node must be black */
+	if ( root->node && root->node->red )
+		return 0;
+
+	/* Check invariants */
+	if ( rbtree_test_check_subtree ( root->node, NULL, &count ) < 0 )
+		return 0;
+	if ( count != expected )
+		return 0;
+
+	/* Check forward ordering */
+	for ( node = rb_first ( root ) ; node ; node = rb_next ( node ) ) {
+		element = rb_entry ( node, struct rbtree_test, node );
+		if ( prev && ( element->key < prev->key ) )
+			return 0;
+		prev = element;
+		walked++;
+	}
+	if ( walked != expected )
+		return 0;
+
+	/* Check reverse ordering */
+	prev = NULL;
+	for ( node = rb_last ( root ) ; node ; node = rb_prev ( node ) ) {
+		element = rb_entry ( node, struct rbtree_test, node );
+		if ( prev && ( element->key > prev->key ) )
+			return 0;
+		prev = element;
+		walked--;
+	}
+	if ( walked != 0 )
+		return 0;
+
+	return 1;
+}
+#define rbtree_check_ok( root, expected ) \
+	ok ( rbtree_test_check ( root, expected ) )
+
+/**
+ * Populate test elements with pseudorandom keys
+ *
+ * @v seed		Random seed
+ */
+static void rbtree_test_keys ( unsigned int seed ) {
+	unsigned int i;
+
+	srandom ( seed );
+	for ( i = 0 ; i < RBTREE_TEST_COUNT ; i++ )
+		rbtree_tests[i].key = random();
+}
+
+/**
+ * Perform red-black tree insertion and removal tests
+ *
+ */
+static void rbtree_test_basic ( void ) {
+	struct rb_root *root = &rbtree_test_root;
+	struct rbtree_test *element;
+	unsigned int count;
+	unsigned int i;
+
+	/* Check empty tree */
+	rb_init ( root );
+	ok ( rb_empty ( root ) );
+	ok ( rb_first ( root ) == NULL );
+	ok ( rb_last ( root ) == NULL );
+	rbtree_check_ok ( root, 0 );
+
+	/* Insert ascending keys (worst case for an unbalanced tree) */
+	for ( i = 0 ; i < RBTREE_TEST_COUNT ; i++ ) {
+		rbtree_tests[i].key = i;
+		rbtree_test_insert ( root, &rbtree_tests[i] );
+	}
+	ok ( ! rb_empty ( root ) );
+	rbtree_check_ok ( root, RBTREE_TEST_COUNT );
+	ok ( rb_first ( root ) == &rbtree_tests[0].node );
+	ok ( rb_last ( root ) ==
+	     &rbtree_tests[ RBTREE_TEST_COUNT - 1 ].node );
+
+	/* Remove alternate elements */
+	for ( i = 0 ; i < RBTREE_TEST_COUNT ; i += 2 )
+		rb_erase ( root, &rbtree_tests[i].node );
+	rbtree_check_ok ( root, ( RBTREE_TEST_COUNT / 2 ) );
+	ok ( rbtree_test_find ( root, 0 ) == NULL );
+	ok ( rbtree_test_find ( root, 1 ) == &rbtree_tests[1] );
+
+	/* Remove remaining elements from the root downwards */
+	count = ( RBTREE_TEST_COUNT / 2 );
+	while ( root->node ) {
+		rb_erase ( root, root->node );
+		count--;
+	}
+	ok ( count == 0 );
+	rbtree_check_ok ( root, 0 );
+
+	/* Insert pseudorandom keys */
+	rbtree_test_keys ( 0x1234 );
+	for ( i = 0 ; i < RBTREE_TEST_COUNT ; i++ )
+		rbtree_test_insert ( root, &rbtree_tests[i] );
+	rbtree_check_ok ( root, RBTREE_TEST_COUNT );
+
+	/* Check that all keys can be found */
+	for ( i = 0 ; i < RBTREE_TEST_COUNT ; i++ ) {
+		element = rbtree_test_find ( root, rbtree_tests[i].key );
+		ok ( element && ( element->key == rbtree_tests[i].key ) );
+	}
+
+	/* Remove elements in pseudorandom order, checking invariants */
+	count = RBTREE_TEST_COUNT;
+	for ( i = 0 ; i < RBTREE_TEST_COUNT ; i += 3 ) {
+		rb_erase ( root, &rbtree_tests[i].node );
+		count--;
+	}
+	rbtree_check_ok ( root, count );
+	for ( i = 1 ; i < RBTREE_TEST_COUNT ; i += 3 ) {
+		rb_erase ( root, &rbtree_tests[i].node );
+		count--;
+	}
+	rbtree_check_ok ( root, count );
+	for ( i = 2 ; i < RBTREE_TEST_COUNT ; i += 3 ) {
+		rb_erase ( root, &rbtree_tests[i].node );
+		count--;
+	}
+	ok ( count == 0 );
+	ok ( rb_empty ( root ) );
+}
+
+/**
+ * Profile red-black tree insertion against sorted list insertion
+ *
+ */
+static void rbtree_test_profile ( void ) {
+	struct rb_root *root = &rbtree_test_root;
+	struct list_head *list = &rbtree_test_list;
+	struct profiler tree_profiler;
+	struct profiler list_profiler;
+	unsigned int i;
+	unsigned int j;
+
+	/* Profile insertion of pseudorandom keys */
+	memset ( &tree_profiler, 0, sizeof ( tree_profiler ) );
+	memset ( &list_profiler, 0, sizeof ( list_profiler ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		rbtree_test_keys ( i );
+
+		/* Profile red-black tree */
+		rb_init ( root );
+		profile_start ( &tree_profiler );
+		for ( j = 0 ; j < RBTREE_TEST_COUNT ; j++ )
+			rbtree_test_insert ( root, &rbtree_tests[j] );
+		profile_stop ( &tree_profiler );
+		rbtree_check_ok ( root, RBTREE_TEST_COUNT );
+
+		/* Profile sorted list */
+		INIT_LIST_HEAD ( list );
+		profile_start ( &list_profiler );
+		for ( j = 0 ; j < RBTREE_TEST_COUNT ; j++ )
+			rbtree_test_list_insert ( list, &rbtree_tests[j] );
+		profile_stop ( &list_profiler );
+	}
+	DBG ( "RBTREE inserted %d keys in %ld +/- %ld ticks (list %ld +/- "
+	      "%ld ticks)\n", RBTREE_TEST_COUNT, profile_mean ( &tree_profiler ),
+	      profile_stddev ( &tree_profiler ),
+	      profile_mean ( &list_profiler ),
+	      profile_stddev ( &list_profiler ) );
+}
+
+/**
+ * Perform red-black tree self-tests
+ *
+ */
+static void rbtree_test_exec ( void ) {
+
+	rbtree_test_basic();
+	rbtree_test_profile();
+}
+
+/** Red-black tree self-test */
+struct self_test rbtree_test __self_test = {
+	.name = "rbtree",
+	.exec = rbtree_test_exec,
+};
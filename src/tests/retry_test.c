@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Retry timer tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <string.h>
+#include <ipxe/timer.h>
+#include <ipxe/retry.h>
+#include <ipxe/profile.h>
+#include <ipxe/test.h>
+
+/** Number of idle timers used for scalability tests */
+#define RETRY_TEST_IDLE_MAX 1024
+
+/** Number of iterations used for each scalability test */
+#define RETRY_TEST_ITERATIONS 256
+
+/** A retry timer test */
+struct retry_test_timer {
+	/** Retry timer */
+	struct retry_timer timer;
+	/** Number of expiries */
+	unsigned int expired;
+	/** Time of most recent expiry */
+	unsigned long when;
+	/** Timer to stop upon expiry, if any */
+	struct retry_test_timer *stop;
+	/** Number of times to restart upon expiry */
+	unsigned int restart;
+};
+
+/** Idle timers used for scalability tests */
+static struct retry_test_timer retry_test_idle[RETRY_TEST_IDLE_MAX];
+
+/**
+ * Handle test timer expiry
+ *
+ * @v timer		Retry timer
+ * @v over		Failure indicator
+ */
+static void retry_test_expired ( struct retry_timer *timer,
+				 int over __unused ) {
+	struct retry_test_timer *test =
+		container_of ( timer, struct retry_test_timer, timer );
+
+	/* Record expiry */
+	test->expired++;
+	test->when = currticks();
+
+	/* Stop another timer, if applicable */
+	if ( test->stop )
+		stop_timer ( &test->stop->timer );
+
+	/* Restart this timer, if applicable */
+	if ( test->restart ) {
+		test->restart--;
+		start_timer_nodelay ( &test->timer );
+	}
+}
+
+/**
+ * Initialise test timer
+ *
+ * @v test		Retry timer test
+ */
+static void retry_test_init ( struct retry_test_timer *test ) {
+
+	memset ( test, 0, sizeof ( *test ) );
+	timer_init ( &test->timer, retry_test_expired, NULL );
+}
+
+/**
+ * Poll retry timers until a test timer expires
+ *
+ * @v test		Retry timer test
+ * @v limit		Maximum time to wait
+ */
+static void retry_test_wait ( struct retry_test_timer *test,
+			      unsigned long limit ) {
+	unsigned long start = currticks();
+
+	while ( ( ! test->expired ) && ( ( currticks() - start ) < limit ) )
+		retry_poll();
+}
+
+/**
+ * Report scalability test result
+ *
+ * @v count		Number of idle timers
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void retry_scale_okx ( unsigned int count, const char *file,
+			      unsigned int line ) {
+	struct profiler poll_profiler;
+	struct profiler start_profiler;
+	struct retry_test_timer test;
+	unsigned int i;
+
+	/* Start idle timers */
+	memset ( &poll_profiler, 0, sizeof ( poll_profiler ) );
+	memset ( &start_profiler, 0, sizeof ( start_profiler ) );
+	for ( i = 0 ; i < count ; i++ ) {
+		retry_test_init ( &retry_test_idle[i] );
+		start_timer_fixed ( &retry_test_idle[i].timer,
+				    ( ( i + 1 ) * TICKS_PER_SEC ) );
+	}
+
+	/* Time polling and starting/stopping a timer */
+	retry_test_init ( &test );
+	for ( i = 0 ; i < RETRY_TEST_ITERATIONS ; i++ ) {
+		profile_start ( &poll_profiler );
+		retry_poll();
+		profile_stop ( &poll_profiler );
+		profile_start ( &start_profiler );
+		start_timer_fixed ( &test.timer, TICKS_PER_SEC );
+		stop_timer ( &test.timer );
+		profile_stop ( &start_profiler );
+	}
+	okx ( test.expired == 0, file, line );
+
+	/* Stop idle timers */
+	for ( i = 0 ; i < count ; i++ ) {
+		okx ( timer_running ( &retry_test_idle[i].timer ), file, line );
+		okx ( retry_test_idle[i].expired == 0, file, line );
+		stop_timer ( &retry_test_idle[i].timer );
+	}
+
+	DBG ( "RETRY with %d idle timers polled in %ld +/- %ld ticks, "
+	      "started/stopped in %ld +/- %ld ticks\n", count,
+	      profile_mean ( &poll_profiler ),
+	      profile_stddev ( &poll_profiler ),
+	      profile_mean ( &start_profiler ),
+	      profile_stddev ( &start_profiler ) );
+}
+#define retry_scale_ok( count ) \
+	retry_scale_okx ( count, __FILE__, __LINE__ )
+
+/**
+ * Perform retry timer self-tests
+ *
+ */
+static void retry_test_exec ( void ) {
+	struct retry_test_timer a;
+	struct retry_test_timer b;
+	struct retry_test_timer c;
+	unsigned long start;
+
+	/* Multiple due timers all expire within a single poll */
+	retry_test_init ( &a );
+	retry_test_init ( &b );
+	retry_test_init ( &c );
+	start_timer_nodelay ( &a.timer );
+	start_timer_nodelay ( &b.timer );
+	start_timer_nodelay ( &c.timer );
+	retry_poll();
+	ok ( a.expired == 1 );
+	ok ( b.expired == 1 );
+	ok ( c.expired == 1 );
+	ok ( ! timer_running ( &a.timer ) );
+	ok ( ! timer_running ( &b.timer ) );
+	ok ( ! timer_running ( &c.timer ) );
+
+	/* Timer stopped by another timer's expiry does not expire */
+	retry_test_init ( &a );
+	retry_test_init ( &b );
+	a.stop = &b;
+	start_timer_nodelay ( &a.timer );
+	start_timer_nodelay ( &b.timer );
+	retry_poll();
+	ok ( a.expired == 1 );
+	ok ( b.expired == 0 );
+	ok ( ! timer_running ( &b.timer ) );
+
+	/* Timer restarted during expiry does not expire again within
+	 * the same poll
+	 */
+	retry_test_init ( &a );
+	a.restart = 1;
+	start_timer_nodelay ( &a.timer );
+	retry_poll();
+	ok ( a.expired == 1 );
+	ok ( timer_running ( &a.timer ) );
+	retry_poll();
+	ok ( a.expired == 2 );
+	ok ( ! timer_running ( &a.timer ) );
+
+	/* Restarting a running timer replaces its timeout */
+	retry_test_init ( &a );
+	start_timer_fixed ( &a.timer, ( 60 * TICKS_PER_SEC ) );
+	start_timer_nodelay ( &a.timer );
+	retry_poll();
+	ok ( a.expired == 1 );
+
+	/* Timers beyond the range of the timer wheel do not expire */
+	retry_test_init ( &a );
+	retry_test_init ( &b );
+	start_timer_fixed ( &a.timer, ( 3600 * TICKS_PER_SEC ) );
+	start_timer_fixed ( &b.timer, ( 86400UL * TICKS_PER_SEC ) );
+	retry_poll();
+	ok ( a.expired == 0 );
+	ok ( b.expired == 0 );
+	ok ( timer_running ( &a.timer ) );
+	ok ( timer_running ( &b.timer ) );
+	stop_timer ( &a.timer );
+	stop_timer ( &b.timer );
+	ok ( ! timer_running ( &a.timer ) );
+	ok ( ! timer_running ( &b.timer ) );
+
+	/* Timers expire at the correct time, including timers that
+	 * must be cascaded from a higher timer wheel level
+	 */
+	retry_test_init ( &a );
+	retry_test_init ( &b );
+	start = currticks();
+	start_timer_fixed ( &a.timer, 10 );
+	start_timer_fixed ( &b.timer, 100 );
+	retry_test_wait ( &b, TICKS_PER_SEC );
+	ok ( a.expired == 1 );
+	ok ( b.expired == 1 );
+	ok ( ( a.when - start ) >= 10 );
+	ok ( ( b.when - start ) >= 100 );
+	ok ( ( b.when - start ) < TICKS_PER_SEC );
+
+	/* Scalability tests */
+	retry_scale_ok ( 1 );
+	retry_scale_ok ( 64 );
+	retry_scale_ok ( RETRY_TEST_IDLE_MAX );
+}
+
+/** Retry timer self-test */
+struct self_test retry_test __self_test = {
+	.name = "retry",
+	.exec = retry_test_exec,
+};
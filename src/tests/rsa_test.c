@@ -40,6 +40,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/md5.h>
 #include <ipxe/sha1.h>
 #include <ipxe/sha256.h>
+#include <ipxe/sha512.h>
 #include <ipxe/test.h>
 #include "pubkey_test.h"
 
@@ -161,6 +162,57 @@ struct rsa_signature_test {
 		.signature_len = sizeof ( name ## _signature ),		\
 	}
 
+/** An RSA-PSS signature self-test */
+struct rsa_pss_test {
+	/** Private key */
+	const void *private;
+	/** Private key length */
+	size_t private_len;
+	/** Public key */
+	const void *public;
+	/** Public key length */
+	size_t public_len;
+	/** Plaintext */
+	const void *plaintext;
+	/** Plaintext length */
+	size_t plaintext_len;
+	/** Digest algorithm */
+	struct digest_algorithm *digest;
+	/** Signature */
+	const void *signature;
+	/** Signature length */
+	size_t signature_len;
+};
+
+/**
+ * Define an RSA-PSS signature test
+ *
+ * @v name		Test name
+ * @v PRIVATE		Private key
+ * @v PUBLIC		Public key
+ * @v PLAINTEXT		Plaintext
+ * @v DIGEST		Digest algorithm
+ * @v SIGNATURE		Signature
+ * @ret test		Signature test
+ */
+#define RSA_PSS_TEST( name, PRIVATE, PUBLIC, PLAINTEXT, DIGEST,		\
+		      SIGNATURE )					\
+	static const uint8_t name ## _private[] = PRIVATE;		\
+	static const uint8_t name ## _public[] = PUBLIC;		\
+	static const uint8_t name ## _plaintext[] = PLAINTEXT;		\
+	static const uint8_t name ## _signature[] = SIGNATURE;		\
+	static struct rsa_pss_test name = {				\
+		.private = name ## _private,				\
+		.private_len = sizeof ( name ## _private ),		\
+		.public = name ## _public,				\
+		.public_len = sizeof ( name ## _public ),		\
+		.plaintext = name ## _plaintext,			\
+		.plaintext_len = sizeof ( name ## _plaintext ),		\
+		.digest = DIGEST,					\
+		.signature = name ## _signature,			\
+		.signature_len = sizeof ( name ## _signature ),		\
+	}
+
 /**
  * Report RSA encryption and decryption test result
  *
@@ -206,6 +258,53 @@ struct rsa_signature_test {
 				sizeof ( bad_signature ) );		\
 	} while ( 0 )
 
+/**
+ * Report RSA-PSS signature test result
+ *
+ * @v test		RSA-PSS signature test
+ *
+ * RSA-PSS signatures are randomised, so the signature generated by
+ * the private key is checked by verifying it using the public key.
+ */
+#define rsa_pss_ok( test ) do {						\
+	struct digest_algorithm *digest = (test)->digest;		\
+	uint8_t digestctx[ digest->ctxsize ];				\
+	uint8_t digestout[ digest->digestsize ];			\
+	uint8_t ctx[ rsa_pss_algorithm.ctxsize ];			\
+	uint8_t signature[ (test)->signature_len ];			\
+	int signature_len;						\
+	pubkey_verify_ok ( &rsa_pss_algorithm, (test)->public,		\
+			   (test)->public_len, digest,			\
+			   (test)->plaintext, (test)->plaintext_len,	\
+			   (test)->signature, (test)->signature_len );	\
+	digest_init ( digest, digestctx );				\
+	digest_update ( digest, digestctx, (test)->plaintext,		\
+			(test)->plaintext_len );			\
+	digest_final ( digest, digestctx, digestout );			\
+	ok ( pubkey_init ( &rsa_pss_algorithm, ctx, (test)->private,	\
+			   (test)->private_len ) == 0 );		\
+	signature_len = pubkey_sign ( &rsa_pss_algorithm, ctx, digest,	\
+				      digestout, signature );		\
+	ok ( signature_len == ( ( int ) sizeof ( signature ) ) );	\
+	pubkey_final ( &rsa_pss_algorithm, ctx );			\
+	pubkey_verify_ok ( &rsa_pss_algorithm, (test)->public,		\
+			   (test)->public_len, digest,			\
+			   (test)->plaintext, (test)->plaintext_len,	\
+			   signature, sizeof ( signature ) );		\
+	signature[ sizeof ( signature ) / 2 ] ^= 0x01;			\
+	pubkey_verify_fail_ok ( &rsa_pss_algorithm, (test)->public,	\
+				(test)->public_len, digest,		\
+				(test)->plaintext,			\
+				(test)->plaintext_len, signature,	\
+				sizeof ( signature ) );			\
+	pubkey_verify_fail_ok ( &rsa_algorithm, (test)->public,		\
+				(test)->public_len, digest,		\
+				(test)->plaintext,			\
+				(test)->plaintext_len,			\
+				(test)->signature,			\
+				(test)->signature_len );		\
+	} while ( 0 )
+
 /** "Hello world" encryption and decryption test */
 RSA_ENCRYPT_DECRYPT_TEST ( hw_test,
 	PRIVATE ( 0x30, 0x82, 0x01, 0x3b, 0x02, 0x01, 0x00, 0x02, 0x41, 0x00,
@@ -479,6 +578,199 @@ RSA_SIGNATURE_TEST ( sha256_test,
 		    0x7d, 0x38, 0x37, 0xc4, 0xea, 0xdd, 0x3a, 0x6f, 0xa8, 0x65,
 		    0x60, 0x73, 0x77, 0x3c ) );
 
+/* RSA-PSS SHA-256 signature test */
+RSA_PSS_TEST ( pss_sha256_test,
+	PRIVATE ( 0x30, 0x82, 0x02, 0x5c, 0x02, 0x01, 0x00, 0x02, 0x81, 0x81,
+		  0x00, 0xb0, 0x45, 0xee, 0x02, 0xfb, 0xfe, 0xbd, 0x6e, 0xac,
+		  0xac, 0x1e, 0x69, 0xa9, 0x59, 0x50, 0xd3, 0xc3, 0xb8, 0xf4,
+		  0xc8, 0x50, 0x13, 0xfc, 0xfa, 0x01, 0xc2, 0xed, 0xe2, 0x5d,
+		  0x2e, 0x78, 0x8b, 0x14, 0xdb, 0x03, 0x1c, 0xeb, 0x3d, 0x66,
+		  0x2a, 0x41, 0x4e, 0x51, 0xb7, 0x3b, 0xfe, 0xc7, 0x2c, 0x97,
+		  0x83, 0x76, 0x3a, 0x24, 0x0e, 0x20, 0x0e, 0x56, 0xef, 0x74,
+		  0xad, 0x91, 0x1d, 0xbb, 0x03, 0x3d, 0xd3, 0x87, 0xe8, 0x5b,
+		  0x29, 0x78, 0x53, 0xec, 0xa7, 0x35, 0xe0, 0xcc, 0x81, 0x63,
+		  0xd7, 0x41, 0x24, 0x97, 0xe2, 0x23, 0x69, 0x69, 0x31, 0x29,
+		  0x01, 0x30, 0x3e, 0xde, 0xd9, 0x23, 0x4f, 0xfa, 0xc2, 0x18,
+		  0x23, 0x3f, 0x68, 0xff, 0x71, 0x87, 0x0d, 0x48, 0x96, 0x12,
+		  0xd3, 0xdf, 0x84, 0x29, 0x15, 0xf0, 0x94, 0xdf, 0xb2, 0xa3,
+		  0x74, 0xb1, 0x18, 0xc2, 0xc3, 0xe6, 0x23, 0x09, 0xe1, 0x02,
+		  0x03, 0x01, 0x00, 0x01, 0x02, 0x81, 0x80, 0x45, 0x1f, 0x36,
+		  0xe4, 0xfe, 0xb1, 0xf6, 0xd0, 0x86, 0x6f, 0x7c, 0x01, 0x8d,
+		  0x01, 0xd4, 0x1b, 0x26, 0x3d, 0xc9, 0xe7, 0x1e, 0xd7, 0xa7,
+		  0xb4, 0xd5, 0xa9, 0xfd, 0xa4, 0x6d, 0x4b, 0xc2, 0xc3, 0x2f,
+		  0x2b, 0x6e, 0xbe, 0x11, 0x54, 0xe3, 0x52, 0x20, 0x87, 0xb8,
+		  0xad, 0x74, 0x9e, 0x44, 0xb6, 0x2c, 0xb7, 0xc5, 0x4d, 0xa9,
+		  0x43, 0xcc, 0xb8, 0x32, 0xc8, 0xf5, 0x64, 0xf6, 0x69, 0xc5,
+		  0x22, 0x2a, 0x95, 0xc6, 0x5b, 0xea, 0xda, 0x8e, 0x80, 0x0f,
+		  0x8b, 0x69, 0x10, 0x31, 0xde, 0x2e, 0xd7, 0xad, 0xa9, 0x24,
+		  0x4a, 0x82, 0xe8, 0x33, 0x3a, 0x1f, 0x30, 0x1f, 0xf3, 0x4c,
+		  0x25, 0xe3, 0x3d, 0x12, 0x83, 0xbd, 0xcf, 0x6f, 0x44, 0x6f,
+		  0xbb, 0x43, 0xd3, 0xdf, 0xd5, 0xf7, 0x5b, 0xb8, 0xba, 0x58,
+		  0x5f, 0x4e, 0x0e, 0x59, 0x67, 0xd6, 0xd6, 0x2f, 0xd5, 0x02,
+		  0x1d, 0xf8, 0x35, 0x43, 0x01, 0x02, 0x41, 0x00, 0xdb, 0x4a,
+		  0xeb, 0xbf, 0xc5, 0x51, 0x0c, 0x4b, 0xd8, 0x93, 0xa0, 0x4b,
+		  0xe0, 0xed, 0x96, 0x07, 0x8d, 0x83, 0xb9, 0x03, 0x91, 0xfd,
+		  0xa9, 0x6f, 0x9b, 0xb8, 0xda, 0x22, 0xae, 0xe4, 0x5e, 0x08,
+		  0xa4, 0x68, 0x12, 0x0c, 0x41, 0x9d, 0x44, 0xc1, 0x3a, 0x8d,
+		  0x89, 0x4d, 0xdd, 0xc5, 0xe5, 0x17, 0x59, 0xff, 0xc6, 0xb6,
+		  0xa2, 0xc6, 0x9c, 0x36, 0xcf, 0xb7, 0x66, 0x4e, 0x17, 0x6a,
+		  0x7a, 0x31, 0x02, 0x41, 0x00, 0xcd, 0xc7, 0x8c, 0x12, 0xe5,
+		  0xa6, 0xeb, 0x7e, 0x12, 0x59, 0x35, 0x7f, 0x4b, 0x67, 0x2b,
+		  0x61, 0x80, 0xb7, 0x92, 0xc1, 0xd8, 0xde, 0x13, 0x59, 0x7d,
+		  0x7b, 0x30, 0x36, 0x62, 0x91, 0x8c, 0xea, 0xc1, 0xff, 0x4a,
+		  0x9a, 0x64, 0x78, 0x54, 0xef, 0x66, 0x32, 0xbf, 0x92, 0x91,
+		  0x57, 0x41, 0x05, 0x77, 0xb2, 0xb1, 0xa5, 0x80, 0xb5, 0x3c,
+		  0xdd, 0x35, 0x22, 0x6c, 0xd1, 0x30, 0xdb, 0xee, 0xb1, 0x02,
+		  0x40, 0x53, 0x49, 0x9a, 0x4e, 0x64, 0xa7, 0xca, 0xae, 0xc7,
+		  0xdc, 0x11, 0xe6, 0x9f, 0xd0, 0x3c, 0xca, 0x33, 0x92, 0x52,
+		  0xe3, 0xab, 0x40, 0x17, 0x69, 0x3f, 0x50, 0xae, 0xf0, 0xbb,
+		  0x52, 0x1a, 0xf0, 0xd7, 0x58, 0x7b, 0x7a, 0x52, 0x35, 0x64,
+		  0x16, 0xab, 0xa1, 0x74, 0x03, 0xb1, 0xf6, 0x66, 0x73, 0x3f,
+		  0x08, 0x69, 0x35, 0x96, 0x8f, 0x2e, 0x67, 0x96, 0xee, 0xc6,
+		  0x19, 0x64, 0xc5, 0x59, 0x11, 0x02, 0x40, 0x16, 0xe1, 0x64,
+		  0x32, 0xc9, 0xb4, 0x38, 0xa5, 0x08, 0xf7, 0x40, 0x5a, 0x8a,
+		  0x10, 0xcb, 0xa3, 0x08, 0xc3, 0xe0, 0x9e, 0x8b, 0x35, 0x8e,
+		  0x23, 0x3a, 0x2f, 0x93, 0x59, 0xc8, 0xb5, 0xf4, 0x5c, 0x39,
+		  0xfb, 0xdf, 0xd8, 0xb0, 0xe9, 0x2c, 0x50, 0x7e, 0x25, 0x90,
+		  0x65, 0x84, 0xa1, 0x96, 0x0a, 0x3c, 0x97, 0xf2, 0xe6, 0xbb,
+		  0x1b, 0xeb, 0xcb, 0x90, 0xd7, 0xe6, 0x0f, 0x90, 0x86, 0x33,
+		  0xd1, 0x02, 0x41, 0x00, 0xb2, 0x60, 0x13, 0xfa, 0x33, 0xfe,
+		  0xcf, 0xf2, 0xed, 0x50, 0x2f, 0xb4, 0xb6, 0xe9, 0xe8, 0xdd,
+		  0xb9, 0xaf, 0xdb, 0x76, 0xec, 0x8d, 0x67, 0x39, 0xa0, 0x95,
+		  0x6c, 0x0b, 0x78, 0x5e, 0xb0, 0xe7, 0x1f, 0x1f, 0x4d, 0xc4,
+		  0x71, 0x9e, 0x3f, 0x39, 0xfa, 0x03, 0x1d, 0x5d, 0x57, 0x8a,
+		  0x4a, 0x7d, 0x76, 0xd2, 0xf4, 0xa4, 0xfd, 0xb7, 0x0d, 0x13,
+		  0x21, 0x53, 0x91, 0xf0, 0xb0, 0xd9, 0x6a, 0xa2 ),
+	PUBLIC ( 0x30, 0x81, 0x9f, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48,
+		 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x81,
+		 0x8d, 0x00, 0x30, 0x81, 0x89, 0x02, 0x81, 0x81, 0x00, 0xb0,
+		 0x45, 0xee, 0x02, 0xfb, 0xfe, 0xbd, 0x6e, 0xac, 0xac, 0x1e,
+		 0x69, 0xa9, 0x59, 0x50, 0xd3, 0xc3, 0xb8, 0xf4, 0xc8, 0x50,
+		 0x13, 0xfc, 0xfa, 0x01, 0xc2, 0xed, 0xe2, 0x5d, 0x2e, 0x78,
+		 0x8b, 0x14, 0xdb, 0x03, 0x1c, 0xeb, 0x3d, 0x66, 0x2a, 0x41,
+		 0x4e, 0x51, 0xb7, 0x3b, 0xfe, 0xc7, 0x2c, 0x97, 0x83, 0x76,
+		 0x3a, 0x24, 0x0e, 0x20, 0x0e, 0x56, 0xef, 0x74, 0xad, 0x91,
+		 0x1d, 0xbb, 0x03, 0x3d, 0xd3, 0x87, 0xe8, 0x5b, 0x29, 0x78,
+		 0x53, 0xec, 0xa7, 0x35, 0xe0, 0xcc, 0x81, 0x63, 0xd7, 0x41,
+		 0x24, 0x97, 0xe2, 0x23, 0x69, 0x69, 0x31, 0x29, 0x01, 0x30,
+		 0x3e, 0xde, 0xd9, 0x23, 0x4f, 0xfa, 0xc2, 0x18, 0x23, 0x3f,
+		 0x68, 0xff, 0x71, 0x87, 0x0d, 0x48, 0x96, 0x12, 0xd3, 0xdf,
+		 0x84, 0x29, 0x15, 0xf0, 0x94, 0xdf, 0xb2, 0xa3, 0x74, 0xb1,
+		 0x18, 0xc2, 0xc3, 0xe6, 0x23, 0x09, 0xe1, 0x02, 0x03, 0x01,
+		 0x00, 0x01 ),
+	PLAINTEXT ( 'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd' ),
+	&sha256_algorithm,
+	SIGNATURE ( 0x68, 0xf3, 0x42, 0xac, 0xb9, 0x1c, 0x1d, 0x26, 0x16, 0x82,
+		    0x38, 0x94, 0x11, 0xb1, 0x62, 0x7f, 0x62, 0xe9, 0x69, 0x65,
+		    0x62, 0xaf, 0x3f, 0xee, 0x49, 0xc0, 0x9e, 0x98, 0x79, 0xd7,
+		    0x9d, 0xb0, 0x48, 0x52, 0xbb, 0x8f, 0x98, 0x8e, 0x00, 0x71,
+		    0x2f, 0xfd, 0x0b, 0x5f, 0xe7, 0x45, 0x6d, 0x5a, 0x46, 0x59,
+		    0x34, 0xbd, 0xa0, 0xd9, 0x12, 0x22, 0x60, 0x15, 0x96, 0x4d,
+		    0x3d, 0x9f, 0x54, 0x18, 0xa4, 0x18, 0x04, 0xb6, 0xfd, 0xaa,
+		    0x5a, 0xd0, 0x8b, 0x10, 0xee, 0xce, 0x35, 0x47, 0xbc, 0x4b,
+		    0x9f, 0x27, 0xa6, 0xe2, 0x93, 0xc8, 0xdb, 0xa6, 0xd3, 0x99,
+		    0xa2, 0x84, 0xfd, 0x9b, 0xc4, 0x6b, 0xc1, 0x8a, 0x7c, 0x3b,
+		    0x90, 0x6d, 0xfb, 0x69, 0x48, 0x63, 0x8f, 0x63, 0x5a, 0x6f,
+		    0xb0, 0x15, 0xff, 0x20, 0xf8, 0x1a, 0x69, 0x05, 0x42, 0x66,
+		    0x98, 0x9e, 0x8d, 0xfb, 0xc5, 0xc6, 0x0e, 0x67 ) );
+
+/* RSA-PSS SHA-384 signature test (1025-bit modulus) */
+RSA_PSS_TEST ( pss_sha384_test,
+	PRIVATE ( 0x30, 0x82, 0x02, 0x5f, 0x02, 0x01, 0x00, 0x02, 0x81, 0x81,
+		  0x01, 0x61, 0x7c, 0x75, 0x2a, 0x68, 0x0b, 0x7b, 0xbe, 0x47,
+		  0xeb, 0x24, 0x48, 0x54, 0x53, 0x0f, 0x41, 0xdd, 0x85, 0xa9,
+		  0xe1, 0x71, 0xa2, 0x85, 0xb4, 0xd4, 0xdd, 0x31, 0xb1, 0xac,
+		  0xc2, 0x03, 0x81, 0xe3, 0x04, 0xfb, 0xf5, 0x93, 0x9f, 0xea,
+		  0x13, 0x74, 0x22, 0x75, 0x91, 0x82, 0xbc, 0x02, 0xc6, 0xfd,
+		  0x1c, 0x49, 0xbd, 0x66, 0x75, 0x03, 0xf3, 0xc3, 0x51, 0xca,
+		  0x95, 0x80, 0xe9, 0x77, 0x6a, 0x6e, 0xfe, 0x2e, 0x0a, 0x4a,
+		  0x51, 0x70, 0xbe, 0x1d, 0xa8, 0xd6, 0x8b, 0x79, 0xdb, 0x23,
+		  0x92, 0x1e, 0x8a, 0xe3, 0x97, 0x7a, 0xe9, 0x1c, 0x44, 0xee,
+		  0x33, 0xb2, 0x15, 0x84, 0xc2, 0x99, 0xf7, 0x69, 0xa8, 0xd1,
+		  0xb6, 0x49, 0x3e, 0x52, 0x8c, 0x8d, 0xec, 0x6b, 0xfe, 0xbf,
+		  0x25, 0x0b, 0x34, 0xe5, 0x72, 0x95, 0xca, 0x79, 0xc4, 0xcc,
+		  0xbf, 0x7b, 0xcc, 0x22, 0xd3, 0xcd, 0xe1, 0x0c, 0xc7, 0x02,
+		  0x03, 0x01, 0x00, 0x01, 0x02, 0x81, 0x81, 0x01, 0x3a, 0xed,
+		  0x3b, 0x25, 0xb0, 0xd4, 0xaa, 0x46, 0x78, 0xa4, 0x92, 0x0a,
+		  0xae, 0xb5, 0xe1, 0x5d, 0xf9, 0x12, 0x60, 0xab, 0xae, 0x25,
+		  0xf1, 0xa1, 0x8e, 0x14, 0x13, 0x76, 0x0c, 0x48, 0x3d, 0xff,
+		  0xb6, 0x56, 0x76, 0x73, 0xf0, 0x36, 0x04, 0xc1, 0x98, 0x32,
+		  0x2b, 0x34, 0x9c, 0x99, 0x0c, 0x90, 0x64, 0x68, 0x93, 0x79,
+		  0xde, 0x92, 0x5a, 0x17, 0x0e, 0xe9, 0x0b, 0xe7, 0xee, 0x96,
+		  0x11, 0xff, 0xd0, 0x5c, 0x3e, 0x8b, 0xd3, 0x9a, 0x48, 0xe4,
+		  0x38, 0xf7, 0x67, 0x6c, 0x9d, 0xaa, 0x28, 0x63, 0xda, 0x07,
+		  0x97, 0x16, 0x1f, 0xc7, 0xef, 0x02, 0x8c, 0x39, 0xaf, 0x0e,
+		  0x4d, 0x47, 0x9a, 0x25, 0x2a, 0x50, 0x27, 0xa7, 0x78, 0xe7,
+		  0x62, 0xa6, 0x67, 0x7d, 0x00, 0x5b, 0x65, 0x08, 0x12, 0xd9,
+		  0xc8, 0x03, 0x6c, 0x7f, 0xbe, 0xc8, 0xf6, 0x82, 0xd2, 0x74,
+		  0xd1, 0x58, 0x7e, 0xc1, 0x7f, 0x01, 0x02, 0x41, 0x01, 0xb2,
+		  0xd1, 0x24, 0x5e, 0x9a, 0x2f, 0x6f, 0xf8, 0x22, 0xcd, 0x6e,
+		  0x7d, 0xb0, 0x0d, 0xd0, 0x8b, 0x47, 0x35, 0x51, 0x25, 0xdd,
+		  0x6d, 0x1f, 0x67, 0xf1, 0xcf, 0xaa, 0x25, 0x2e, 0x9d, 0xfe,
+		  0xf2, 0x11, 0x10, 0xc3, 0x00, 0x5b, 0x06, 0xd9, 0x15, 0xb6,
+		  0x78, 0x19, 0x7a, 0xc6, 0xf5, 0x70, 0xed, 0x64, 0x29, 0x98,
+		  0x7b, 0x6d, 0xad, 0x52, 0xee, 0x1d, 0x0b, 0x69, 0x2c, 0x50,
+		  0xaf, 0x57, 0xe7, 0x02, 0x41, 0x00, 0xd0, 0x1d, 0xbf, 0xe3,
+		  0x7b, 0xe9, 0xd3, 0xbe, 0x21, 0xe1, 0x62, 0x99, 0x78, 0xf5,
+		  0x3b, 0x41, 0x0e, 0x63, 0x55, 0x98, 0xf5, 0x21, 0x25, 0xa0,
+		  0xba, 0xac, 0xe7, 0x67, 0xfa, 0x6d, 0xe1, 0x96, 0xfe, 0xf3,
+		  0xc5, 0x94, 0x57, 0xd5, 0xaa, 0xf7, 0x3a, 0x12, 0x83, 0xb0,
+		  0x9d, 0x60, 0x96, 0x1d, 0x5d, 0xd5, 0xf9, 0x59, 0x4f, 0x5d,
+		  0x21, 0x69, 0x15, 0xf8, 0xea, 0xd7, 0x98, 0x4c, 0x88, 0x21,
+		  0x02, 0x41, 0x01, 0xaf, 0xb9, 0xa6, 0xc1, 0xe3, 0x97, 0x7c,
+		  0x36, 0x44, 0xdf, 0xf2, 0x78, 0x0b, 0x48, 0xfc, 0x2a, 0x7e,
+		  0x0e, 0x7b, 0x3e, 0xfc, 0x66, 0xef, 0xca, 0xf6, 0x36, 0x79,
+		  0xba, 0xa7, 0x59, 0xaa, 0x9c, 0x50, 0xc3, 0x72, 0xca, 0xb4,
+		  0x96, 0xcd, 0x0e, 0x98, 0xf9, 0x10, 0x5b, 0x6e, 0x96, 0x9e,
+		  0x84, 0xa6, 0x72, 0x02, 0x7b, 0x72, 0xff, 0xa8, 0x1a, 0xd2,
+		  0x6d, 0xd5, 0x04, 0x72, 0x2c, 0x57, 0x3b, 0x02, 0x41, 0x00,
+		  0xc5, 0xcb, 0xb0, 0x87, 0x75, 0x4a, 0xbb, 0xdb, 0x15, 0xfa,
+		  0x4f, 0x2a, 0xcc, 0x02, 0x4e, 0xe9, 0xba, 0xd2, 0x00, 0x15,
+		  0x9a, 0xcc, 0x81, 0x25, 0xac, 0xa6, 0x0e, 0x5d, 0x0d, 0x6f,
+		  0x87, 0x9b, 0x69, 0xfe, 0xa7, 0xc7, 0x20, 0x5f, 0xcb, 0xd8,
+		  0xa2, 0x91, 0xdc, 0x25, 0x6c, 0xbd, 0xd2, 0x8e, 0x60, 0x93,
+		  0xb0, 0x24, 0x08, 0xc0, 0xdb, 0xb3, 0x33, 0x95, 0xdb, 0x25,
+		  0x42, 0xf3, 0x61, 0xe1, 0x02, 0x41, 0x01, 0x01, 0x72, 0x81,
+		  0x00, 0x68, 0xb7, 0xe5, 0x5c, 0x17, 0xda, 0x9d, 0x33, 0xd6,
+		  0x6b, 0xa0, 0xdb, 0xe7, 0x21, 0x92, 0xda, 0xa8, 0x98, 0x20,
+		  0x52, 0xb7, 0x48, 0xa2, 0x60, 0xd6, 0x2e, 0x0d, 0x0d, 0x97,
+		  0xe4, 0x04, 0x00, 0x81, 0x62, 0xab, 0x0b, 0x89, 0x1a, 0xc0,
+		  0x81, 0x34, 0xa1, 0x49, 0x3a, 0xa9, 0xee, 0x99, 0xc6, 0x89,
+		  0x4e, 0x40, 0xdb, 0xa2, 0x28, 0xdb, 0x40, 0x01, 0xe9, 0xbc,
+		  0xdc ),
+	PUBLIC ( 0x30, 0x81, 0x9f, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48,
+		 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00, 0x03, 0x81,
+		 0x8d, 0x00, 0x30, 0x81, 0x89, 0x02, 0x81, 0x81, 0x01, 0x61,
+		 0x7c, 0x75, 0x2a, 0x68, 0x0b, 0x7b, 0xbe, 0x47, 0xeb, 0x24,
+		 0x48, 0x54, 0x53, 0x0f, 0x41, 0xdd, 0x85, 0xa9, 0xe1, 0x71,
+		 0xa2, 0x85, 0xb4, 0xd4, 0xdd, 0x31, 0xb1, 0xac, 0xc2, 0x03,
+		 0x81, 0xe3, 0x04, 0xfb, 0xf5, 0x93, 0x9f, 0xea, 0x13, 0x74,
+		 0x22, 0x75, 0x91, 0x82, 0xbc, 0x02, 0xc6, 0xfd, 0x1c, 0x49,
+		 0xbd, 0x66, 0x75, 0x03, 0xf3, 0xc3, 0x51, 0xca, 0x95, 0x80,
+		 0xe9, 0x77, 0x6a, 0x6e, 0xfe, 0x2e, 0x0a, 0x4a, 0x51, 0x70,
+		 0xbe, 0x1d, 0xa8, 0xd6, 0x8b, 0x79, 0xdb, 0x23, 0x92, 0x1e,
+		 0x8a, 0xe3, 0x97, 0x7a, 0xe9, 0x1c, 0x44, 0xee, 0x33, 0xb2,
+		 0x15, 0x84, 0xc2, 0x99, 0xf7, 0x69, 0xa8, 0xd1, 0xb6, 0x49,
+		 0x3e, 0x52, 0x8c, 0x8d, 0xec, 0x6b, 0xfe, 0xbf, 0x25, 0x0b,
+		 0x34, 0xe5, 0x72, 0x95, 0xca, 0x79, 0xc4, 0xcc, 0xbf, 0x7b,
+		 0xcc, 0x22, 0xd3, 0xcd, 0xe1, 0x0c, 0xc7, 0x02, 0x03, 0x01,
+		 0x00, 0x01 ),
+	PLAINTEXT ( 'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd' ),
+	&sha384_algorithm,
+	SIGNATURE ( 0x00, 0xec, 0x07, 0x19, 0x68, 0xfd, 0x5c, 0x37, 0xa0, 0xc6,
+		    0x65, 0x06, 0x01, 0xe8, 0x2b, 0xb7, 0x09, 0x16, 0xa6, 0xf1,
+		    0xcd, 0x22, 0x3d, 0x0e, 0x30, 0xbd, 0x31, 0x72, 0xb0, 0xf9,
+		    0x67, 0x89, 0x2d, 0x41, 0x0c, 0x88, 0xca, 0x5f, 0xa0, 0x57,
+		    0x73, 0x36, 0x0a, 0x4d, 0x2c, 0xf3, 0x42, 0xe7, 0x50, 0xba,
+		    0x7d, 0xb7, 0x25, 0xbb, 0x21, 0x61, 0xb7, 0x92, 0x75, 0x5e,
+		    0x7a, 0xd4, 0xa4, 0xd0, 0x2b, 0x63, 0xf9, 0xc0, 0xf7, 0x33,
+		    0x66, 0x4e, 0x17, 0xb4, 0xa5, 0x65, 0x5c, 0x4f, 0x03, 0x69,
+		    0xd7, 0xb2, 0x37, 0x76, 0x80, 0xfd, 0xc4, 0x0e, 0x3b, 0x34,
+		    0x41, 0x6c, 0x46, 0xb7, 0xba, 0x81, 0x31, 0xc1, 0x76, 0xcf,
+		    0xed, 0x5c, 0x8b, 0xa2, 0xf3, 0xd2, 0xa7, 0xdc, 0x33, 0x3d,
+		    0xe0, 0x74, 0x81, 0x19, 0x06, 0xc9, 0xe2, 0x98, 0x7d, 0x70,
+		    0x81, 0x6f, 0x9b, 0xde, 0x83, 0xe1, 0x0d, 0x6c, 0x92 ) );
+
 /**
  * Perform RSA self-tests
  *
@@ -489,6 +781,8 @@ static void rsa_test_exec ( void ) {
 	rsa_signature_ok ( &md5_test );
 	rsa_signature_ok ( &sha1_test );
 	rsa_signature_ok ( &sha256_test );
+	rsa_pss_ok ( &pss_sha256_test );
+	rsa_pss_ok ( &pss_sha384_test );
 }
 
 /** RSA self-test */
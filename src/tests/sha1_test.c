@@ -58,6 +58,12 @@ DIGEST_TEST ( sha1_nist_abc_opq, &sha1_algorithm, DIGEST_NIST_ABC_OPQ,
 		       0xae, 0x4a, 0xa1, 0xf9, 0x51, 0x29, 0xe5, 0xe5, 0x46,
 		       0x70, 0xf1 ) );
 
+/* NIST test vector "abc...stu" */
+DIGEST_TEST ( sha1_nist_abc_stu, &sha1_algorithm, DIGEST_NIST_ABC_STU,
+	      DIGEST ( 0xa4, 0x9b, 0x24, 0x46, 0xa0, 0x2c, 0x64, 0x5b, 0xf4,
+		       0x19, 0xf9, 0x95, 0xb6, 0x70, 0x91, 0x25, 0x3a, 0x04,
+		       0xa2, 0x59 ) );
+
 /**
  * Perform SHA-1 self-test
  *
@@ -68,10 +74,15 @@ static void sha1_test_exec ( void ) {
 	digest_ok ( &sha1_empty );
 	digest_ok ( &sha1_nist_abc );
 	digest_ok ( &sha1_nist_abc_opq );
+	digest_ok ( &sha1_nist_abc_stu );
+
+	/* Block function implementation tests */
+	digest_accel_ok ( &sha1_algorithm );
 
 	/* Speed tests */
-	DBG ( "SHA1 required %ld cycles per byte\n",
-	      digest_cost ( &sha1_algorithm ) );
+	DBG ( "SHA1 required %ld cycles per byte (%ld MB/s)\n",
+	      digest_cost ( &sha1_algorithm ),
+	      digest_rate ( &sha1_algorithm ) );
 }
 
 /** SHA-1 self-test */
@@ -37,6 +37,7 @@ REQUIRE_OBJECT ( string_test );
 REQUIRE_OBJECT ( math_test );
 REQUIRE_OBJECT ( vsprintf_test );
 REQUIRE_OBJECT ( list_test );
+REQUIRE_OBJECT ( rbtree_test );
 REQUIRE_OBJECT ( byteswap_test );
 REQUIRE_OBJECT ( base64_test );
 REQUIRE_OBJECT ( base16_test );
@@ -78,5 +79,11 @@ REQUIRE_OBJECT ( gzip_test );
 REQUIRE_OBJECT ( utf8_test );
 REQUIRE_OBJECT ( acpi_test );
 REQUIRE_OBJECT ( hmac_test );
+REQUIRE_OBJECT ( hkdf_test );
 REQUIRE_OBJECT ( dhe_test );
 REQUIRE_OBJECT ( gcm_test );
+REQUIRE_OBJECT ( x25519_test );
+REQUIRE_OBJECT ( p256_test );
+REQUIRE_OBJECT ( ecdsa_test );
+REQUIRE_OBJECT ( xferbuf_test );
+REQUIRE_OBJECT ( retry_test );
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Data transfer buffer tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/test.h>
+
+/** Number of test buffer reallocations */
+static unsigned int xferbuf_test_reallocs;
+
+/** Maximum size of test buffer */
+static size_t xferbuf_test_max_len;
+
+/**
+ * Reallocate test data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v len		New length (or zero to free buffer)
+ * @ret rc		Return status code
+ */
+static int xferbuf_test_realloc ( struct xfer_buffer *xferbuf, size_t len ) {
+
+	/* Simulate a limited amount of available memory */
+	if ( len > xferbuf_test_max_len )
+		return -ENOSPC;
+
+	/* Count reallocations */
+	xferbuf_test_reallocs++;
+
+	return xferbuf_malloc_operations.realloc ( xferbuf, len );
+}
+
+/**
+ * Write data to test data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @v data		Data to copy
+ * @v len		Length of data
+ */
+static void xferbuf_test_write ( struct xfer_buffer *xferbuf, size_t offset,
+				 const void *data, size_t len ) {
+
+	xferbuf_malloc_operations.write ( xferbuf, offset, data, len );
+}
+
+/**
+ * Read data from test data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @v data		Data to read
+ * @v len		Length of data
+ */
+static void xferbuf_test_read ( struct xfer_buffer *xferbuf, size_t offset,
+				void *data, size_t len ) {
+
+	xferbuf_malloc_operations.read ( xferbuf, offset, data, len );
+}
+
+/** Test data buffer operations */
+static struct xfer_buffer_operations xferbuf_test_operations = {
+	.realloc = xferbuf_test_realloc,
+	.write = xferbuf_test_write,
+	.read = xferbuf_test_read,
+};
+
+/**
+ * Report data transfer buffer append test result
+ *
+ * @v presize		Total length is known in advance
+ * @v max_len		Maximum size of buffer
+ * @v count		Number of writes
+ * @v len		Length of each write
+ * @v max_reallocs	Maximum expected number of reallocations
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void xferbuf_append_okx ( int presize, size_t max_len,
+				 unsigned int count, size_t len,
+				 unsigned int max_reallocs,
+				 const char *file, unsigned int line ) {
+	struct xfer_buffer xferbuf;
+	uint8_t data[len];
+	uint8_t expected[len];
+	size_t total = ( count * len );
+	unsigned int i;
+
+	/* Initialise buffer */
+	memset ( &xferbuf, 0, sizeof ( xferbuf ) );
+	xferbuf.op = &xferbuf_test_operations;
+	xferbuf_test_max_len = max_len;
+	xferbuf_test_reallocs = 0;
+
+	/* Record total length, if known */
+	if ( presize ) {
+		okx ( xferbuf_write ( &xferbuf, total, NULL, 0 ) == 0,
+		      file, line );
+		okx ( xferbuf.allocated == total, file, line );
+	}
+
+	/* Append data */
+	for ( i = 0 ; i < count ; i++ ) {
+		memset ( data, i, sizeof ( data ) );
+		okx ( xferbuf_write ( &xferbuf, ( i * len ), data,
+				      sizeof ( data ) ) == 0, file, line );
+		okx ( xferbuf.len == ( presize ? total : ( ( i + 1 ) * len ) ),
+		      file, line );
+		okx ( xferbuf.allocated >= xferbuf.len, file, line );
+	}
+	okx ( xferbuf_test_reallocs <= max_reallocs, file, line );
+
+	/* Trim buffer */
+	xferbuf_trim ( &xferbuf );
+	okx ( xferbuf.len == total, file, line );
+	okx ( xferbuf.allocated == total, file, line );
+
+	/* Verify data */
+	for ( i = 0 ; i < count ; i++ ) {
+		memset ( expected, i, sizeof ( expected ) );
+		okx ( xferbuf_read ( &xferbuf, ( i * len ), data,
+				     sizeof ( data ) ) == 0, file, line );
+		okx ( memcmp ( data, expected, sizeof ( data ) ) == 0,
+		      file, line );
+	}
+	okx ( xferbuf_read ( &xferbuf, total, data, 1 ) != 0, file, line );
+
+	/* Free buffer */
+	xferbuf_free ( &xferbuf );
+	okx ( xferbuf.len == 0, file, line );
+	okx ( xferbuf.allocated == 0, file, line );
+}
+#define xferbuf_append_ok( presize, max_len, count, len, max_reallocs ) \
+	xferbuf_append_okx ( presize, max_len, count, len, max_reallocs, \
+			     __FILE__, __LINE__ )
+
+/**
+ * Perform data transfer buffer self-tests
+ *
+ */
+static void xferbuf_test_exec ( void ) {
+	struct xfer_buffer xferbuf;
+	uint8_t data[64];
+
+	/* Data of unknown length should require only a logarithmic
+	 * number of reallocations.
+	 */
+	xferbuf_append_ok ( 0, -1UL, 1000, 100, 20 );
+	xferbuf_append_ok ( 0, -1UL, 4096, 1, 24 );
+
+	/* Data of known length should require a single allocation */
+	xferbuf_append_ok ( 1, -1UL, 1000, 100, 1 );
+
+	/* Data should still fit if geometric growth is not possible */
+	xferbuf_append_ok ( 0, 100000, 1000, 100, 1000 );
+
+	/* Writes beyond the available space should fail */
+	memset ( &xferbuf, 0, sizeof ( xferbuf ) );
+	xferbuf.op = &xferbuf_test_operations;
+	xferbuf_test_max_len = 100;
+	memset ( data, 0, sizeof ( data ) );
+	ok ( xferbuf_write ( &xferbuf, 0, data, sizeof ( data ) ) == 0 );
+	ok ( xferbuf_write ( &xferbuf, 64, data, sizeof ( data ) ) != 0 );
+	ok ( xferbuf.len == 64 );
+	ok ( xferbuf_write ( &xferbuf, 36, data, sizeof ( data ) ) == 0 );
+	ok ( xferbuf.len == 100 );
+	xferbuf_free ( &xferbuf );
+}
+
+/** Data transfer buffer self-test */
+struct self_test xferbuf_test __self_test = {
+	.name = "xferbuf",
+	.exec = xferbuf_test_exec,
+};
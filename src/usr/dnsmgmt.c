@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <string.h>
+#include <ipxe/socket.h>
+#include <ipxe/timer.h>
+#include <ipxe/dns.h>
+#include <usr/dnsmgmt.h>
+
+/** @file
+ *
+ * DNS cache management
+ *
+ */
+
+/**
+ * Print DNS cache
+ *
+ */
+void dnsstat ( void ) {
+	struct dns_cache_entry *entry;
+	unsigned long now = currticks();
+	unsigned long age;
+
+	list_for_each_entry ( entry, &dns_cache, list ) {
+		age = ( now - entry->created );
+		printf ( "%s is %s", entry->name,
+			 ( entry->rc ? strerror ( entry->rc ) :
+			   sock_ntoa ( &entry->address.sa ) ) );
+		if ( age < entry->lifetime ) {
+			printf ( " (expires in %lds)",
+				 ( ( entry->lifetime - age ) /
+				   TICKS_PER_SEC ) );
+		} else {
+			printf ( " (expired)" );
+		}
+		printf ( "\n" );
+	}
+}